@@ -18,6 +18,7 @@
 
 #include "mir/dispatch/multiplexing_dispatchable.h"
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <memory>
@@ -72,6 +73,48 @@ private:
 
 thread_local uint64_t TestDispatchable::dispatch_count = 0;
 
+/// A pipe that stays readable, so it is ready on every epoll_wait()
+class AlwaysReadyDispatchable : public md::Dispatchable
+{
+public:
+    AlwaysReadyDispatchable(std::atomic<uint64_t>& dispatch_count)
+        : dispatch_count{dispatch_count}
+    {
+        int pipefds[2];
+        if (pipe(pipefds) < 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        }
+
+        read_fd = mir::Fd{pipefds[0]};
+        write_fd = mir::Fd{pipefds[1]};
+
+        char dummy{0};
+        if (::write(write_fd, &dummy, sizeof(dummy)) != sizeof(dummy))
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to mark dispatchable"};
+        }
+    }
+
+    mir::Fd watch_fd() const override
+    {
+        return read_fd;
+    }
+    bool dispatch(md::FdEvents) override
+    {
+        dispatch_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    md::FdEvents relevant_events() const override
+    {
+        return md::FdEvent::readable;
+    }
+
+private:
+    std::atomic<uint64_t>& dispatch_count;
+    mir::Fd read_fd, write_fd;
+};
+
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -117,5 +160,30 @@ int main(int argc, char** argv)
 
     auto duration = std::chrono::steady_clock::now() - start;
     std::cout<<"Dispatching "<<dispatch_count<<" times took "<<std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()<<"ns"<<std::endl;
+
+    // Single-threaded throughput with many busy sources, one event per dispatch() versus batches
+    for (int const fds : {1, 10, 100})
+    {
+        for (int const batch : {1, 16})
+        {
+            std::atomic<uint64_t> dispatched{0};
+            md::MultiplexingDispatchable multiplexer(batch);
+            for (int i = 0; i < fds; ++i)
+            {
+                multiplexer.add_watch(std::make_shared<AlwaysReadyDispatchable>(dispatched));
+            }
+
+            auto const batch_start = std::chrono::steady_clock::now();
+            while (dispatched < dispatch_count)
+            {
+                multiplexer.dispatch(md::FdEvent::readable);
+            }
+            auto const elapsed = std::chrono::steady_clock::now() - batch_start;
+
+            std::cout<<fds<<" fd(s), up to "<<batch<<" event(s) per dispatch: "
+                     <<dispatched * 1e9 / std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+                     <<" dispatches/s"<<std::endl;
+        }
+    }
     exit(0);
 }
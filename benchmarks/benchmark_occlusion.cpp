@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/occlusion.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+namespace geom = mir::geometry;
+namespace mg = mir::graphics;
+namespace mc = mir::compositor;
+
+namespace
+{
+struct Window : mg::Renderable
+{
+    explicit Window(geom::Rectangle const& position)
+        : position{position}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return nullptr; }
+    geom::Rectangle screen_position() const override { return position; }
+    std::experimental::optional<geom::Rectangle> clip_area() const override { return {}; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4(1); }
+    bool shaped() const override { return false; }
+    unsigned int swap_interval() const override { return 1; }
+
+    geom::Rectangle const position;
+};
+
+struct Element : mc::SceneElement
+{
+    explicit Element(std::shared_ptr<mg::Renderable> const& window)
+        : window{window}
+    {
+    }
+
+    std::shared_ptr<mg::Renderable> renderable() const override { return window; }
+    void rendered() override {}
+    void occluded() override {}
+
+    std::shared_ptr<mg::Renderable> const window;
+};
+
+/// Windows of 100x100 to 800x600 scattered over a 3840x2160 output, bottom to top
+auto make_scene(int windows, std::mt19937& random) -> mc::SceneElementSequence
+{
+    std::uniform_int_distribution<int> width{100, 800};
+    std::uniform_int_distribution<int> height{100, 600};
+    std::uniform_int_distribution<int> x{-100, 3840};
+    std::uniform_int_distribution<int> y{-100, 2160};
+
+    mc::SceneElementSequence scene;
+    for (int i = 0; i != windows; ++i)
+    {
+        auto const window = std::make_shared<Window>(geom::Rectangle{{x(random), y(random)}, {width(random), height(random)}});
+        scene.push_back(std::make_shared<Element>(window));
+    }
+    return scene;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of windows> <frames>"<<std::endl;
+        exit(1);
+    }
+
+    int const windows = std::atoi(argv[1]);
+    uint64_t const frames = std::atoll(argv[2]);
+
+    std::mt19937 random{42};
+    auto const scene = make_scene(windows, random);
+    geom::Rectangle const output{{0, 0}, {3840, 2160}};
+
+    size_t occluded{0};
+    size_t drawn{0};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i != frames; ++i)
+    {
+        // As the compositor does: a fresh copy of the scene each frame
+        auto elements = scene;
+        occluded += mc::filter_occlusions_from(elements, output).size();
+        drawn += elements.size();
+    }
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    std::cout << windows << " windows: "
+              << static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) / frames
+              << "us per frame, "
+              << occluded / frames << " occluded, "
+              << drawn / frames << " drawn" << std::endl;
+
+    exit(0);
+}
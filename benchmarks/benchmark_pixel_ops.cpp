@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/pixel_ops.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace mgp = mir::graphics::pixel_ops;
+
+namespace
+{
+/*
+ * The scalar versions: what the KMS cursor, GLPixelBuffer and the decoration renderer
+ * did before they used pixel_ops, and the obvious loops for the rest.
+ */
+void scalar_rotate_left(uint8_t const* src, unsigned width, unsigned height, uint8_t* dest)
+{
+    auto const src_stride = width * 4;
+    auto const dest_stride = height * 4;
+    for (unsigned row = 0; row != width; ++row)
+        for (unsigned col = 0; col != height; ++col)
+            memcpy(dest + row * dest_stride + 4 * col, src + ((width - 1) - row) * 4 + src_stride * col, 4);
+}
+
+void scalar_rotate_inverted(uint8_t const* src, unsigned width, unsigned height, uint8_t* dest)
+{
+    auto const stride = width * 4;
+    for (unsigned row = 0; row != height; ++row)
+        for (unsigned col = 0; col != width; ++col)
+            memcpy(dest + row * stride + 4 * col, src + ((height - 1) - row) * stride + 4 * ((width - 1) - col), 4);
+}
+
+void scalar_flip_and_swizzle(char* pixels, unsigned width, unsigned height)
+{
+    auto const convert_line = [width](char* src, char* dst)
+        {
+            auto pixels_src = reinterpret_cast<uint32_t*>(src);
+            auto pixels_dst = reinterpret_cast<uint32_t*>(dst);
+            for (uint32_t n = 0; n < width; n++)
+            {
+                auto const p = pixels_src[n];
+                pixels_dst[n] = ((p << 16) & 0x00ff0000) | (p & 0x0000ff00) | ((p >> 16) & 0x000000ff) | (p & 0xff000000);
+            }
+        };
+
+    auto const stride = width * 4;
+    std::vector<char> tmp(stride);
+    for (unsigned i = 0; i < height / 2; i++)
+    {
+        tmp.assign(&pixels[i * stride], &pixels[(i + 1) * stride]);
+        convert_line(&pixels[(height - i - 1) * stride], &pixels[i * stride]);
+        convert_line(tmp.data(), &pixels[(height - i - 1) * stride]);
+    }
+    if (height % 2 == 1)
+        convert_line(&pixels[(height / 2) * stride], &pixels[(height / 2) * stride]);
+}
+
+void scalar_blend(uint32_t* pixels, unsigned char const* coverage, size_t count, uint32_t color)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const alpha = coverage[i] * (color >> 24) / 255;
+        uint32_t blended = pixels[i] & 0xFF000000;
+        for (int shift = 0; shift != 24; shift += 8)
+        {
+            auto const channel = (((pixels[i] >> shift) & 0xFF) * (255 - alpha) + ((color >> shift) & 0xFF) * alpha) / 255;
+            blended |= channel << shift;
+        }
+        pixels[i] = blended;
+    }
+}
+
+void scalar_expand_rgb_565(uint16_t const* src, uint32_t* dest, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        uint32_t const r = src[i] >> 11, g = (src[i] >> 5) & 0x3F, b = src[i] & 0x1F;
+        dest[i] = 0xFF000000 | ((r * 255 / 31) << 16) | ((g * 255 / 63) << 8) | (b * 255 / 31);
+    }
+}
+
+void scalar_premultiply(uint32_t const* src, uint32_t* dest, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+    {
+        auto const a = src[i] >> 24;
+        dest[i] = (src[i] & 0xFF000000) |
+            ((((src[i] >> 16) & 0xFF) * a / 255) << 16) |
+            ((((src[i] >> 8) & 0xFF) * a / 255) << 8) |
+            ((src[i] & 0xFF) * a / 255);
+    }
+}
+
+template<typename Op>
+auto microseconds_per_run(int iterations, Op const& op) -> double
+{
+    op();   // Warm the caches
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != iterations; ++i)
+        op();
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::micro>{duration}.count() / iterations;
+}
+
+void compare(char const* name, int iterations, void (*scalar)(), void (*vectorized)())
+{
+    auto const before = microseconds_per_run(iterations, scalar);
+    auto const after = microseconds_per_run(iterations, vectorized);
+    std::cout << name << ": " << before << "us scalar, " << after << "us pixel_ops ("
+              << before / after << "x)" << std::endl;
+}
+
+unsigned width;
+unsigned height;
+std::vector<uint32_t> image;
+std::vector<uint32_t> output;
+std::vector<uint16_t> narrow_image;
+std::vector<unsigned char> coverage;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <width> <height> <iterations>"<<std::endl;
+        exit(1);
+    }
+
+    width = std::atoi(argv[1]);
+    height = std::atoi(argv[2]);
+    int const iterations = std::atoi(argv[3]);
+
+    size_t const count = width * height;
+    image.resize(count);
+    output.resize(count);
+    narrow_image.resize(count);
+    coverage.resize(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+        image[i] = static_cast<uint32_t>(i * 0x9E3779B1u);
+        narrow_image[i] = static_cast<uint16_t>(image[i]);
+        coverage[i] = static_cast<unsigned char>(image[i] >> 8);
+    }
+
+    std::cout << width << "x" << height << ":" << std::endl;
+
+    compare("rotate left", iterations,
+        []{ scalar_rotate_left(reinterpret_cast<uint8_t*>(image.data()), width, height, reinterpret_cast<uint8_t*>(output.data())); },
+        []{ mgp::rotate(mir_orientation_left, image.data(), width * 4, width, height, output.data(), height * 4); });
+
+    compare("rotate inverted", iterations,
+        []{ scalar_rotate_inverted(reinterpret_cast<uint8_t*>(image.data()), width, height, reinterpret_cast<uint8_t*>(output.data())); },
+        []{ mgp::rotate(mir_orientation_inverted, image.data(), width * 4, width, height, output.data(), width * 4); });
+
+    compare("flip and swap red/blue", iterations,
+        []{ scalar_flip_and_swizzle(reinterpret_cast<char*>(image.data()), width, height); },
+        []
+        {
+            mgp::swap_red_and_blue(image.data(), image.data(), image.size());
+            mgp::flip_vertically(image.data(), width * 4, height);
+        });
+
+    compare("blend coverage", iterations,
+        []{ scalar_blend(image.data(), coverage.data(), image.size(), 0xC0204080); },
+        []{ mgp::blend_coverage(image.data(), coverage.data(), image.size(), 0xC0204080); });
+
+    compare("expand rgb_565", iterations,
+        []{ scalar_expand_rgb_565(narrow_image.data(), output.data(), output.size()); },
+        []{ mgp::expand_rgb_565(narrow_image.data(), output.data(), output.size()); });
+
+    compare("premultiply", iterations,
+        []{ scalar_premultiply(image.data(), output.data(), output.size()); },
+        []{ mgp::premultiply_alpha(image.data(), output.data(), output.size()); });
+
+    exit(0);
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/recursive_read_write_mutex.h"
+#include "mir/recursive_shared_mutex.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Adapts both mutexes to the same read locking interface
+struct OldMutex
+{
+    static char const* name() { return "RecursiveReadWriteMutex"; }
+    void read_lock() { mutex.read_lock(); }
+    void read_unlock() { mutex.read_unlock(); }
+    void write_lock() { mutex.write_lock(); }
+    void write_unlock() { mutex.write_unlock(); }
+
+    mir::RecursiveReadWriteMutex mutex;
+};
+
+struct NewMutex
+{
+    static char const* name() { return "RecursiveSharedMutex"; }
+    void read_lock() { mutex.lock_shared(); }
+    void read_unlock() { mutex.unlock_shared(); }
+    void write_lock() { mutex.lock(); }
+    void write_unlock() { mutex.unlock(); }
+
+    mir::RecursiveSharedMutex mutex;
+};
+
+/// The mean cost, in nanoseconds, of a read lock and unlock on each of \a threads threads
+template<typename Mutex>
+auto read_cost(int threads, uint64_t iterations, bool with_writer) -> double
+{
+    Mutex mutex;
+    std::atomic<bool> go{false};
+    std::atomic<bool> done{false};
+    std::atomic<int> ready{0};
+
+    std::thread writer;
+    if (with_writer)
+    {
+        writer = std::thread{[&]
+            {
+                while (!done)
+                {
+                    mutex.write_lock();
+                    mutex.write_unlock();
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                }
+            }};
+    }
+
+    std::vector<std::thread> readers;
+    std::vector<std::chrono::nanoseconds> durations(threads);
+
+    for (int i = 0; i < threads; ++i)
+    {
+        readers.emplace_back([&, i]
+            {
+                ++ready;
+                while (!go) std::this_thread::yield();
+
+                auto const start = std::chrono::steady_clock::now();
+                for (uint64_t j = 0; j != iterations; ++j)
+                {
+                    mutex.read_lock();
+                    mutex.read_unlock();
+                }
+                durations[i] = std::chrono::steady_clock::now() - start;
+            });
+    }
+
+    while (ready != threads) std::this_thread::yield();
+    go = true;
+
+    for (auto& thread : readers)
+        thread.join();
+
+    done = true;
+    if (writer.joinable())
+        writer.join();
+
+    std::chrono::nanoseconds total{0};
+    for (auto const& duration : durations)
+        total += duration;
+
+    return static_cast<double>(total.count()) / (threads * iterations);
+}
+
+template<typename Mutex>
+void report(int max_threads, uint64_t iterations)
+{
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::cout << Mutex::name() << ": " << threads << " reader(s): "
+                  << read_cost<Mutex>(threads, iterations, false) << "ns per read lock, "
+                  << read_cost<Mutex>(threads, iterations, true) << "ns with a writer"
+                  << std::endl;
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <max number of reader threads> <read locks per thread>"<<std::endl;
+        exit(1);
+    }
+
+    int const max_threads = std::atoi(argv[1]);
+    uint64_t const iterations = std::atoll(argv[2]);
+
+    report<OldMutex>(max_threads, iterations);
+    report<NewMutex>(max_threads, iterations);
+
+    exit(0);
+}
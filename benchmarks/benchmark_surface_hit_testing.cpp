@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/spatial_index.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace geom = mir::geometry;
+
+namespace
+{
+/// Stands in for a surface: the input area is its bounds
+struct Surface
+{
+    geom::Rectangle bounds;
+
+    auto input_area_contains(geom::Point const& point) const -> bool
+    {
+        return bounds.contains(point);
+    }
+};
+
+using Stack = std::vector<std::shared_ptr<Surface>>;
+
+/// Windows of 100x100 to 800x600 scattered over a 3840x2160 output, bottom to top
+auto make_stack(int surfaces, std::mt19937& random) -> Stack
+{
+    std::uniform_int_distribution<int> width{100, 800};
+    std::uniform_int_distribution<int> height{100, 600};
+    std::uniform_int_distribution<int> x{-100, 3840};
+    std::uniform_int_distribution<int> y{-100, 2160};
+
+    Stack stack;
+    for (int i = 0; i != surfaces; ++i)
+    {
+        stack.push_back(std::make_shared<Surface>(Surface{{{x(random), y(random)}, {width(random), height(random)}}}));
+    }
+    return stack;
+}
+
+/// What SurfaceStack and the input dispatcher did before the index: walk the whole stack
+auto linear_surface_at(Stack const& stack, geom::Point const& point) -> std::shared_ptr<Surface>
+{
+    std::shared_ptr<Surface> top;
+    for (auto const& surface : stack)
+    {
+        if (surface->input_area_contains(point))
+            top = surface;
+    }
+    return top;
+}
+
+template<typename Lookup>
+auto lookup_cost(std::vector<geom::Point> const& points, uint64_t iterations, Lookup const& lookup) -> double
+{
+    uint64_t hits{0};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i != iterations; ++i)
+    {
+        if (lookup(points[i % points.size()]))
+            ++hits;
+    }
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    // Use the result so the lookups can't be optimized away
+    if (hits == iterations + 1)
+        std::cout << "impossible" << std::endl;
+
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / iterations;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <number of surfaces> <lookups>"<<std::endl;
+        exit(1);
+    }
+
+    int const surfaces = std::atoi(argv[1]);
+    uint64_t const iterations = std::atoll(argv[2]);
+
+    std::mt19937 random{42};
+    auto const stack = make_stack(surfaces, random);
+
+    mir::scene::SpatialIndex<Surface> index;
+    for (auto const& surface : stack)
+        index.add(surface, surface->bounds);
+
+    std::uniform_int_distribution<int> x{0, 3839};
+    std::uniform_int_distribution<int> y{0, 2159};
+    std::vector<geom::Point> points;
+    for (int i = 0; i != 4096; ++i)
+        points.push_back({x(random), y(random)});
+
+    for (auto const& point : points)
+    {
+        if (linear_surface_at(stack, point) != index.top_item_at(point, [&](Surface const& s) { return s.input_area_contains(point); }))
+        {
+            std::cout << "Index and linear scan disagree at " << point << std::endl;
+            exit(1);
+        }
+    }
+
+    auto const linear = lookup_cost(points, iterations,
+        [&](geom::Point const& point) { return linear_surface_at(stack, point); });
+
+    auto const indexed = lookup_cost(points, iterations,
+        [&](geom::Point const& point)
+        {
+            return index.top_item_at(point, [&](Surface const& s) { return s.input_area_contains(point); });
+        });
+
+    std::cout << surfaces << " surfaces: "
+              << linear << "ns per linear scan, "
+              << indexed << "ns per indexed lookup" << std::endl;
+
+    auto const moves_start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i != iterations; ++i)
+    {
+        auto const& surface = stack[i % stack.size()];
+        auto bounds = surface->bounds;
+        bounds.top_left = {bounds.top_left.x.as_int() + (i % 2 ? 7 : -7), bounds.top_left.y.as_int()};
+        surface->bounds = bounds;
+        index.update(surface.get(), bounds);
+    }
+    auto const moves = std::chrono::steady_clock::now() - moves_start;
+
+    std::cout << surfaces << " surfaces: "
+              << static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(moves).count()) / iterations
+              << "ns per indexed move" << std::endl;
+
+    exit(0);
+}
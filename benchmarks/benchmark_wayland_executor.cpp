@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wayland_executor.h"
+
+#include <wayland-server-core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace mf = mir::frontend;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Latencies
+{
+    double mean_us;
+    double max_us;
+};
+
+/**
+ * Each of \a clients threads spawns \a items work items onto the Wayland thread
+ * (as the input, compositor and shell threads do on behalf of clients) and we
+ * measure how long each waits before it runs.
+ */
+auto spawn_latency(int clients, int items) -> Latencies
+{
+    auto const loop = wl_event_loop_create();
+    std::vector<Clock::duration> waits;
+    std::atomic<bool> done{false};
+
+    {
+        auto const executor = std::make_shared<mf::WaylandExecutor>(loop);
+
+        std::thread wayland_thread{[&]
+            {
+                while (!done)
+                    wl_event_loop_dispatch(loop, 10);
+            }};
+
+        std::vector<std::thread> client_threads;
+        for (int i = 0; i != clients; ++i)
+        {
+            client_threads.emplace_back([&]
+                {
+                    for (int j = 0; j != items; ++j)
+                    {
+                        auto const spawned = Clock::now();
+                        // Only the Wayland thread touches waits
+                        executor->spawn([&waits, spawned] { waits.push_back(Clock::now() - spawned); });
+                        if (j % 16 == 0)
+                            std::this_thread::yield();
+                    }
+                });
+        }
+
+        for (auto& thread : client_threads)
+            thread.join();
+
+        std::atomic<bool> flushed{false};
+        executor->spawn([&flushed] { flushed = true; });
+        while (!flushed)
+            std::this_thread::yield();
+
+        done = true;
+        executor->spawn([]{});
+        wayland_thread.join();
+    }
+
+    wl_event_loop_destroy(loop);
+
+    Clock::duration total{0};
+    for (auto const& wait : waits)
+        total += wait;
+
+    using us = std::chrono::duration<double, std::micro>;
+    return {
+        us{total}.count() / waits.size(),
+        us{*std::max_element(waits.begin(), waits.end())}.count()};
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <max number of client threads> <work items per client>"<<std::endl;
+        exit(1);
+    }
+
+    int const max_clients = std::atoi(argv[1]);
+    int const items = std::atoi(argv[2]);
+
+    for (int clients = 1; clients <= max_clients; clients *= 2)
+    {
+        auto const latency = spawn_latency(clients, items);
+        std::cout << clients << " client(s): "
+                  << latency.mean_us << "us mean wait, "
+                  << latency.max_us << "us max wait" << std::endl;
+    }
+
+    exit(0);
+}
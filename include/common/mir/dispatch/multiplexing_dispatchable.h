@@ -22,6 +22,8 @@
 #include "mir/dispatch/dispatchable.h"
 #include "mir/posix_rw_mutex.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <list>
@@ -54,6 +56,15 @@ class MultiplexingDispatchable final : public Dispatchable
 {
 public:
     MultiplexingDispatchable();
+    /**
+     * \brief Create an adaptor that handles several ready dispatchees per dispatch()
+     * \param [in] max_events_per_dispatch Up to this many ready dispatchees are taken
+     *                                     from a single epoll_wait() and dispatched in turn.
+     *                                     A batch runs on the thread that called dispatch(),
+     *                                     so only use more than 1 where a single thread
+     *                                     dispatches this adaptor.
+     */
+    explicit MultiplexingDispatchable(int max_events_per_dispatch);
     MultiplexingDispatchable(std::initializer_list<std::shared_ptr<Dispatchable>> dispatchees);
     virtual ~MultiplexingDispatchable() noexcept;
 
@@ -95,8 +106,13 @@ public:
      */
     void remove_watch(Fd const& fd);
 private:
+    bool is_watched(std::shared_ptr<Dispatchable> const& dispatchee);
+
+    int const max_events_per_dispatch;
     PosixRWMutex lifetime_mutex;
     std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
+    /// Bumped by every remove_watch(), so a batch can tell when its later events might be stale
+    std::atomic<uint64_t> removals{0};
 
     Fd epoll_fd;
 };
@@ -62,6 +62,20 @@ private:
 
 std::ostream& operator<<(std::ostream& out, Rectangles const& value);
 
+/**
+ * Region operations.
+ *
+ * The arguments are treated as the areas they cover, so may contain
+ * overlapping or empty rectangles. The results never do: each is a set of
+ * non-empty, non-overlapping rectangles covering the resulting area.
+ */
+/// \{
+Rectangles union_of(Rectangles const& a, Rectangles const& b);
+Rectangles intersection_of(Rectangles const& a, Rectangles const& b);
+/// The area covered by a that is not covered by b
+Rectangles difference_of(Rectangles const& a, Rectangles const& b);
+/// \}
+
 }
 }
 
@@ -120,6 +120,11 @@ public:
     /// Could allow a client to extract information about other programs the user is running
     /// \remark Since MirAL 3.1
     static char const* const zwlr_foreign_toplevel_manager_v1;
+
+    /// Allows a client to copy the contents of outputs, for screenshots and screen recording
+    /// Exposes everything on screen, so should be restricted to trusted clients with set_filter()
+    /// \remark Since MirAL 3.2
+    static char const* const zwlr_screencopy_manager_v1;
     /** @} */
 
     /// Add a bespoke Wayland extension both to "supported" and "enabled by default".
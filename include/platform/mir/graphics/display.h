@@ -78,6 +78,22 @@ public:
      */
     virtual std::chrono::milliseconds recommended_sleep() const = 0;
 
+    /**
+     * Returns the frame most recently shown by this group: the sequence
+     * number and time of its latest page flip. The compositor uses this to
+     * time its work against vblank rather than recommended_sleep().
+     *
+     * Platforms that don't know return a default Frame (msc of zero).
+     */
+    virtual Frame last_frame() const { return {}; }
+
+    /**
+     * How frames reported by last_frame() reach the screen, as a combination
+     * of Presentation::Flags (e.g. whether the timestamp comes from the
+     * hardware). Defaults to none of them.
+     */
+    virtual uint32_t presentation_flags() const { return 0; }
+
     virtual ~DisplaySyncGroup() = default;
 protected:
     DisplaySyncGroup() = default;
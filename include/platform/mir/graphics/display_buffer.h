@@ -68,6 +68,23 @@ public:
     **/
     virtual bool overlay(RenderableList const& renderlist) = 0;
 
+    /** Offers renderlist to any hardware planes that can show some of it
+     *  without compositing, for the frame the caller is about to render.
+     *
+     *  Unlike overlay() the hardware may take just part of the list. This is
+     *  only used for frames where overlay() has returned false, and the
+     *  planes are updated along with the caller's composited frame.
+     *  \param [in] renderlist
+     *      The renderables that should appear on the screen, bottom first.
+     *  \returns
+     *      The renderables the caller still needs to composite, in their
+     *      original order. By default the hardware takes none of them.
+    **/
+    virtual RenderableList assign_planes(RenderableList const& renderlist)
+    {
+        return renderlist;
+    }
+
     /**
      * Returns a transformation that the renderer must apply to all rendering.
      * There is usually no transformation required (just the identity matrix)
@@ -21,6 +21,9 @@
 
 #include <EGL/egl.h>
 
+#include <chrono>
+#include <cstdint>
+
 namespace mir
 {
 namespace graphics
@@ -38,6 +41,10 @@ public:
     virtual void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) = 0;
     virtual void report_vsync(unsigned int output_id, Frame const& f) = 0;
 
+    /* Client dmabufs: each wl_buffer is imported into EGL once, and reused on every later commit */
+    virtual void report_dmabuf_import(uint32_t /*drm_fourcc*/, std::chrono::nanoseconds /*duration*/) {}
+    virtual void report_dmabuf_import_reused(uint32_t /*drm_fourcc*/) {}
+
     /* gbm-kms specific */
     virtual void report_successful_drm_mode_set_crtc_on_construction() = 0;
     virtual void report_drm_master_failure(int error) = 0;
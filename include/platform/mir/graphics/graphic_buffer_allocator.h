@@ -20,6 +20,7 @@
 #define MIR_GRAPHICS_GRAPHIC_BUFFER_ALLOCATOR_H_
 
 #include "mir/graphics/buffer.h"
+#include "mir/geometry/rectangles.h"
 
 #include <vector>
 #include <memory>
@@ -85,10 +86,25 @@ public:
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release) = 0;
 
+    /**
+     * Import a Wayland SHM buffer
+     *
+     * Successive SHM buffers submitted to the same stream usually differ only a little;
+     * implementations may reuse resources of the previous buffer and update only the
+     * parts that have changed.
+     *
+     * \param buffer [in]           The wl_shm buffer to import
+     * \param wayland_executor [in] An Executor that spawns tasks on the Wayland event loop
+     * \param on_consumed [in]      Closure to call when the compositor has consumed this buffer
+     * \param previous [in]         The buffer previously submitted to the same stream, if any
+     * \param damage [in]           The parts of buffer that differ from previous, in buffer coordinates
+     */
     virtual auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<mir::Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> = 0;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        geometry::Rectangles const& damage) -> std::shared_ptr<Buffer> = 0;
 
 protected:
     GraphicBufferAllocator() = default;
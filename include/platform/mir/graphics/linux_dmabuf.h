@@ -43,6 +43,7 @@ namespace graphics
 {
 
 class DmaBufFormatDescriptors;
+class DisplayReport;
 
 class LinuxDmaBufUnstable : public mir::wayland::LinuxDmabufV1::Global
 {
@@ -51,8 +52,16 @@ public:
         wl_display* display,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext);
+        EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+        std::shared_ptr<DisplayReport> report);
 
+    /**
+     * Import a wl_buffer, if it is one of ours
+     *
+     * This doesn't need a current EGL context: the buffer only becomes a GL texture
+     * on its first bind(), on the compositor's thread. The EGLImage and texture are
+     * kept for the life of the wl_buffer, so later submissions of it reuse them.
+     */
     std::shared_ptr<Buffer> buffer_from_resource(
         wl_resource* buffer,
         std::shared_ptr<renderer::gl::Context> ctx,
@@ -67,6 +76,7 @@ private:
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
     std::shared_ptr<DmaBufFormatDescriptors> const formats;
+    std::shared_ptr<DisplayReport> const report;
 };
 
 }
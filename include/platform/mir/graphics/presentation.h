@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_PRESENTATION_H_
+#define MIR_GRAPHICS_PRESENTATION_H_
+
+#include "mir/graphics/frame.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace mir { namespace graphics {
+
+/**
+ * Presentation describes how and when some content reached the screen.
+ *
+ * The flags have the same values as those of wp_presentation_feedback, so
+ * they can be passed on to Wayland clients as they are.
+ */
+struct Presentation
+{
+    enum Flags : uint32_t
+    {
+        vsync = 0x1,          /**< Shown at a vblank, without tearing */
+        hw_clock = 0x2,       /**< The timestamp came from the display hardware */
+        hw_completion = 0x4,  /**< The display hardware signalled the flip */
+        zero_copy = 0x8,      /**< Shown straight from the client's buffer */
+    };
+
+    Frame frame;                                 /**< The frame the content first appeared in */
+    std::chrono::nanoseconds refresh{0};         /**< Time until the following vblank, zero if unknown */
+    uint32_t flags = 0;
+};
+
+}} // namespace mir::graphics
+
+#endif // MIR_GRAPHICS_PRESENTATION_H_
@@ -21,7 +21,10 @@
 
 #include <experimental/optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
+#include <mir/graphics/buffer_id.h>
 #include <glm/glm.hpp>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -31,6 +34,7 @@ namespace graphics
 {
 
 class Buffer;
+struct Presentation;
 class Renderable
 {
 public:
@@ -49,6 +53,18 @@ public:
      */
     virtual std::shared_ptr<Buffer> buffer() const = 0;
 
+    /**
+     * The parts of buffer() that differ from \a earlier, a buffer this
+     * renderable showed before, in buffer coordinates.
+     *
+     * Returns nothing if it is not known what changed, in which case the
+     * whole buffer should be treated as damaged.
+     */
+    virtual std::experimental::optional<geometry::Rectangles> damage_since(BufferID /*earlier*/) const
+    {
+        return {};
+    }
+
     virtual geometry::Rectangle screen_position() const = 0;
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
@@ -72,7 +88,30 @@ public:
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
+    /**
+     * The parts of screen_position() that are known to be fully opaque
+     * before alpha() is applied, in screen coordinates.
+     *
+     * A renderable that is not shaped() is opaque everywhere; one that is
+     * may still have been declared opaque in places by its client.
+     */
+    virtual geometry::Rectangles opaque_region() const
+    {
+        if (shaped())
+            return {};
+        return geometry::Rectangles{screen_position()};
+    }
+
     virtual unsigned int swap_interval() const = 0;
+
+    /**
+     * Returns something to call once the frame buffer() went into has
+     * reached the screen, or nothing if the renderable doesn't care.
+     *
+     * It must not hold on to buffer(), as it may outlive the renderable by
+     * a frame or two.
+     */
+    virtual auto on_presented() const -> std::function<void(Presentation const&)> { return {}; }
 protected:
     Renderable() = default;
     Renderable(Renderable const&) = delete;
@@ -48,6 +48,8 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const gl_batching_opt;
+extern char const* const coalesce_input_motion_opt;
 extern char const* const enable_key_repeat_opt;
 extern char const* const x11_display_opt;
 extern char const* const x11_scale_opt;
@@ -20,10 +20,13 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/dimensions.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
 
+#include <functional>
+
 namespace mir
 {
 namespace renderer
@@ -37,6 +40,52 @@ public:
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     virtual void set_output_transform(glm::mat2 const&) = 0;
     virtual void render(graphics::RenderableList const&) const = 0;
+
+    /**
+     * Limits the next render() to the given area of the viewport. The content
+     * of the target buffer outside this area is assumed to be correct already.
+     *
+     * Renderers that always draw the whole viewport may ignore this.
+     */
+    virtual void set_damage(geometry::Rectangle const& /*damage*/)
+    {
+    }
+
+    /**
+     * The number of frames since the buffer the next render() draws into
+     * was last drawn into, or 0 if its content is undefined.
+     */
+    virtual unsigned buffer_age() const
+    {
+        return 0;
+    }
+
+    /// The number of draw calls the last render() issued, or 0 if not counted
+    virtual unsigned draw_calls() const
+    {
+        return 0;
+    }
+
+    /**
+     * Copies \a area (in scene coordinates, like set_viewport()) of the frame
+     * the next render() draws into \a pixels, as 0xAARRGGBB rows \a stride
+     * bytes apart with the top row first. Then \a done is called with whether
+     * the copy succeeded; an area outside the viewport fails.
+     *
+     * \a done is called from that render() or, if the copy is left to the GPU,
+     * a later one, so callers have to keep frames coming until it has been.
+     *
+     * Renderers that can't capture call \a done straight away with false.
+     */
+    virtual void capture_next_frame(
+        geometry::Rectangle const& /*area*/,
+        void* /*pixels*/,
+        geometry::Stride /*stride*/,
+        std::function<void(bool captured)> const& done)
+    {
+        done(false);
+    }
+
     virtual void suspend() = 0; // called when render() is skipped
 
 protected:
@@ -20,7 +20,7 @@
 #define MIR_TEST_DOUBLES_MOCK_GL_H_
 
 #include <gmock/gmock.h>
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
 
 namespace mir
 {
@@ -46,11 +46,14 @@ public:
     MOCK_METHOD4(glBlendColor, void(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha));
     MOCK_METHOD2(glBlendFunc, void(GLenum, GLenum));
     MOCK_METHOD4(glBlendFuncSeparate, void(GLenum, GLenum, GLenum, GLenum));
+    MOCK_METHOD10(glBlitFramebuffer,
+                  void(GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum));
     MOCK_METHOD4(glBufferData,
                  void(GLenum, GLsizeiptr, const GLvoid *, GLenum));
     MOCK_METHOD1(glCheckFramebufferStatus, GLenum(GLenum));
     MOCK_METHOD1(glClear, void(GLbitfield));
     MOCK_METHOD4(glClearColor, void(GLclampf, GLclampf, GLclampf, GLclampf));
+    MOCK_METHOD3(glClientWaitSync, GLenum(GLsync, GLbitfield, GLuint64));
     MOCK_METHOD4(glColorMask, void(GLboolean, GLboolean, GLboolean, GLboolean));
     MOCK_METHOD1(glCompileShader, void(GLuint));
     MOCK_METHOD0(glCreateProgram, GLuint());
@@ -60,12 +63,14 @@ public:
     MOCK_METHOD2(glDeleteRenderbuffers, void(GLsizei, const GLuint *));
     MOCK_METHOD1(glDeleteProgram, void(GLuint));
     MOCK_METHOD1(glDeleteShader, void(GLuint));
+    MOCK_METHOD1(glDeleteSync, void(GLsync));
     MOCK_METHOD2(glDeleteTextures, void(GLsizei, const GLuint *));
     MOCK_METHOD1(glDisable, void(GLenum));
     MOCK_METHOD1(glDisableVertexAttribArray, void(GLuint));
     MOCK_METHOD3(glDrawArrays, void(GLenum, GLint, GLsizei));
     MOCK_METHOD1(glEnable, void(GLenum));
     MOCK_METHOD1(glEnableVertexAttribArray, void(GLuint));
+    MOCK_METHOD2(glFenceSync, GLsync(GLenum, GLbitfield));
     MOCK_METHOD0(glFinish, void());
     MOCK_METHOD4(glFramebufferRenderbuffer,
                  void(GLenum, GLenum, GLenum, GLuint));
@@ -87,6 +92,7 @@ public:
     MOCK_METHOD1(glGetString, const GLubyte*(GLenum));
     MOCK_METHOD2(glGetUniformLocation, GLint(GLuint, const GLchar *));
     MOCK_METHOD1(glLinkProgram, void(GLuint));
+    MOCK_METHOD4(glMapBufferRange, void*(GLenum, GLintptr, GLsizeiptr, GLbitfield));
     MOCK_METHOD2(glPixelStorei, void(GLenum, GLint));
     MOCK_METHOD7(glReadPixels,
                  void(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum,
@@ -99,11 +105,15 @@ public:
                  void(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum,
                       GLenum,const GLvoid*));
     MOCK_METHOD3(glTexParameteri, void(GLenum, GLenum, GLenum));
+    MOCK_METHOD9(glTexSubImage2D,
+                 void(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum,
+                      GLenum, const GLvoid*));
     MOCK_METHOD2(glUniform1f, void(GLint, GLfloat));
     MOCK_METHOD3(glUniform2f, void(GLint, GLfloat, GLfloat));
     MOCK_METHOD2(glUniform1i, void(GLint, GLint));
     MOCK_METHOD4(glUniformMatrix4fv,
                  void(GLuint, GLsizei, GLboolean, const GLfloat *));
+    MOCK_METHOD1(glUnmapBuffer, GLboolean(GLenum));
     MOCK_METHOD1(glUseProgram, void(GLuint));
     MOCK_METHOD6(glVertexAttribPointer,
                  void(GLuint, GLint, GLenum, GLboolean, GLsizei,
@@ -43,6 +43,7 @@ struct StubSurface : scene::Surface
     void resize(geometry::Size const&) override {}
     geometry::Point top_left() const override { return {}; }
     geometry::Rectangle input_bounds() const override { return {}; }
+    geometry::Rectangle input_region_bounds() const override { return input_bounds(); }
     bool input_area_contains(geometry::Point const&) const override { return false; }
     void consume(MirEvent const*) override {}
     void set_alpha(float) override {}
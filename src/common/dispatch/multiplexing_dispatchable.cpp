@@ -31,11 +31,15 @@
 #include <string.h>
 #include <system_error>
 #include <algorithm>
+#include <array>
 
 namespace md = mir::dispatch;
 
 namespace
 {
+// Bounds the per-dispatch() stack buffers
+int const max_batch_size{16};
+
 class DispatchableAdaptor : public md::Dispatchable
 {
 public:
@@ -72,7 +76,13 @@ private:
 }
 
 md::MultiplexingDispatchable::MultiplexingDispatchable()
-    : lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
+    : MultiplexingDispatchable(1)
+{
+}
+
+md::MultiplexingDispatchable::MultiplexingDispatchable(int max_events_per_dispatch)
+    : max_events_per_dispatch{std::clamp(max_events_per_dispatch, 1, max_batch_size)},
+      lifetime_mutex{PosixRWMutex::Type::PreferWriterNonRecursive},
       epoll_fd{mir::Fd{::epoll_create1(EPOLL_CLOEXEC)}}
 {
     if (epoll_fd == mir::Fd::invalid)
@@ -108,43 +118,53 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    std::array<epoll_event, max_batch_size> ready;
+    std::array<std::pair<std::shared_ptr<md::Dispatchable>, bool>, max_batch_size> sources;
+    int ready_count;
+    uint64_t removals_before_batch;
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        removals_before_batch = removals;
+        ready_count = epoll_wait(epoll_fd, ready.data(), max_events_per_dispatch, 0);
 
-        if (result < 0)
+        if (ready_count < 0)
         {
             BOOST_THROW_EXCEPTION((std::system_error{errno,
                                                      std::system_category(),
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        // If this is zero some other thread must have stolen the event we were
+        // woken for; that's ok, there's just nothing to do.
+        for (int i = 0; i != ready_count; ++i)
         {
-            // Some other thread must have stolen the event we were woken for;
-            // that's ok, just return.
-            return true;
+            sources[i] = *reinterpret_cast<decltype(dispatchee_holder)::pointer>(ready[i].data.ptr);
         }
-
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
-
-        source = event_source->first;
-        rearm_source = event_source->second;
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
-    {
-        remove_watch(source);
-    }
-    else if (rearm_source)
+    for (int i = 0; i != ready_count; ++i)
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        auto const& source = sources[i].first;
+        auto const rearm_source = sources[i].second;
+
+        // An earlier dispatchee in this batch may have removed this one
+        if (i != 0 && removals != removals_before_batch && !is_watched(source))
+        {
+            continue;
+        }
+
+        if (!source->dispatch(epoll_to_fd_event(ready[i])))
+        {
+            remove_watch(source);
+        }
+        else if (rearm_source)
+        {
+            // Only sequential dispatchees are EPOLLONESHOT; reentrant ones stay armed
+            ready[i].events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &ready[i]);
+        }
     }
 
     return true;
@@ -227,4 +247,15 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
     {
         return candidate.first->watch_fd() == fd;
     });
+    ++removals;
+}
+
+bool md::MultiplexingDispatchable::is_watched(std::shared_ptr<Dispatchable> const& dispatchee)
+{
+    std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+    return std::any_of(dispatchee_holder.begin(), dispatchee_holder.end(),
+        [&dispatchee](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
+        {
+            return candidate.first == dispatchee;
+        });
 }
@@ -21,17 +21,17 @@
 // MirCloseSurfaceEvent is a deprecated type, but we need to implement it
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
-MirCloseSurfaceEvent::MirCloseSurfaceEvent()
+MirCloseSurfaceEvent::MirCloseSurfaceEvent() :
+    MirEvent{mir::events::CloseSurfaceEventData{}}
 {
-    event.initCloseSurface();
 }
 
 int MirCloseSurfaceEvent::surface_id() const
 {
-    return event.asReader().getCloseSurface().getSurfaceId();
+    return close_surface().surface_id;
 }
 
 void MirCloseSurfaceEvent::set_surface_id(int id)
 {
-    event.getCloseSurface().setSurfaceId(id);
+    close_surface().surface_id = id;
 }
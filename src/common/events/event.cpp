@@ -33,81 +33,446 @@
 #include "mir/events/input_device_state_event.h"
 #include "mir/events/surface_placement_event.h"
 
+#include "mir_event.capnp.h"
+
+#include <capnp/message.h>
 #include <capnp/serialize.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 
 namespace ml = mir::logging;
+namespace mev = mir::events;
 
-MirEvent::MirEvent(MirEvent const& e)
+namespace
+{
+template<typename Bytes>
+auto bytes_from(Bytes const& reader) -> mev::SharedBytes
 {
-    auto reader = e.event.asReader();
-    message.setRoot(reader);
-    event = message.getRoot<mir::capnp::Event>();
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    bytes->reserve(reader.size());
+
+    // Can't use std::copy() as the CapnP iterators don't provide an iterator category
+    for (auto p = reader.begin(); p != reader.end(); ++p)
+        bytes->push_back(*p);
+
+    return bytes;
 }
 
-MirEvent& MirEvent::operator=(MirEvent const& e)
+auto bytes_of(mev::SharedBytes const& bytes) -> kj::ArrayPtr<uint8_t const>
 {
-    auto reader = e.event.asReader();
-    message.setRoot(reader);
-    event = message.getRoot<mir::capnp::Event>();
-    return *this;
+    return {bytes->data(), bytes->size()};
 }
 
-// TODO Look at replacing the surface event serializer with a capnproto layer
-mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
+void build(mev::KeyboardEventData const& key, mir::capnp::KeyboardEvent::Builder builder)
 {
-    auto e = mir::EventUPtr(new MirEvent, [](MirEvent* ev) { delete ev; });
-    kj::ArrayPtr<::capnp::word const> words(reinterpret_cast<::capnp::word const*>(
-        bytes.data()), bytes.size() / sizeof(::capnp::word));
+    builder.setAction(static_cast<mir::capnp::KeyboardEvent::Action>(key.action));
+    builder.setKeyCode(key.key_code);
+    builder.setScanCode(key.scan_code);
+    builder.setText(key.text.c_str());
+}
 
-    initMessageBuilderFromFlatArrayCopy(words, e->message);
-    e->event = e->message.getRoot<mir::capnp::Event>();
+void build(mev::TouchEventData const& touch, mir::capnp::TouchScreenEvent::Builder builder)
+{
+    using Contact = mir::capnp::TouchScreenEvent::Contact;
 
-    return e;
+    builder.setButtons(touch.buttons);
+    builder.setCount(touch.count);
+    auto contacts = builder.initContacts(mir::capnp::TouchScreenEvent::MAX_COUNT);
+
+    for (size_t i = 0; i != touch.count; ++i)
+    {
+        auto const& contact = touch.contacts[i];
+        auto out = contacts[i];
+        out.setId(contact.id);
+        out.setX(contact.x);
+        out.setY(contact.y);
+        out.setTouchMajor(contact.touch_major);
+        out.setTouchMinor(contact.touch_minor);
+        out.setPressure(contact.pressure);
+        out.setOrientation(contact.orientation);
+        out.setToolType(static_cast<Contact::ToolType>(contact.tool_type));
+        out.setAction(static_cast<Contact::TouchAction>(contact.action));
+    }
 }
 
-std::string MirEvent::serialize(MirEvent const* event)
+void build(mev::PointerEventData const& pointer, mir::capnp::PointerEvent::Builder builder)
 {
-    std::string output;
-    auto flat_event = ::capnp::messageToFlatArray(const_cast<MirEvent*>(event)->message);
+    builder.setX(pointer.x);
+    builder.setY(pointer.y);
+    builder.setDx(pointer.dx);
+    builder.setDy(pointer.dy);
+    builder.setVscroll(pointer.vscroll);
+    builder.setHscroll(pointer.hscroll);
+    builder.setAction(static_cast<mir::capnp::PointerEvent::PointerAction>(pointer.action));
+    builder.setButtons(pointer.buttons);
+    if (pointer.dnd_handle)
+        builder.setDndHandle(bytes_of(pointer.dnd_handle));
+}
 
-    return {reinterpret_cast<char*>(flat_event.asBytes().begin()), flat_event.asBytes().size()};
+void build(mev::InputEventData const& input, mir::capnp::InputEvent::Builder builder)
+{
+    builder.getDeviceId().setId(input.device_id);
+    builder.setCookie(::capnp::Data::Reader{input.cookie.data(), input.cookie_size});
+    builder.getEventTime().setCount(input.event_time.count());
+    builder.setModifiers(input.modifiers);
+    builder.setWindowId(input.window_id);
+
+    if (auto const key = std::get_if<mev::KeyboardEventData>(&input.details))
+        build(*key, builder.initKey());
+    else if (auto const touch = std::get_if<mev::TouchEventData>(&input.details))
+        build(*touch, builder.initTouch());
+    else
+        build(std::get<mev::PointerEventData>(input.details), builder.initPointer());
 }
 
-MirEventType MirEvent::type() const
+void build(mev::EventData const& event, mir::capnp::Event::Builder builder)
+{
+    if (auto const input = std::get_if<mev::InputEventData>(&event))
+    {
+        build(*input, builder.initInput());
+    }
+    else if (auto const surface = std::get_if<mev::SurfaceEventData>(&event))
+    {
+        auto out = builder.initSurface();
+        out.setId(surface->id);
+        out.setAttrib(static_cast<mir::capnp::SurfaceEvent::Attrib>(surface->attrib));
+        out.setValue(surface->value);
+        if (surface->dnd_handle)
+            out.setDndHandle(bytes_of(surface->dnd_handle));
+    }
+    else if (auto const resize = std::get_if<mev::ResizeEventData>(&event))
+    {
+        auto out = builder.initResize();
+        out.setSurfaceId(resize->surface_id);
+        out.setWidth(resize->width);
+        out.setHeight(resize->height);
+    }
+    else if (auto const prompt_session = std::get_if<mev::PromptSessionEventData>(&event))
+    {
+        builder.initPromptSession().setNewState(
+            static_cast<mir::capnp::PromptSessionEvent::State>(prompt_session->new_state));
+    }
+    else if (auto const orientation = std::get_if<mev::OrientationEventData>(&event))
+    {
+        auto out = builder.initOrientation();
+        out.setSurfaceId(orientation->surface_id);
+        out.setDirection(orientation->direction);
+    }
+    else if (auto const close_surface = std::get_if<mev::CloseSurfaceEventData>(&event))
+    {
+        builder.initCloseSurface().setSurfaceId(close_surface->surface_id);
+    }
+    else if (auto const keymap = std::get_if<mev::KeymapEventData>(&event))
+    {
+        auto out = builder.initKeymap();
+        out.setSurfaceId(keymap->surface_id);
+        out.getDeviceId().setId(keymap->device_id);
+        if (keymap->buffer)
+            out.setBuffer(::capnp::Text::Reader{keymap->buffer->c_str(), keymap->buffer->size()});
+    }
+    else if (auto const input_configuration = std::get_if<mev::InputConfigurationEventData>(&event))
+    {
+        auto out = builder.initInputConfiguration();
+        out.setAction(static_cast<mir::capnp::InputConfigurationEvent::Action>(input_configuration->action));
+        out.getWhen().setCount(input_configuration->when.count());
+        out.getId().setId(input_configuration->id);
+    }
+    else if (auto const surface_output = std::get_if<mev::SurfaceOutputEventData>(&event))
+    {
+        auto out = builder.initSurfaceOutput();
+        out.setSurfaceId(surface_output->surface_id);
+        out.setDpi(surface_output->dpi);
+        out.setScale(surface_output->scale);
+        out.setFormFactor(static_cast<mir::capnp::SurfaceOutputEvent::FormFactor>(surface_output->form_factor));
+        out.setOutputId(surface_output->output_id);
+        out.setRefreshRate(surface_output->refresh_rate);
+    }
+    else if (auto const device_state = std::get_if<mev::InputDeviceStateEventData>(&event))
+    {
+        auto out = builder.initInputDevice();
+        out.getWhen().setCount(device_state->when.count());
+        out.setButtons(device_state->buttons);
+        out.setModifiers(device_state->modifiers);
+        out.setPointerX(device_state->pointer_x);
+        out.setPointerY(device_state->pointer_y);
+        out.setWindowId(device_state->window_id);
+
+        if (device_state->devices)
+        {
+            auto const& states = *device_state->devices;
+            auto devices = out.initDevices(states.size());
+            for (size_t i = 0; i != states.size(); ++i)
+            {
+                devices[i].getDeviceId().setId(states[i].id);
+                devices[i].setButtons(states[i].buttons);
+                auto keys = devices[i].initPressedKeys(states[i].pressed_keys.size());
+                for (size_t j = 0; j != states[i].pressed_keys.size(); ++j)
+                    keys.set(j, states[i].pressed_keys[j]);
+            }
+        }
+    }
+    else
+    {
+        auto const& placement = std::get<mev::SurfacePlacementEventData>(event);
+        auto out = builder.initSurfacePlacement();
+        out.setId(placement.id);
+        auto rect = out.getRectangle();
+        rect.setLeft(placement.rectangle.left);
+        rect.setTop(placement.rectangle.top);
+        rect.setWidth(placement.rectangle.width);
+        rect.setHeight(placement.rectangle.height);
+    }
+}
+
+auto data_from(mir::capnp::InputEvent::Reader reader) -> mev::InputEventData
 {
-    switch (event.asReader().which())
+    mev::InputEventData input;
+    input.device_id = reader.getDeviceId().getId();
+    input.event_time = std::chrono::nanoseconds{reader.getEventTime().getCount()};
+    input.modifiers = reader.getModifiers();
+    input.window_id = reader.getWindowId();
+
+    auto const cookie = reader.getCookie();
+    if (cookie.size() > input.cookie.size())
+        BOOST_THROW_EXCEPTION(std::length_error("Event cookie is too large"));
+    std::copy(cookie.begin(), cookie.end(), input.cookie.begin());
+    input.cookie_size = cookie.size();
+
+    switch (reader.which())
+    {
+    case mir::capnp::InputEvent::Which::KEY:
+    {
+        auto const key = reader.getKey();
+        mev::KeyboardEventData data;
+        data.action = static_cast<MirKeyboardAction>(key.getAction());
+        data.key_code = key.getKeyCode();
+        data.scan_code = key.getScanCode();
+        data.text = key.getText().cStr();
+        input.details = std::move(data);
+        break;
+    }
+    case mir::capnp::InputEvent::Which::TOUCH:
+    {
+        auto const touch = reader.getTouch();
+        auto const contacts = touch.getContacts();
+        mev::TouchEventData data;
+        data.buttons = touch.getButtons();
+        data.count = std::min<size_t>({touch.getCount(), contacts.size(), data.contacts.size()});
+        for (size_t i = 0; i != data.count; ++i)
+        {
+            auto const contact = contacts[i];
+            auto& out = data.contacts[i];
+            out.id = contact.getId();
+            out.x = contact.getX();
+            out.y = contact.getY();
+            out.touch_major = contact.getTouchMajor();
+            out.touch_minor = contact.getTouchMinor();
+            out.pressure = contact.getPressure();
+            out.orientation = contact.getOrientation();
+            out.tool_type = static_cast<MirTouchTooltype>(contact.getToolType());
+            out.action = static_cast<MirTouchAction>(contact.getAction());
+        }
+        input.details = data;
+        break;
+    }
+    case mir::capnp::InputEvent::Which::POINTER:
+    {
+        auto const pointer = reader.getPointer();
+        mev::PointerEventData data;
+        data.x = pointer.getX();
+        data.y = pointer.getY();
+        data.dx = pointer.getDx();
+        data.dy = pointer.getDy();
+        data.vscroll = pointer.getVscroll();
+        data.hscroll = pointer.getHscroll();
+        data.action = static_cast<MirPointerAction>(pointer.getAction());
+        data.buttons = pointer.getButtons();
+        if (pointer.hasDndHandle())
+            data.dnd_handle = bytes_from(pointer.getDndHandle());
+        input.details = std::move(data);
+        break;
+    }
+    default:
+        BOOST_THROW_EXCEPTION(std::runtime_error("Unknown input event type"));
+    }
+
+    return input;
+}
+
+auto data_from(mir::capnp::Event::Reader reader) -> mev::EventData
+{
+    switch (reader.which())
     {
     case mir::capnp::Event::Which::INPUT:
-        return mir_event_type_input;
+        return data_from(reader.getInput());
+
     case mir::capnp::Event::Which::SURFACE:
-        return mir_event_type_window;
+    {
+        auto const surface = reader.getSurface();
+        mev::SurfaceEventData data;
+        data.id = surface.getId();
+        data.attrib = static_cast<MirWindowAttrib>(surface.getAttrib());
+        data.value = surface.getValue();
+        if (surface.hasDndHandle())
+            data.dnd_handle = bytes_from(surface.getDndHandle());
+        return data;
+    }
+
     case mir::capnp::Event::Which::RESIZE:
-        return mir_event_type_resize;
+    {
+        auto const resize = reader.getResize();
+        return mev::ResizeEventData{resize.getSurfaceId(), resize.getWidth(), resize.getHeight()};
+    }
+
     case mir::capnp::Event::Which::PROMPT_SESSION:
-        return mir_event_type_prompt_session_state_change;
+        return mev::PromptSessionEventData{
+            static_cast<MirPromptSessionState>(reader.getPromptSession().getNewState())};
+
     case mir::capnp::Event::Which::ORIENTATION:
-        return mir_event_type_orientation;
+    {
+        auto const orientation = reader.getOrientation();
+        return mev::OrientationEventData{
+            orientation.getSurfaceId(),
+            static_cast<MirOrientation>(orientation.getDirection())};
+    }
+
     case mir::capnp::Event::Which::CLOSE_SURFACE:
-        return mir_event_type_close_window;
+        return mev::CloseSurfaceEventData{reader.getCloseSurface().getSurfaceId()};
+
     case mir::capnp::Event::Which::KEYMAP:
-        return mir_event_type_keymap;
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    {
+        auto const keymap = reader.getKeymap();
+        auto const buffer = keymap.getBuffer();
+        return mev::KeymapEventData{
+            keymap.getSurfaceId(),
+            keymap.getDeviceId().getId(),
+            std::make_shared<std::string const>(buffer.cStr(), buffer.size())};
+    }
+
     case mir::capnp::Event::Which::INPUT_CONFIGURATION:
-        return mir_event_type_input_configuration;
-#pragma GCC diagnostic pop
+    {
+        auto const input_configuration = reader.getInputConfiguration();
+        return mev::InputConfigurationEventData{
+            static_cast<uint16_t>(input_configuration.getAction()),
+            std::chrono::nanoseconds{input_configuration.getWhen().getCount()},
+            input_configuration.getId().getId()};
+    }
+
     case mir::capnp::Event::Which::SURFACE_OUTPUT:
-        return mir_event_type_window_output;
+    {
+        auto const surface_output = reader.getSurfaceOutput();
+        return mev::SurfaceOutputEventData{
+            surface_output.getSurfaceId(),
+            surface_output.getDpi(),
+            surface_output.getScale(),
+            static_cast<MirFormFactor>(surface_output.getFormFactor()),
+            surface_output.getOutputId(),
+            surface_output.getRefreshRate()};
+    }
+
     case mir::capnp::Event::Which::INPUT_DEVICE:
-        return mir_event_type_input_device_state;
+    {
+        auto const device_state = reader.getInputDevice();
+        mev::InputDeviceStateEventData data;
+        data.when = std::chrono::nanoseconds{device_state.getWhen().getCount()};
+        data.buttons = device_state.getButtons();
+        data.modifiers = device_state.getModifiers();
+        data.pointer_x = device_state.getPointerX();
+        data.pointer_y = device_state.getPointerY();
+        data.window_id = device_state.getWindowId();
+
+        auto states = std::make_shared<std::vector<mev::InputDeviceState>>();
+        for (auto const device : device_state.getDevices())
+        {
+            std::vector<uint32_t> pressed_keys;
+            for (auto const key : device.getPressedKeys())
+                pressed_keys.push_back(key);
+            states->push_back({device.getDeviceId().getId(), std::move(pressed_keys), device.getButtons()});
+        }
+        data.devices = std::move(states);
+        return data;
+    }
+
     case mir::capnp::Event::Which::SURFACE_PLACEMENT:
-        return mir_event_type_window_placement;
+    {
+        auto const placement = reader.getSurfacePlacement();
+        auto const rect = placement.getRectangle();
+        return mev::SurfacePlacementEventData{
+            placement.getId(),
+            {rect.getLeft(), rect.getTop(), rect.getWidth(), rect.getHeight()}};
+    }
+
     default:
         mir::log_critical("unknown event type.");
         abort();
     }
 }
+}
+
+// TODO Look at replacing the surface event serializer with a capnproto layer
+mir::EventUPtr MirEvent::deserialize(std::string const& bytes)
+{
+    // Copied, as the reader needs the words to be aligned
+    auto words = kj::heapArray<::capnp::word>(bytes.size() / sizeof(::capnp::word));
+    memcpy(words.begin(), bytes.data(), words.asBytes().size());
+
+    ::capnp::FlatArrayMessageReader message{words};
+
+    return mir::EventUPtr(
+        new MirEvent{data_from(message.getRoot<mir::capnp::Event>())},
+        [](MirEvent* ev) { delete ev; });
+}
+
+std::string MirEvent::serialize(MirEvent const* event)
+{
+    ::capnp::MallocMessageBuilder message;
+    build(event->event, message.initRoot<mir::capnp::Event>());
+
+    auto flat_event = ::capnp::messageToFlatArray(message);
+
+    return {reinterpret_cast<char*>(flat_event.asBytes().begin()), flat_event.asBytes().size()};
+}
+
+namespace
+{
+/// The type of each kind of event; a new alternative of mev::EventData won't build without one
+struct EventTypeOf
+{
+    auto operator()(mev::InputEventData const&) const -> MirEventType { return mir_event_type_input; }
+    auto operator()(mev::SurfaceEventData const&) const -> MirEventType { return mir_event_type_window; }
+    auto operator()(mev::ResizeEventData const&) const -> MirEventType { return mir_event_type_resize; }
+    auto operator()(mev::PromptSessionEventData const&) const -> MirEventType
+    {
+        return mir_event_type_prompt_session_state_change;
+    }
+    auto operator()(mev::OrientationEventData const&) const -> MirEventType { return mir_event_type_orientation; }
+    auto operator()(mev::CloseSurfaceEventData const&) const -> MirEventType { return mir_event_type_close_window; }
+    auto operator()(mev::KeymapEventData const&) const -> MirEventType { return mir_event_type_keymap; }
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+    auto operator()(mev::InputConfigurationEventData const&) const -> MirEventType
+    {
+        return mir_event_type_input_configuration;
+    }
+#pragma GCC diagnostic pop
+    auto operator()(mev::SurfaceOutputEventData const&) const -> MirEventType { return mir_event_type_window_output; }
+    auto operator()(mev::InputDeviceStateEventData const&) const -> MirEventType
+    {
+        return mir_event_type_input_device_state;
+    }
+    auto operator()(mev::SurfacePlacementEventData const&) const -> MirEventType
+    {
+        return mir_event_type_window_placement;
+    }
+};
+}
+
+MirEventType MirEvent::type() const
+{
+    return std::visit(EventTypeOf{}, event);
+}
 
 MirInputEvent* MirEvent::to_input()
 {
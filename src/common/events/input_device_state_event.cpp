@@ -20,19 +20,28 @@
 
 #include <boost/throw_exception.hpp>
 
-MirInputDeviceStateEvent::MirInputDeviceStateEvent()
+namespace
+{
+auto states_of(mir::events::InputDeviceStateEventData const& event) -> std::vector<mir::events::InputDeviceState> const&
+{
+    static std::vector<mir::events::InputDeviceState> const none;
+    return event.devices ? *event.devices : none;
+}
+}
+
+MirInputDeviceStateEvent::MirInputDeviceStateEvent() :
+    MirEvent{mir::events::InputDeviceStateEventData{}}
 {
-    event.initInputDevice();
 }
 
 MirPointerButtons MirInputDeviceStateEvent::pointer_buttons() const
 {
-    return static_cast<MirPointerButtons>(event.asReader().getInputDevice().getButtons());
+    return device_state().buttons;
 }
 
 void MirInputDeviceStateEvent::set_pointer_buttons(MirPointerButtons new_pointer_buttons)
 {
-    event.getInputDevice().setButtons(new_pointer_buttons);
+    device_state().buttons = new_pointer_buttons;
 }
 
 float MirInputDeviceStateEvent::pointer_axis(MirPointerAxis axis) const
@@ -40,9 +49,9 @@ float MirInputDeviceStateEvent::pointer_axis(MirPointerAxis axis) const
     switch(axis)
     {
     case mir_pointer_axis_x:
-        return event.asReader().getInputDevice().getPointerX();
+        return device_state().pointer_x;
     case mir_pointer_axis_y:
-        return event.asReader().getInputDevice().getPointerY();
+        return device_state().pointer_y;
     default:
         return 0.0f;
     }
@@ -53,10 +62,10 @@ void MirInputDeviceStateEvent::set_pointer_axis(MirPointerButtons axis, float va
     switch(axis)
     {
     case mir_pointer_axis_x:
-        event.getInputDevice().setPointerX(value);
+        device_state().pointer_x = value;
         break;
     case mir_pointer_axis_y:
-        event.getInputDevice().setPointerY(value);
+        device_state().pointer_y = value;
         break;
     default:
         break;
@@ -65,72 +74,60 @@ void MirInputDeviceStateEvent::set_pointer_axis(MirPointerButtons axis, float va
 
 std::chrono::nanoseconds MirInputDeviceStateEvent::when() const
 {
-    return std::chrono::nanoseconds{event.asReader().getInputDevice().getWhen().getCount()};
+    return device_state().when;
 }
 
 void MirInputDeviceStateEvent::set_when(std::chrono::nanoseconds const& when)
 {
-    event.getInputDevice().getWhen().setCount(when.count());
+    device_state().when = when;
 }
 
 MirInputEventModifiers MirInputDeviceStateEvent::modifiers() const
 {
-    return static_cast<MirInputEventModifiers>(event.asReader().getInputDevice().getModifiers());
+    return device_state().modifiers;
 }
 
 void MirInputDeviceStateEvent::set_modifiers(MirInputEventModifiers modifiers)
 {
-    event.getInputDevice().setModifiers(modifiers);
+    device_state().modifiers = modifiers;
 }
 
 void MirInputDeviceStateEvent::set_device_states(std::vector<mir::events::InputDeviceState> const& device_states)
 {
-    event.getInputDevice().initDevices(device_states.size());
-
-    for (size_t i = 0; i < device_states.size(); i++)
-    {
-        auto const& state = device_states[i];
-        event.getInputDevice().getDevices()[i].getDeviceId().setId(state.id);
-        event.getInputDevice().getDevices()[i].setButtons(state.buttons);
-        event.getInputDevice().getDevices()[i].initPressedKeys(state.pressed_keys.size());
-        for (size_t j = 0; j < state.pressed_keys.size(); j++)
-        {
-            event.getInputDevice().getDevices()[i].getPressedKeys().set(j, state.pressed_keys[j]);
-        }
-    }
+    device_state().devices = std::make_shared<std::vector<mir::events::InputDeviceState> const>(device_states);
 }
 
 uint32_t MirInputDeviceStateEvent::device_count() const
 {
-    return event.asReader().getInputDevice().getDevices().size();
+    return states_of(device_state()).size();
 }
 
 MirInputDeviceId MirInputDeviceStateEvent::device_id(size_t index) const
 {
-    return event.asReader().getInputDevice().getDevices()[index].getDeviceId().getId();
+    return states_of(device_state()).at(index).id;
 }
 
 uint32_t MirInputDeviceStateEvent::device_pressed_keys_for_index(size_t index, size_t pressed_index) const
 {
-    return event.asReader().getInputDevice().getDevices()[index].getPressedKeys()[pressed_index];
+    return states_of(device_state()).at(index).pressed_keys.at(pressed_index);
 }
 
 uint32_t MirInputDeviceStateEvent::device_pressed_keys_count(size_t index) const
 {
-    return event.asReader().getInputDevice().getDevices()[index].getPressedKeys().size();
+    return states_of(device_state()).at(index).pressed_keys.size();
 }
 
 MirPointerButtons MirInputDeviceStateEvent::device_pointer_buttons(size_t index) const
 {
-    return event.asReader().getInputDevice().getDevices()[index].getButtons();
+    return states_of(device_state()).at(index).buttons;
 }
 
 void MirInputDeviceStateEvent::set_window_id(int id)
 {
-    event.getInputDevice().setWindowId(id);
+    device_state().window_id = id;
 }
 
 int MirInputDeviceStateEvent::window_id() const
 {
-    return event.asReader().getInputDevice().getWindowId();
+    return device_state().window_id;
 }
@@ -21,33 +21,40 @@
 #include "mir/events/keyboard_event.h"
 #include "mir/events/pointer_event.h"
 #include "mir/events/touch_event.h"
+#include "mir/cookie/blob.h"
 
+#include <boost/throw_exception.hpp>
+
+#include <stdexcept>
 #include <stdlib.h>
 
+namespace mev = mir::events;
+
+static_assert(mir::cookie::default_blob_size <= mev::InputEventData::max_cookie_size,
+              "Input events must have room for a cookie");
+
 MirInputEvent::MirInputEvent(MirInputDeviceId dev,
                              std::chrono::nanoseconds et,
                              MirInputEventModifiers mods,
-                             std::vector<uint8_t> const& cookie)
+                             std::vector<uint8_t> const& cookie) :
+    MirEvent{mev::InputEventData{}}
 {
-    event.initInput();
-    auto input = event.getInput();
-    input.getDeviceId().setId(dev);
-    input.getEventTime().setCount(et.count());
-    input.setModifiers(mods);
-
-    ::capnp::Data::Reader cookie_data(cookie.data(), cookie.size());
-    input.setCookie(cookie_data);
+    auto& input = this->input();
+    input.device_id = dev;
+    input.event_time = et;
+    input.modifiers = mods;
+    set_cookie(cookie);
 }
 
 MirInputEventType MirInputEvent::input_type() const
 {
-    switch (event.asReader().getInput().which())
+    switch (input().details.index())
     {
-    case mir::capnp::InputEvent::Which::KEY:
+    case 0:
         return mir_input_event_type_key;
-    case mir::capnp::InputEvent::Which::TOUCH:
+    case 1:
         return mir_input_event_type_touch;
-    case mir::capnp::InputEvent::Which::POINTER:
+    case 2:
         return mir_input_event_type_pointer;
     default:
         abort();
@@ -56,22 +63,22 @@ MirInputEventType MirInputEvent::input_type() const
 
 int MirInputEvent::window_id() const
 {
-    return event.asReader().getInput().getWindowId();
+    return input().window_id;
 }
 
 void MirInputEvent::set_window_id(int id)
 {
-    event.getInput().setWindowId(id);
+    input().window_id = id;
 }
 
 MirInputDeviceId MirInputEvent::device_id() const
 {
-    return event.asReader().getInput().getDeviceId().getId();
+    return input().device_id;
 }
 
 void MirInputEvent::set_device_id(MirInputDeviceId id)
 {
-    event.getInput().getDeviceId().setId(id);
+    input().device_id = id;
 }
 
 MirKeyboardEvent* MirInputEvent::to_keyboard()
@@ -106,35 +113,37 @@ MirTouchEvent const* MirInputEvent::to_touch() const
 
 std::chrono::nanoseconds MirInputEvent::event_time() const
 {
-    return std::chrono::nanoseconds{event.asReader().getInput().getEventTime().getCount()};
+    return input().event_time;
 }
 
 void MirInputEvent::set_event_time(std::chrono::nanoseconds const& event_time)
 {
-    event.getInput().getEventTime().setCount(event_time.count());
+    input().event_time = event_time;
 }
 
 std::vector<uint8_t> MirInputEvent::cookie() const
 {
-    auto cookie = event.asReader().getInput().getCookie();
-    std::vector<uint8_t> vec_cookie(cookie.size());
-    std::copy(std::begin(cookie), std::end(cookie), std::begin(vec_cookie));
-
-    return vec_cookie;
+    auto const& input = this->input();
+    return {input.cookie.begin(), input.cookie.begin() + input.cookie_size};
 }
 
 void MirInputEvent::set_cookie(std::vector<uint8_t> const& cookie)
 {
-    ::capnp::Data::Reader cookie_data(cookie.data(), cookie.size());
-    event.getInput().setCookie(cookie_data);
+    auto& input = this->input();
+
+    if (cookie.size() > input.cookie.size())
+        BOOST_THROW_EXCEPTION(std::length_error("Event cookie is too large"));
+
+    std::copy(cookie.begin(), cookie.end(), input.cookie.begin());
+    input.cookie_size = cookie.size();
 }
 
 MirInputEventModifiers MirInputEvent::modifiers() const
 {
-    return event.asReader().getInput().getModifiers();
+    return input().modifiers;
 }
 
 void MirInputEvent::set_modifiers(MirInputEventModifiers modifiers)
 {
-    event.getInput().setModifiers(modifiers);
+    input().modifiers = modifiers;
 }
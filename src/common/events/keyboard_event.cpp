@@ -21,46 +21,45 @@
 
 MirKeyboardEvent::MirKeyboardEvent()
 {
-    event.initInput();
-    event.getInput().initKey();
+    input().details = mir::events::KeyboardEventData{};
 }
 
 MirKeyboardAction MirKeyboardEvent::action() const
 {
-    return static_cast<MirKeyboardAction>(event.asReader().getInput().getKey().getAction());
+    return key().action;
 }
 
 void MirKeyboardEvent::set_action(MirKeyboardAction action)
 {
-    event.getInput().getKey().setAction(static_cast<mir::capnp::KeyboardEvent::Action>(action));
+    key().action = action;
 }
 
 int32_t MirKeyboardEvent::key_code() const
 {
-    return event.asReader().getInput().getKey().getKeyCode();
+    return key().key_code;
 }
 
 void MirKeyboardEvent::set_key_code(int32_t key_code)
 {
-    event.getInput().getKey().setKeyCode(key_code);
+    key().key_code = key_code;
 }
 
 int32_t MirKeyboardEvent::scan_code() const
 {
-    return event.asReader().getInput().getKey().getScanCode();
+    return key().scan_code;
 }
 
 void MirKeyboardEvent::set_scan_code(int32_t scan_code)
 {
-    event.getInput().getKey().setScanCode(scan_code);
+    key().scan_code = scan_code;
 }
 
 char const* MirKeyboardEvent::text() const
 {
-    return event.asReader().getInput().getKey().getText().cStr();
+    return key().text.c_str();
 }
 
 void MirKeyboardEvent::set_text(char const* str)
 {
-    event.getInput().getKey().setText(str);
+    key().text = str;
 }
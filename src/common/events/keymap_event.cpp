@@ -20,43 +20,44 @@
 
 #include "mir/events/keymap_event.h"
 
-MirKeymapEvent::MirKeymapEvent()
+MirKeymapEvent::MirKeymapEvent() :
+    MirEvent{mir::events::KeymapEventData{}}
 {
-    event.initKeymap();
 }
 
 int MirKeymapEvent::surface_id() const
 {
-    return event.asReader().getKeymap().getSurfaceId();
+    return keymap().surface_id;
 }
 
 void MirKeymapEvent::set_surface_id(int id)
 {
-    event.getKeymap().setSurfaceId(id);
+    keymap().surface_id = id;
 }
 
 MirInputDeviceId MirKeymapEvent::device_id() const
 {
-    return event.asReader().getKeymap().getDeviceId().getId();
+    return keymap().device_id;
 }
 
 void MirKeymapEvent::set_device_id(MirInputDeviceId id)
 {
-    event.getKeymap().getDeviceId().setId(id);
+    keymap().device_id = id;
 }
 
 char const* MirKeymapEvent::buffer() const
 {
-    return event.asReader().getKeymap().getBuffer().cStr();
+    auto const& buffer = keymap().buffer;
+    return buffer ? buffer->c_str() : "";
 }
 
 void MirKeymapEvent::set_buffer(char const* buffer)
 {
-    ::capnp::Text::Reader capnp_text(buffer, strlen(buffer));
-    event.getKeymap().setBuffer(capnp_text);
+    keymap().buffer = std::make_shared<std::string const>(buffer);
 }
 
 size_t MirKeymapEvent::size() const
 {
-    return event.asReader().getKeymap().getBuffer().size();
+    auto const& buffer = keymap().buffer;
+    return buffer ? buffer->size() : 0;
 }
@@ -18,27 +18,27 @@
 
 #include "mir/events/orientation_event.h"
 
-MirOrientationEvent::MirOrientationEvent()
+MirOrientationEvent::MirOrientationEvent() :
+    MirEvent{mir::events::OrientationEventData{}}
 {
-    event.initOrientation();
 }
 
 int MirOrientationEvent::surface_id() const
 {
-    return event.asReader().getOrientation().getSurfaceId();
+    return orientation().surface_id;
 }
 
 void MirOrientationEvent::set_surface_id(int id)
 {
-    event.getOrientation().setSurfaceId(id);
+    orientation().surface_id = id;
 }
 
 MirOrientation MirOrientationEvent::direction() const
 {
-    return static_cast<MirOrientation>(event.asReader().getOrientation().getDirection());
+    return orientation().direction;
 }
 
 void MirOrientationEvent::set_direction(MirOrientation orientation)
 {
-    event.getOrientation().setDirection(orientation);
+    this->orientation().direction = orientation;
 }
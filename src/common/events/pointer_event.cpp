@@ -21,10 +21,11 @@
 
 #include <boost/throw_exception.hpp>
 
+namespace mev = mir::events;
+
 MirPointerEvent::MirPointerEvent()
 {
-    event.initInput();
-    event.getInput().initPointer();
+    input().details = mev::PointerEventData{};
 }
 
 MirPointerEvent::MirPointerEvent(MirInputDeviceId dev,
@@ -41,103 +42,102 @@ MirPointerEvent::MirPointerEvent(MirInputDeviceId dev,
                     float hscroll)
     : MirInputEvent(dev, et, mods, cookie)
 {
-    auto input = event.getInput();
-    input.initPointer();
-    auto ptr = event.getInput().getPointer();
-    ptr.setX(x);
-    ptr.setY(y);
-    ptr.setDx(dx);
-    ptr.setDy(dy);
-    ptr.setVscroll(vscroll);
-    ptr.setHscroll(hscroll);
-    ptr.setButtons(buttons);
-    ptr.setAction(static_cast<mir::capnp::PointerEvent::PointerAction>(action));
+    mev::PointerEventData pointer;
+    pointer.x = x;
+    pointer.y = y;
+    pointer.dx = dx;
+    pointer.dy = dy;
+    pointer.vscroll = vscroll;
+    pointer.hscroll = hscroll;
+    pointer.buttons = buttons;
+    pointer.action = action;
+
+    input().details = pointer;
 }
 
 MirPointerButtons MirPointerEvent::buttons() const
 {
-    return event.asReader().getInput().getPointer().getButtons();
+    return pointer().buttons;
 }
 
 void MirPointerEvent::set_buttons(MirPointerButtons buttons)
 {
-    event.getInput().getPointer().setButtons(buttons);
+    pointer().buttons = buttons;
 }
 
 float MirPointerEvent::x() const
 {
-    return event.asReader().getInput().getPointer().getX();
+    return pointer().x;
 }
 
 void MirPointerEvent::set_x(float x)
 {
-    event.getInput().getPointer().setX(x);
+    pointer().x = x;
 }
 
 float MirPointerEvent::y() const
 {
-    return event.asReader().getInput().getPointer().getY();
+    return pointer().y;
 }
 
 void MirPointerEvent::set_y(float y)
 {
-    event.getInput().getPointer().setY(y);
+    pointer().y = y;
 }
 
 float MirPointerEvent::dx() const
 {
-    return event.asReader().getInput().getPointer().getDx();
+    return pointer().dx;
 }
 
 void MirPointerEvent::set_dx(float dx)
 {
-    event.getInput().getPointer().setDx(dx);
+    pointer().dx = dx;
 }
 
 float MirPointerEvent::dy() const
 {
-    return event.asReader().getInput().getPointer().getDy();
+    return pointer().dy;
 }
 
 void MirPointerEvent::set_dy(float dy)
 {
-    event.getInput().getPointer().setDy(dy);
+    pointer().dy = dy;
 }
 
 float MirPointerEvent::vscroll() const
 {
-    return event.asReader().getInput().getPointer().getVscroll();
+    return pointer().vscroll;
 }
 
 void MirPointerEvent::set_vscroll(float vs)
 {
-    event.getInput().getPointer().setVscroll(vs);
+    pointer().vscroll = vs;
 }
 
 float MirPointerEvent::hscroll() const
 {
-    return event.asReader().getInput().getPointer().getHscroll();
+    return pointer().hscroll;
 }
 
 void MirPointerEvent::set_hscroll(float hs)
 {
-    event.getInput().getPointer().setHscroll(hs);
+    pointer().hscroll = hs;
 }
 
 MirPointerAction MirPointerEvent::action() const
 {
-    return static_cast<MirPointerAction>(event.asReader().getInput().getPointer().getAction());
+    return pointer().action;
 }
 
 void MirPointerEvent::set_action(MirPointerAction action)
 {
-    event.getInput().getPointer().setAction(static_cast<mir::capnp::PointerEvent::PointerAction>(action));
+    pointer().action = action;
 }
 
 void MirPointerEvent::set_dnd_handle(std::vector<uint8_t> const& handle)
 {
-    event.getInput().getPointer().initDndHandle(handle.size());
-    event.getInput().getPointer().setDndHandle(::kj::ArrayPtr<uint8_t const>{&*begin(handle), &*end(handle)});
+    pointer().dnd_handle = std::make_shared<std::vector<uint8_t> const>(handle);
 }
 
 namespace
@@ -154,19 +154,13 @@ struct MyMirBlob : MirBlob
 
 MirBlob* MirPointerEvent::dnd_handle() const
 {
-    auto const reader = event.asReader().getInput().getPointer();
+    auto const& dnd_handle = pointer().dnd_handle;
 
-    if (!reader.hasDndHandle())
+    if (!dnd_handle)
         return nullptr;
 
-    auto const dnd_handle = reader.getDndHandle();
-
     auto blob = std::make_unique<MyMirBlob>();
-    blob->data_.reserve(dnd_handle.size());
-
-    // Can't use std::copy() as the CapnP iterators don't provide an iterator category
-    for (auto p = dnd_handle.begin(); p != dnd_handle.end(); ++p)
-        blob->data_.push_back(*p);
+    blob->data_ = *dnd_handle;
 
     return blob.release();
 }
@@ -18,17 +18,17 @@
 
 #include "mir/events/prompt_session_event.h"
 
-MirPromptSessionEvent::MirPromptSessionEvent()
+MirPromptSessionEvent::MirPromptSessionEvent() :
+    MirEvent{mir::events::PromptSessionEventData{}}
 {
-    event.initPromptSession();
 }
 
 MirPromptSessionState MirPromptSessionEvent::new_state() const
 {
-    return static_cast<MirPromptSessionState>(event.asReader().getPromptSession().getNewState());
+    return prompt_session().new_state;
 }
 
 void MirPromptSessionEvent::set_new_state(MirPromptSessionState state)
 {
-    event.getPromptSession().setNewState(static_cast<mir::capnp::PromptSessionEvent::State>(state));
+    prompt_session().new_state = state;
 }
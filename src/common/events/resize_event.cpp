@@ -18,37 +18,37 @@
 
 #include "mir/events/resize_event.h"
 
-MirResizeEvent::MirResizeEvent()
+MirResizeEvent::MirResizeEvent() :
+    MirEvent{mir::events::ResizeEventData{}}
 {
-    event.initResize();
 }
 
 int MirResizeEvent::surface_id() const
 {
-    return event.asReader().getResize().getSurfaceId();
+    return resize().surface_id;
 }
 
 void MirResizeEvent::set_surface_id(int id)
 {
-    event.getResize().setSurfaceId(id);
+    resize().surface_id = id;
 }
 
 int MirResizeEvent::width() const
 {
-    return event.asReader().getResize().getWidth();
+    return resize().width;
 }
 
 void MirResizeEvent::set_width(int width)
 {
-    event.getResize().setWidth(width);
+    resize().width = width;
 }
 
 int MirResizeEvent::height() const
 {
-    return event.asReader().getResize().getHeight();
+    return resize().height;
 }
 
 void MirResizeEvent::set_height(int height)
 {
-    event.getResize().setHeight(height);
+    resize().height = height;
 }
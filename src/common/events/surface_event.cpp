@@ -22,52 +22,50 @@
 // MirSurfaceEvent is a deprecated type, but we need to implement it
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
-MirSurfaceEvent::MirSurfaceEvent()
+MirSurfaceEvent::MirSurfaceEvent() :
+    MirEvent{mir::events::SurfaceEventData{}}
 {
-    event.initSurface();
 }
 
 int MirSurfaceEvent::id() const
 {
-    return event.asReader().getSurface().getId();
+    return surface().id;
 }
 
 void MirSurfaceEvent::set_id(int id)
 {
-    event.getSurface().setId(id);
+    surface().id = id;
 }
 
 MirWindowAttrib MirSurfaceEvent::attrib() const
 {
-    return static_cast<MirWindowAttrib>(event.asReader().getSurface().getAttrib());
+    return surface().attrib;
 }
 
 void MirSurfaceEvent::set_attrib(MirWindowAttrib attrib)
 {
-    event.getSurface().setAttrib(static_cast<mir::capnp::SurfaceEvent::Attrib>(attrib));
+    surface().attrib = attrib;
 }
 
 int MirSurfaceEvent::value() const
 {
-    return event.asReader().getSurface().getValue();
+    return surface().value;
 }
 
 void MirSurfaceEvent::set_value(int value)
 {
-    event.getSurface().setValue(value);
+    surface().value = value;
 }
 
 void MirSurfaceEvent::set_dnd_handle(std::vector<uint8_t> const& handle)
 {
-    event.getSurface().initDndHandle(handle.size());
-    event.getSurface().setDndHandle(::kj::ArrayPtr<uint8_t const>{&*begin(handle), &*end(handle)});
+    surface().dnd_handle = std::make_shared<std::vector<uint8_t> const>(handle);
 }
 
 namespace
 {
 struct MyMirBlob : MirBlob
 {
-
     size_t size() const override { return data_.size(); }
     virtual void const* data() const override { return data_.data(); }
 
@@ -77,19 +75,13 @@ struct MyMirBlob : MirBlob
 
 MirBlob* MirSurfaceEvent::dnd_handle() const
 {
-    if (!event.asReader().getSurface().hasDndHandle())
+    auto const& dnd_handle = surface().dnd_handle;
+
+    if (!dnd_handle)
         return nullptr;
 
     auto blob = std::make_unique<MyMirBlob>();
-
-    auto reader = event.asReader().getSurface().getDndHandle();
-
-    blob->data_.reserve(reader.size());
-
-    // Can't use std::copy() as the CapnP iterators don't provide an iterator category
-    for (auto p = reader.begin(); p != reader.end(); ++p)
-        blob->data_.push_back(*p);
+    blob->data_ = *dnd_handle;
 
     return blob.release();
 }
-
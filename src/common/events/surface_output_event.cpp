@@ -21,67 +21,67 @@
 // MirSurfaceOutputEvent is a deprecated type, but we need to implement it
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
-MirSurfaceOutputEvent::MirSurfaceOutputEvent()
+MirSurfaceOutputEvent::MirSurfaceOutputEvent() :
+    MirEvent{mir::events::SurfaceOutputEventData{}}
 {
-    event.initSurfaceOutput();
 }
 
 int MirSurfaceOutputEvent::surface_id() const
 {
-    return event.asReader().getSurfaceOutput().getSurfaceId();
+    return surface_output().surface_id;
 }
 
 void MirSurfaceOutputEvent::set_surface_id(int id)
 {
-    event.getSurfaceOutput().setSurfaceId(id);
+    surface_output().surface_id = id;
 }
 
 int MirSurfaceOutputEvent::dpi() const
 {
-    return event.asReader().getSurfaceOutput().getDpi();
+    return surface_output().dpi;
 }
 
 void MirSurfaceOutputEvent::set_dpi(int dpi)
 {
-    event.getSurfaceOutput().setDpi(dpi);
+    surface_output().dpi = dpi;
 }
 
 float MirSurfaceOutputEvent::scale() const
 {
-    return event.asReader().getSurfaceOutput().getScale();
+    return surface_output().scale;
 }
 
 void MirSurfaceOutputEvent::set_scale(float scale)
 {
-    event.getSurfaceOutput().setScale(scale);
+    surface_output().scale = scale;
 }
 
 double MirSurfaceOutputEvent::refresh_rate() const
 {
-    return event.asReader().getSurfaceOutput().getRefreshRate();
+    return surface_output().refresh_rate;
 }
 
 void MirSurfaceOutputEvent::set_refresh_rate(double rate)
 {
-    event.getSurfaceOutput().setRefreshRate(rate);
+    surface_output().refresh_rate = rate;
 }
 
 MirFormFactor MirSurfaceOutputEvent::form_factor() const
 {
-    return static_cast<MirFormFactor>(event.asReader().getSurfaceOutput().getFormFactor());
+    return surface_output().form_factor;
 }
 
 void MirSurfaceOutputEvent::set_form_factor(MirFormFactor factor)
 {
-    event.getSurfaceOutput().setFormFactor(static_cast<mir::capnp::SurfaceOutputEvent::FormFactor>(factor));
+    surface_output().form_factor = factor;
 }
 
 uint32_t MirSurfaceOutputEvent::output_id() const
 {
-    return event.asReader().getSurfaceOutput().getOutputId();
+    return surface_output().output_id;
 }
 
 void MirSurfaceOutputEvent::set_output_id(uint32_t id)
 {
-    event.getSurfaceOutput().setOutputId(id);
+    surface_output().output_id = id;
 }
@@ -21,34 +21,29 @@
 // MirSurfacePlacementEvent is a deprecated type, but we need to implement it
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 
-MirSurfacePlacementEvent::MirSurfacePlacementEvent()
+MirSurfacePlacementEvent::MirSurfacePlacementEvent() :
+    MirEvent{mir::events::SurfacePlacementEventData{}}
 {
-    event.initSurfacePlacement();
 }
 
 int MirSurfacePlacementEvent::id() const
 {
-    return event.asReader().getSurfacePlacement().getId();
+    return surface_placement().id;
 }
 
 void MirSurfacePlacementEvent::set_id(int const id)
 {
-    event.getSurfacePlacement().setId(id);
+    surface_placement().id = id;
 }
 
 MirRectangle MirSurfacePlacementEvent::placement() const
 {
-    auto rect = event.asReader().getSurfacePlacement().getRectangle();
-    return {rect.getLeft(), rect.getTop(), rect.getWidth(), rect.getHeight()};
+    return surface_placement().rectangle;
 }
 
 void MirSurfacePlacementEvent::set_placement(MirRectangle const& placement)
 {
-    auto rect = event.getSurfacePlacement().getRectangle();
-    rect.setLeft(placement.left);
-    rect.setTop(placement.top);
-    rect.setWidth(placement.width);
-    rect.setHeight(placement.height);
+    surface_placement().rectangle = placement;
 }
 
 MirSurfacePlacementEvent* MirEvent::to_window_placement()
@@ -60,4 +55,3 @@ MirSurfacePlacementEvent const* MirEvent::to_window_placement() const
 {
     return static_cast<MirSurfacePlacementEvent const*>(this);
 }
-
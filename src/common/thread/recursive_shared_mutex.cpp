@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/recursive_shared_mutex.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+struct SharedHold
+{
+    void const* mutex;
+    unsigned count;
+};
+
+/**
+ * The shared locks held by the current thread.
+ *
+ * Threads rarely hold more than a few at once, so a linear search of a small
+ * array beats anything cleverer. Being trivially destructible, the array
+ * needs none of the lazy initialization that makes thread_local objects slow
+ * to access; the vector only comes into play for unusually deep nesting.
+ */
+struct SharedHolds
+{
+    static size_t constexpr capacity = 16;
+
+    SharedHold held[capacity];
+    size_t size;
+    size_t overflowed;
+};
+
+thread_local SharedHolds holds;
+
+auto overflow() -> std::vector<SharedHold>&
+{
+    thread_local std::vector<SharedHold> overflow;
+    return overflow;
+}
+
+auto find_hold(void const* mutex) -> SharedHold*
+{
+    for (auto hold = holds.held; hold != holds.held + holds.size; ++hold)
+    {
+        if (hold->mutex == mutex)
+            return hold;
+    }
+
+    if (holds.overflowed)
+    {
+        for (auto& hold : overflow())
+        {
+            if (hold.mutex == mutex)
+                return &hold;
+        }
+    }
+
+    return nullptr;
+}
+
+void add_hold(void const* mutex)
+{
+    if (holds.size != SharedHolds::capacity)
+    {
+        holds.held[holds.size++] = {mutex, 1};
+    }
+    else
+    {
+        overflow().push_back({mutex, 1});
+        ++holds.overflowed;
+    }
+}
+
+void release_hold(SharedHold* hold)
+{
+    if (--hold->count)
+        return;
+
+    if (hold >= holds.held && hold < holds.held + holds.size)
+    {
+        *hold = holds.held[--holds.size];
+    }
+    else
+    {
+        auto& spilled = overflow();
+        *hold = spilled.back();
+        spilled.pop_back();
+        --holds.overflowed;
+    }
+}
+}
+
+void mir::RecursiveSharedMutex::lock_shared()
+{
+    if (auto const hold = find_hold(this))
+    {
+        // Recursive locks can't wait for a writer: it could be waiting for us
+        readers.fetch_add(1);
+        ++hold->count;
+        return;
+    }
+
+    // Pairs with lock(): either we see the writer, or it sees our count
+    readers.fetch_add(1);
+
+    for (auto current = writer.load();
+         current != std::thread::id{} && current != std::this_thread::get_id();
+         current = writer.load())
+    {
+        readers.fetch_sub(1);
+        {
+            std::unique_lock<decltype(mutex)> lock{mutex};
+            cv.notify_all();
+            cv.wait(lock, [this]{ return writer.load() == std::thread::id{}; });
+        }
+        readers.fetch_add(1);
+    }
+
+    add_hold(this);
+}
+
+void mir::RecursiveSharedMutex::unlock_shared()
+{
+    release_hold(find_hold(this));
+    readers.fetch_sub(1);
+
+    if (writer.load() != std::thread::id{})
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        cv.notify_all();
+    }
+}
+
+void mir::RecursiveSharedMutex::lock()
+{
+    auto const me = std::this_thread::get_id();
+
+    if (writer.load(std::memory_order_relaxed) == me)
+    {
+        ++write_count;
+        return;
+    }
+
+    std::unique_lock<decltype(mutex)> lock{mutex};
+    cv.wait(lock, [this]{ return writer.load() == std::thread::id{}; });
+    writer.store(me);
+
+    auto const hold = find_hold(this);
+    auto const mine = hold ? hold->count : 0;
+    cv.wait(lock, [this, mine]{ return readers.load() == mine; });
+
+    write_count = 1;
+}
+
+void mir::RecursiveSharedMutex::unlock()
+{
+    if (--write_count)
+        return;
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    writer.store(std::thread::id{});
+    cv.notify_all();
+}
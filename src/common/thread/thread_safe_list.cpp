@@ -0,0 +1,24 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/thread_safe_list.h"
+
+// Not inline in the header: every library using ThreadSafeList must see the same calls
+auto mir::detail::innermost_thread_safe_list_call() -> ThreadSafeListCall const*&
+{
+    thread_local ThreadSafeListCall const* innermost{nullptr};
+    return innermost;
+}
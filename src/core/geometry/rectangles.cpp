@@ -39,6 +39,93 @@ geom::Rectangle rect_from_points(geom::Point const& tl, geom::Point const& br)
     return {tl, as_size(br-tl)};
 }
 
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width <= geom::Width{0} || rect.size.height <= geom::Height{0};
+}
+
+void add_if_not_empty(std::vector<geom::Rectangle>& rects, geom::Rectangle const& rect)
+{
+    if (!is_empty(rect))
+        rects.push_back(rect);
+}
+
+/// Appends the parts of rect not covered by cut: at most four bands around it
+void append_difference(
+    std::vector<geom::Rectangle>& result,
+    geom::Rectangle const& rect,
+    geom::Rectangle const& cut)
+{
+    auto const overlap = intersection_of(rect, cut);
+    if (is_empty(overlap))
+    {
+        add_if_not_empty(result, rect);
+        return;
+    }
+
+    geom::Point const tl{rect.left(), rect.top()};
+    geom::Point const br{rect.right(), rect.bottom()};
+    geom::Point const otl{overlap.left(), overlap.top()};
+    geom::Point const obr{overlap.right(), overlap.bottom()};
+
+    add_if_not_empty(result, rect_from_points(tl, {br.x, otl.y}));
+    add_if_not_empty(result, rect_from_points({tl.x, obr.y}, br));
+    add_if_not_empty(result, rect_from_points({tl.x, otl.y}, {otl.x, obr.y}));
+    add_if_not_empty(result, rect_from_points({obr.x, otl.y}, {br.x, obr.y}));
+}
+
+/// Removes cut from every rectangle in rects
+void subtract(std::vector<geom::Rectangle>& rects, geom::Rectangle const& cut)
+{
+    // Most cuts miss everything; don't rebuild rects for those
+    auto const overlaps_cut = [&cut](geom::Rectangle const& rect) { return !is_empty(intersection_of(rect, cut)); };
+    if (std::none_of(rects.begin(), rects.end(), overlaps_cut))
+        return;
+
+    std::vector<geom::Rectangle> remaining;
+    remaining.reserve(rects.size());
+
+    for (auto const& rect : rects)
+        append_difference(remaining, rect, cut);
+
+    rects.swap(remaining);
+}
+
+/// Adds the parts of rect not already in the (non-overlapping) rects
+void add_disjoint(std::vector<geom::Rectangle>& rects, geom::Rectangle const& rect)
+{
+    std::vector<geom::Rectangle> pieces;
+    add_if_not_empty(pieces, rect);
+
+    for (auto const& existing : rects)
+    {
+        if (pieces.empty())
+            return;
+        subtract(pieces, existing);
+    }
+
+    rects.insert(rects.end(), pieces.begin(), pieces.end());
+}
+
+std::vector<geom::Rectangle> disjoint(geom::Rectangles const& rects)
+{
+    std::vector<geom::Rectangle> result;
+    result.reserve(rects.size());
+
+    for (auto const& rect : rects)
+        add_disjoint(result, rect);
+
+    return result;
+}
+
+geom::Rectangles from_vector(std::vector<geom::Rectangle> const& rects)
+{
+    geom::Rectangles result;
+    for (auto const& rect : rects)
+        result.add(rect);
+    return result;
+}
+
 }
 
 geom::Rectangles::Rectangles()
@@ -202,3 +289,42 @@ std::ostream& geom::operator<<(std::ostream& out, Rectangles const& value)
     out << ']';
     return out;
 }
+
+geom::Rectangles geom::union_of(Rectangles const& a, Rectangles const& b)
+{
+    auto result = disjoint(a);
+
+    for (auto const& rect : b)
+        add_disjoint(result, rect);
+
+    return from_vector(result);
+}
+
+geom::Rectangles geom::intersection_of(Rectangles const& a, Rectangles const& b)
+{
+    std::vector<Rectangle> result;
+
+    // Pieces of two disjoint sets intersect in disjoint pieces
+    auto const disjoint_b = disjoint(b);
+    for (auto const& rect_a : disjoint(a))
+    {
+        for (auto const& rect_b : disjoint_b)
+            add_if_not_empty(result, intersection_of(rect_a, rect_b));
+    }
+
+    return from_vector(result);
+}
+
+geom::Rectangles geom::difference_of(Rectangles const& a, Rectangles const& b)
+{
+    auto result = disjoint(a);
+
+    for (auto const& cut : b)
+    {
+        if (result.empty())
+            break;
+        subtract(result, cut);
+    }
+
+    return from_vector(result);
+}
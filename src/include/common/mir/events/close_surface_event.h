@@ -27,6 +27,9 @@ struct MirCloseSurfaceEvent : MirEvent
 
     int surface_id() const;
     void set_surface_id(int id);
+private:
+    mir::events::CloseSurfaceEventData& close_surface() { return get<mir::events::CloseSurfaceEventData>(); }
+    mir::events::CloseSurfaceEventData const& close_surface() const { return get<mir::events::CloseSurfaceEventData>(); }
 };
 
 #endif /* MIR_COMMON_CLOSE_SURFACE_EVENT_H_ */
@@ -21,16 +21,14 @@
 
 #include "mir_toolkit/event.h"
 #include "mir/events/event_builders.h"
-#include "mir_event.capnp.h"
-
-#include <capnp/message.h>
+#include "mir/events/event_data.h"
 
 #include <cstring>
 
 struct MirEvent
 {
-    MirEvent(MirEvent const& event);
-    MirEvent& operator=(MirEvent const& event);
+    MirEvent(MirEvent const& event) = default;
+    MirEvent& operator=(MirEvent const& event) = default;
 
     MirEventType type() const;
 
@@ -69,9 +67,16 @@ struct MirEvent
 
 protected:
     MirEvent() = default;
+    explicit MirEvent(mir::events::EventData const& event) : event{event} {}
+
+    /// \throws std::bad_variant_access if this isn't an event of type T
+    template<typename T>
+    T& get() { return std::get<T>(event); }
+    template<typename T>
+    T const& get() const { return std::get<T>(event); }
 
-    ::capnp::MallocMessageBuilder message;
-    mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
+    // The capnproto form of events is only built to send them over the wire
+    mir::events::EventData event;
 };
 
 #endif /* MIR_COMMON_EVENT_H_ */
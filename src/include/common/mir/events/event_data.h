@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMMON_EVENT_DATA_H_
+#define MIR_COMMON_EVENT_DATA_H_
+
+#include "mir_toolkit/event.h"
+#include "mir_toolkit/client_types.h"
+#include "mir/events/input_device_state.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace mir
+{
+namespace events
+{
+/*
+ * The state held by a MirEvent of each type.
+ *
+ * Everything an input event carries is held inline, so creating and copying
+ * input events doesn't allocate. The variable length parts of rarer events
+ * (drag and drop handles, keymaps and device states) are immutable once set
+ * and shared between copies.
+ */
+
+using SharedBytes = std::shared_ptr<std::vector<uint8_t> const>;
+
+struct KeyboardEventData
+{
+    MirKeyboardAction action{mir_keyboard_action_up};
+    int32_t key_code{0};
+    int32_t scan_code{0};
+    std::string text;   ///< Short enough for the small string optimisation
+};
+
+struct TouchContactData
+{
+    int id{0};
+    float x{0};
+    float y{0};
+    float touch_major{0};
+    float touch_minor{0};
+    float pressure{0};
+    float orientation{0};
+    MirTouchTooltype tool_type{mir_touch_tooltype_unknown};
+    MirTouchAction action{mir_touch_action_up};
+};
+
+struct TouchEventData
+{
+    /// As TouchScreenEvent.maxCount on the wire
+    static size_t constexpr max_contacts = 16;
+
+    uint32_t buttons{0};
+    uint32_t count{0};
+    std::array<TouchContactData, max_contacts> contacts{};
+};
+
+struct PointerEventData
+{
+    float x{0};
+    float y{0};
+    float dx{0};
+    float dy{0};
+    float vscroll{0};
+    float hscroll{0};
+    MirPointerAction action{mir_pointer_action_button_up};
+    MirPointerButtons buttons{0};
+    SharedBytes dnd_handle;
+};
+
+struct InputEventData
+{
+    /// Large enough for a mir::cookie::Blob
+    static size_t constexpr max_cookie_size = 48;
+
+    MirInputDeviceId device_id{0};
+    std::array<uint8_t, max_cookie_size> cookie{};
+    uint8_t cookie_size{0};
+    std::chrono::nanoseconds event_time{0};
+    MirInputEventModifiers modifiers{0};
+    int window_id{0};
+
+    std::variant<KeyboardEventData, TouchEventData, PointerEventData> details;
+};
+
+struct SurfaceEventData
+{
+    int id{0};
+    MirWindowAttrib attrib{mir_window_attrib_type};
+    int value{0};
+    SharedBytes dnd_handle;
+};
+
+struct ResizeEventData
+{
+    int surface_id{0};
+    int width{0};
+    int height{0};
+};
+
+struct PromptSessionEventData
+{
+    MirPromptSessionState new_state{mir_prompt_session_state_stopped};
+};
+
+struct OrientationEventData
+{
+    int surface_id{0};
+    MirOrientation direction{mir_orientation_normal};
+};
+
+struct CloseSurfaceEventData
+{
+    int surface_id{0};
+};
+
+struct KeymapEventData
+{
+    int surface_id{0};
+    MirInputDeviceId device_id{0};
+    std::shared_ptr<std::string const> buffer;
+};
+
+/// Only exists to be passed on from the wire: nothing creates these any more
+struct InputConfigurationEventData
+{
+    uint16_t action{0};
+    std::chrono::nanoseconds when{0};
+    MirInputDeviceId id{0};
+};
+
+struct SurfaceOutputEventData
+{
+    int surface_id{0};
+    int dpi{0};
+    float scale{0};
+    MirFormFactor form_factor{mir_form_factor_unknown};
+    uint32_t output_id{0};
+    double refresh_rate{0};
+};
+
+struct InputDeviceStateEventData
+{
+    std::chrono::nanoseconds when{0};
+    MirPointerButtons buttons{0};
+    MirInputEventModifiers modifiers{0};
+    float pointer_x{0};
+    float pointer_y{0};
+    std::shared_ptr<std::vector<InputDeviceState> const> devices;
+    int window_id{0};
+};
+
+struct SurfacePlacementEventData
+{
+    int id{0};
+    MirRectangle rectangle{0, 0, 0, 0};
+};
+
+/// Alternatives are in the order of the capnproto Event union
+using EventData = std::variant<
+    InputEventData,
+    SurfaceEventData,
+    ResizeEventData,
+    PromptSessionEventData,
+    OrientationEventData,
+    CloseSurfaceEventData,
+    KeymapEventData,
+    InputConfigurationEventData,
+    SurfaceOutputEventData,
+    InputDeviceStateEventData,
+    SurfacePlacementEventData>;
+}
+}
+
+#endif /* MIR_COMMON_EVENT_DATA_H_ */
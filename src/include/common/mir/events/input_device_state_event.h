@@ -52,6 +52,9 @@ struct MirInputDeviceStateEvent : MirEvent
     void set_device_states(std::vector<mir::events::InputDeviceState> const& device_states);
     void set_window_id(int id);
     int window_id() const;
+private:
+    mir::events::InputDeviceStateEventData& device_state() { return get<mir::events::InputDeviceStateEventData>(); }
+    mir::events::InputDeviceStateEventData const& device_state() const { return get<mir::events::InputDeviceStateEventData>(); }
 };
 
 #endif /* MIR_COMMON_INPUT_DEVICE_STATE_EVENT_H_*/
@@ -58,6 +58,14 @@ protected:
     MirInputEvent() = default;
     MirInputEvent(MirInputEvent const& event) = default;
     MirInputEvent& operator=(MirInputEvent const& event) = default;
+
+    mir::events::InputEventData& input() { return get<mir::events::InputEventData>(); }
+    mir::events::InputEventData const& input() const { return get<mir::events::InputEventData>(); }
+
+    template<typename T>
+    T& details() { return std::get<T>(input().details); }
+    template<typename T>
+    T const& details() const { return std::get<T>(input().details); }
 };
 
 #endif /* MIR_COMMON_INPUT_EVENT_H_ */
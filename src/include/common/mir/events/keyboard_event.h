@@ -40,6 +40,10 @@ struct MirKeyboardEvent : MirInputEvent
 
     char const* text() const;
     void set_text(char const* str);
+
+private:
+    mir::events::KeyboardEventData& key() { return details<mir::events::KeyboardEventData>(); }
+    mir::events::KeyboardEventData const& key() const { return details<mir::events::KeyboardEventData>(); }
 };
 
 #endif /* MIR_COMMON_KEYBOARD_EVENT_H_ */
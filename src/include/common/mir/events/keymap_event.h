@@ -37,6 +37,9 @@ struct MirKeymapEvent : MirEvent
     void set_buffer(char const* buffer);
 
     size_t size() const;
+private:
+    mir::events::KeymapEventData& keymap() { return get<mir::events::KeymapEventData>(); }
+    mir::events::KeymapEventData const& keymap() const { return get<mir::events::KeymapEventData>(); }
 };
 
 #endif /* MIR_COMMON_KEYMAP_EVENT_H_ */
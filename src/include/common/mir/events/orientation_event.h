@@ -30,6 +30,9 @@ struct MirOrientationEvent : MirEvent
 
     MirOrientation direction() const;
     void set_direction(MirOrientation orientation);
+private:
+    mir::events::OrientationEventData& orientation() { return get<mir::events::OrientationEventData>(); }
+    mir::events::OrientationEventData const& orientation() const { return get<mir::events::OrientationEventData>(); }
 };
 
 #endif /* MIR_COMMON_ORIENTATION_EVENT_H_ */
@@ -65,7 +65,10 @@ struct MirPointerEvent : MirInputEvent
 
     void set_dnd_handle(std::vector<uint8_t> const& handle);
     MirBlob* dnd_handle() const;
+
 private:
+    mir::events::PointerEventData& pointer() { return details<mir::events::PointerEventData>(); }
+    mir::events::PointerEventData const& pointer() const { return details<mir::events::PointerEventData>(); }
 };
 
 #endif
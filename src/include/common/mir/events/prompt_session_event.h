@@ -27,6 +27,9 @@ struct MirPromptSessionEvent : MirEvent
 
     MirPromptSessionState new_state() const;
     void set_new_state(MirPromptSessionState state);
+private:
+    mir::events::PromptSessionEventData& prompt_session() { return get<mir::events::PromptSessionEventData>(); }
+    mir::events::PromptSessionEventData const& prompt_session() const { return get<mir::events::PromptSessionEventData>(); }
 };
 
 #endif /* MIR_COMMON_PROMPT_SESSION_EVENT_H_ */
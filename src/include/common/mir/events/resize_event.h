@@ -33,6 +33,9 @@ struct MirResizeEvent : MirEvent
 
     int height() const;
     void set_height(int height);
+private:
+    mir::events::ResizeEventData& resize() { return get<mir::events::ResizeEventData>(); }
+    mir::events::ResizeEventData const& resize() const { return get<mir::events::ResizeEventData>(); }
 };
 
 #endif /* MIR_COMMON_RESIZE_EVENT_H_ */
@@ -38,6 +38,9 @@ struct MirSurfaceEvent : MirEvent
 
     void set_dnd_handle(std::vector<uint8_t> const& handle);
     MirBlob* dnd_handle() const;
+private:
+    mir::events::SurfaceEventData& surface() { return get<mir::events::SurfaceEventData>(); }
+    mir::events::SurfaceEventData const& surface() const { return get<mir::events::SurfaceEventData>(); }
 };
 
 #endif /* MIR_COMMON_SURFACE_EVENT_H_ */
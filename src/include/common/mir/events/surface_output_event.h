@@ -44,6 +44,9 @@ struct MirSurfaceOutputEvent : MirEvent
 
     uint32_t output_id() const;
     void set_output_id(uint32_t id);
+private:
+    mir::events::SurfaceOutputEventData& surface_output() { return get<mir::events::SurfaceOutputEventData>(); }
+    mir::events::SurfaceOutputEventData const& surface_output() const { return get<mir::events::SurfaceOutputEventData>(); }
 };
 
 #endif /* MIR_COMMON_SURFACE_OUTPUT_EVENT_H_ */
@@ -31,6 +31,9 @@ struct MirSurfacePlacementEvent : MirEvent
 
     MirRectangle placement() const;
     void set_placement(MirRectangle const& placement);
+private:
+    mir::events::SurfacePlacementEventData& surface_placement() { return get<mir::events::SurfacePlacementEventData>(); }
+    mir::events::SurfacePlacementEventData const& surface_placement() const { return get<mir::events::SurfacePlacementEventData>(); }
 };
 
 #endif //MIR_SURFACE_PLACEMENT_EVENT_H
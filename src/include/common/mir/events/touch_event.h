@@ -66,6 +66,9 @@ struct MirTouchEvent : MirInputEvent
 private:
     void throw_if_out_of_bounds(size_t index) const;
 
+    mir::events::TouchEventData& touch() { return details<mir::events::TouchEventData>(); }
+    mir::events::TouchEventData const& touch() const { return details<mir::events::TouchEventData>(); }
+
 };
 
 #endif /* MIR_COMMON_TOUCH_EVENT_H */
@@ -0,0 +1,67 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RECURSIVE_SHARED_MUTEX_H_
+#define MIR_RECURSIVE_SHARED_MUTEX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mir
+{
+/**
+ * A recursive reader-writer mutex meeting the SharedMutex requirements, so it
+ * can be used with std::shared_lock, std::unique_lock and std::lock_guard.
+ *
+ * It allows the same recursion as RecursiveReadWriteMutex: shared and
+ * exclusive locks may both be taken recursively, a thread holding the
+ * exclusive lock may take shared locks and a thread holding shared locks may
+ * take the exclusive lock (once no other thread holds a shared lock).
+ *
+ * Unlike RecursiveReadWriteMutex, taking and releasing a shared lock while no
+ * thread wants the exclusive lock is an atomic increment and decrement; the
+ * internal mutex is only used while a writer is waiting or holding the lock.
+ * Waiting writers take precedence over threads not yet holding a shared lock.
+ */
+class RecursiveSharedMutex
+{
+public:
+    RecursiveSharedMutex() = default;
+    RecursiveSharedMutex(RecursiveSharedMutex const&) = delete;
+    RecursiveSharedMutex& operator=(RecursiveSharedMutex const&) = delete;
+
+    void lock();
+    void unlock();
+
+    void lock_shared();
+    void unlock_shared();
+
+private:
+    /// Shared locks held by all threads (including any held by the writer)
+    std::atomic<unsigned> readers{0};
+    /// The thread holding or waiting for the exclusive lock
+    std::atomic<std::thread::id> writer{};
+    /// Recursion depth of the exclusive lock, only touched by the writer
+    unsigned write_count{0};
+
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+}
+
+#endif /* MIR_RECURSIVE_SHARED_MUTEX_H_ */
@@ -20,29 +20,44 @@
 #ifndef MIR_THREAD_SAFE_LIST_H_
 #define MIR_THREAD_SAFE_LIST_H_
 
-#include "mir/recursive_read_write_mutex.h"
-
 #include <atomic>
-#include <functional>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace mir
 {
+namespace detail
+{
+/// A ThreadSafeList::for_each() callback in progress on the current thread
+struct ThreadSafeListCall
+{
+    void const* item;
+    ThreadSafeListCall const* outer;
+};
+
+/// The innermost ThreadSafeList::for_each() callback in progress on the current thread
+auto innermost_thread_safe_list_call() -> ThreadSafeListCall const*&;
+}
 
 /*
+ * The elements are held in an immutable array that add() and remove() replace,
+ * so for_each() need only take a reference to the current array: it does not
+ * allocate, and does not hold the list's mutex while calling back. Taking the
+ * reference is not lock-free, though: std::atomic_load() of a shared_ptr locks
+ * one of a small global pool of mutexes for the duration of the copy.
+ *
+ * Once remove() returns, the removed element will not be passed to any
+ * callback, and any callbacks it was already passed to on other threads have
+ * returned. Elements added during for_each() are not visited by it.
+ *
  * Requirements for type 'Element'
- *  - for_each():
- *    - copy-assignable
  *  - add():
- *    - copy-assignable
- *    - conversion to bool: indicates whether this is a valid element
+ *    - copy-constructible
  *  - remove(), remove_all():
- *    - copy-assignable
- *    - Element{}: default construction should create an invalid element
  *    - bool operator==: equality of elements
- *    - bool operator!=: inequality of elements
- *  - clear():
- *    - copy-assignable
- *    - Element{}: value initialization should create an invalid element
  */
 
 template<class Element>
@@ -53,133 +68,158 @@ public:
     void remove(Element const& element);
     unsigned int remove_all(Element const& element);
     void clear();
-    void for_each(std::function<void(Element const& element)> const& f);
+
+    template<typename Callback>
+    void for_each(Callback&& f);
 
 private:
-    struct ListItem
+    struct Item
     {
-        ListItem() {}
-        RecursiveReadWriteMutex mutex;
-        Element element{};
-        std::atomic<ListItem*> next{nullptr};
+        explicit Item(Element const& element) : element{element} {}
 
-        ~ListItem() { delete next.load(); }
-    } head;
-};
+        Element const element;
+        std::atomic<bool> removed{false};
+        std::atomic<unsigned> in_use{0};
+    };
 
-template<class Element>
-void ThreadSafeList<Element>::for_each(
-    std::function<void(Element const& element)> const& f)
-{
-    ListItem* current_item = &head;
+    using Items = std::vector<std::shared_ptr<Item>>;
 
-    while (current_item)
-    {
-        RecursiveReadLock lock{current_item->mutex};
+    class CallInProgress;
 
-        // We need to take a copy in case we recursively remove during call
-        if (auto const copy_of_element = current_item->element) f(copy_of_element);
+    template<typename Predicate>
+    auto remove_where(Predicate const& matches, unsigned int limit) -> unsigned int;
 
-        current_item = current_item->next;
-    }
-}
+    std::mutex mutex;
+    std::condition_variable removal_cv;
+    std::shared_ptr<Items const> items{std::make_shared<Items const>()};
+};
 
 template<class Element>
-void ThreadSafeList<Element>::add(Element const& element)
+class ThreadSafeList<Element>::CallInProgress
 {
-    ListItem* current_item = &head;
-
-    do
+public:
+    CallInProgress(ThreadSafeList& list, Item& item) :
+        list{list},
+        item{item},
+        innermost{detail::innermost_thread_safe_list_call()},
+        call{&item, innermost}
     {
-        // Note: we release the read lock to avoid two threads calling add at
-        // the same time mutually blocking the other's upgrade to write lock.
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element) continue;
-        }
+        innermost = &call;
+    }
 
-        RecursiveWriteLock lock{current_item->mutex};
+    ~CallInProgress()
+    {
+        innermost = call.outer;
 
-        if (!current_item->element)
+        if (item.in_use.fetch_sub(1) && item.removed)
         {
-            current_item->element = element;
-            return;
+            std::lock_guard<std::mutex> lock{list.mutex};
+            list.removal_cv.notify_all();
         }
     }
-    while (current_item->next && (current_item = current_item->next));
 
-    // No empty Items so append a new one
-    auto new_item = new ListItem;
-    new_item->element = element;
+private:
+    ThreadSafeList& list;
+    Item& item;
+    detail::ThreadSafeListCall const*& innermost;
+    detail::ThreadSafeListCall const call;
+};
 
-    for (ListItem* expected{nullptr};
-        !current_item->next.compare_exchange_weak(expected, new_item);
-        expected = nullptr)
+template<class Element>
+template<typename Callback>
+void ThreadSafeList<Element>::for_each(Callback&& f)
+{
+    // The snapshot keeps the items alive, so callbacks may remove them
+    auto const snapshot = std::atomic_load(&items);
+
+    for (auto const& item : *snapshot)
     {
-        if (expected) current_item = expected;
+        // Pairs with remove_where(): either we see the removal, or it sees us
+        item->in_use.fetch_add(1);
+        CallInProgress const call{*this, *item};
+
+        if (!item->removed)
+            f(item->element);
     }
 }
 
 template<class Element>
-void ThreadSafeList<Element>::remove(Element const& element)
+void ThreadSafeList<Element>::add(Element const& element)
 {
-    ListItem* current_item = &head;
+    std::lock_guard<std::mutex> lock{mutex};
 
-    do
-    {
-        {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
-        }
+    auto updated = std::make_shared<Items>(*items);
+    updated->push_back(std::make_shared<Item>(element));
 
-        RecursiveWriteLock lock{current_item->mutex};
+    std::atomic_store(&items, std::shared_ptr<Items const>{std::move(updated)});
+}
 
-        if (current_item->element == element)
-        {
-            current_item->element = Element{};
-            return;
-        }
-    }
-    while ((current_item = current_item->next));
+template<class Element>
+void ThreadSafeList<Element>::remove(Element const& element)
+{
+    remove_where([&](Element const& candidate) { return candidate == element; }, 1);
 }
 
 template<class Element>
 unsigned int ThreadSafeList<Element>::remove_all(Element const& element)
 {
-    ListItem* current_item = &head;
-    auto removed = 0u;
+    return remove_where(
+        [&](Element const& candidate) { return candidate == element; },
+        std::numeric_limits<unsigned int>::max());
+}
 
-    do
+template<class Element>
+void ThreadSafeList<Element>::clear()
+{
+    remove_where([](Element const&) { return true; }, std::numeric_limits<unsigned int>::max());
+}
+
+template<class Element>
+template<typename Predicate>
+auto ThreadSafeList<Element>::remove_where(Predicate const& matches, unsigned int limit) -> unsigned int
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    auto remaining = std::make_shared<Items>();
+    Items removed;
+
+    for (auto const& item : *items)
     {
+        if (removed.size() < limit && matches(item->element))
         {
-            RecursiveReadLock lock{current_item->mutex};
-            if (current_item->element != element) continue;
+            item->removed = true;
+            removed.push_back(item);
         }
-
-        RecursiveWriteLock lock{current_item->mutex};
-
-        if (current_item->element == element)
+        else
         {
-            current_item->element = Element{};
-            ++removed;
+            remaining->push_back(item);
         }
     }
-    while ((current_item = current_item->next));
 
-    return removed;
-}
+    if (removed.empty())
+        return 0;
 
-template<class Element>
-void ThreadSafeList<Element>::clear()
-{
-    ListItem* current_item = &head;
+    std::atomic_store(&items, std::shared_ptr<Items const>{std::move(remaining)});
 
-    do
+    // Callbacks this thread is making can't finish until we return
+    auto const calls_on_this_thread = [](Item const* item)
+        {
+            unsigned int calls = 0;
+            for (auto call = detail::innermost_thread_safe_list_call(); call; call = call->outer)
+            {
+                if (call->item == item)
+                    ++calls;
+            }
+            return calls;
+        };
+
+    for (auto const& item : removed)
     {
-        RecursiveWriteLock lock{current_item->mutex};
-        current_item->element = Element{};
+        auto const ours = calls_on_this_thread(item.get());
+        removal_cv.wait(lock, [&]{ return item->in_use == ours; });
     }
-    while ((current_item = current_item->next));
+
+    return removed.size();
 }
 
 }
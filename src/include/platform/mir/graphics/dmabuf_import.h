@@ -0,0 +1,130 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_DMABUF_IMPORT_H_
+#define MIR_GRAPHICS_DMABUF_IMPORT_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES2/gl2.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+class Executor;
+namespace renderer { namespace gl { class Context; } }
+namespace graphics
+{
+class EGLExtensions;
+class DisplayReport;
+
+/**
+ * The EGLImage of a client's dmabufs, and the texture it is bound to
+ *
+ * Importing the dmabufs is costly, so it's done once per wl_buffer and shared by every
+ * submission of that wl_buffer, rather than done again each time the client commits it.
+ * This lives until both the wl_buffer and the last frame using it have gone.
+ */
+class DmabufImport
+{
+public:
+    /**
+     * Import dmabufs into an EGLImage
+     *
+     * \param [in] attributes   The EGL_LINUX_DMA_BUF_EXT attributes describing the dmabufs
+     * \return                  The import, or nullptr if EGL rejected the dmabufs
+     */
+    static auto import(
+        EGLDisplay dpy,
+        std::shared_ptr<EGLExtensions> const& extensions,
+        std::shared_ptr<DisplayReport> const& report,
+        uint32_t drm_fourcc,
+        EGLint const* attributes) -> std::shared_ptr<DmabufImport>;
+
+    DmabufImport(
+        EGLDisplay dpy,
+        std::shared_ptr<EGLExtensions> extensions,
+        std::shared_ptr<DisplayReport> report,
+        uint32_t drm_fourcc,
+        EGLImageKHR image);
+    ~DmabufImport();
+
+    DmabufImport(DmabufImport const&) = delete;
+    DmabufImport& operator=(DmabufImport const&) = delete;
+
+    /**
+     * Note a new submission of the buffer, reporting the reuse for all but the first
+     *
+     * \note Only called on the Wayland thread
+     */
+    void submitted();
+
+    /**
+     * Bind the texture, creating it on first use
+     *
+     * \param [in] relatch  Whether the client has submitted new content since the last bind.
+     *                      GL_TEXTURE_2D siblings need respecifying from the EGLImage to be
+     *                      guaranteed to see it; external textures always sample the current
+     *                      content.
+     * \param [in] ctx, wayland_executor
+     *                      Where the texture is deleted, once the last user has gone
+     */
+    void bind(
+        GLenum target,
+        bool relatch,
+        std::shared_ptr<renderer::gl::Context> const& ctx,
+        std::shared_ptr<Executor> const& wayland_executor);
+
+private:
+    EGLDisplay const dpy;
+    std::shared_ptr<EGLExtensions> const extensions;
+    std::shared_ptr<DisplayReport> const report;
+    uint32_t const drm_fourcc;
+    EGLImageKHR const image;
+    bool first_submission{true};
+
+    std::mutex mutex;
+    GLuint tex{0};
+    std::shared_ptr<renderer::gl::Context> ctx;
+    std::shared_ptr<Executor> wayland_executor;
+};
+
+/**
+ * One submission of a dmabuf buffer, re-latching the shared import on its first bind only
+ *
+ * \note bind() calls must be serialised by the caller
+ */
+class DmabufSubmission
+{
+public:
+    explicit DmabufSubmission(std::shared_ptr<DmabufImport> import);
+
+    void bind(
+        GLenum target,
+        std::shared_ptr<renderer::gl::Context> const& ctx,
+        std::shared_ptr<Executor> const& wayland_executor);
+
+private:
+    std::shared_ptr<DmabufImport> const import;
+    bool latched{false};    ///< Whether this submission's content has been bound yet
+};
+}
+}
+
+#endif /* MIR_GRAPHICS_DMABUF_IMPORT_H_ */
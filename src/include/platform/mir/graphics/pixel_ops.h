@@ -0,0 +1,84 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_PIXEL_OPS_H_
+#define MIR_GRAPHICS_PIXEL_OPS_H_
+
+#include "mir_toolkit/common.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mir
+{
+namespace graphics
+{
+/*!
+ * \name Bulk pixel operations
+ *
+ * CPU-side shuffling of pixels, vectorized for whatever the target has. Unless noted,
+ * pixels are 32-bit native-endian words (so 0xAARRGGBB for mir_pixel_format_argb_8888),
+ * strides are in bytes, and \a src may be the same as \a dest.
+ * \{
+ */
+namespace pixel_ops
+{
+/**
+ * Copy a \a width × \a height image into \a dest, turned by \a orientation
+ *
+ * mir_orientation_left turns the image a quarter-turn anticlockwise, so \a dest must be
+ * \a height pixels wide and \a width rows tall (likewise for mir_orientation_right).
+ * \a src and \a dest must not overlap.
+ */
+void rotate(
+    MirOrientation orientation,
+    void const* src,
+    size_t src_stride,
+    unsigned width,
+    unsigned height,
+    void* dest,
+    size_t dest_stride);
+
+/// Reverse the order of the \a height rows of \a pixels, in place
+void flip_vertically(void* pixels, size_t stride, unsigned height);
+
+/// Swap the first and third bytes of each pixel, converting between RGBA and BGRA byte orders
+void swap_red_and_blue(void const* src, void* dest, size_t count);
+
+/// Expand mir_pixel_format_rgb_565 (16-bit) pixels into opaque mir_pixel_format_argb_8888
+void expand_rgb_565(void const* src, void* dest, size_t count);
+
+/// Expand mir_pixel_format_rgba_4444 (16-bit) pixels into mir_pixel_format_argb_8888
+void expand_rgba_4444(void const* src, void* dest, size_t count);
+
+/// Multiply the colour channels of mir_pixel_format_argb_8888 pixels by their alpha
+void premultiply_alpha(void const* src, void* dest, size_t count);
+
+/**
+ * Blend \a color over the colour channels of \a count pixels, weighted by 8-bit \a coverage
+ *
+ * This is for drawing antialiased text and shapes into a buffer: the alpha of \a color
+ * scales the coverage, and the alpha of \a pixels is left as it was.
+ */
+void blend_coverage(void* pixels, unsigned char const* coverage, size_t count, uint32_t color);
+}
+/*!
+ * \}
+ */
+}
+}
+
+#endif /* MIR_GRAPHICS_PIXEL_OPS_H_ */
@@ -0,0 +1,50 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BUFFER_QUEUE_STATS_H_
+#define MIR_COMPOSITOR_BUFFER_QUEUE_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+
+namespace mir
+{
+namespace compositor
+{
+/**
+ * A snapshot of how the buffers submitted to a stream have fared.
+ *
+ * The counts cover the life of the stream; the latencies are percentiles
+ * over the most recent buffers only, zero until there is a sample.
+ */
+struct BufferQueueStats
+{
+    uint64_t submitted{0};      ///< Buffers the client submitted
+    uint64_t acquired{0};       ///< Buffers taken from the queue for compositing
+    uint64_t reacquired{0};     ///< Times a compositor got a buffer it had already used
+    uint64_t dropped{0};        ///< Buffers replaced before anything acquired them
+    uint64_t presented{0};      ///< Buffers that reached the screen
+    unsigned queued{0};         ///< Buffers waiting to be acquired
+
+    std::chrono::nanoseconds queue_latency_p50{0};      ///< Submission to acquisition
+    std::chrono::nanoseconds queue_latency_p99{0};
+    std::chrono::nanoseconds present_latency_p50{0};    ///< Submission to presentation
+    std::chrono::nanoseconds present_latency_p99{0};
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_BUFFER_QUEUE_STATS_H_ */
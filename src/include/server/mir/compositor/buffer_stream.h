@@ -24,7 +24,9 @@
 #include "mir/frontend/buffer_stream.h"
 #include "mir_toolkit/common.h"
 #include "mir/graphics/buffer_id.h"
+#include "mir/compositor/buffer_queue_stats.h"
 
+#include <experimental/optional>
 #include <memory>
 
 namespace mir
@@ -49,6 +51,19 @@ public:
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+    /**
+     * The damage (in buffer coordinates) submitted with the buffers after
+     * \a earlier, up to and including \a later. Returns nothing if either
+     * buffer is no longer remembered.
+     */
+    virtual auto damage_between(graphics::BufferID earlier, graphics::BufferID later) const
+        -> std::experimental::optional<geometry::Rectangles> = 0;
+    /// The opaque region last set, in logical coordinates
+    virtual auto opaque_region() const -> geometry::Rectangles = 0;
+    /// The buffer \a id has reached the screen, superseding any submitted before it
+    virtual void presented(graphics::BufferID id, graphics::Presentation const& presentation) = 0;
+    /// How buffers have moved through the stream so far; cheap enough to poll
+    virtual auto queue_stats() const -> BufferQueueStats = 0;
 };
 
 }
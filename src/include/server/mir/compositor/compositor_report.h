@@ -20,6 +20,9 @@
 #define MIR_COMPOSITOR_COMPOSITOR_REPORT_H_
 
 #include "mir/graphics/renderable.h"
+#include "mir/graphics/buffer_id.h"
+
+#include <chrono>
 
 namespace mir
 {
@@ -30,11 +33,29 @@ class CompositorReport
 {
 public:
     typedef const void* SubCompositorId;  // e.g. thread/display buffer ID
+    typedef const void* StreamId;
     virtual void added_display(int width, int height, int x, int y, SubCompositorId id) = 0;
     virtual void began_frame(SubCompositorId id) = 0;
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
+    virtual void damage_in_frame(SubCompositorId id, geometry::Rectangle const& redrawn) = 0;
+    virtual void draw_calls_in_frame(SubCompositorId id, unsigned draw_calls) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
+    /// A frame reached the screen, latency after composition started sampling the scene
+    virtual void presented_frame(SubCompositorId id, std::chrono::nanoseconds latency) = 0;
+    /// A client submitted \a buffer to \a stream, leaving \a queued buffers awaiting composition
+    virtual void buffer_submitted(StreamId stream, graphics::BufferID buffer, unsigned queued) = 0;
+    /// \a buffer was replaced in the queue before anything acquired it
+    virtual void buffer_dropped(StreamId stream, graphics::BufferID buffer) = 0;
+    /// \a buffer left the queue for compositor \a id (null for a snapshot), latency after submission
+    virtual void buffer_acquired(
+        StreamId stream, SubCompositorId id, graphics::BufferID buffer, std::chrono::nanoseconds latency) = 0;
+    /// Compositor \a id was given \a buffer again as nothing newer was queued
+    virtual void buffer_reacquired(StreamId stream, SubCompositorId id, graphics::BufferID buffer) = 0;
+    /// \a stream no longer hands \a buffer to compositors
+    virtual void buffer_released(StreamId stream, graphics::BufferID buffer) = 0;
+    /// \a buffer first reached the screen, latency after submission
+    virtual void buffer_presented(StreamId stream, graphics::BufferID buffer, std::chrono::nanoseconds latency) = 0;
     virtual void started() = 0;
     virtual void stopped() = 0;
     virtual void scheduled() = 0;
@@ -24,6 +24,10 @@
 
 namespace mir
 {
+namespace graphics
+{
+struct Presentation;
+}
 namespace compositor
 {
 
@@ -34,6 +38,12 @@ public:
 
     virtual void composite(SceneElementSequence&& scene_sequence) = 0;
 
+    /**
+     * The oldest frame composited that wasn't yet known to be on screen
+     * has now been shown, as described by \a presentation.
+     */
+    virtual void presented(graphics::Presentation const& /*presentation*/) {}
+
 protected:
     DisplayBufferCompositor() = default;
     DisplayBufferCompositor& operator=(DisplayBufferCompositor const&) = delete;
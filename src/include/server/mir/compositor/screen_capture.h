@@ -0,0 +1,111 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_SCREEN_CAPTURE_H_
+#define MIR_COMPOSITOR_SCREEN_CAPTURE_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/dimensions.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+class Renderer;
+}
+namespace compositor
+{
+
+/**
+ * Copies composited frames for screen recorders, screenshot tools and remote desktops.
+ *
+ * Frontends ask for the next frame of an area of the scene; the display buffer
+ * compositor drawing that area has the renderer copy it out as it is drawn.
+ */
+class ScreenCapture
+{
+public:
+    struct Frame
+    {
+        /// The area of the scene captured
+        geometry::Rectangle area;
+
+        /**
+         * The part of area (in scene coordinates) that changed since the frame
+         * numbered \a since in the request; all of area if that is unknown.
+         */
+        geometry::Rectangle damage;
+
+        /// Numbers the frames composited for the output; pass it back as \a since
+        uint64_t sequence;
+
+        /// When the frame was drawn, in CLOCK_MONOTONIC
+        std::chrono::nanoseconds timestamp;
+
+        /// 0xAARRGGBB pixels, top row first, without padding between rows
+        std::vector<uint32_t> pixels;
+
+        auto stride() const -> geometry::Stride { return geometry::Stride{area.size.width.as_uint32_t() * 4}; }
+    };
+
+    /// Called on a compositor thread with the frame, or with nullptr if it couldn't be captured
+    using Callback = std::function<void(std::shared_ptr<Frame const> const& frame)>;
+
+    virtual ~ScreenCapture() = default;
+
+    /**
+     * Captures \a area from the next frame drawn of the output containing it.
+     *
+     * \param [in] area         in scene coordinates; it must lie within one output
+     * \param [in] since        the sequence of the caller's previous frame of this output, or 0
+     * \param [in] wait_for_damage  whether to wait until part of \a area changes after \a since
+     * \param [in] on_captured  called once, when the frame is copied or the capture fails
+     *                          (as it does if no output shows \a area, or the output is removed)
+     */
+    virtual void capture(
+        geometry::Rectangle const& area,
+        uint64_t since,
+        bool wait_for_damage,
+        Callback const& on_captured) = 0;
+
+    /// For compositors: whether anything is waiting for a frame of \a view_area
+    virtual bool wants_frame(geometry::Rectangle const& view_area) const = 0;
+
+    /**
+     * For compositors: \a renderer is about to draw a frame of \a view_area, in which
+     * \a damage changed. Any captures of it are handed to the renderer.
+     */
+    virtual void frame_rendering(
+        geometry::Rectangle const& view_area,
+        geometry::Rectangle const& damage,
+        renderer::Renderer& renderer) = 0;
+
+protected:
+    ScreenCapture() = default;
+    ScreenCapture(ScreenCapture const&) = delete;
+    ScreenCapture& operator=(ScreenCapture const&) = delete;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_SCREEN_CAPTURE_H_ */
@@ -22,6 +22,7 @@
 #include <mir_toolkit/common.h>
 #include "mir/graphics/buffer_id.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include <functional>
 #include <memory>
 
@@ -31,6 +32,7 @@ namespace graphics
 {
 class Buffer;
 struct BufferProperties;
+struct Presentation;
 }
 
 namespace frontend
@@ -43,9 +45,25 @@ public:
 
     virtual void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) = 0;
 
+    /**
+     * Submit a buffer that differs from the previously submitted one only
+     * within \a damage (in buffer coordinates).
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) = 0;
+
     virtual void set_frame_posted_callback(
         std::function<void(geometry::Size const&)> const& callback) = 0;
 
+    /**
+     * Calls \a callback once the buffer submitted last reaches the screen,
+     * or with nullptr if it never will (e.g. it is replaced first).
+     * The callback may be called from any thread.
+     */
+    virtual void add_presentation_callback(
+        std::function<void(graphics::Presentation const*)> const& callback) = 0;
+
     virtual void with_most_recent_buffer_do(
         std::function<void(graphics::Buffer&)> const& exec) = 0;
 
@@ -55,6 +73,8 @@ public:
     //      side once we only support the NBS system.
     virtual void allow_framedropping(bool) = 0;
     virtual void set_scale(float scale) = 0;
+    /// The parts of the stream the client promises are opaque, in logical coordinates
+    virtual void set_opaque_region(geometry::Rectangles const& region) = 0;
 protected:
     BufferStream() = default;
     BufferStream(BufferStream const&) = delete;
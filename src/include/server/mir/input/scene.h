@@ -25,6 +25,10 @@
 
 namespace mir
 {
+namespace geometry
+{
+struct Point;
+}
 namespace scene
 {
 class Observer;
@@ -45,6 +49,9 @@ public:
 
     virtual void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) = 0;
 
+    /// The topmost surface whose input area contains point (or null)
+    virtual auto input_surface_at(geometry::Point const& point) -> std::shared_ptr<input::Surface> = 0;
+
     virtual void add_observer(std::shared_ptr<scene::Observer> const& observer) = 0;
     virtual void remove_observer(std::weak_ptr<scene::Observer> const& observer) = 0;
 
@@ -87,6 +87,8 @@ public:
      * set_input_region({Rectangle{}}).
      */
     virtual void set_input_region(std::vector<geometry::Rectangle> const& region) = 0;
+    /// Bounding box of input_area_contains(), as input_bounds() extended by any input region outside it
+    virtual geometry::Rectangle input_region_bounds() const = 0;
     /// Given value is the frame size of the window
     virtual void resize(geometry::Size const& window_size) = 0;
     virtual void set_transformation(glm::mat4 const& t) = 0;
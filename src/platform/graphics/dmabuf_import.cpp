@@ -0,0 +1,139 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/dmabuf_import.h"
+#include "mir/graphics/egl_extensions.h"
+#include "mir/graphics/display_report.h"
+#include "mir/renderer/gl/context.h"
+#include "mir/executor.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <chrono>
+#include <utility>
+
+namespace mg = mir::graphics;
+
+auto mg::DmabufImport::import(
+    EGLDisplay dpy,
+    std::shared_ptr<EGLExtensions> const& extensions,
+    std::shared_ptr<DisplayReport> const& report,
+    uint32_t drm_fourcc,
+    EGLint const* attributes) -> std::shared_ptr<DmabufImport>
+{
+    auto const start = std::chrono::steady_clock::now();
+    auto const image = extensions->base(dpy).eglCreateImageKHR(
+        dpy,
+        EGL_NO_CONTEXT,
+        EGL_LINUX_DMA_BUF_EXT,
+        nullptr,
+        attributes);
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    if (image == EGL_NO_IMAGE_KHR)
+    {
+        return nullptr;
+    }
+
+    report->report_dmabuf_import(drm_fourcc, duration);
+    return std::make_shared<DmabufImport>(dpy, extensions, report, drm_fourcc, image);
+}
+
+mg::DmabufImport::DmabufImport(
+    EGLDisplay dpy,
+    std::shared_ptr<EGLExtensions> extensions,
+    std::shared_ptr<DisplayReport> report,
+    uint32_t drm_fourcc,
+    EGLImageKHR image)
+    : dpy{dpy},
+      extensions{std::move(extensions)},
+      report{std::move(report)},
+      drm_fourcc{drm_fourcc},
+      image{image}
+{
+}
+
+mg::DmabufImport::~DmabufImport()
+{
+    if (tex)
+    {
+        wayland_executor->spawn(
+            [context = ctx, tex = tex]()
+            {
+              context->make_current();
+
+              glDeleteTextures(1, &tex);
+
+              context->release_current();
+            });
+    }
+
+    extensions->base(dpy).eglDestroyImageKHR(dpy, image);
+}
+
+void mg::DmabufImport::submitted()
+{
+    if (!std::exchange(first_submission, false))
+    {
+        report->report_dmabuf_import_reused(drm_fourcc);
+    }
+}
+
+void mg::DmabufImport::bind(
+    GLenum target,
+    bool relatch,
+    std::shared_ptr<renderer::gl::Context> const& ctx,
+    std::shared_ptr<Executor> const& wayland_executor)
+{
+    std::lock_guard<decltype(mutex)> lock(mutex);
+
+    if (!tex)
+    {
+        glGenTextures(1, &tex);
+        glBindTexture(target, tex);
+        extensions->base(dpy).glEGLImageTargetTexture2DOES(target, image);
+
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        this->ctx = ctx;
+        this->wayland_executor = wayland_executor;
+    }
+    else
+    {
+        glBindTexture(target, tex);
+        if (relatch && target != GL_TEXTURE_EXTERNAL_OES)
+        {
+            extensions->base(dpy).glEGLImageTargetTexture2DOES(target, image);
+        }
+    }
+}
+
+mg::DmabufSubmission::DmabufSubmission(std::shared_ptr<DmabufImport> import)
+    : import{std::move(import)}
+{
+    this->import->submitted();
+}
+
+void mg::DmabufSubmission::bind(
+    GLenum target,
+    std::shared_ptr<renderer::gl::Context> const& ctx,
+    std::shared_ptr<Executor> const& wayland_executor)
+{
+    import->bind(target, !std::exchange(latched, true), ctx, wayland_executor);
+}
@@ -29,6 +29,8 @@
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/buffer_basic.h"
 #include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/dmabuf_import.h"
+#include "mir/graphics/display_report.h"
 #include "mir/executor.h"
 
 #define MIR_LOG_COMPONENT "linux-dmabuf-import"
@@ -41,6 +43,7 @@
 #include <mutex>
 #include <vector>
 #include <optional>
+#include <utility>
 #include <drm_fourcc.h>
 #include <wayland-server.h>
 
@@ -380,6 +383,7 @@ public:
     WlDmaBufBuffer(
         EGLDisplay dpy,
         std::shared_ptr<mg::EGLExtensions> egl_extensions,
+        std::shared_ptr<mg::DisplayReport> report,
         BufferGLDescription const& desc,
         wl_resource* wl_buffer,
         int32_t width,
@@ -391,6 +395,7 @@ public:
             : Buffer(wl_buffer, Version<1>{}),
               dpy{dpy},
               egl_extensions{std::move(egl_extensions)},
+              report{std::move(report)},
               desc{desc},
               width{width},
               height{height},
@@ -398,17 +403,8 @@ public:
               flags{flags},
               modifier_{modifier},
               planes_{std::move(plane_params)},
-              image{EGL_NO_IMAGE_KHR}
+              import{import_egl_image()}
     {
-        reimport_egl_image();
-    }
-
-    ~WlDmaBufBuffer()
-    {
-        if (image != EGL_NO_IMAGE_KHR)
-        {
-            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, image);
-        }
     }
 
     static auto maybe_dmabuf_from_wl_buffer(wl_resource* buffer) -> WlDmaBufBuffer*
@@ -443,15 +439,27 @@ public:
         return desc;
     }
     /**
-     * Reimport dmabufs into EGL
-     *
-     * This is necessary to call each time the buffer is re-submitted by the client,
-     * to ensure any state is properly synchronised.
+     * The dmabufs imported into EGL
      *
-     * \return  An EGLImageKHR handle to the imported
-     * \throws  A std::system_error containing the EGL error on failure.
+     * The import is done on creation, to validate the buffer, and shared by every
+     * submission after that.
      */
-    auto reimport_egl_image() -> EGLImageKHR
+    auto imported() -> std::shared_ptr<mg::DmabufImport>
+    {
+        return import;
+    }
+
+    auto modifier() -> uint64_t
+    {
+        return modifier_;
+    }
+
+    auto planes() -> std::vector<PlaneInfo> const&
+    {
+        return planes_;
+    }
+private:
+    auto import_egl_image() -> std::shared_ptr<mg::DmabufImport>
     {
         std::vector<EGLint> attributes;
 
@@ -482,18 +490,9 @@ public:
             }
         }
         attributes.push_back(EGL_NONE);
-        if (image != EGL_NO_IMAGE_KHR)
-        {
-            egl_extensions->base(dpy).eglDestroyImageKHR(dpy, image);
-        }
-        image = egl_extensions->base(dpy).eglCreateImageKHR(
-            dpy,
-            EGL_NO_CONTEXT,
-            EGL_LINUX_DMA_BUF_EXT,
-            nullptr,
-            attributes.data());
-
-        if (image == EGL_NO_IMAGE_KHR)
+        auto imported = mg::DmabufImport::import(dpy, egl_extensions, report, format(), attributes.data());
+
+        if (!imported)
         {
             auto const msg = planes_.size() > 1 ?
                 "Failed to import supplied dmabufs" :
@@ -501,19 +500,9 @@ public:
             BOOST_THROW_EXCEPTION((mg::egl_error(msg)));
         }
 
-        return image;
-    }
-
-    auto modifier() -> uint64_t
-    {
-        return modifier_;
+        return imported;
     }
 
-    auto planes() -> std::vector<PlaneInfo> const&
-    {
-        return planes_;
-    }
-private:
     void destroy() override
     {
         destroy_wayland_object();
@@ -521,13 +510,14 @@ private:
 
     EGLDisplay const dpy;
     std::shared_ptr<mg::EGLExtensions> const egl_extensions;
+    std::shared_ptr<mg::DisplayReport> const report;
     BufferGLDescription const& desc;
     int32_t const width, height;
     uint32_t const format_;
     uint32_t const flags;
     uint64_t const modifier_;
     std::vector<PlaneInfo> const planes_;
-    EGLImageKHR image;
+    std::shared_ptr<mg::DmabufImport> const import;
 
     struct EGLPlaneAttribs
     {
@@ -576,12 +566,14 @@ public:
         wl_resource* new_resource,
         EGLDisplay dpy,
         std::shared_ptr<mg::EGLExtensions> egl_extensions,
-        std::shared_ptr<mg::DmaBufFormatDescriptors const> formats)
+        std::shared_ptr<mg::DmaBufFormatDescriptors const> formats,
+        std::shared_ptr<mg::DisplayReport> report)
         : mir::wayland::LinuxBufferParamsV1(new_resource, Version<3>{}),
           consumed{false},
           dpy{dpy},
           egl_extensions{std::move(egl_extensions)},
-          formats{std::move(formats)}
+          formats{std::move(formats)},
+          report{std::move(report)}
     {
     }
 
@@ -595,6 +587,7 @@ private:
     EGLDisplay dpy;
     std::shared_ptr<mg::EGLExtensions> egl_extensions;
     std::shared_ptr<mg::DmaBufFormatDescriptors const> const formats;
+    std::shared_ptr<mg::DisplayReport> const report;
 
     void destroy() override
     {
@@ -777,6 +770,7 @@ private:
             new WlDmaBufBuffer{
                 dpy,
                 egl_extensions,
+                report,
                 descriptor_for_format_and_modifiers(format),
                 buffer_resource,
                 width,
@@ -819,6 +813,7 @@ private:
             new WlDmaBufBuffer{
                 dpy,
                 egl_extensions,
+                report,
                 descriptor_for_format_and_modifiers(format),
                 buffer_id,
                 width,
@@ -851,13 +846,6 @@ private:
     }
 };
 
-GLuint get_tex_id()
-{
-    GLuint tex;
-    glGenTextures(1, &tex);
-    return tex;
-}
-
 bool drm_format_has_alpha(uint32_t format)
 {
     /* TODO: We should really have something like libweston/pixel-formats.h
@@ -890,17 +878,19 @@ class WaylandDmabufTexBuffer :
     public mg::DMABufBuffer
 {
 public:
-    // Note: Must be called with a current EGL context
+    /*
+     * The EGLImage was created with the wl_buffer, on the Wayland thread, so import failures
+     * could be reported to the client. Binding it to a texture needs a current context, so waits
+     * for the first bind() on a compositor thread rather than holding up other clients.
+     */
     WaylandDmabufTexBuffer(
         WlDmaBufBuffer& source,
-        mg::EGLExtensions const& extensions,
         std::shared_ptr<mir::renderer::gl::Context> ctx,
-        EGLDisplay dpy,
         std::function<void()>&& on_consumed,
         std::function<void()>&& on_release,
         std::shared_ptr<mir::Executor> wayland_executor)
         : ctx{std::move(ctx)},
-          tex{get_tex_id()},
+          submission{source.imported()},
           desc{source.descriptor()},
           on_consumed{std::move(on_consumed)},
           on_release{std::move(on_release)},
@@ -912,33 +902,10 @@ public:
           fourcc{source.format()},
           wayland_executor{std::move(wayland_executor)}
     {
-        eglBindAPI(EGL_OPENGL_ES_API);
-
-        auto const target = source.descriptor().target;
-
-        glBindTexture(target, tex);
-        extensions.base(dpy).glEGLImageTargetTexture2DOES(target, source.reimport_egl_image());
-        // tex is now an EGLImage sibling, so we can free the EGLImage without
-        // freeing the backing data.
-
-        glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     }
 
     ~WaylandDmabufTexBuffer() override
     {
-        wayland_executor->spawn(
-            [context = ctx, tex = tex]()
-            {
-              context->make_current();
-
-              glDeleteTextures(1, &tex);
-
-              context->release_current();
-            });
-
         on_release();
     }
 
@@ -989,9 +956,10 @@ public:
 
     void bind() override
     {
-        glBindTexture(desc.target, tex);
+        std::lock_guard<decltype(mutex)> lock(mutex);
+
+        submission.bind(desc.target, ctx, wayland_executor);
 
-        std::lock_guard<decltype(consumed_mutex)> lock(consumed_mutex);
         on_consumed();
         on_consumed = [](){};
     }
@@ -1017,10 +985,11 @@ public:
 
 private:
     std::shared_ptr<mir::renderer::gl::Context> const ctx;
-    GLuint const tex;
+
+    std::mutex mutex;
+    mg::DmabufSubmission submission;
     BufferGLDescription const& desc;
 
-    std::mutex consumed_mutex;
     std::function<void()> on_consumed;
     std::function<void()> const on_release;
 
@@ -1045,11 +1014,13 @@ public:
         wl_resource* new_resource,
         EGLDisplay dpy,
         std::shared_ptr<EGLExtensions> egl_extensions,
-        std::shared_ptr<DmaBufFormatDescriptors const> formats)
+        std::shared_ptr<DmaBufFormatDescriptors const> formats,
+        std::shared_ptr<DisplayReport> report)
         : mir::wayland::LinuxDmabufV1(new_resource, Version<3>{}),
           dpy{dpy},
           egl_extensions{std::move(egl_extensions)},
-          formats{std::move(formats)}
+          formats{std::move(formats)},
+          report{std::move(report)}
     {
         for (auto i = 0u; i < this->formats->num_formats(); ++i)
         {
@@ -1077,23 +1048,26 @@ private:
 
     void create_params(struct wl_resource* params_id) override
     {
-        new LinuxDmaBufParams{params_id, dpy, egl_extensions, formats};
+        new LinuxDmaBufParams{params_id, dpy, egl_extensions, formats, report};
     }
 
     EGLDisplay const dpy;
     std::shared_ptr<EGLExtensions> const egl_extensions;
     std::shared_ptr<DmaBufFormatDescriptors const> const formats;
+    std::shared_ptr<DisplayReport> const report;
 };
 
 mg::LinuxDmaBufUnstable::LinuxDmaBufUnstable(
     wl_display* display,
     EGLDisplay dpy,
     std::shared_ptr<EGLExtensions> egl_extensions,
-    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext)
+    EGLExtensions::EXTImageDmaBufImportModifiers const& dmabuf_ext,
+    std::shared_ptr<DisplayReport> report)
     : mir::wayland::LinuxDmabufV1::Global(display, Version<3>{}),
       dpy{dpy},
       egl_extensions{std::move(egl_extensions)},
-      formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)}
+      formats{std::make_shared<DmaBufFormatDescriptors>(dpy, dmabuf_ext)},
+      report{std::move(report)}
 {
 }
 
@@ -1109,9 +1083,7 @@ auto mg::LinuxDmaBufUnstable::buffer_from_resource(
     {
         return std::make_shared<WaylandDmabufTexBuffer>(
             *dmabuf,
-            *egl_extensions,
             std::move(ctx),
-            dpy,
             std::move(on_consumed),
             std::move(on_release),
             std::move(wayland_executor));
@@ -1121,5 +1093,5 @@ auto mg::LinuxDmaBufUnstable::buffer_from_resource(
 
 void mg::LinuxDmaBufUnstable::bind(wl_resource* new_resource)
 {
-    new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, formats};
+    new LinuxDmaBufUnstable::Instance{new_resource, dpy, egl_extensions, formats, report};
 }
@@ -0,0 +1,284 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/pixel_ops.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mg = mir::graphics;
+
+/*
+ * The kernels are written with GCC/Clang generic vectors, which are lowered to whatever
+ * SIMD the target has (SSE2 on x86-64, NEON on arm64) or to scalar code. On x86-64 the
+ * streaming kernels are built a second time for AVX2, and the dynamic loader picks the
+ * version for the CPU we're running on.
+ */
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define MIR_PIXEL_KERNEL __attribute__((target_clones("avx2", "default")))
+#endif
+#endif
+#ifndef MIR_PIXEL_KERNEL
+#define MIR_PIXEL_KERNEL
+#endif
+
+/*
+ * Everything the kernels call with vectors must be inlined into them (even at -O0), so each
+ * build of a kernel gets its own copy: an out-of-line helper would be built for only one of
+ * the instruction sets, and passes 32-byte vectors differently with and without AVX.
+ */
+#define MIR_PIXEL_HELPER __attribute__((always_inline))
+
+namespace
+{
+/// Eight pixels at a time: one AVX2 register, or a pair of SSE2/NEON ones
+using Pixels = uint32_t __attribute__((vector_size(32)));
+size_t const pixels_per_vector = sizeof(Pixels) / sizeof(uint32_t);
+static_assert(pixels_per_vector == 8, "the 16-bit loads below fill eight lanes");
+
+/// Divides by 255, rounding to nearest, for any x up to 255 * 255 (per lane for vectors)
+template<typename T>
+MIR_PIXEL_HELPER inline auto div255(T x) -> T
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+/// Applies \a op to \a count 32-bit pixels from \a src, storing the results in \a dest
+template<typename Op>
+MIR_PIXEL_HELPER inline void transform(void const* src, void* dest, size_t count, Op const& op)
+{
+    auto const in = static_cast<unsigned char const*>(src);
+    auto const out = static_cast<unsigned char*>(dest);
+
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector)
+    {
+        Pixels pixels;
+        memcpy(&pixels, in + i * sizeof(uint32_t), sizeof(pixels));
+        pixels = op(pixels);
+        memcpy(out + i * sizeof(uint32_t), &pixels, sizeof(pixels));
+    }
+    for (; i < count; ++i)
+    {
+        uint32_t pixel;
+        memcpy(&pixel, in + i * sizeof(uint32_t), sizeof(pixel));
+        pixel = op(pixel);
+        memcpy(out + i * sizeof(uint32_t), &pixel, sizeof(pixel));
+    }
+}
+
+/// Applies \a op to \a count 16-bit pixels from \a src (widened to 32 bits), storing the results in \a dest
+template<typename Op>
+MIR_PIXEL_HELPER inline void widen(void const* src, void* dest, size_t count, Op const& op)
+{
+    auto const in = static_cast<unsigned char const*>(src);
+    auto const out = static_cast<unsigned char*>(dest);
+
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector)
+    {
+        uint16_t narrow[pixels_per_vector];
+        memcpy(narrow, in + i * sizeof(uint16_t), sizeof(narrow));
+        Pixels pixels{
+            narrow[0], narrow[1], narrow[2], narrow[3],
+            narrow[4], narrow[5], narrow[6], narrow[7]};
+        pixels = op(pixels);
+        memcpy(out + i * sizeof(uint32_t), &pixels, sizeof(pixels));
+    }
+    for (; i < count; ++i)
+    {
+        uint16_t narrow;
+        memcpy(&narrow, in + i * sizeof(uint16_t), sizeof(narrow));
+        uint32_t const pixel = op(uint32_t{narrow});
+        memcpy(out + i * sizeof(uint32_t), &pixel, sizeof(pixel));
+    }
+}
+
+/// Square tiles keep the rows being read and the rows being written in cache while rotating
+unsigned const tile_size = 32;
+
+inline auto pixel_at(void const* image, size_t stride, unsigned x, unsigned y) -> uint32_t const*
+{
+    return reinterpret_cast<uint32_t const*>(static_cast<unsigned char const*>(image) + y * stride) + x;
+}
+
+inline auto pixel_at(void* image, size_t stride, unsigned x, unsigned y) -> uint32_t*
+{
+    return reinterpret_cast<uint32_t*>(static_cast<unsigned char*>(image) + y * stride) + x;
+}
+}
+
+void mg::pixel_ops::rotate(
+    MirOrientation orientation,
+    void const* src,
+    size_t src_stride,
+    unsigned width,
+    unsigned height,
+    void* dest,
+    size_t dest_stride)
+{
+    switch (orientation)
+    {
+    case mir_orientation_normal:
+        for (unsigned y = 0; y != height; ++y)
+        {
+            memcpy(pixel_at(dest, dest_stride, 0, y), pixel_at(src, src_stride, 0, y), width * sizeof(uint32_t));
+        }
+        break;
+
+    case mir_orientation_inverted:
+        for (unsigned y = 0; y != height; ++y)
+        {
+            auto const in = pixel_at(src, src_stride, 0, (height - 1) - y);
+            std::reverse_copy(in, in + width, pixel_at(dest, dest_stride, 0, y));
+        }
+        break;
+
+    case mir_orientation_left:
+    case mir_orientation_right:
+        for (unsigned tile_y = 0; tile_y < height; tile_y += tile_size)
+        {
+            auto const tile_bottom = std::min(height, tile_y + tile_size);
+            for (unsigned tile_x = 0; tile_x < width; tile_x += tile_size)
+            {
+                auto const tile_right = std::min(width, tile_x + tile_size);
+                for (unsigned x = tile_x; x != tile_right; ++x)
+                {
+                    // Column x of the source becomes a row of the destination
+                    if (orientation == mir_orientation_left)
+                    {
+                        auto out = pixel_at(dest, dest_stride, tile_y, (width - 1) - x);
+                        for (unsigned y = tile_y; y != tile_bottom; ++y)
+                            *out++ = *pixel_at(src, src_stride, x, y);
+                    }
+                    else
+                    {
+                        auto out = pixel_at(dest, dest_stride, (height - 1) - tile_y, x);
+                        for (unsigned y = tile_y; y != tile_bottom; ++y)
+                            *out-- = *pixel_at(src, src_stride, x, y);
+                    }
+                }
+            }
+        }
+        break;
+    }
+}
+
+void mg::pixel_ops::flip_vertically(void* pixels, size_t stride, unsigned height)
+{
+    unsigned char chunk[1024];
+    auto const rows = static_cast<unsigned char*>(pixels);
+
+    for (unsigned y = 0; y < height / 2; ++y)
+    {
+        auto const top = rows + y * stride;
+        auto const bottom = rows + ((height - 1) - y) * stride;
+        for (size_t offset = 0; offset < stride; offset += sizeof(chunk))
+        {
+            auto const length = std::min(sizeof(chunk), stride - offset);
+            memcpy(chunk, top + offset, length);
+            memcpy(top + offset, bottom + offset, length);
+            memcpy(bottom + offset, chunk, length);
+        }
+    }
+}
+
+MIR_PIXEL_KERNEL
+void mg::pixel_ops::swap_red_and_blue(void const* src, void* dest, size_t count)
+{
+    transform(src, dest, count, [](auto p) MIR_PIXEL_HELPER
+        {
+            return ((p << 16) & 0x00FF0000) | (p & 0xFF00FF00) | ((p >> 16) & 0x000000FF);
+        });
+}
+
+MIR_PIXEL_KERNEL
+void mg::pixel_ops::expand_rgb_565(void const* src, void* dest, size_t count)
+{
+    widen(src, dest, count, [](auto p) MIR_PIXEL_HELPER
+        {
+            auto const r = p >> 11;
+            auto const g = (p >> 5) & 0x3F;
+            auto const b = p & 0x1F;
+            return 0xFF000000 |
+                (((r << 3) | (r >> 2)) << 16) |
+                (((g << 2) | (g >> 4)) << 8) |
+                ((b << 3) | (b >> 2));
+        });
+}
+
+MIR_PIXEL_KERNEL
+void mg::pixel_ops::expand_rgba_4444(void const* src, void* dest, size_t count)
+{
+    widen(src, dest, count, [](auto p) MIR_PIXEL_HELPER
+        {
+            // Each nibble n becomes n * 17, so 0xF expands to 0xFF
+            return ((p & 0x000F) * 0x11000000) |
+                (((p >> 12) & 0x0F) * 0x00110000) |
+                (((p >> 8) & 0x0F) * 0x00001100) |
+                (((p >> 4) & 0x0F) * 0x00000011);
+        });
+}
+
+MIR_PIXEL_KERNEL
+void mg::pixel_ops::premultiply_alpha(void const* src, void* dest, size_t count)
+{
+    transform(src, dest, count, [](auto p) MIR_PIXEL_HELPER
+        {
+            auto const alpha = p >> 24;
+            return (p & 0xFF000000) |
+                (div255(((p >> 16) & 0xFF) * alpha) << 16) |
+                (div255(((p >> 8) & 0xFF) * alpha) << 8) |
+                div255((p & 0xFF) * alpha);
+        });
+}
+
+MIR_PIXEL_KERNEL
+void mg::pixel_ops::blend_coverage(void* pixels, unsigned char const* coverage, size_t count, uint32_t color)
+{
+    auto const blend = [color](auto p, auto p_coverage) MIR_PIXEL_HELPER
+        {
+            auto const alpha = div255(p_coverage * (color >> 24));
+            auto const inverse = 255 - alpha;
+            return (p & 0xFF000000) |
+                (div255(((p >> 16) & 0xFF) * inverse + ((color >> 16) & 0xFF) * alpha) << 16) |
+                (div255(((p >> 8) & 0xFF) * inverse + ((color >> 8) & 0xFF) * alpha) << 8) |
+                div255((p & 0xFF) * inverse + (color & 0xFF) * alpha);
+        };
+
+    auto const out = static_cast<unsigned char*>(pixels);
+
+    size_t i = 0;
+    for (; i + pixels_per_vector <= count; i += pixels_per_vector)
+    {
+        Pixels p;
+        memcpy(&p, out + i * sizeof(uint32_t), sizeof(p));
+        Pixels const p_coverage{
+            coverage[i], coverage[i + 1], coverage[i + 2], coverage[i + 3],
+            coverage[i + 4], coverage[i + 5], coverage[i + 6], coverage[i + 7]};
+        p = blend(p, p_coverage);
+        memcpy(out + i * sizeof(uint32_t), &p, sizeof(p));
+    }
+    for (; i < count; ++i)
+    {
+        uint32_t p;
+        memcpy(&p, out + i * sizeof(uint32_t), sizeof(p));
+        p = blend(p, uint32_t{coverage[i]});
+        memcpy(out + i * sizeof(uint32_t), &p, sizeof(p));
+    }
+}
@@ -19,7 +19,9 @@
 
 #include "buffer_from_wl_shm.h"
 #include "shm_buffer.h"
+#include "shm_texture.h"
 
+#include "egl_context_executor.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/executor.h"
 #include "mir/renderer/gl/context.h"
@@ -40,6 +42,7 @@
 
 namespace mg = mir::graphics;
 namespace mgc = mir::graphics::common;
+namespace geom = mir::geometry;
 
 namespace mir
 {
@@ -310,6 +313,8 @@ public:
     WlShmBuffer(
         SharedWlBuffer buffer,
         std::shared_ptr<mgc::EGLContextExecutor> egl_delegate,
+        std::shared_ptr<mgc::ShmTexture> shared_texture,
+        uint64_t sequence,
         mir::geometry::Size const& size,
         mir::geometry::Stride stride,
         MirPixelFormat format,
@@ -317,10 +322,17 @@ public:
         : ShmBuffer(size, format, std::move(egl_delegate)),
           on_consumed{std::move(on_consumed)},
           buffer{std::move(buffer)},
-          stride_{stride}
+          stride_{stride},
+          shared_texture{std::move(shared_texture)},
+          sequence{sequence}
     {
     }
 
+    auto texture() const -> std::shared_ptr<mgc::ShmTexture>
+    {
+        return shared_texture;
+    }
+
     std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override
     {
         BOOST_THROW_EXCEPTION((std::logic_error{"Attempt to get mirclient handle for Wayland Shm buffer"}));
@@ -328,19 +340,29 @@ public:
 
     void bind() override
     {
-        ShmBuffer::bind();
         std::lock_guard<std::mutex> lock{consumption_mutex};
-        if (!uploaded)
+        auto const read_pixels = [this](std::function<void(unsigned char const*)> const& do_with_pixels)
+            {
+                read_internal(do_with_pixels);
+            };
+
+        if (!shared_texture->bind(sequence, size(), pixel_format(), stride_, read_pixels))
         {
-            read_internal(
-                [this](unsigned char const* pixels)
-                {
-                    upload_to_texture(pixels, stride());
-                });
-            on_consumed();
-            on_consumed = [](){};
-            uploaded = true;
+            // A newer buffer of the stream is already in the shared texture (perhaps an
+            // output is lagging behind), so fall back to a texture of our own
+            ShmBuffer::bind();
+            if (!uploaded)
+            {
+                read_internal(
+                    [this](unsigned char const* pixels)
+                    {
+                        upload_to_texture(pixels, stride());
+                    });
+                uploaded = true;
+            }
         }
+        on_consumed();
+        on_consumed = [](){};
     }
 
     void write(unsigned char const* /*pixels*/, size_t /*size*/) override
@@ -386,22 +408,33 @@ private:
     std::function<void()> on_consumed;
     SharedWlBuffer const buffer;
     mir::geometry::Stride const stride_;
+    std::shared_ptr<mgc::ShmTexture> const shared_texture;
+    uint64_t const sequence;
 };
 
 auto mg::wayland::buffer_from_wl_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> executor,
     std::shared_ptr<common::EGLContextExecutor> egl_delegate,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    geometry::Rectangles const& damage) -> std::shared_ptr<Buffer>
 {
     auto const shm_buffer = wl_shm_buffer_get(buffer);
     if (!shm_buffer)
     {
         BOOST_THROW_EXCEPTION((std::logic_error{"Attempt to import a non-SHM buffer as a SHM buffer"}));
     }
+
+    auto const previous_shm = std::dynamic_pointer_cast<WlShmBuffer>(previous);
+    auto const texture = previous_shm ? previous_shm->texture() : std::make_shared<mgc::ShmTexture>(egl_delegate);
+    auto const sequence = texture->submit(damage);
+
     return std::make_shared<WlShmBuffer>(
         SharedWlBuffer{buffer, std::move(executor)},
         std::move(egl_delegate),
+        texture,
+        sequence,
         mir::geometry::Size{
             wl_shm_buffer_get_width(shm_buffer),
             wl_shm_buffer_get_height(shm_buffer)
@@ -20,6 +20,8 @@
 #ifndef MIR_GRAPHICS_GL_WAYLAND_SHM_PROVIDER_H_
 #define MIR_GRAPHICS_GL_WAYLAND_SHM_PROVIDER_H_
 
+#include "mir/geometry/rectangles.h"
+
 #include <memory>
 #include <functional>
 
@@ -46,19 +48,26 @@ namespace wayland
  * The returned buffer will support the mg::gl::Texture and
  * mir::renderer::sw::PixelSource interfaces.
  *
+ * If previous was also imported from SHM, the two share a GL texture and
+ * binding the new buffer uploads only what has been damaged since.
+ *
  * \note This must be called on the Wayland thread, with a current GL context
  *
  * \param buffer        [in]    The Wayland SHM buffer to import
  * \param executor      [in]    An Executor that will defer work to the Wayland event loop
  * \param egl_delegate  [in]    An EGL-context-thread delegator
  * \param on_consumed   [in]    Closure to call when the compositor has consumed this buffer
+ * \param previous      [in]    The buffer previously submitted to the same stream, if any
+ * \param damage        [in]    The parts of buffer that differ from previous
  * \return                      An mg::Buffer supporting being rendered from in GL and read by the CPU.
  */
 auto buffer_from_wl_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> executor,
     std::shared_ptr<common::EGLContextExecutor> egl_delegate,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>;
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    geometry::Rectangles const& damage) -> std::shared_ptr<Buffer>;
 }
 }
 }
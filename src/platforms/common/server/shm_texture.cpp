@@ -0,0 +1,229 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "shm_texture.h"
+#include "egl_context_executor.h"
+
+#include "mir/graphics/gl_format.h"
+
+#define MIR_LOG_COMPONENT "wayland-gfx-helpers"
+#include "mir/log.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mgc = mir::graphics::common;
+namespace geom = mir::geometry;
+
+mgc::ShmTexture::ShmTexture(std::shared_ptr<EGLContextExecutor> egl_delegate)
+    : egl_delegate{std::move(egl_delegate)}
+{
+}
+
+mgc::ShmTexture::~ShmTexture()
+{
+    std::vector<GLuint> ids;
+    for (auto const& texture : textures)
+    {
+        ids.push_back(texture.second.id);
+    }
+
+    if (!ids.empty())
+    {
+        // The textures are all in the share group of the delegate's context
+        egl_delegate->spawn(
+            [ids = std::move(ids)]()
+            {
+                glDeleteTextures(ids.size(), ids.data());
+            });
+    }
+}
+
+auto mgc::ShmTexture::submit(geom::Rectangles const& damage) -> uint64_t
+{
+    std::lock_guard<std::mutex> lock{mutex};
+    history.push_back({++latest, damage});
+    if (history.size() > max_history)
+    {
+        history.pop_front();
+    }
+    return latest;
+}
+
+bool mgc::ShmTexture::bind(
+    uint64_t seq,
+    geom::Size const& size,
+    MirPixelFormat format,
+    geom::Stride const& stride,
+    ReadPixels const& read)
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const context = eglGetCurrentContext();
+    if (textures.find(context) == textures.end())
+    {
+        forget_destroyed_contexts();
+    }
+    auto& texture = textures[context];
+
+    if (seq < texture.content)
+    {
+        return false;
+    }
+
+    if (texture.id == 0)
+    {
+        glGenTextures(1, &texture.id);
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+    }
+
+    if (seq == texture.content)
+    {
+        return true;
+    }
+
+    GLenum gl_format, gl_type;
+    if (!mg::get_gl_pixel_format(format, gl_format, gl_type))
+    {
+        mir::log_error(
+            "SHM buffer has non-GL-compatible pixel format %i; rendering will be incomplete",
+            format);
+        texture.content = seq;
+        return true;
+    }
+
+    bool const reallocate = texture.content == 0 || size != texture.size || format != texture.format;
+    geom::Rectangle const whole_buffer{{0, 0}, size};
+
+    read(
+        [&](unsigned char const* pixels)
+        {
+            auto const bytes_per_pixel = MIR_BYTES_PER_PIXEL(format);
+
+            // We assume that stride is a multiple of whole pixels; see ShmBuffer::upload_to_texture()
+            glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, stride.as_int() / bytes_per_pixel);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            if (reallocate)
+            {
+                glTexImage2D(
+                    GL_TEXTURE_2D,
+                    0,
+                    gl_format,
+                    size.width.as_int(), size.height.as_int(),
+                    0,
+                    gl_format,
+                    gl_type,
+                    pixels);
+            }
+            else
+            {
+                for (auto const& rect : damage_between(texture.content, seq, whole_buffer))
+                {
+                    // With the row length set, offsetting the source pointer is all it
+                    // takes to upload a sub-rectangle straight from the client's memory
+                    glTexSubImage2D(
+                        GL_TEXTURE_2D,
+                        0,
+                        rect.left().as_int(), rect.top().as_int(),
+                        rect.size.width.as_int(), rect.size.height.as_int(),
+                        gl_format,
+                        gl_type,
+                        pixels +
+                            rect.top().as_int() * stride.as_int() +
+                            rect.left().as_int() * bytes_per_pixel);
+                }
+            }
+
+            // Be nice to other users of the GL context by reverting our changes to shared state
+            glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            texture.size = size;
+            texture.format = format;
+            texture.content = seq;
+        });
+
+    return true;
+}
+
+void mgc::ShmTexture::forget_destroyed_contexts()
+{
+    auto const display = eglGetCurrentDisplay();
+
+    std::vector<GLuint> ids;
+    for (auto i = textures.begin(); i != textures.end();)
+    {
+        EGLint config_id;
+        if (eglQueryContext(display, i->first, EGL_CONFIG_ID, &config_id) == EGL_FALSE)
+        {
+            ids.push_back(i->second.id);
+            i = textures.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    if (!ids.empty())
+    {
+        // The current context shares them, so they can go straight away
+        glDeleteTextures(ids.size(), ids.data());
+    }
+}
+
+auto mgc::ShmTexture::damage_between(uint64_t from, uint64_t to, geom::Rectangle const& whole_buffer) const
+    -> geom::Rectangles
+{
+    if (history.empty() || history.front().first > from + 1)
+    {
+        return geom::Rectangles{whole_buffer};
+    }
+
+    geom::Rectangles damage;
+    for (auto const& entry : history)
+    {
+        if (entry.first > from && entry.first <= to)
+        {
+            for (auto const& rect : entry.second)
+            {
+                auto const clipped = rect.intersection_with(whole_buffer);
+                if (clipped.size.width > geom::Width{} && clipped.size.height > geom::Height{})
+                {
+                    damage.add(clipped);
+                }
+            }
+        }
+    }
+
+    if (damage.size() > max_upload_rects)
+    {
+        return geom::Rectangles{damage.bounding_rectangle()};
+    }
+
+    return damage;
+}
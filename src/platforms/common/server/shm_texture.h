@@ -0,0 +1,116 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_COMMON_SHM_TEXTURE_H_
+#define MIR_GRAPHICS_COMMON_SHM_TEXTURE_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+#include "mir/geometry/rectangles.h"
+#include "mir_toolkit/common.h"
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace graphics
+{
+namespace common
+{
+class EGLContextExecutor;
+
+/**
+ * GL textures shared by the successive wl_shm buffers of a stream
+ *
+ * Each buffer submitted to the stream gets a sequence number, and we remember how
+ * it differs from its predecessor. Binding a buffer newer than the one a texture
+ * holds then only needs to upload what was damaged in between, and the texture is
+ * only reallocated when the size or format changes.
+ *
+ * Each GL context binding the stream's buffers (each compositor) gets a texture of
+ * its own. Contexts in a share group see a texture's storage, but nothing orders
+ * one context's glTexSubImage2D() against another's draws from the texture. The
+ * textures of contexts that have since been destroyed are deleted when a new
+ * context first binds, which is when compositors get replaced.
+ */
+class ShmTexture
+{
+public:
+    using ReadPixels = std::function<void(std::function<void(unsigned char const*)> const&)>;
+
+    explicit ShmTexture(std::shared_ptr<EGLContextExecutor> egl_delegate);
+    ~ShmTexture();
+
+    ShmTexture(ShmTexture const&) = delete;
+    ShmTexture& operator=(ShmTexture const&) = delete;
+
+    /// Records the next buffer of the stream, which differs from its predecessor by damage
+    auto submit(geometry::Rectangles const& damage) -> uint64_t;
+
+    /**
+     * Binds the current context's texture, first bringing it up to date with buffer \p seq
+     *
+     * \note This must be called with a current GL context
+     * \return false if the texture already holds a newer buffer than seq
+     */
+    bool bind(
+        uint64_t seq,
+        geometry::Size const& size,
+        MirPixelFormat format,
+        geometry::Stride const& stride,
+        ReadPixels const& read);
+
+private:
+    /// Enough to bridge the buffers dropped between two frames of even a slow output
+    static size_t const max_history{16};
+    /// Beyond this many rectangles, the per-call overhead outweighs uploading a little extra
+    static size_t const max_upload_rects{16};
+
+    struct Texture
+    {
+        GLuint id{0};
+        geometry::Size size;
+        MirPixelFormat format{mir_pixel_format_invalid};
+        uint64_t content{0};    ///< The buffer whose pixels are in the texture; 0 for none
+    };
+
+    /// Deletes the textures of contexts that no longer exist
+    void forget_destroyed_contexts();
+
+    /// The damage of buffers after from up to and including to, clipped to whole_buffer
+    auto damage_between(uint64_t from, uint64_t to, geometry::Rectangle const& whole_buffer) const
+        -> geometry::Rectangles;
+
+    std::shared_ptr<EGLContextExecutor> const egl_delegate;
+
+    std::mutex mutex;
+    std::map<EGLContext, Texture> textures;
+    uint64_t latest{0};
+    std::deque<std::pair<uint64_t, geometry::Rectangles>> history;
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_COMMON_SHM_TEXTURE_H_ */
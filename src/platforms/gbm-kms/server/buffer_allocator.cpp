@@ -237,12 +237,14 @@ mgg::BufferAllocator::BufferAllocator(
     mg::Display const& output,
     gbm_device* device,
     BypassOption bypass_option,
-    mgg::BufferImportMethod const buffer_import_method)
+    mgg::BufferImportMethod const buffer_import_method,
+    std::shared_ptr<DisplayReport> const& report)
     : ctx{context_for_output(output)},
       egl_delegate{
           std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
       device(device),
       egl_extensions(std::make_shared<mg::EGLExtensions>()),
+      report{report},
       bypass_option(buffer_import_method == mgg::BufferImportMethod::dma_buf ?
                         mgg::BypassOption::prohibited :
                         bypass_option),
@@ -320,6 +322,7 @@ void mgg::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    report,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -368,10 +371,7 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::buffer_from_resource(
     std::function<void()>&& on_consumed,
     std::function<void()>&& on_release)
 {
-    auto context_guard = mir::raii::paired_calls(
-        [this]() { ctx->make_current(); },
-        [this]() { ctx->release_current(); });
-
+    // Importing a dmabuf doesn't need a current context, so don't pay for switching to one
     if (auto dmabuf = dmabuf_extension->buffer_from_resource(
         buffer,
         ctx,
@@ -381,6 +381,11 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::buffer_from_resource(
     {
         return dmabuf;
     }
+
+    auto context_guard = mir::raii::paired_calls(
+        [this]() { ctx->make_current(); },
+        [this]() { ctx->release_current(); });
+
     return mg::wayland::buffer_from_resource(
         buffer,
         std::move(on_consumed),
@@ -393,11 +398,15 @@ std::shared_ptr<mg::Buffer> mgg::BufferAllocator::buffer_from_resource(
 auto mgg::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    geom::Rectangles const& damage) -> std::shared_ptr<Buffer>
 {
     return mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        std::move(on_consumed),
+        previous,
+        damage);
 }
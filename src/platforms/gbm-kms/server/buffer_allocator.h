@@ -47,6 +47,7 @@ class Context;
 namespace graphics
 {
 class Display;
+class DisplayReport;
 struct EGLExtensions;
 
 namespace common
@@ -71,7 +72,8 @@ public:
         Display const& output,
         gbm_device* device,
         BypassOption bypass_option,
-        BufferImportMethod const buffer_import_method);
+        BufferImportMethod const buffer_import_method,
+        std::shared_ptr<DisplayReport> const& report);
 
     std::shared_ptr<Buffer> alloc_software_buffer(geometry::Size size, MirPixelFormat) override;
     std::vector<MirPixelFormat> supported_pixel_formats() override;
@@ -85,7 +87,9 @@ public:
     auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        geometry::Rectangles const& damage) -> std::shared_ptr<Buffer> override;
 private:
     std::shared_ptr<Buffer> alloc_hardware_buffer(
         graphics::BufferProperties const& buffer_properties);
@@ -96,6 +100,7 @@ private:
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
     gbm_device* const device;
     std::shared_ptr<EGLExtensions> const egl_extensions;
+    std::shared_ptr<DisplayReport> const report;
     bool egl_display_bound{false};
 
     BypassOption const bypass_option;
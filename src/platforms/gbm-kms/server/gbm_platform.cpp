@@ -49,12 +49,14 @@ mir::Fd drm_fd_from_authentication(mg::PlatformAuthentication& authenticator)
 mgg::GBMPlatform::GBMPlatform(
     BypassOption bypass_option,
     BufferImportMethod import_method,
-    std::shared_ptr<mg::PlatformAuthentication> const& platform_authentication) :
+    std::shared_ptr<mg::PlatformAuthentication> const& platform_authentication,
+    std::shared_ptr<mg::DisplayReport> const& report) :
     bypass_option(bypass_option),
     import_method(import_method),
     platform_authentication(platform_authentication),
     gbm{std::make_shared<mgg::helpers::GBMHelper>(drm_fd_from_authentication(*platform_authentication))},
-    auth{std::make_shared<mgg::NestedAuthentication>(platform_authentication)}
+    auth{std::make_shared<mgg::NestedAuthentication>(platform_authentication)},
+    report{report}
 {
     auto gbm_extension = platform_authentication->set_gbm_extension();
     if (gbm_extension.is_set())
@@ -65,20 +67,22 @@ mgg::GBMPlatform::GBMPlatform(
     BypassOption bypass_option,
     BufferImportMethod import_method,
     std::shared_ptr<mir::udev::Context> const& udev,
-    std::shared_ptr<mgg::helpers::DRMHelper> const& drm) :
+    std::shared_ptr<mgg::helpers::DRMHelper> const& drm,
+    std::shared_ptr<mg::DisplayReport> const& report) :
     bypass_option(bypass_option),
     import_method(import_method),
     udev(udev),
     drm(drm),
     gbm{std::make_shared<mgg::helpers::GBMHelper>(drm->fd)},
-    auth{drm}
+    auth{drm},
+    report{report}
 {
 }
 
 mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgg::GBMPlatform::create_buffer_allocator(
     Display const& output)
 {
-    return make_module_ptr<mgg::BufferAllocator>(output, gbm->device, bypass_option, import_method);
+    return make_module_ptr<mgg::BufferAllocator>(output, gbm->device, bypass_option, import_method, report);
 }
 
 MirServerEGLNativeDisplayType mgg::GBMPlatform::egl_native_display() const
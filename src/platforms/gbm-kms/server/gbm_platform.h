@@ -38,12 +38,14 @@ public:
     GBMPlatform(
         BypassOption option,
         BufferImportMethod import_method,
-        std::shared_ptr<PlatformAuthentication> const& platform_authentication);
+        std::shared_ptr<PlatformAuthentication> const& platform_authentication,
+        std::shared_ptr<DisplayReport> const& report);
     GBMPlatform(
         BypassOption bypass_option,
         BufferImportMethod import_method,
         std::shared_ptr<mir::udev::Context> const& udev,
-        std::shared_ptr<helpers::DRMHelper> const& drm);
+        std::shared_ptr<helpers::DRMHelper> const& drm,
+        std::shared_ptr<DisplayReport> const& report);
 
     UniqueModulePtr<GraphicBufferAllocator>
         create_buffer_allocator(Display const& output) override;
@@ -56,6 +58,7 @@ private:
     std::shared_ptr<graphics::gbm::helpers::DRMHelper> drm;
     std::shared_ptr<helpers::GBMHelper> const gbm;
     std::shared_ptr<DRMAuthentication> const auth;
+    std::shared_ptr<DisplayReport> const report;
 };
 }
 }
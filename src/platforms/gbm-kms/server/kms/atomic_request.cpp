@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "atomic_request.h"
+
+#include <boost/throw_exception.hpp>
+#include <stdexcept>
+#include <system_error>
+
+namespace mgg = mir::graphics::gbm;
+
+mgg::AtomicRequest::AtomicRequest()
+    : request{drmModeAtomicAlloc(), &drmModeAtomicFree}
+{
+    if (!request)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to allocate atomic KMS request"));
+}
+
+void mgg::AtomicRequest::add_property(uint32_t object_id, uint32_t property_id, uint64_t value)
+{
+    auto const result = drmModeAtomicAddProperty(request.get(), object_id, property_id, value);
+    if (result < 0)
+    {
+        BOOST_THROW_EXCEPTION((
+            std::system_error{-result, std::system_category(), "Failed to add property to atomic KMS request"}));
+    }
+}
+
+void mgg::AtomicRequest::add_flip(uint32_t crtc_id, uint32_t connector_id)
+{
+    flips_.push_back({crtc_id, connector_id});
+}
+
+auto mgg::AtomicRequest::flips() const -> std::vector<Flip> const&
+{
+    return flips_;
+}
+
+void mgg::AtomicRequest::on_commit(std::function<void()> const& action)
+{
+    commit_actions.push_back(action);
+}
+
+void mgg::AtomicRequest::committed()
+{
+    for (auto const& action : commit_actions)
+        action();
+
+    commit_actions.clear();
+}
+
+auto mgg::AtomicRequest::get() const -> drmModeAtomicReq*
+{
+    return request.get();
+}
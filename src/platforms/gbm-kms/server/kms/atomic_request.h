@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_GBM_ATOMIC_REQUEST_H_
+#define MIR_GRAPHICS_GBM_ATOMIC_REQUEST_H_
+
+#include <xf86drmMode.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace gbm
+{
+
+/**
+ * An atomic KMS commit under construction, possibly spanning several CRTCs.
+ */
+class AtomicRequest
+{
+public:
+    /// A CRTC the request changes, and the connector it drives
+    struct Flip
+    {
+        uint32_t crtc_id;
+        uint32_t connector_id;
+    };
+
+    AtomicRequest();
+
+    void add_property(uint32_t object_id, uint32_t property_id, uint64_t value);
+
+    /// Notes that committing the request flips crtc_id to a new frame
+    void add_flip(uint32_t crtc_id, uint32_t connector_id);
+    auto flips() const -> std::vector<Flip> const&;
+
+    /**
+     * Add something to do once the request has been committed. Nothing
+     * happens if the commit is never made or fails.
+     */
+    void on_commit(std::function<void()> const& action);
+    void committed();
+
+    auto get() const -> drmModeAtomicReq*;
+
+private:
+    std::unique_ptr<drmModeAtomicReq, void(*)(drmModeAtomicReqPtr)> const request;
+    std::vector<Flip> flips_;
+    std::vector<std::function<void()>> commit_actions;
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_GBM_ATOMIC_REQUEST_H_ */
@@ -30,6 +30,11 @@ mgg::BypassMatch::BypassMatch(geometry::Rectangle const& rect)
 {
 }
 
+bool mgg::BypassMatch::covers_view_area(graphics::Renderable const& renderable) const
+{
+    return difference_of(geometry::Rectangles{view_area}, renderable.opaque_region()).size() == 0;
+}
+
 bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& renderable)
 {
     //we've already eliminated bypass as a possibility
@@ -40,8 +45,8 @@ bool mgg::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     if (!view_area.overlaps(renderable->screen_position()))
         return false;
 
-    auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
     auto const fits = (renderable->screen_position() == view_area);
+    auto const is_opaque = renderable->alpha() == 1.0f && (!renderable->shaped() || covers_view_area(*renderable));
     auto const is_orthogonal = (renderable->transformation() == identity);
     bypass_is_feasible = (is_opaque && fits && is_orthogonal);
     return bypass_is_feasible;
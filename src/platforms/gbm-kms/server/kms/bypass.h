@@ -34,6 +34,9 @@ public:
     BypassMatch(geometry::Rectangle const& rect);
     bool operator()(std::shared_ptr<graphics::Renderable> const&);
 private:
+    /// Whether the client has declared a shaped renderable opaque over all of view_area
+    bool covers_view_area(graphics::Renderable const& renderable) const;
+
     geometry::Rectangle const view_area;
     bool bypass_is_feasible;
     glm::mat4 const identity;
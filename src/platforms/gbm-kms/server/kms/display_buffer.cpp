@@ -18,6 +18,7 @@
 
 #include "display_buffer.h"
 #include "kms_output.h"
+#include "atomic_request.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
 #include "bypass.h"
@@ -30,6 +31,8 @@
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/gl_config.h"
 #include "mir/graphics/dmabuf_buffer.h"
+#include "mir/graphics/presentation.h"
+#include "mir/geometry/rectangles.h"
 
 #include <boost/throw_exception.hpp>
 #include <EGL/egl.h>
@@ -164,6 +167,46 @@ void require_gl_extensions(std::initializer_list<char const*> extensions)
         });
 }
 
+/**
+ * The overlay plane layer that would show renderable in the same place
+ * compositing it would, if there can be one.
+ */
+auto overlay_layer_for(
+    mg::Renderable const& renderable,
+    geom::Rectangle const& view_area,
+    mgg::KMSOutput const& output) -> std::optional<mgg::OverlayLayer>
+{
+    glm::mat4 static const identity(1);
+    auto const position = renderable.screen_position();
+
+    // Planes can't rotate, blend with what is beneath them or crop for us
+    if (renderable.transformation() != identity ||
+        renderable.alpha() != 1.0f ||
+        (renderable.shaped() &&
+         difference_of(geom::Rectangles{position}, renderable.opaque_region()).size() != 0) ||
+        renderable.clip_area() ||
+        !view_area.contains(position))
+    {
+        return {};
+    }
+
+    auto const buffer = renderable.buffer();
+    auto const dmabuf = dynamic_cast<mg::DMABufBuffer*>(buffer->native_buffer_base());
+    if (!dmabuf)
+        return {};
+
+    auto fb = output.fb_for(*dmabuf);
+    if (!fb)
+        return {};
+
+    return mgg::OverlayLayer{
+        std::move(fb),
+        dmabuf->drm_fourcc(),
+        dmabuf->modifier(),
+        buffer->size(),
+        {as_point(position.top_left - view_area.top_left), position.size}};
+}
+
 bool needs_bounce_buffer(mgg::KMSOutput const& destination, gbm_bo* source)
 {
     return destination.buffer_requires_migration(source);
@@ -526,6 +569,9 @@ void mgg::DisplayBuffer::set_transformation(glm::mat2 const& t, geometry::Rectan
 
 bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
 {
+    overlay_layers.clear();
+    overlay_bufs.clear();
+
     glm::mat2 static const no_transformation(1);
     if (transform == no_transformation &&
        (bypass_option == mgg::BypassOption::allowed))
@@ -554,6 +600,64 @@ bool mgg::DisplayBuffer::overlay(RenderableList const& renderable_list)
     return false;
 }
 
+mg::RenderableList mgg::DisplayBuffer::assign_planes(RenderableList const& renderable_list)
+{
+    overlay_layers.clear();
+    overlay_bufs.clear();
+
+    glm::mat2 static const no_transformation(1);
+    if (transform != no_transformation ||
+        bypass_option != mgg::BypassOption::allowed ||
+        outputs.size() != 1)
+    {
+        return renderable_list;
+    }
+
+    auto& output = *outputs.front();
+    RenderableList composited;
+    std::vector<geom::Rectangle> composited_above;
+
+    /*
+     * Overlay planes are stacked above the composited primary plane, so
+     * work down from the top: nothing overlapping a composited renderable
+     * can go beneath it on a plane. Each candidate is checked by the driver
+     * together with those already accepted, and anything it can't take is
+     * left for GL to composite.
+     */
+    for (auto r = renderable_list.rbegin(); r != renderable_list.rend(); ++r)
+    {
+        auto const& renderable = *r;
+        auto const position = renderable->screen_position();
+
+        auto const beneath_composited = std::any_of(
+            composited_above.begin(),
+            composited_above.end(),
+            [&position](auto const& above) { return above.overlaps(position); });
+
+        if (!beneath_composited)
+        {
+            if (auto layer = overlay_layer_for(*renderable, area, output))
+            {
+                auto candidate = overlay_layers;
+                candidate.insert(candidate.begin(), std::move(*layer));
+
+                if (output.can_show_overlays(candidate))
+                {
+                    overlay_layers = std::move(candidate);
+                    overlay_bufs.push_back(renderable->buffer());
+                    continue;
+                }
+            }
+        }
+
+        composited_above.push_back(position);
+        composited.push_back(renderable);
+    }
+
+    std::reverse(composited.begin(), composited.end());
+    return composited;
+}
+
 void mgg::DisplayBuffer::for_each_display_buffer(
     std::function<void(graphics::DisplayBuffer&)> const& f)
 {
@@ -609,6 +713,20 @@ void mgg::DisplayBuffer::post()
     }
 
     scheduled_fb = std::move(bufobj);
+
+    /*
+     * Overlay planes change with the page flip; they are switched off with
+     * the first frame that doesn't use them (including bypass frames).
+     */
+    if (!overlay_layers.empty() || overlays_shown)
+    {
+        outputs.front()->set_overlays(overlay_layers);
+        overlays_shown = !overlay_layers.empty();
+    }
+    scheduled_overlay_bufs = std::move(overlay_bufs);
+    overlay_bufs.clear();
+    overlay_layers.clear();
+
     /*
      * Try to schedule a page flip as first preference to avoid tearing.
      * [will complete in a background thread]
@@ -691,12 +809,30 @@ std::chrono::milliseconds mgg::DisplayBuffer::recommended_sleep() const
     return recommend_sleep;
 }
 
+mg::Frame mgg::DisplayBuffer::last_frame() const
+{
+    // Clones flip together, so the first output speaks for the group
+    return outputs.front()->last_frame();
+}
+
+uint32_t mgg::DisplayBuffer::presentation_flags() const
+{
+    // Page flip events are timestamped by the kernel at the vblank they happen in
+    return mg::Presentation::vsync | mg::Presentation::hw_clock | mg::Presentation::hw_completion;
+}
+
 bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
 {
     /*
      * Schedule the current front buffer object for display. Note that
      * the page flip is asynchronous and synchronized with vertical refresh.
      */
+    if (outputs.size() > 1 && schedule_atomic_page_flip(bufobj))
+    {
+        page_flips_pending = true;
+        return true;
+    }
+
     for (auto& output : outputs)
     {
         if (output->schedule_page_flip(bufobj))
@@ -706,6 +842,24 @@ bool mgg::DisplayBuffer::schedule_page_flip(FBHandle const& bufobj)
     return page_flips_pending;
 }
 
+bool mgg::DisplayBuffer::schedule_atomic_page_flip(FBHandle const& bufobj)
+{
+    /*
+     * Clones on one device can all flip in a single atomic commit, so they
+     * show each frame from the same vblank rather than one after the other.
+     */
+    auto const drm_fd = outputs.front()->drm_fd();
+    AtomicRequest request;
+
+    for (auto& output : outputs)
+    {
+        if (output->drm_fd() != drm_fd || !output->add_page_flip(request, bufobj))
+            return false;
+    }
+
+    return outputs.front()->schedule_atomic_flip(request);
+}
+
 void mgg::DisplayBuffer::wait_for_page_flip()
 {
     if (page_flips_pending)
@@ -730,6 +884,9 @@ void mgg::DisplayBuffer::wait_for_page_flip()
 
         visible_composite_frame = std::move(scheduled_composite_frame);
         scheduled_composite_frame = nullptr;
+
+        visible_overlay_bufs = std::move(scheduled_overlay_bufs);
+        scheduled_overlay_bufs.clear();
     }
 }
 
@@ -24,6 +24,7 @@
 #include "mir/renderer/gl/render_target.h"
 #include "display_helpers.h"
 #include "egl_helper.h"
+#include "kms_output.h"
 #include "platform_common.h"
 
 #include <vector>
@@ -112,12 +113,15 @@ public:
     void release_current() override;
     void swap_buffers() override;
     bool overlay(RenderableList const& renderlist) override;
+    RenderableList assign_planes(RenderableList const& renderlist) override;
     void bind() override;
 
     void for_each_display_buffer(
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
+    uint32_t presentation_flags() const override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
@@ -128,11 +132,17 @@ public:
 
 private:
     bool schedule_page_flip(FBHandle const& bufobj);
+    bool schedule_atomic_page_flip(FBHandle const& bufobj);
     void set_crtc(FBHandle const&);
 
     std::shared_ptr<graphics::Buffer> visible_bypass_frame, scheduled_bypass_frame;
     std::shared_ptr<Buffer> bypass_buf{nullptr};
     std::shared_ptr<FBHandle const> bypass_bufobj{nullptr};
+    /// Client buffers on overlay planes this frame, bottom first
+    std::vector<OverlayLayer> overlay_layers;
+    std::vector<std::shared_ptr<Buffer>> overlay_bufs;
+    std::vector<std::shared_ptr<Buffer>> visible_overlay_bufs, scheduled_overlay_bufs;
+    bool overlays_shown{false};
     std::shared_ptr<DisplayReport> const listener;
     BypassOption bypass_option;
 
@@ -22,6 +22,7 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
+#include "mir/geometry/rectangle.h"
 #include "mir/graphics/display_configuration.h"
 #include "mir/graphics/frame.h"
 #include "mir/graphics/dmabuf_buffer.h"
@@ -31,6 +32,9 @@
 
 #include <gbm.h>
 
+#include <optional>
+#include <vector>
+
 namespace mir
 {
 namespace graphics
@@ -41,6 +45,20 @@ namespace gbm
 {
 
 class FBHandle;
+class AtomicRequest;
+
+/**
+ * A client buffer to be scanned out by a hardware plane above the primary one.
+ */
+struct OverlayLayer
+{
+    std::shared_ptr<FBHandle const> fb;
+    uint32_t format;
+    std::optional<uint64_t> modifier;
+    geometry::Size buffer_size;
+    /// Where the buffer is shown, relative to the top-left of the output
+    geometry::Rectangle destination;
+};
 
 class KMSOutput
 {
@@ -70,6 +88,35 @@ public:
     virtual bool schedule_page_flip(FBHandle const& fb) = 0;
     virtual void wait_for_page_flip() = 0;
 
+    /**
+     * Add the changes schedule_page_flip(fb) would make to request, so that
+     * several outputs on the same device can flip in one atomic commit.
+     *
+     * Returns false, leaving request as it was, if this output is not
+     * driven by atomic commits.
+     */
+    virtual bool add_page_flip(AtomicRequest& request, FBHandle const& fb) = 0;
+    /**
+     * Schedule the flips in request, which may include those of other
+     * outputs on this device, as one nonblocking atomic commit. Each output
+     * then waits for its flip with wait_for_page_flip() as usual.
+     */
+    virtual bool schedule_atomic_flip(AtomicRequest& request) = 0;
+
+    /**
+     * Check whether the hardware can show layers on overlay planes of this
+     * output, stacked bottom-to-top in the order given, above the current
+     * primary framebuffer.
+     *
+     * Nothing changes on screen; the configuration is only tested.
+     */
+    virtual bool can_show_overlays(std::vector<OverlayLayer> const& layers) = 0;
+    /**
+     * Show layers on overlay planes from the next schedule_page_flip() or
+     * set_crtc(). An empty list stops using overlay planes.
+     */
+    virtual void set_overlays(std::vector<OverlayLayer> const& layers) = 0;
+
     virtual bool set_cursor(gbm_bo* buffer) = 0;
     virtual void move_cursor(geometry::Point destination) = 0;
     virtual bool clear_cursor() = 0;
@@ -44,6 +44,17 @@ void page_flip_handler(int /*fd*/, unsigned int seq,
                                               seq, ns);
 }
 
+void page_flip_handler2(int /*fd*/, unsigned int seq,
+                        unsigned int sec, unsigned int usec,
+                        unsigned int crtc_id, void* data)
+{
+    auto page_flip_data = static_cast<mgg::PageFlipEventData*>(data);
+    std::chrono::nanoseconds ns{sec*1000000000LL + usec*1000LL};
+    // Kernels without DRM_CAP_CRTC_IN_VBLANK_EVENT report a crtc_id of 0
+    page_flip_data->flipper->notify_page_flip(crtc_id ? crtc_id : page_flip_data->crtc_id,
+                                              seq, ns);
+}
+
 }
 
 mgg::KMSPageFlipper::KMSPageFlipper(
@@ -52,6 +63,7 @@ mgg::KMSPageFlipper::KMSPageFlipper(
     drm_fd{drm_fd},
     report{report},
     pending_page_flips(),
+    shared_event_data{0, 0, this},
     worker_tid()
 {
     uint64_t mono = 0;
@@ -59,31 +71,83 @@ mgg::KMSPageFlipper::KMSPageFlipper(
         clock_id = CLOCK_REALTIME;
     else
         clock_id = CLOCK_MONOTONIC;
+
+    uint64_t crtc_in_event = 0;
+    crtc_in_vblank_event = !drmGetCap(drm_fd, DRM_CAP_CRTC_IN_VBLANK_EVENT, &crtc_in_event) && crtc_in_event;
 }
 
 bool mgg::KMSPageFlipper::schedule_flip(uint32_t crtc_id,
                                         uint32_t fb_id,
                                         uint32_t connector_id)
 {
-    std::unique_lock<std::mutex> lock{pf_mutex};
-
-    if (pending_page_flips.find(crtc_id) != pending_page_flips.end())
-        BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
-
-    pending_page_flips[crtc_id] = PageFlipEventData{crtc_id, connector_id, this};
-
     /*
      * It appears we can't tell the difference between flipping being
      * unsupported or failing for other reasons. On VirtualBox this always
      * fails with -22 (Invalid argument) despite the arguments being
      * apparently valid.
      */
-    auto ret = drmModePageFlip(drm_fd, crtc_id, fb_id,
-                               DRM_MODE_PAGE_FLIP_EVENT,
-                               &pending_page_flips[crtc_id]);
+    return schedule(
+        {{crtc_id, connector_id}},
+        [this, crtc_id, fb_id](PageFlipEventData* data)
+        {
+            return drmModePageFlip(drm_fd, crtc_id, fb_id, DRM_MODE_PAGE_FLIP_EVENT, data);
+        });
+}
+
+bool mgg::KMSPageFlipper::schedule_atomic_flip(AtomicRequest& request)
+{
+    /*
+     * A commit spanning several CRTCs sends an event for each of them with
+     * the same user data, so we rely on the kernel to say which one it was.
+     */
+    if (request.flips().size() > 1 && !crtc_in_vblank_event)
+        return false;
+
+    if (!schedule(
+        request.flips(),
+        [this, &request](PageFlipEventData* data)
+        {
+            return drmModeAtomicCommit(
+                drm_fd,
+                request.get(),
+                DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK,
+                data);
+        }))
+    {
+        return false;
+    }
+
+    request.committed();
+    return true;
+}
+
+bool mgg::KMSPageFlipper::schedule(
+    std::vector<AtomicRequest::Flip> const& flips,
+    std::function<int(PageFlipEventData*)> const& submit)
+{
+    std::unique_lock<std::mutex> lock{pf_mutex};
+
+    for (auto const& flip : flips)
+    {
+        if (pending_page_flips.find(flip.crtc_id) != pending_page_flips.end())
+            BOOST_THROW_EXCEPTION(std::logic_error("Page flip for crtc_id is already scheduled"));
+    }
+
+    for (auto const& flip : flips)
+        pending_page_flips[flip.crtc_id] = PageFlipEventData{flip.crtc_id, flip.connector_id, this};
+
+    /*
+     * A single flip's event data can go away with its pending entry, but
+     * events for a group of CRTCs share data that has to outlive them all.
+     */
+    auto const data = flips.size() == 1 ? &pending_page_flips[flips.front().crtc_id] : &shared_event_data;
+    auto ret = submit(data);
 
     if (ret)
-        pending_page_flips.erase(crtc_id);
+    {
+        for (auto const& flip : flips)
+            pending_page_flips.erase(flip.crtc_id);
+    }
 
     return (ret == 0);
 }
@@ -92,8 +156,9 @@ mg::Frame mgg::KMSPageFlipper::wait_for_flip(uint32_t crtc_id)
 {
     drmEventContext evctx;
     memset(&evctx, 0, sizeof evctx);
-    evctx.version = 2;  // We only support the old v2 page_flip_handler
+    evctx.version = 3;
     evctx.page_flip_handler = &page_flip_handler;
+    evctx.page_flip_handler2 = &page_flip_handler2;
 
     static std::thread::id const invalid_tid;
 
@@ -20,8 +20,11 @@
 #define MIR_GRAPHICS_GBM_KMS_PAGE_FLIPPER_H_
 
 #include "page_flipper.h"
+#include "atomic_request.h"
 
 #include <unordered_map>
+#include <vector>
+#include <functional>
 #include <chrono>
 #include <mutex>
 #include <condition_variable>
@@ -53,22 +56,28 @@ public:
     KMSPageFlipper(int drm_fd, std::shared_ptr<DisplayReport> const& report);
 
     bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) override;
+    bool schedule_atomic_flip(AtomicRequest& request) override;
     Frame wait_for_flip(uint32_t crtc_id) override;
 
     std::thread::id debug_get_worker_tid();
 
     void notify_page_flip(uint32_t crtc_id, int64_t msc, std::chrono::nanoseconds ust);
 private:
+    bool schedule(
+        std::vector<AtomicRequest::Flip> const& flips,
+        std::function<int(PageFlipEventData*)> const& submit);
     bool page_flip_is_done(uint32_t crtc_id);
 
     int const drm_fd;
     std::shared_ptr<DisplayReport> const report;
     std::unordered_map<uint32_t,PageFlipEventData> pending_page_flips;
     std::unordered_map<uint32_t,Frame> completed_page_flips;
+    PageFlipEventData shared_event_data;
     std::mutex pf_mutex;
     std::condition_variable pf_cv;
     std::thread::id worker_tid;
     clockid_t clock_id;
+    bool crtc_in_vblank_event;
 };
 
 }
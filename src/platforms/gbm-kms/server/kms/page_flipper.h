@@ -28,6 +28,7 @@ namespace graphics
 {
 namespace gbm
 {
+class AtomicRequest;
 
 class PageFlipper
 {
@@ -35,6 +36,14 @@ public:
     virtual ~PageFlipper() {}
 
     virtual bool schedule_flip(uint32_t crtc_id, uint32_t fb_id, uint32_t connector_id) = 0;
+    /**
+     * Schedule a nonblocking atomic commit of request as the flips of all its
+     * CRTCs, to be waited for with wait_for_flip() like any other flip.
+     *
+     * Returns false, scheduling nothing, if the commit fails or the driver
+     * can't tell the CRTCs' flip events apart.
+     */
+    virtual bool schedule_atomic_flip(AtomicRequest& request) = 0;
     virtual Frame wait_for_flip(uint32_t crtc_id) = 0;
 
 protected:
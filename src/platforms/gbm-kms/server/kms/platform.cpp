@@ -68,7 +68,7 @@ mgg::Platform::Platform(std::shared_ptr<DisplayReport> const& listener,
 mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgg::Platform::create_buffer_allocator(
     mg::Display const& output)
 {
-    return make_module_ptr<mgg::BufferAllocator>(output, gbm->device, bypass_option_, mgg::BufferImportMethod::gbm_native_pixmap);
+    return make_module_ptr<mgg::BufferAllocator>(output, gbm->device, bypass_option_, mgg::BufferImportMethod::gbm_native_pixmap, listener);
 }
 
 mir::UniqueModulePtr<mg::Display> mgg::Platform::create_display(
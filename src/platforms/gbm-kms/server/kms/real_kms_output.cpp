@@ -19,6 +19,7 @@
 #include "real_kms_output.h"
 #include "mir/graphics/display_configuration.h"
 #include "page_flipper.h"
+#include "atomic_request.h"
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
@@ -27,7 +28,9 @@
 
 #include <boost/throw_exception.hpp>
 #include <system_error>
+#include <algorithm>
 #include <xf86drm.h>
+#include <drm_fourcc.h>
 
 namespace mg = mir::graphics;
 namespace mgg = mg::gbm;
@@ -58,6 +61,88 @@ private:
     uint32_t const fb_id;
 };
 
+namespace
+{
+char const* const required_plane_properties[] = {
+    "FB_ID", "CRTC_ID",
+    "SRC_X", "SRC_Y", "SRC_W", "SRC_H",
+    "CRTC_X", "CRTC_Y", "CRTC_W", "CRTC_H"};
+
+auto format_modifiers_of(int drm_fd, mgk::ObjectProperties const& properties)
+    -> std::vector<std::pair<uint32_t, uint64_t>>
+{
+    std::vector<std::pair<uint32_t, uint64_t>> format_modifiers;
+
+    if (!properties.has_property("IN_FORMATS") || properties["IN_FORMATS"] == 0)
+        return format_modifiers;
+
+    std::unique_ptr<drmModePropertyBlobRes, void(*)(drmModePropertyBlobPtr)> const blob{
+        drmModeGetPropertyBlob(drm_fd, properties["IN_FORMATS"]),
+        &drmModeFreePropertyBlob};
+
+    if (!blob)
+        return format_modifiers;
+
+    auto const data = static_cast<char const*>(blob->data);
+    auto const header = reinterpret_cast<drm_format_modifier_blob const*>(data);
+    auto const formats = reinterpret_cast<uint32_t const*>(data + header->formats_offset);
+    auto const modifiers = reinterpret_cast<drm_format_modifier const*>(data + header->modifiers_offset);
+
+    // Each modifier has a bitmask of the (up to 64) formats from offset onwards it applies to
+    for (auto i = 0u; i != header->count_modifiers; ++i)
+    {
+        for (auto bit = 0u; bit != 64; ++bit)
+        {
+            auto const format_index = modifiers[i].offset + bit;
+            if ((modifiers[i].formats & (1ull << bit)) && format_index < header->count_formats)
+                format_modifiers.emplace_back(formats[format_index], modifiers[i].modifier);
+        }
+    }
+
+    return format_modifiers;
+}
+}
+
+struct mgg::RealKMSOutput::Plane
+{
+    Plane(int drm_fd, kms::DRMModePlaneUPtr const& plane)
+        : id{plane->plane_id},
+          properties{drm_fd, plane},
+          formats{plane->formats, plane->formats + plane->count_formats},
+          format_modifiers{format_modifiers_of(drm_fd, properties)}
+    {
+    }
+
+    auto zpos() const -> uint64_t
+    {
+        return properties.has_property("zpos") ? properties["zpos"] : 0;
+    }
+
+    bool supports(uint32_t format, std::optional<uint64_t> modifier) const
+    {
+        if (std::find(formats.begin(), formats.end(), format) == formats.end())
+            return false;
+
+        if (!modifier || *modifier == DRM_FORMAT_MOD_INVALID)
+            return true;
+
+        // Drivers without IN_FORMATS can only be relied on to scan out linear buffers
+        if (format_modifiers.empty())
+            return *modifier == DRM_FORMAT_MOD_LINEAR;
+
+        return std::find(
+            format_modifiers.begin(),
+            format_modifiers.end(),
+            std::make_pair(format, *modifier)) != format_modifiers.end();
+    }
+
+    uint32_t const id;
+    kms::ObjectProperties const properties;
+    std::vector<uint32_t> const formats;
+    /// The format and modifier pairs listed in IN_FORMATS, if the driver has it
+    std::vector<std::pair<uint32_t, uint64_t>> const format_modifiers;
+};
+
 
 mgg::RealKMSOutput::RealKMSOutput(
     int drm_fd,
@@ -89,6 +174,7 @@ mgg::RealKMSOutput::RealKMSOutput(
 
 mgg::RealKMSOutput::~RealKMSOutput()
 {
+    disable_overlays();
     restore_saved_crtc();
 }
 
@@ -160,6 +246,12 @@ bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
         return false;
     }
 
+    if (ensure_atomic() && set_crtc_atomic(fb))
+    {
+        using_saved_crtc = false;
+        return true;
+    }
+
     auto ret = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                               fb.get_drm_fb_id(), fb_offset.dx.as_int(), fb_offset.dy.as_int(),
                               &connector->connector_id, 1,
@@ -171,6 +263,11 @@ bool mgg::RealKMSOutput::set_crtc(FBHandle const& fb)
     }
 
     using_saved_crtc = false;
+
+    // SetCrtc only touches the primary plane; bring the overlays up to date too
+    if (!overlays.empty() || !overlay_planes_in_use.empty())
+        commit_overlays();
+
     return true;
 }
 
@@ -191,6 +288,9 @@ void mgg::RealKMSOutput::clear_crtc()
         return;
     }
 
+    // The kernel refuses to disable a CRTC that still has planes attached
+    disable_overlays();
+
     auto result = drmModeSetCrtc(drm_fd_, current_crtc->crtc_id,
                                  0, 0, 0, nullptr, 0, nullptr);
     if (result)
@@ -230,10 +330,55 @@ bool mgg::RealKMSOutput::schedule_page_flip(FBHandle const& fb)
                        mgk::connector_name(connector).c_str());
         return false;
     }
-    return page_flipper->schedule_flip(
-        current_crtc->crtc_id,
-        fb.get_drm_fb_id(),
-        connector->connector_id);
+    if (!ensure_atomic())
+    {
+        return page_flipper->schedule_flip(
+            current_crtc->crtc_id,
+            fb.get_drm_fb_id(),
+            connector->connector_id);
+    }
+
+    AtomicRequest request;
+    return add_flip(request, fb) && page_flipper->schedule_atomic_flip(request);
+}
+
+bool mgg::RealKMSOutput::add_page_flip(AtomicRequest& request, FBHandle const& fb)
+{
+    std::unique_lock<std::mutex> lg(power_mutex);
+    if (power_mode != mir_power_mode_on || !current_crtc || !ensure_atomic())
+        return false;
+
+    return add_flip(request, fb);
+}
+
+bool mgg::RealKMSOutput::schedule_atomic_flip(AtomicRequest& request)
+{
+    return page_flipper->schedule_atomic_flip(request);
+}
+
+bool mgg::RealKMSOutput::add_flip(AtomicRequest& request, FBHandle const& fb)
+{
+    /*
+     * Overlay planes have to change in the same vblank as the primary
+     * framebuffer, so they go in the same commit.
+     */
+    auto const planes = planes_for(overlays);
+    if (planes.size() != overlays.size())
+    {
+        mir::log_warning("Output %s can no longer show its overlay planes",
+                         mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    request.add_property(
+        primary_plane->id,
+        primary_plane->properties.id_for("FB_ID"),
+        fb.get_drm_fb_id());
+    add_overlays(request, overlays, planes);
+    request.add_flip(current_crtc->crtc_id, connector->connector_id);
+    request.on_commit([this, planes]() { overlay_planes_in_use = planes; });
+
+    return true;
 }
 
 void mgg::RealKMSOutput::wait_for_page_flip()
@@ -250,6 +395,296 @@ void mgg::RealKMSOutput::wait_for_page_flip()
     last_frame_.store(page_flipper->wait_for_flip(current_crtc->crtc_id));
 }
 
+bool mgg::RealKMSOutput::can_show_overlays(std::vector<OverlayLayer> const& layers)
+{
+    if (!ensure_atomic())
+        return false;
+
+    auto const planes = planes_for(layers);
+    if (planes.size() != layers.size())
+        return false;
+
+    AtomicRequest request;
+    add_overlays(request, layers, planes);
+
+    return drmModeAtomicCommit(drm_fd_, request.get(), DRM_MODE_ATOMIC_TEST_ONLY, nullptr) == 0;
+}
+
+void mgg::RealKMSOutput::set_overlays(std::vector<OverlayLayer> const& layers)
+{
+    overlays = layers;
+}
+
+bool mgg::RealKMSOutput::set_crtc_atomic(FBHandle const& fb)
+{
+    if (mode_index >= static_cast<size_t>(connector->count_modes))
+        return false;
+
+    auto const& mode = connector->modes[mode_index];
+
+    auto const planes = planes_for(overlays);
+    if (planes.size() != overlays.size())
+        overlays.clear();
+
+    uint32_t mode_blob;
+    if (auto const result = drmModeCreatePropertyBlob(drm_fd_, &mode, sizeof mode, &mode_blob))
+    {
+        mir::log_warning("Failed to create mode blob for output %s: %s",
+                         mgk::connector_name(connector).c_str(),
+                         strerror(-result));
+        return false;
+    }
+
+    auto const crtc_id = current_crtc->crtc_id;
+    AtomicRequest request;
+
+    request.add_property(crtc_id, crtc_properties->id_for("MODE_ID"), mode_blob);
+    request.add_property(crtc_id, crtc_properties->id_for("ACTIVE"), 1);
+    request.add_property(connector->connector_id, connector_properties->id_for("CRTC_ID"), crtc_id);
+
+    /* Source viewport. Coordinates are 16.16 fixed point format */
+    auto const& primary = primary_plane->properties;
+    request.add_property(primary_plane->id, primary.id_for("SRC_X"), uint64_t(fb_offset.dx.as_int()) << 16);
+    request.add_property(primary_plane->id, primary.id_for("SRC_Y"), uint64_t(fb_offset.dy.as_int()) << 16);
+    request.add_property(primary_plane->id, primary.id_for("SRC_W"), uint64_t{mode.hdisplay} << 16);
+    request.add_property(primary_plane->id, primary.id_for("SRC_H"), uint64_t{mode.vdisplay} << 16);
+
+    /* Destination viewport. Coordinates are *not* 16.16 */
+    request.add_property(primary_plane->id, primary.id_for("CRTC_X"), 0);
+    request.add_property(primary_plane->id, primary.id_for("CRTC_Y"), 0);
+    request.add_property(primary_plane->id, primary.id_for("CRTC_W"), mode.hdisplay);
+    request.add_property(primary_plane->id, primary.id_for("CRTC_H"), mode.vdisplay);
+
+    request.add_property(primary_plane->id, primary.id_for("FB_ID"), fb.get_drm_fb_id());
+    request.add_property(primary_plane->id, primary.id_for("CRTC_ID"), crtc_id);
+
+    add_overlays(request, overlays, planes);
+
+    auto const result = drmModeAtomicCommit(drm_fd_, request.get(), DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+
+    // The committed state holds its own reference to the blob
+    drmModeDestroyPropertyBlob(drm_fd_, mode_blob);
+
+    if (result)
+    {
+        mir::log_warning("Atomic modeset of output %s failed (%s); falling back to legacy modesetting",
+                         mgk::connector_name(connector).c_str(),
+                         strerror(-result));
+        return false;
+    }
+
+    overlay_planes_in_use = planes;
+    return true;
+}
+
+bool mgg::RealKMSOutput::ensure_atomic()
+{
+    if (!current_crtc)
+        return false;
+
+    if (atomic_crtc_id == current_crtc->crtc_id)
+        return primary_plane != nullptr;
+
+    atomic_crtc_id = current_crtc->crtc_id;
+    crtc_properties = nullptr;
+    connector_properties = nullptr;
+    primary_plane = nullptr;
+    overlay_planes.clear();
+    overlay_planes_in_use.clear();
+
+    // Atomic modesetting also gives us the primary and cursor planes
+    if (drmSetClientCap(drm_fd_, DRM_CLIENT_CAP_ATOMIC, 1) != 0)
+    {
+        mir::log_info("Output %s: driver does not support atomic modesetting; using legacy modesetting",
+                      mgk::connector_name(connector).c_str());
+        return false;
+    }
+
+    try
+    {
+        crtc_properties = std::make_unique<kms::ObjectProperties>(
+            drm_fd_, current_crtc->crtc_id, DRM_MODE_OBJECT_CRTC);
+        connector_properties = std::make_unique<kms::ObjectProperties>(
+            drm_fd_, connector->connector_id, DRM_MODE_OBJECT_CONNECTOR);
+
+        if (!crtc_properties->has_property("MODE_ID") ||
+            !crtc_properties->has_property("ACTIVE") ||
+            !connector_properties->has_property("CRTC_ID"))
+        {
+            return false;
+        }
+
+        kms::DRMModeResources resources{drm_fd_};
+        auto crtcs = resources.crtcs();
+        auto const crtc = std::find_if(
+            crtcs.begin(),
+            crtcs.end(),
+            [crtc_id = current_crtc->crtc_id](kms::DRMModeCrtcUPtr& candidate)
+            {
+                return candidate->crtc_id == crtc_id;
+            });
+        if (crtc == crtcs.end())
+            return false;
+        auto const crtc_mask = 1u << std::distance(crtcs.begin(), crtc);
+
+        kms::PlaneResources plane_resources{drm_fd_};
+        for (auto& plane : plane_resources.planes())
+        {
+            if (!(plane->possible_crtcs & crtc_mask))
+                continue;
+
+            auto candidate = std::make_unique<Plane>(drm_fd_, plane);
+            if (!std::all_of(
+                std::begin(required_plane_properties),
+                std::end(required_plane_properties),
+                [&](char const* name) { return candidate->properties.has_property(name); }))
+            {
+                continue;
+            }
+
+            switch (candidate->properties["type"])
+            {
+            case DRM_PLANE_TYPE_PRIMARY:
+                primary_plane = std::move(candidate);
+                break;
+
+            case DRM_PLANE_TYPE_OVERLAY:
+                overlay_planes.push_back(std::move(candidate));
+                break;
+            }
+        }
+    }
+    catch (std::exception const& error)
+    {
+        mir::log_info("Output %s: failed to enumerate planes (%s); using legacy modesetting",
+                      mgk::connector_name(connector).c_str(),
+                      error.what());
+        primary_plane = nullptr;
+        overlay_planes.clear();
+        return false;
+    }
+
+    if (!primary_plane)
+    {
+        overlay_planes.clear();
+        return false;
+    }
+
+    std::stable_sort(
+        overlay_planes.begin(),
+        overlay_planes.end(),
+        [](auto const& lhs, auto const& rhs) { return lhs->zpos() < rhs->zpos(); });
+
+    // Some hardware has "overlay" planes that can only go beneath the primary plane
+    if (primary_plane->properties.has_property("zpos"))
+    {
+        overlay_planes.erase(
+            std::remove_if(
+                overlay_planes.begin(),
+                overlay_planes.end(),
+                [this](auto const& plane) { return plane->zpos() <= primary_plane->zpos(); }),
+            overlay_planes.end());
+    }
+
+    mir::log_info("Output %s: using atomic modesetting with %zu overlay plane(s)",
+                  mgk::connector_name(connector).c_str(),
+                  overlay_planes.size());
+    return true;
+}
+
+auto mgg::RealKMSOutput::planes_for(std::vector<OverlayLayer> const& layers) const
+    -> std::vector<Plane const*>
+{
+    std::vector<Plane const*> planes;
+
+    // Each layer needs a plane above the one given to the layer below it
+    auto next = overlay_planes.begin();
+    for (auto const& layer : layers)
+    {
+        next = std::find_if(
+            next,
+            overlay_planes.end(),
+            [&layer](auto const& plane) { return plane->supports(layer.format, layer.modifier); });
+
+        if (next == overlay_planes.end())
+            return {};
+
+        planes.push_back(next->get());
+        ++next;
+    }
+
+    return planes;
+}
+
+void mgg::RealKMSOutput::add_overlays(
+    AtomicRequest& request,
+    std::vector<OverlayLayer> const& layers,
+    std::vector<Plane const*> const& planes) const
+{
+    for (auto i = 0u; i != layers.size(); ++i)
+    {
+        auto const& layer = layers[i];
+        auto const plane_id = planes[i]->id;
+        auto const& props = planes[i]->properties;
+        auto const& dest = layer.destination;
+
+        /* Source viewport. Coordinates are 16.16 fixed point format */
+        request.add_property(plane_id, props.id_for("SRC_X"), 0);
+        request.add_property(plane_id, props.id_for("SRC_Y"), 0);
+        request.add_property(
+            plane_id, props.id_for("SRC_W"), uint64_t{layer.buffer_size.width.as_uint32_t()} << 16);
+        request.add_property(
+            plane_id, props.id_for("SRC_H"), uint64_t{layer.buffer_size.height.as_uint32_t()} << 16);
+
+        /* Destination viewport. Coordinates are *not* 16.16 */
+        request.add_property(plane_id, props.id_for("CRTC_X"), dest.top_left.x.as_int());
+        request.add_property(plane_id, props.id_for("CRTC_Y"), dest.top_left.y.as_int());
+        request.add_property(plane_id, props.id_for("CRTC_W"), dest.size.width.as_uint32_t());
+        request.add_property(plane_id, props.id_for("CRTC_H"), dest.size.height.as_uint32_t());
+
+        request.add_property(plane_id, props.id_for("FB_ID"), layer.fb->get_drm_fb_id());
+        request.add_property(plane_id, props.id_for("CRTC_ID"), current_crtc->crtc_id);
+    }
+
+    // ...and switch off any planes we no longer need
+    for (auto const plane : overlay_planes_in_use)
+    {
+        if (std::find(planes.begin(), planes.end(), plane) == planes.end())
+        {
+            request.add_property(plane->id, plane->properties.id_for("FB_ID"), 0);
+            request.add_property(plane->id, plane->properties.id_for("CRTC_ID"), 0);
+        }
+    }
+}
+
+void mgg::RealKMSOutput::commit_overlays()
+{
+    auto const planes = ensure_atomic() ? planes_for(overlays) : std::vector<Plane const*>{};
+    if (planes.size() != overlays.size())
+        overlays.clear();
+
+    AtomicRequest request;
+    add_overlays(request, overlays, planes);
+
+    if (auto const result = drmModeAtomicCommit(drm_fd_, request.get(), 0, nullptr))
+    {
+        mir::log_warning("Failed to update overlay planes of output %s: %s",
+                         mgk::connector_name(connector).c_str(),
+                         strerror(-result));
+        return;
+    }
+
+    overlay_planes_in_use = planes;
+}
+
+void mgg::RealKMSOutput::disable_overlays()
+{
+    overlays.clear();
+
+    if (current_crtc && !overlay_planes_in_use.empty())
+        commit_overlays();
+}
+
 mg::Frame mgg::RealKMSOutput::last_frame() const
 {
     return last_frame_.load();
@@ -56,6 +56,12 @@ public:
     bool schedule_page_flip(FBHandle const& fb) override;
     void wait_for_page_flip() override;
 
+    bool add_page_flip(AtomicRequest& request, FBHandle const& fb) override;
+    bool schedule_atomic_flip(AtomicRequest& request) override;
+
+    bool can_show_overlays(std::vector<OverlayLayer> const& layers) override;
+    void set_overlays(std::vector<OverlayLayer> const& layers) override;
+
     bool set_cursor(gbm_bo* buffer) override;
     void move_cursor(geometry::Point destination) override;
     bool clear_cursor() override;
@@ -79,6 +85,23 @@ private:
     bool ensure_crtc();
     void restore_saved_crtc();
 
+    struct Plane;
+    /**
+     * Finds the planes and properties atomic commits on the current CRTC
+     * need. Returns false if the driver doesn't support atomic modesetting.
+     */
+    bool ensure_atomic();
+    bool set_crtc_atomic(FBHandle const& fb);
+    /// Requires power_mutex to be held
+    bool add_flip(AtomicRequest& request, FBHandle const& fb);
+    auto planes_for(std::vector<OverlayLayer> const& layers) const -> std::vector<Plane const*>;
+    void add_overlays(
+        AtomicRequest& request,
+        std::vector<OverlayLayer> const& layers,
+        std::vector<Plane const*> const& planes) const;
+    void commit_overlays();
+    void disable_overlays();
+
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
 
@@ -105,6 +128,15 @@ private:
     bool using_saved_crtc;
     bool has_cursor_;
 
+    uint32_t atomic_crtc_id{0};
+    std::unique_ptr<kms::ObjectProperties> crtc_properties;
+    std::unique_ptr<kms::ObjectProperties> connector_properties;
+    std::unique_ptr<Plane> primary_plane;
+    /// Usable overlay planes of the current CRTC, bottom first
+    std::vector<std::unique_ptr<Plane>> overlay_planes;
+    std::vector<OverlayLayer> overlays;
+    std::vector<Plane const*> overlay_planes_in_use;
+
     MirPowerMode power_mode;
     int dpms_enum_id;
 
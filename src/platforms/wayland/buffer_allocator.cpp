@@ -72,10 +72,11 @@ std::unique_ptr<mir::renderer::gl::Context> context_for_output(mg::Display const
 }
 }
 
-mgw::BufferAllocator::BufferAllocator(graphics::Display const& output) :
+mgw::BufferAllocator::BufferAllocator(graphics::Display const& output, std::shared_ptr<DisplayReport> const& report) :
     egl_extensions(std::make_shared<mg::EGLExtensions>()),
     ctx{context_for_output(output)},
-    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))}
+    egl_delegate{std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
+    report{report}
 {
 }
 
@@ -127,6 +128,7 @@ void mgw::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    report,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -175,10 +177,7 @@ auto mgw::BufferAllocator::buffer_from_resource(
     std::function<void()>&& on_consumed,
     std::function<void()>&& on_release) -> std::shared_ptr<Buffer>
 {
-    auto context_guard = mir::raii::paired_calls(
-        [this]() { ctx->make_current(); },
-        [this]() { ctx->release_current(); });
-
+    // Importing a dmabuf doesn't need a current context, so don't pay for switching to one
     if (auto dmabuf = dmabuf_extension->buffer_from_resource(
         buffer,
         ctx,
@@ -188,6 +187,11 @@ auto mgw::BufferAllocator::buffer_from_resource(
     {
         return dmabuf;
     }
+
+    auto context_guard = mir::raii::paired_calls(
+        [this]() { ctx->make_current(); },
+        [this]() { ctx->release_current(); });
+
     return mg::wayland::buffer_from_resource(
         buffer,
         std::move(on_consumed),
@@ -200,11 +204,15 @@ auto mgw::BufferAllocator::buffer_from_resource(
 auto mgw::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    geom::Rectangles const& damage) -> std::shared_ptr<Buffer>
 {
     return mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        std::move(on_consumed),
+        previous,
+        damage);
 }
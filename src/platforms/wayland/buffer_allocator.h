@@ -30,6 +30,7 @@ namespace mir
 namespace graphics
 {
 class Display;
+class DisplayReport;
 class LinuxDmaBufUnstable;
 
 namespace common
@@ -42,7 +43,7 @@ namespace wayland
 class BufferAllocator: public GraphicBufferAllocator
 {
 public:
-    BufferAllocator(graphics::Display const& output);
+    BufferAllocator(graphics::Display const& output, std::shared_ptr<DisplayReport> const& report);
 
     std::shared_ptr<Buffer> alloc_software_buffer(geometry::Size size, MirPixelFormat format) override;
 
@@ -57,7 +58,9 @@ public:
     auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        geometry::Rectangles const& damage) -> std::shared_ptr<Buffer> override;
 
     std::vector<MirPixelFormat> supported_pixel_formats() override;
 
@@ -67,6 +70,7 @@ private:
     std::shared_ptr<renderer::gl::Context> const ctx;
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
+    std::shared_ptr<DisplayReport> const report;
     bool egl_display_bound{false};
 };
 }
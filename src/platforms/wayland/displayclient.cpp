@@ -17,6 +17,7 @@
 
 #include "displayclient.h"
 #include "mir/graphics/egl_error.h"
+#include "mir/graphics/atomic_frame.h"
 #include <mir/graphics/pixel_format_utils.h>
 
 #include <wayland-client.h>
@@ -95,10 +96,14 @@ public:
 
     std::function<void(Output const&)> on_done;
 
+    // When the host last asked for a new frame
+    AtomicFrame frame_done;
+
     // DisplaySyncGroup implementation
     void for_each_display_buffer(std::function<void(DisplayBuffer&)> const& /*f*/) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    auto last_frame() const -> Frame override;
 
     // DisplayBuffer implementation
     auto view_area() const -> geometry::Rectangle override;
@@ -323,6 +328,13 @@ auto mgw::DisplayClient::Output::recommended_sleep() const -> std::chrono::milli
     return std::chrono::milliseconds{0};
 }
 
+auto mgw::DisplayClient::Output::last_frame() const -> Frame
+{
+    // The host doesn't tell us when it presented our frame (that would need
+    // wp_presentation on the host), but asks for the next one when it has.
+    return frame_done.load();
+}
+
 auto mgw::DisplayClient::Output::view_area() const -> geometry::Rectangle
 {
     return dcout.extents();
@@ -361,7 +373,8 @@ void mgw::DisplayClient::Output::swap_buffers()
 {
     struct FrameSync
     {
-        explicit FrameSync(wl_surface* surface) :
+        FrameSync(wl_surface* surface, AtomicFrame& frame) :
+            frame{frame},
             callback{wl_surface_frame(surface)}
         {
             static struct wl_callback_listener const frame_listener =
@@ -380,6 +393,8 @@ void mgw::DisplayClient::Output::swap_buffers()
 
         void frame_done(wl_callback*, uint32_t)
         {
+            frame.increment_now();
+
             std::lock_guard<decltype(mutex)> lock{mutex};
             posted = true;
             cv.notify_all();
@@ -395,8 +410,9 @@ void mgw::DisplayClient::Output::swap_buffers()
         bool posted = false;
         std::condition_variable cv;
 
+        AtomicFrame& frame;
         wl_callback* const callback;
-    } frame_sync{surface};
+    } frame_sync{surface, frame_done};
 
     // Avoid throttling compositing by blocking in eglSwapBuffers().
     // Instead we use the frame "done" notification.
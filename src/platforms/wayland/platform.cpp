@@ -55,6 +55,6 @@ EGLNativeDisplayType mgw::Platform::egl_native_display() const
 
 mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgw::Platform::create_buffer_allocator(mg::Display const& output)
 {
-    return mir::make_module_ptr<mgw::BufferAllocator>(output);
+    return mir::make_module_ptr<mgw::BufferAllocator>(output, report);
 }
 
@@ -86,11 +86,12 @@ std::unique_ptr<mir::renderer::gl::Context> context_for_output(mg::Display const
 }
 }
 
-mgx::BufferAllocator::BufferAllocator(mg::Display const& output)
+mgx::BufferAllocator::BufferAllocator(mg::Display const& output, std::shared_ptr<mg::DisplayReport> const& report)
     : ctx{context_for_output(output)},
       egl_delegate{
           std::make_shared<mgc::EGLContextExecutor>(context_for_output(output))},
-      egl_extensions(std::make_shared<mg::EGLExtensions>())
+      egl_extensions(std::make_shared<mg::EGLExtensions>()),
+      report{report}
 {
 }
 
@@ -164,6 +165,7 @@ void mgx::BufferAllocator::bind_display(wl_display* display, std::shared_ptr<Exe
                     dpy,
                     egl_extensions,
                     modifier_ext,
+                    report,
                 },
                 [wayland_executor](LinuxDmaBufUnstable* global)
                 {
@@ -211,10 +213,7 @@ std::shared_ptr<mg::Buffer> mgx::BufferAllocator::buffer_from_resource(
     std::function<void()>&& on_consumed,
     std::function<void()>&& on_release)
 {
-    auto context_guard = mir::raii::paired_calls(
-        [this]() { ctx->make_current(); },
-        [this]() { ctx->release_current(); });
-
+    // Importing a dmabuf doesn't need a current context, so don't pay for switching to one
     if (auto dmabuf = dmabuf_extension->buffer_from_resource(
         buffer,
         ctx,
@@ -224,6 +223,11 @@ std::shared_ptr<mg::Buffer> mgx::BufferAllocator::buffer_from_resource(
     {
         return dmabuf;
     }
+
+    auto context_guard = mir::raii::paired_calls(
+        [this]() { ctx->make_current(); },
+        [this]() { ctx->release_current(); });
+
     return mg::wayland::buffer_from_resource(
         buffer,
         std::move(on_consumed),
@@ -236,11 +240,15 @@ std::shared_ptr<mg::Buffer> mgx::BufferAllocator::buffer_from_resource(
 auto mgx::BufferAllocator::buffer_from_shm(
     wl_resource* buffer,
     std::shared_ptr<Executor> wayland_executor,
-    std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer>
+    std::function<void()>&& on_consumed,
+    std::shared_ptr<Buffer> const& previous,
+    geom::Rectangles const& damage) -> std::shared_ptr<Buffer>
 {
     return mg::wayland::buffer_from_wl_shm(
         buffer,
         std::move(wayland_executor),
         egl_delegate,
-        std::move(on_consumed));
+        std::move(on_consumed),
+        previous,
+        damage);
 }
@@ -41,6 +41,7 @@ class Context;
 namespace graphics
 {
 class Display;
+class DisplayReport;
 struct EGLExtensions;
 struct LinuxDmaBufUnstable;
 
@@ -56,7 +57,7 @@ class BufferAllocator :
     public graphics::GraphicBufferAllocator
 {
 public:
-    BufferAllocator(graphics::Display const& output);
+    BufferAllocator(graphics::Display const& output, std::shared_ptr<DisplayReport> const& report);
 
     std::shared_ptr<Buffer> alloc_software_buffer(geometry::Size size, MirPixelFormat) override;
     std::vector<MirPixelFormat> supported_pixel_formats() override;
@@ -70,13 +71,16 @@ public:
     auto buffer_from_shm(
         wl_resource* buffer,
         std::shared_ptr<Executor> wayland_executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<Buffer> override;
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<Buffer> const& previous,
+        geometry::Rectangles const& damage) -> std::shared_ptr<Buffer> override;
 private:
     std::shared_ptr<renderer::gl::Context> const ctx;
     std::shared_ptr<common::EGLContextExecutor> const egl_delegate;
     std::shared_ptr<Executor> wayland_executor;
     std::unique_ptr<LinuxDmaBufUnstable, std::function<void(LinuxDmaBufUnstable*)>> dmabuf_extension;
     std::shared_ptr<EGLExtensions> const egl_extensions;
+    std::shared_ptr<DisplayReport> const report;
     bool egl_display_bound{false};
 };
 
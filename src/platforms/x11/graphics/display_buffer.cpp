@@ -23,6 +23,7 @@
 #include "display_configuration.h"
 #include "mir/graphics/display_report.h"
 #include "mir/graphics/transformation.h"
+#include "mir/graphics/presentation.h"
 #include <cstring>
 
 namespace mg=mir::graphics;
@@ -41,7 +42,7 @@ mgx::DisplayBuffer::DisplayBuffer(::Display* const x_dpy,
                                     area{view_area},
                                     transform(1),
                                     egl{gl_config, x_dpy, win, shared_context},
-                                    last_frame{f},
+                                    last_frame_{f},
                                     output_id{output_id},
                                     eglGetSyncValues{nullptr}
 {
@@ -125,12 +126,12 @@ void mgx::DisplayBuffer::swap_buffers()
         mg::Frame frame;
         frame.msc = msc;
         frame.ust = {CLOCK_MONOTONIC, ust_ns};
-        last_frame->store(frame);
+        last_frame_->store(frame);
         (void)sbc; // unused
     }
     else  // Extension not available? Fall back to a reasonable estimate:
     {
-        last_frame->increment_now();
+        last_frame_->increment_now();
     }
 
     /*
@@ -138,7 +139,7 @@ void mgx::DisplayBuffer::swap_buffers()
      * but this is best-effort. And besides, we don't want Mir reporting all
      * real vsyncs because that would mean the compositor never sleeps.
      */
-    report->report_vsync(output_id.as_value(), last_frame->load());
+    report->report_vsync(output_id.as_value(), last_frame_->load());
 }
 
 void mgx::DisplayBuffer::bind()
@@ -179,3 +180,17 @@ std::chrono::milliseconds mgx::DisplayBuffer::recommended_sleep() const
 {
     return std::chrono::milliseconds::zero();
 }
+
+mg::Frame mgx::DisplayBuffer::last_frame() const
+{
+    // Our estimated frames only say when we swapped, not when it was shown
+    if (!eglGetSyncValues)
+        return {};
+
+    return last_frame_->load();
+}
+
+uint32_t mgx::DisplayBuffer::presentation_flags() const
+{
+    return eglGetSyncValues ? Presentation::vsync | Presentation::hw_clock : 0;
+}
@@ -70,6 +70,8 @@ public:
         std::function<void(graphics::DisplayBuffer&)> const& f) override;
     void post() override;
     std::chrono::milliseconds recommended_sleep() const override;
+    Frame last_frame() const override;
+    uint32_t presentation_flags() const override;
 
     glm::mat2 transformation() const override;
     NativeDisplayBuffer* native_display_buffer() override;
@@ -79,7 +81,7 @@ private:
     geometry::Rectangle area;
     glm::mat2 transform;
     helpers::EGLHelper const egl;
-    std::shared_ptr<AtomicFrame> const last_frame;
+    std::shared_ptr<AtomicFrame> const last_frame_;
     DisplayConfigurationOutputId const output_id;
 
     typedef EGLBoolean (EGLAPIENTRY EglGetSyncValuesCHROMIUM)
@@ -121,7 +121,7 @@ mgx::Platform::Platform(std::shared_ptr<::Display> const& conn,
 mir::UniqueModulePtr<mg::GraphicBufferAllocator> mgx::Platform::create_buffer_allocator(
     mg::Display const& output)
 {
-    return make_module_ptr<mgx::BufferAllocator>(output);
+    return make_module_ptr<mgx::BufferAllocator>(output, report);
 }
 
 mir::UniqueModulePtr<mg::Display> mgx::Platform::create_display(
@@ -33,15 +33,22 @@
 #include "mir/graphics/texture.h"
 #include "mir/graphics/program_factory.h"
 #include "mir/graphics/program.h"
+#include "mir/graphics/pixel_ops.h"
 
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
 #include <sstream>
 
 namespace mg = mir::graphics;
@@ -193,6 +200,130 @@ const GLchar* const vertex_shader_src =
     "   v_texcoord = texcoord;\n"
     "}\n"
 };
+
+// Whether all of a shaped renderable that lies within area is opaque, so needn't be blended
+bool is_opaque_within(mg::Renderable const& renderable, geom::Rectangle const& area)
+{
+    static glm::mat4 const identity(1);
+
+    // The opaque region doesn't account for transformations
+    if (renderable.transformation() != identity)
+        return false;
+
+    return difference_of(geom::Rectangles{area}, renderable.opaque_region()).size() == 0;
+}
+
+struct BlendSeparate  // Represents parameters of glBlendFuncSeparate()
+{
+    GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
+};
+
+bool operator==(BlendSeparate const& lhs, BlendSeparate const& rhs)
+{
+    return lhs.src_rgb == rhs.src_rgb && lhs.dst_rgb == rhs.dst_rgb &&
+           lhs.src_alpha == rhs.src_alpha && lhs.dst_alpha == rhs.dst_alpha;
+}
+
+bool operator!=(BlendSeparate const& lhs, BlendSeparate const& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/// How to blend the part of renderable within drawn_area. Uses the blend colour's alpha if dst_rgb says so.
+BlendSeparate blend_for(mg::Renderable const& renderable, geom::Rectangle const& drawn_area)
+{
+    // These renderable method names could be better (see LP: #1236224)
+    bool const shaped = renderable.shaped();
+    if (renderable.alpha() == 1.0f && (!shaped || is_opaque_within(renderable, drawn_area)))
+    {   // RGBX, or RGBA opaque wherever we draw, and no window translucency:
+        return {GL_ONE,  GL_ZERO,
+                GL_ZERO, GL_ONE};  // Avoid using src_alpha!
+    }
+    else if (shaped)  // Client is RGBA:
+    {
+        return {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
+                GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
+    }
+    else
+    {   // Client is RGBX but we also have window translucency.
+        // The texture alpha channel is possibly uninitialized so we must be
+        // careful and avoid using SRC_ALPHA (LP: #1423462).
+        return {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
+                GL_ZERO, GL_ONE};
+    }
+}
+
+// GL textures have (0,0) at bottom-left rather than top-left
+// We have to invert a TopRowFirst texture to get it the way up GL expects.
+glm::mat4 const flip_top_row_first{
+    1.0, 0.0, 0.0, 0.0,
+    0.0, -1.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    -1.0, 1.0, 0.0, 1.0
+};
+
+/// A run of vertices in the batch vertex buffer drawn with one glDrawArrays()
+struct VertexSpan
+{
+    GLenum type;
+    GLint first;
+    GLsizei count;
+};
+
+/**
+ * Appends the primitive's vertices to those of the frame. Triangle strips and
+ * fans are unrolled into plain triangles so that all of a renderable's
+ * primitives can usually be drawn with a single call. Spans before
+ * first_span belong to other renderables and are never extended.
+ */
+void append_primitive(
+    std::vector<mgl::Vertex>& vertices,
+    std::vector<VertexSpan>& spans,
+    size_t first_span,
+    mgl::Primitive const& p)
+{
+    auto const first = static_cast<GLint>(vertices.size());
+    auto const* const v = p.vertices;
+
+    switch (p.type)
+    {
+    case GL_TRIANGLES:
+        vertices.insert(vertices.end(), v, v + p.nvertices);
+        break;
+
+    case GL_TRIANGLE_FAN:
+        for (int i = 1; i < p.nvertices - 1; ++i)
+            vertices.insert(vertices.end(), {v[0], v[i], v[i+1]});
+        break;
+
+    case GL_TRIANGLE_STRIP:
+        for (int i = 0; i < p.nvertices - 2; ++i)
+        {
+            // Every other triangle of a strip is wound the other way
+            if (i % 2)
+                vertices.insert(vertices.end(), {v[i+1], v[i], v[i+2]});
+            else
+                vertices.insert(vertices.end(), {v[i], v[i+1], v[i+2]});
+        }
+        break;
+
+    default:
+        vertices.insert(vertices.end(), v, v + p.nvertices);
+        spans.push_back({p.type, first, p.nvertices});
+        return;
+    }
+
+    auto const count = static_cast<GLsizei>(vertices.size()) - first;
+    if (spans.size() > first_span && spans.back().type == GL_TRIANGLES &&
+        spans.back().first + spans.back().count == first)
+    {
+        spans.back().count += count;
+    }
+    else if (count > 0)
+    {
+        spans.push_back({GL_TRIANGLES, first, count});
+    }
+}
 }
 
 class mrg::Renderer::ProgramFactory : public mir::graphics::gl::ProgramFactory
@@ -349,14 +480,15 @@ mrg::Renderer::Program::Program(GLuint program_id)
     alpha_uniform = glGetUniformLocation(id, "alpha");
 }
 
-mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
+mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer, DrawMode draw_mode)
     : render_target(&display_buffer),
       clear_color{0.0f, 0.0f, 0.0f, 0.0f},
       default_program(family.add_program(vshader, default_fshader)),
       alpha_program(family.add_program(vshader, alpha_fshader)),
       program_factory{std::make_unique<ProgramFactory>()},
       texture_cache(mgl::DefaultProgramFactory().create_texture_cache()),
-      display_transform(1)
+      display_transform(1),
+      draw_mode{draw_mode}
 {
     eglBindAPI(EGL_OPENGL_ES_API);
     EGLDisplay disp = eglGetCurrentDisplay();
@@ -374,6 +506,9 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
             auto val = eglQueryString(disp, s.id);
             mir::log_info(std::string(s.label) + ": " + (val ? val : ""));
         }
+
+        auto const extensions = eglQueryString(disp, EGL_EXTENSIONS);
+        has_buffer_age = extensions && strstr(extensions, "EGL_EXT_buffer_age");
     }
 
     struct {GLenum id; char const* label;} const glstrings[] =
@@ -391,6 +526,12 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
         mir::log_info(std::string(s.label) + ": " + (val ? val : ""));
     }
 
+    // Pixel buffer objects are core in GLES 3
+    auto const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+    int major_version{0};
+    has_pixel_buffer_objects =
+        version && sscanf(version, "OpenGL ES %d", &major_version) == 1 && major_version >= 3;
+
     GLint max_texture_size = 0;
     glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_texture_size);
     mir::log_info("GL max texture size = %d", max_texture_size);
@@ -413,6 +554,22 @@ mrg::Renderer::Renderer(graphics::DisplayBuffer& display_buffer)
 mrg::Renderer::~Renderer()
 {
     render_target.ensure_current();
+
+    if (vertex_buffer)
+        glDeleteBuffers(1, &vertex_buffer);
+
+    for (auto const& readback : readbacks)
+    {
+        for (auto const& capture : readback.captures)
+            capture.done(false);
+        glDeleteSync(readback.copied);
+        glDeleteBuffers(1, &readback.buffer.id);
+    }
+    for (auto const& buffer : spare_capture_buffers)
+        glDeleteBuffers(1, &buffer.id);
+
+    for (auto const& capture : captures)
+        capture.done(false);
 }
 
 void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
@@ -426,16 +583,65 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
     render_target.bind();
 
+    if (!readbacks.empty())
+        finish_readbacks();
+
+    if (damage && damage.value() == viewport)
+        damage = std::experimental::nullopt;
+
+    if (damage)
+    {
+        // Everything outside the damage is still correct in this buffer
+        glEnable(GL_SCISSOR_TEST);
+        scissor_to(damage.value());
+    }
+
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
     glClear(GL_COLOR_BUFFER_BIT);
 
+    static glm::mat4 const identity(1);
+
     ++frameno;
-    for (auto const& r : renderables)
+    draw_call_count = 0;
+
+    if (draw_mode == DrawMode::batched)
+    {
+        render_batched(renderables);
+    }
+    else
+    {
+        for (auto const& r : renderables)
+        {
+            if (damage &&
+                r->transformation() == identity &&
+                !r->screen_position().overlaps(damage.value()))
+            {
+                continue;
+            }
+
+            draw(*r);
+        }
+    }
+
+    // Forget the buffers of renderables that weren't drawn this frame
+    for (auto i = texture_downcasts.begin(); i != texture_downcasts.end();)
+    {
+        if (i->second.frameno != frameno)
+            i = texture_downcasts.erase(i);
+        else
+            ++i;
+    }
+
+    if (damage)
     {
-        draw(*r);
+        glDisable(GL_SCISSOR_TEST);
+        damage = std::experimental::nullopt;
     }
 
+    if (!captures.empty())
+        read_captures();
+
     render_target.swap_buffers();
 
     // Deleting unused textures only requires the GL context. This clean-up
@@ -446,27 +652,337 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
         mir::log_debug("GL error: %d", gl_error);
 }
 
+auto mrg::Renderer::gl_texture_of(mg::Renderable const& renderable, mg::Buffer* buffer) const
+    -> mg::gl::Texture*
+{
+    if (!buffer)
+        return nullptr;
+
+    // The ID guards against a new buffer allocated where an old one was
+    auto& cached = texture_downcasts[renderable.id()];
+    auto const buffer_id = buffer->id();
+    if (cached.buffer != buffer || cached.buffer_id != buffer_id)
+    {
+        cached.buffer = buffer;
+        cached.buffer_id = buffer_id;
+        cached.texture = dynamic_cast<mg::gl::Texture*>(buffer);
+    }
+    cached.frameno = frameno;
+
+    return cached.texture;
+}
+
+void mrg::Renderer::render_batched(mg::RenderableList const& renderables) const
+{
+    static glm::mat4 const identity(1);
+
+    struct Draw
+    {
+        mg::Renderable const* renderable;
+        std::shared_ptr<mg::Buffer> buffer;
+        mg::gl::Texture* texture;
+        std::shared_ptr<mir::gl::Texture> fallback_texture;
+        Program const* program;
+        BlendSeparate blend;
+        GLfloat alpha;
+        glm::mat4 transform;
+        GLfloat centre[2];
+        std::experimental::optional<geom::Rectangle> scissor;
+        /// Where it draws, or nullopt if it could be anywhere
+        std::experimental::optional<geom::Rectangle> area;
+        size_t first_span, end_span;
+    };
+
+    std::vector<Draw> draws;
+    std::vector<VertexSpan> spans;
+    draws.reserve(renderables.size());
+    batch_vertices.clear();
+
+    for (auto const& r : renderables)
+    {
+        auto const transformed = r->transformation() != identity;
+        if (damage && !transformed && !r->screen_position().overlaps(damage.value()))
+            continue;
+
+        Draw draw;
+        draw.renderable = r.get();
+        draw.buffer = r->buffer();
+        draw.texture = gl_texture_of(*r, draw.buffer.get());
+        if (!draw.texture)
+        {
+            try
+            {
+                draw.fallback_texture = texture_cache->load(*r);
+            }
+            catch (std::exception const&)
+            {
+                report_exception();
+            }
+
+            if (!draw.fallback_texture)
+            {
+                mir::log_error("Buffer does not support GL rendering!");
+                continue;
+            }
+        }
+
+        draw.alpha = r->alpha();
+        auto const translucent = draw.alpha < 1.0f;
+        if (draw.texture)
+        {
+            auto const& family = static_cast<::Program const&>(draw.texture->shader(*program_factory));
+            draw.program = translucent ? &family.alpha : &family.opaque;
+        }
+        else
+        {
+            draw.program = translucent ? &alpha_program : &default_program;
+        }
+
+        auto const clip_area = r->clip_area();
+        draw.scissor = damage;
+        if (clip_area)
+            draw.scissor = damage ? clip_area.value().intersection_with(damage.value()) : clip_area.value();
+
+        auto const& rect = r->screen_position();
+        auto drawn_area = rect;
+        if (draw.scissor)
+            drawn_area = drawn_area.intersection_with(draw.scissor.value());
+        draw.blend = blend_for(*r, drawn_area);
+        if (!transformed)
+            draw.area = drawn_area;
+
+        draw.centre[0] = rect.top_left.x.as_int() + rect.size.width.as_int() / 2.0f;
+        draw.centre[1] = rect.top_left.y.as_int() + rect.size.height.as_int() / 2.0f;
+        draw.transform = r->transformation();
+        if (draw.texture && (draw.texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
+            draw.transform *= flip_top_row_first;
+
+        primitives.clear();
+        tessellate(primitives, *r);
+        draw.first_span = spans.size();
+        for (auto const& p : primitives)
+            append_primitive(batch_vertices, spans, draw.first_span, p);
+        draw.end_span = spans.size();
+
+        draws.push_back(std::move(draw));
+    }
+
+    /*
+     * Group draws sharing a program and blend state. A draw may only move
+     * down the stack into an earlier group if it overlaps nothing it would
+     * then be drawn beneath, so the result looks the same as drawing in order.
+     */
+    struct Group
+    {
+        Program const* program;
+        BlendSeparate blend;
+        std::vector<size_t> members;
+    };
+
+    auto const overlap = [](Draw const& a, Draw const& b)
+        {
+            return !a.area || !b.area || a.area.value().overlaps(b.area.value());
+        };
+
+    std::vector<Group> groups;
+    for (size_t i = 0; i != draws.size(); ++i)
+    {
+        auto const& draw = draws[i];
+        Group* target = nullptr;
+
+        for (auto g = groups.rbegin(); g != groups.rend(); ++g)
+        {
+            if (g->program == draw.program && g->blend == draw.blend)
+            {
+                target = &*g;
+                break;
+            }
+
+            auto const overlapped = std::any_of(g->members.begin(), g->members.end(),
+                [&](size_t m) { return overlap(draws[m], draw); });
+            if (overlapped)
+                break;
+        }
+
+        if (target)
+            target->members.push_back(i);
+        else
+            groups.push_back({draw.program, draw.blend, {i}});
+    }
+
+    if (!vertex_buffer)
+        glGenBuffers(1, &vertex_buffer);
+
+    // Respecifying the whole store lets the driver hand us fresh memory
+    // rather than waiting for the last frame to finish with it.
+    glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER,
+                 batch_vertices.size() * sizeof(mgl::Vertex),
+                 batch_vertices.data(),
+                 GL_STREAM_DRAW);
+
+    glActiveTexture(GL_TEXTURE0);
+
+    struct Uniforms
+    {
+        glm::mat4 transform;
+        GLfloat centre[2];
+        GLfloat alpha;
+    };
+    std::unordered_map<Program const*, Uniforms> uploaded;
+
+    Program const* current_program = nullptr;
+    std::experimental::optional<BlendSeparate> current_blend;
+    GLfloat current_blend_alpha = -1.0f;
+    auto current_scissor = damage;
+
+    for (auto const& group : groups)
+    {
+        auto const& prog = *group.program;
+
+        if (current_program)
+        {
+            glDisableVertexAttribArray(current_program->texcoord_attr);
+            glDisableVertexAttribArray(current_program->position_attr);
+        }
+        current_program = &prog;
+
+        glUseProgram(prog.id);
+        if (prog.last_used_frameno != frameno)
+        {   // Avoid reloading the screen-global uniforms on every renderable
+            prog.last_used_frameno = frameno;
+            for (auto i = 0u; i < prog.tex_uniforms.size(); ++i)
+            {
+                if (prog.tex_uniforms[i] != -1)
+                {
+                    glUniform1i(prog.tex_uniforms[i], i);
+                }
+            }
+            glUniformMatrix4fv(prog.display_transform_uniform, 1, GL_FALSE,
+                               glm::value_ptr(display_transform));
+            glUniformMatrix4fv(prog.screen_to_gl_coords_uniform, 1, GL_FALSE,
+                               glm::value_ptr(screen_to_gl_coords));
+        }
+
+        glEnableVertexAttribArray(prog.position_attr);
+        glEnableVertexAttribArray(prog.texcoord_attr);
+        glVertexAttribPointer(prog.position_attr, 3, GL_FLOAT,
+                              GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<void const*>(offsetof(mgl::Vertex, position)));
+        glVertexAttribPointer(prog.texcoord_attr, 2, GL_FLOAT,
+                              GL_FALSE, sizeof(mgl::Vertex),
+                              reinterpret_cast<void const*>(offsetof(mgl::Vertex, texcoord)));
+
+        if (!current_blend || current_blend.value() != group.blend)
+        {
+            current_blend = group.blend;
+            if (group.blend.dst_rgb == GL_ZERO)
+            {
+                glDisable(GL_BLEND);
+            }
+            else
+            {
+                glEnable(GL_BLEND);
+                glBlendFuncSeparate(group.blend.src_rgb,   group.blend.dst_rgb,
+                                    group.blend.src_alpha, group.blend.dst_alpha);
+            }
+        }
+
+        for (auto const i : group.members)
+        {
+            auto const& draw = draws[i];
+
+            auto const first_use = uploaded.find(&prog) == uploaded.end();
+            auto& uniforms = uploaded[&prog];
+
+            if (first_use || uniforms.centre[0] != draw.centre[0] || uniforms.centre[1] != draw.centre[1])
+                glUniform2f(prog.centre_uniform, draw.centre[0], draw.centre[1]);
+            if (first_use || uniforms.transform != draw.transform)
+                glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE, glm::value_ptr(draw.transform));
+            if (prog.alpha_uniform >= 0 && (first_use || uniforms.alpha != draw.alpha))
+                glUniform1f(prog.alpha_uniform, draw.alpha);
+            uniforms = {draw.transform, {draw.centre[0], draw.centre[1]}, draw.alpha};
+
+            if (group.blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA && current_blend_alpha != draw.alpha)
+            {
+                current_blend_alpha = draw.alpha;
+                glBlendColor(0.0f, 0.0f, 0.0f, draw.alpha);
+            }
+
+            if (draw.scissor != current_scissor)
+            {
+                if (!draw.scissor)
+                    glDisable(GL_SCISSOR_TEST);
+                else if (!current_scissor)
+                    glEnable(GL_SCISSOR_TEST);
+
+                if (draw.scissor)
+                    scissor_to(draw.scissor.value());
+                current_scissor = draw.scissor;
+            }
+
+            // if we fail to load the texture, we need to carry on (part of lp:1629275)
+            try
+            {
+                if (draw.fallback_texture)
+                    draw.fallback_texture->bind();
+                else
+                    draw.texture->bind();
+
+                for (auto s = draw.first_span; s != draw.end_span; ++s)
+                {
+                    glDrawArrays(spans[s].type, spans[s].first, spans[s].count);
+                    ++draw_call_count;
+                }
+
+                if (draw.texture)
+                {
+                    // We're done with the texture for now
+                    draw.texture->add_syncpoint();
+                }
+            }
+            catch (std::exception const&)
+            {
+                report_exception();
+            }
+        }
+    }
+
+    if (current_program)
+    {
+        glDisableVertexAttribArray(current_program->texcoord_attr);
+        glDisableVertexAttribArray(current_program->position_attr);
+    }
+
+    // Leave things as render() expects to find them
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (current_scissor != damage)
+    {
+        if (damage)
+        {
+            glEnable(GL_SCISSOR_TEST);
+            scissor_to(damage.value());
+        }
+        else
+        {
+            glDisable(GL_SCISSOR_TEST);
+        }
+    }
+}
+
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
 {
     auto const clip_area = renderable.clip_area();
     if (clip_area)
     {
         glEnable(GL_SCISSOR_TEST);
-        glScissor(
-            clip_area.value().top_left.x.as_int() -
-                viewport.top_left.x.as_int(),
-            viewport.top_left.y.as_int() +
-                viewport.size.height.as_int() -
-                clip_area.value().top_left.y.as_int() -
-                clip_area.value().size.height.as_int(),
-            clip_area.value().size.width.as_int(), 
-            clip_area.value().size.height.as_int()
-        );
-    }
-
-    auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
+        scissor_to(damage ? clip_area.value().intersection_with(damage.value()) : clip_area.value());
+    }
+
+    auto const buffer = renderable.buffer();
+    auto* const texture = gl_texture_of(renderable, buffer.get());
     auto const surface_tex =
-        [this, &renderable, need_fallback = !static_cast<bool>(texture)]() -> std::shared_ptr<mir::gl::Texture>
+        [this, &renderable, need_fallback = !texture]() -> std::shared_ptr<mir::gl::Texture>
         {
             if (need_fallback)
             {
@@ -483,7 +999,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         }();
 
     auto const* maybe_prog =
-        [this, &texture, &surface_tex](bool alpha) -> Program const*
+        [this, texture, &surface_tex](bool alpha) -> Program const*
         {
             if (texture)
             {
@@ -542,16 +1058,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
 
     glm::mat4 transform = renderable.transformation();
     if (texture && (texture->layout() == mg::gl::Texture::Layout::TopRowFirst))
-    {
-        // GL textures have (0,0) at bottom-left rather than top-left
-        // We have to invert this texture to get it the way up GL expects.
-        transform *= glm::mat4{
-            1.0, 0.0, 0.0, 0.0,
-            0.0, -1.0, 0.0, 0.0,
-            0.0, 0.0, 1.0, 0.0,
-            -1.0, 1.0, 0.0, 1.0
-        };
-    }
+        transform *= flip_top_row_first;
 
     glUniformMatrix4fv(prog.transform_uniform, 1, GL_FALSE,
                        glm::value_ptr(transform));
@@ -568,32 +1075,15 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     // if we fail to load the texture, we need to carry on (part of lp:1629275)
     try
     {
-        typedef struct  // Represents parameters of glBlendFuncSeparate()
-        {
-            GLenum src_rgb, dst_rgb, src_alpha, dst_alpha;
-        } BlendSeparate;
-
-        BlendSeparate client_blend;
-
-        // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
-        {
-            client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
-                            GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
-        }
-        else if (renderable.alpha() == 1.0f)  // RGBX and no window translucency:
-        {
-            client_blend = {GL_ONE,  GL_ZERO,
-                            GL_ZERO, GL_ONE};  // Avoid using src_alpha!
-        }
-        else
-        {   // Client is RGBX but we also have window translucency.
-            // The texture alpha channel is possibly uninitialized so we must be
-            // careful and avoid using SRC_ALPHA (LP: #1423462).
-            client_blend = {GL_ONE,  GL_ONE_MINUS_CONSTANT_ALPHA,
-                            GL_ZERO, GL_ONE};
+        auto drawn_area = renderable.screen_position();
+        if (clip_area)
+            drawn_area = drawn_area.intersection_with(clip_area.value());
+        if (damage)
+            drawn_area = drawn_area.intersection_with(damage.value());
+
+        auto const client_blend = blend_for(renderable, drawn_area);
+        if (client_blend.dst_rgb == GL_ONE_MINUS_CONSTANT_ALPHA)
             glBlendColor(0.0f, 0.0f, 0.0f, renderable.alpha());
-        }
 
         for (auto const& p : primitives)
         {
@@ -628,6 +1118,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             }
 
             glDrawArrays(p.type, 0, p.nvertices);
+            ++draw_call_count;
 
             if (texture)
             {
@@ -643,12 +1134,225 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
 
     glDisableVertexAttribArray(prog.texcoord_attr);
     glDisableVertexAttribArray(prog.position_attr);
-    if (renderable.clip_area())
+    if (clip_area)
     {
-        glDisable(GL_SCISSOR_TEST);
+        if (damage)
+            scissor_to(damage.value());
+        else
+            glDisable(GL_SCISSOR_TEST);
+    }
+}
+
+void mrg::Renderer::scissor_to(geom::Rectangle const& area) const
+{
+    glScissor(
+        area.top_left.x.as_int() -
+            viewport.top_left.x.as_int(),
+        viewport.top_left.y.as_int() +
+            viewport.size.height.as_int() -
+            area.top_left.y.as_int() -
+            area.size.height.as_int(),
+        area.size.width.as_int(),
+        area.size.height.as_int()
+    );
+}
+
+void mrg::Renderer::set_damage(geom::Rectangle const& damage)
+{
+    this->damage = damage;
+}
+
+unsigned mrg::Renderer::draw_calls() const
+{
+    return draw_call_count;
+}
+
+void mrg::Renderer::capture_next_frame(
+    geom::Rectangle const& area,
+    void* pixels,
+    geom::Stride stride,
+    std::function<void(bool captured)> const& done)
+{
+    captures.push_back({area, pixels, stride, done, GL_BGRA_EXT, 0});
+}
+
+void mrg::Renderer::read_captures() const
+{
+    auto const requested = std::move(captures);
+    captures.clear();
+
+    // Framebuffer pixels only line up with the scene when the viewport is neither scaled nor rotated
+    GLint gl_viewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_VIEWPORT, gl_viewport);
+    bool const readable = display_transform == glm::mat4(1) &&
+        gl_viewport[0] == 0 && gl_viewport[1] == 0 &&
+        gl_viewport[2] == viewport.size.width.as_int() && gl_viewport[3] == viewport.size.height.as_int();
+
+    std::vector<Capture> reading;
+    size_t total_size = 0;
+    for (auto const& capture : requested)
+    {
+        if (readable && viewport.contains(capture.area))
+        {
+            reading.push_back(capture);
+            reading.back().offset = total_size;
+            total_size += capture.area.size.width.as_uint32_t() * capture.area.size.height.as_uint32_t() * 4;
+        }
+        else
+        {
+            capture.done(false);
+        }
+    }
+
+    if (reading.empty())
+        return;
+
+    CaptureBuffer buffer{0, 0};
+    if (has_pixel_buffer_objects)
+    {
+        if (spare_capture_buffers.empty())
+        {
+            glGenBuffers(1, &buffer.id);
+        }
+        else
+        {
+            buffer = spare_capture_buffers.back();
+            spare_capture_buffers.pop_back();
+        }
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer.id);
+        if (total_size > buffer.size)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, total_size, nullptr, GL_STREAM_READ);
+            buffer.size = total_size;
+        }
+    }
+    else
+    {
+        capture_pixels.resize(total_size);
+    }
+
+    for (auto& capture : reading)
+    {
+        // GL's rows count up from the bottom of the viewport
+        auto const x = capture.area.left().as_int() - viewport.left().as_int();
+        auto const y = viewport.bottom().as_int() - capture.area.bottom().as_int();
+        auto const width = capture.area.size.width.as_int();
+        auto const height = capture.area.size.height.as_int();
+
+        // With a pixel buffer object bound, the "pointer" is an offset into it
+        auto const destination = has_pixel_buffer_objects ?
+            reinterpret_cast<void*>(capture.offset) :
+            static_cast<void*>(capture_pixels.data() + capture.offset);
+
+        glGetError();
+        glReadPixels(x, y, width, height, capture_format, GL_UNSIGNED_BYTE, destination);
+        if (capture_format == GL_BGRA_EXT && glGetError() != GL_NO_ERROR)
+        {
+            capture_format = GL_RGBA;
+            glReadPixels(x, y, width, height, capture_format, GL_UNSIGNED_BYTE, destination);
+        }
+        capture.format = capture_format;
+    }
+
+    if (has_pixel_buffer_objects)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        /*
+         * The GPU copies the pixels once it has drawn the frame. Mapping the buffer now
+         * would wait for that; by the time we draw another frame it's usually done.
+         */
+        readbacks.push_back({std::move(reading), buffer, total_size, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    }
+    else
+    {
+        for (auto const& capture : reading)
+            copy_out(capture, capture_pixels.data());
     }
 }
 
+void mrg::Renderer::finish_readbacks() const
+{
+    while (!readbacks.empty())
+    {
+        auto const status = glClientWaitSync(readbacks.front().copied, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+        {
+            // Later readbacks were queued behind this one, so they aren't done either
+            return;
+        }
+
+        auto const readback = std::move(readbacks.front());
+        readbacks.pop_front();
+
+        char const* source = nullptr;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.id);
+        if (status != GL_WAIT_FAILED)
+            source = static_cast<char const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.size, GL_MAP_READ_BIT));
+
+        for (auto const& capture : readback.captures)
+        {
+            if (source)
+                copy_out(capture, source);
+            else
+                capture.done(false);
+        }
+
+        if (source)
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        glDeleteSync(readback.copied);
+        spare_capture_buffers.push_back(readback.buffer);
+    }
+}
+
+void mrg::Renderer::copy_out(Capture const& capture, char const* source) const
+{
+    auto const width = capture.area.size.width.as_uint32_t();
+    auto const height = capture.area.size.height.as_uint32_t();
+    auto const row_size = width * 4;
+
+    for (unsigned row = 0; row != height; ++row)
+    {
+        auto const from = source + capture.offset + (height - 1 - row) * row_size;
+        auto const to = static_cast<char*>(capture.pixels) + row * capture.stride.as_uint32_t();
+
+        if (capture.format == GL_RGBA)
+            mg::pixel_ops::swap_red_and_blue(from, to, width);
+        else
+            memcpy(to, from, row_size);
+    }
+
+    capture.done(true);
+}
+
+unsigned mrg::Renderer::buffer_age() const
+{
+    // Damage is tracked in viewport coordinates, which only match the buffer
+    // when it is neither scaled nor rotated.
+    if (!has_buffer_age || !unscaled_viewport || display_transform != glm::mat4(1))
+        return 0;
+
+    render_target.bind();
+
+    // If we are drawing to an FBO, EGL doesn't know what is in it
+    GLint framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+    if (framebuffer != 0)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age) ||
+        age < 0)
+    {
+        return 0;
+    }
+
+    return age;
+}
+
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
 {
     if (rect == viewport)
@@ -725,6 +1429,14 @@ void mrg::Renderer::update_gl_viewport()
         GLint offset_y = (buf_height - reduced_height) / 2;
 
         glViewport(offset_x, offset_y, reduced_width, reduced_height);
+
+        unscaled_viewport =
+            reduced_width == buf_width && reduced_width == viewport.size.width.as_int() &&
+            reduced_height == buf_height && reduced_height == viewport.size.height.as_int();
+    }
+    else
+    {
+        unscaled_viewport = false;
     }
 }
 
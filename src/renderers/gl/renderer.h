@@ -29,6 +29,9 @@
 #include "mir/renderer/gl/render_target.h"
 
 #include <GLES2/gl2.h>
+#include <GLES2/gl2ext.h>
+#include <GLES3/gl3.h>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -36,7 +39,11 @@
 namespace mir
 {
 namespace gl { class TextureCache; }
-namespace graphics { class DisplayBuffer; }
+namespace graphics
+{
+class DisplayBuffer;
+namespace gl { class Texture; }
+}
 namespace renderer
 {
 namespace gl
@@ -59,13 +66,34 @@ private:
 class Renderer : public renderer::Renderer
 {
 public:
-    Renderer(graphics::DisplayBuffer& display_buffer);
+    /// How render() turns renderables into GL calls
+    enum class DrawMode
+    {
+        /// Each renderable is drawn by draw(), with its own GL state and client-side vertices
+        per_renderable,
+        /**
+         * The frame's vertices are uploaded at once into a persistent vertex
+         * buffer and draws are grouped by program and blend state wherever
+         * that doesn't change the result. draw() is not used.
+         */
+        batched
+    };
+
+    Renderer(graphics::DisplayBuffer& display_buffer, DrawMode draw_mode = DrawMode::per_renderable);
     virtual ~Renderer();
 
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
     void render(graphics::RenderableList const&) const override;
+    void set_damage(geometry::Rectangle const& damage) override;
+    unsigned buffer_age() const override;
+    unsigned draw_calls() const override;
+    void capture_next_frame(
+        geometry::Rectangle const& area,
+        void* pixels,
+        geometry::Stride stride,
+        std::function<void(bool captured)> const& done) override;
 
     // This is called _without_ a GL context:
     void suspend() override;
@@ -127,6 +155,25 @@ protected:
 
 private:
     void update_gl_viewport();
+    void scissor_to(geometry::Rectangle const& area) const;
+    void render_batched(graphics::RenderableList const& renderables) const;
+
+    /// Copies the captured areas out of the framebuffer, before it is swapped
+    void read_captures() const;
+    /// Hands over the pixel buffer objects of earlier frames that the GPU has finished copying into
+    void finish_readbacks() const;
+
+    /// The renderable's buffer as a graphics::gl::Texture, if it is one
+    graphics::gl::Texture* gl_texture_of(graphics::Renderable const& renderable, graphics::Buffer* buffer) const;
+
+    /// Remembers which buffers are textures, saving a dynamic_cast per renderable per frame
+    struct TextureDowncast
+    {
+        graphics::Buffer const* buffer;
+        graphics::BufferID buffer_id;
+        graphics::gl::Texture* texture;
+        long long frameno;
+    };
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -135,6 +182,54 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+    std::experimental::optional<geometry::Rectangle> mutable damage;
+    bool has_buffer_age = false;
+    bool unscaled_viewport = false;
+
+    DrawMode const draw_mode;
+    unsigned mutable draw_call_count = 0;
+    std::unordered_map<graphics::Renderable::ID, TextureDowncast> mutable texture_downcasts;
+    GLuint mutable vertex_buffer = 0;
+    std::vector<mir::gl::Vertex> mutable batch_vertices;
+
+    struct Capture
+    {
+        geometry::Rectangle area;
+        void* pixels;
+        geometry::Stride stride;
+        std::function<void(bool captured)> done;
+        GLenum format;
+        size_t offset;  ///< Into the pixels read
+    };
+    /// Copies \a capture out of the pixels read for its frame, and tells whoever asked
+    void copy_out(Capture const& capture, char const* source) const;
+
+    /// Captures of the next frame
+    std::vector<Capture> mutable captures;
+
+    struct CaptureBuffer
+    {
+        GLuint id;
+        size_t size;
+    };
+    /// Captures read into a pixel buffer object, which the GPU may still be copying into
+    struct Readback
+    {
+        std::vector<Capture> captures;
+        CaptureBuffer buffer;
+        size_t size;    ///< Of the pixels read, which may not fill the buffer
+        GLsync copied;
+    };
+    std::deque<Readback> mutable readbacks;
+
+    /// Whether captures can be read into a pixel buffer object (GLES 3), and not straight into memory
+    bool has_pixel_buffer_objects = false;
+    /// Pixel buffer objects of finished readbacks, to reuse
+    std::vector<CaptureBuffer> mutable spare_capture_buffers;
+    /// Where captures are read to without pixel buffer objects
+    std::vector<char> mutable capture_pixels;
+    /// GL_RGBA once reading GL_BGRA_EXT has failed
+    GLenum mutable capture_format = GL_BGRA_EXT;
 };
 
 }
@@ -17,14 +17,18 @@
  */
 
 #include "renderer_factory.h"
-#include "renderer.h"
 #include "mir/graphics/display_buffer.h"
 
 namespace mrg = mir::renderer::gl;
 
+mrg::RendererFactory::RendererFactory(Renderer::DrawMode draw_mode) :
+    draw_mode{draw_mode}
+{
+}
+
 std::unique_ptr<mir::renderer::Renderer>
 mrg::RendererFactory::create_renderer_for(
     graphics::DisplayBuffer& display_buffer)
 {
-    return std::make_unique<Renderer>(display_buffer);
+    return std::make_unique<Renderer>(display_buffer, draw_mode);
 }
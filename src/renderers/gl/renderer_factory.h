@@ -20,6 +20,7 @@
 #define MIR_RENDERER_GL_RENDERER_FACTORY_H_
 
 #include "mir/renderer/renderer_factory.h"
+#include "renderer.h"
 
 namespace mir
 {
@@ -31,8 +32,13 @@ namespace gl
 class RendererFactory : public renderer::RendererFactory
 {
 public:
+    explicit RendererFactory(Renderer::DrawMode draw_mode = Renderer::DrawMode::per_renderable);
+
     std::unique_ptr<renderer::Renderer> create_renderer_for(
         graphics::DisplayBuffer& display_buffer) override;
+
+private:
+    Renderer::DrawMode const draw_mode;
 };
 
 }
@@ -0,0 +1,257 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "basic_screen_capture.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/renderer/renderer.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+// More than enough for a recorder that keeps up; one that doesn't gets a full frame
+size_t const max_damage_history{32};
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width == geom::Width{0} || rect.size.height == geom::Height{0};
+}
+}
+
+mc::BasicScreenCapture::BasicScreenCapture(std::function<void()> const& schedule_frame) :
+    schedule_frame{schedule_frame}
+{
+}
+
+void mc::BasicScreenCapture::capture(
+    geom::Rectangle const& area,
+    uint64_t since,
+    bool wait_for_damage,
+    Callback const& on_captured)
+{
+    {
+        std::unique_lock<decltype(mutex)> lock{mutex};
+        if (!is_shown(area))
+        {
+            lock.unlock();
+            on_captured(nullptr);
+            return;
+        }
+        requests.push_back({area, since, wait_for_damage, on_captured});
+    }
+
+    // Waiting for damage doesn't need a frame drawn now, unless we don't know what changed
+    if (!wait_for_damage || since == 0)
+        schedule_frame();
+}
+
+bool mc::BasicScreenCapture::wants_frame(geom::Rectangle const& view_area) const
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    // A frame that isn't rendered doesn't finish the captures of earlier frames either
+    return std::find(unfinished.begin(), unfinished.end(), view_area) != unfinished.end() ||
+        std::any_of(requests.begin(), requests.end(),
+            [&](Request const& request) { return view_area.contains(request.area); });
+}
+
+void mc::BasicScreenCapture::frame_rendering(
+    geom::Rectangle const& view_area,
+    geom::Rectangle const& damage,
+    renderer::Renderer& renderer)
+{
+    std::vector<std::pair<std::shared_ptr<Frame>, Callback>> frames;
+    bool finishing;
+
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        // Until the configuration catches up with the compositor, the frame isn't of a known output
+        auto const output = std::find_if(outputs.begin(), outputs.end(),
+            [&](Output const& output) { return output.view_area == view_area; });
+        if (output == outputs.end())
+            return;
+
+        auto const sequence = ++output->sequence;
+        if (!is_empty(damage))
+        {
+            output->damage.emplace_front(sequence, damage);
+            if (output->damage.size() > max_damage_history)
+            {
+                output->forgotten = output->damage.back().first;
+                output->damage.pop_back();
+            }
+        }
+
+        for (auto request = requests.begin(); request != requests.end();)
+        {
+            if (!view_area.contains(request->area))
+            {
+                ++request;
+                continue;
+            }
+
+            auto const changed = damage_since(*output, request->area, request->since);
+            if (request->wait_for_damage && is_empty(changed))
+            {
+                ++request;
+                continue;
+            }
+
+            auto const frame = std::make_shared<Frame>();
+            frame->area = request->area;
+            frame->damage = changed;
+            frame->sequence = sequence;
+            frame->pixels.resize(request->area.size.width.as_uint32_t() * request->area.size.height.as_uint32_t());
+            frames.emplace_back(frame, std::move(request->on_captured));
+
+            request = requests.erase(request);
+        }
+
+        unfinished.insert(unfinished.end(), frames.size(), view_area);
+        finishing = std::find(unfinished.begin(), unfinished.end(), view_area) != unfinished.end();
+    }
+
+    // The renderer may need another frame drawn to finish its captures
+    if (finishing)
+        schedule_frame();
+
+    for (auto const& frame : frames)
+    {
+        renderer.capture_next_frame(
+            frame.first->area,
+            frame.first->pixels.data(),
+            frame.first->stride(),
+            [this, frame, view_area](bool captured)
+            {
+                {
+                    std::lock_guard<decltype(mutex)> lock{mutex};
+                    unfinished.erase(std::find(unfinished.begin(), unfinished.end(), view_area));
+                }
+
+                if (captured)
+                {
+                    frame.first->timestamp = std::chrono::steady_clock::now().time_since_epoch();
+                    frame.second(frame.first);
+                }
+                else
+                {
+                    frame.second(nullptr);
+                }
+            });
+    }
+}
+
+auto mc::BasicScreenCapture::damage_since(Output const& output, geom::Rectangle const& area, uint64_t since)
+    -> geom::Rectangle
+{
+    // Anything we can't account for has to be assumed changed
+    if (since == 0 || since < output.forgotten || since > output.sequence)
+        return area;
+
+    geom::Rectangles changed;
+    for (auto const& frame : output.damage)
+    {
+        if (frame.first <= since)
+            break;
+
+        auto const in_area = frame.second.intersection_with(area);
+        if (!is_empty(in_area))
+            changed.add(in_area);
+    }
+
+    return changed.bounding_rectangle();
+}
+
+void mc::BasicScreenCapture::initial_configuration(std::shared_ptr<mg::DisplayConfiguration const> const& config)
+{
+    outputs_changed(*config);
+}
+
+void mc::BasicScreenCapture::configuration_applied(std::shared_ptr<mg::DisplayConfiguration const> const& config)
+{
+    outputs_changed(*config);
+}
+
+void mc::BasicScreenCapture::outputs_changed(mg::DisplayConfiguration const& config)
+{
+    std::vector<Callback> failed;
+    bool still_pending;
+
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        std::vector<Output> current;
+        config.for_each_output(
+            [&](mg::DisplayConfigurationOutput const& conf)
+            {
+                if (!conf.used)
+                    return;
+
+                auto const known = std::find_if(outputs.begin(), outputs.end(),
+                    [&](Output const& output) { return output.id == conf.id; });
+
+                if (known == outputs.end())
+                {
+                    current.push_back(Output{conf.id, conf.extents(), 0, 0, {}});
+                    return;
+                }
+
+                current.push_back(std::move(*known));
+                auto& output = current.back();
+                if (output.view_area != conf.extents())
+                {
+                    // Keep numbering the frames, but the next can't be compared with earlier ones
+                    output.view_area = conf.extents();
+                    output.forgotten = output.sequence + 1;
+                    output.damage.clear();
+                }
+            });
+        outputs.swap(current);
+
+        for (auto request = requests.begin(); request != requests.end();)
+        {
+            if (is_shown(request->area))
+            {
+                ++request;
+            }
+            else
+            {
+                failed.push_back(std::move(request->on_captured));
+                request = requests.erase(request);
+            }
+        }
+
+        still_pending = !requests.empty();
+    }
+
+    for (auto const& on_captured : failed)
+        on_captured(nullptr);
+
+    // The outputs' compositors may have drawn before we heard of the outputs
+    if (still_pending)
+        schedule_frame();
+}
+
+bool mc::BasicScreenCapture::is_shown(geom::Rectangle const& area) const
+{
+    return std::any_of(outputs.begin(), outputs.end(),
+        [&](Output const& output) { return output.view_area.contains(area); });
+}
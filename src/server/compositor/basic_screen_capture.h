@@ -0,0 +1,118 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BASIC_SCREEN_CAPTURE_H_
+#define MIR_COMPOSITOR_BASIC_SCREEN_CAPTURE_H_
+
+#include "mir/compositor/screen_capture.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display_configuration_observer.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Captures frames for the outputs of the current display configuration.
+ *
+ * Each output's frames are numbered, and their damage remembered, for as long as the
+ * output stays in the configuration. Captures of an area that no output shows fail.
+ */
+class BasicScreenCapture : public ScreenCapture, public graphics::DisplayConfigurationObserver
+{
+public:
+    /// \param schedule_frame asks the compositor to draw a frame, even if nothing has changed
+    explicit BasicScreenCapture(std::function<void()> const& schedule_frame);
+
+    void capture(
+        geometry::Rectangle const& area,
+        uint64_t since,
+        bool wait_for_damage,
+        Callback const& on_captured) override;
+
+    bool wants_frame(geometry::Rectangle const& view_area) const override;
+
+    void frame_rendering(
+        geometry::Rectangle const& view_area,
+        geometry::Rectangle const& damage,
+        renderer::Renderer& renderer) override;
+
+    void initial_configuration(std::shared_ptr<graphics::DisplayConfiguration const> const& config) override;
+    void configuration_applied(std::shared_ptr<graphics::DisplayConfiguration const> const& config) override;
+    void base_configuration_updated(std::shared_ptr<graphics::DisplayConfiguration const> const&) override {}
+    void session_configuration_applied(
+        std::shared_ptr<scene::Session> const&,
+        std::shared_ptr<graphics::DisplayConfiguration> const&) override {}
+    void session_configuration_removed(std::shared_ptr<scene::Session> const&) override {}
+    void configuration_failed(
+        std::shared_ptr<graphics::DisplayConfiguration const> const&,
+        std::exception const&) override {}
+    void catastrophic_configuration_error(
+        std::shared_ptr<graphics::DisplayConfiguration const> const&,
+        std::exception const&) override {}
+    void configuration_updated_for_session(
+        std::shared_ptr<scene::Session> const&,
+        std::shared_ptr<graphics::DisplayConfiguration const> const&) override {}
+
+private:
+    struct Request
+    {
+        geometry::Rectangle area;
+        uint64_t since;
+        bool wait_for_damage;
+        Callback on_captured;
+    };
+
+    struct Output
+    {
+        graphics::DisplayConfigurationOutputId id;
+        geometry::Rectangle view_area;
+        /// The last frame drawn
+        uint64_t sequence;
+        /// The newest frame whose damage is no longer in the history
+        uint64_t forgotten;
+        /// The damage of recent frames, newest first (frames without damage are left out)
+        std::deque<std::pair<uint64_t, geometry::Rectangle>> damage;
+    };
+
+    /// Takes on the outputs of \a config, failing the requests none of them can capture
+    void outputs_changed(graphics::DisplayConfiguration const& config);
+
+    /// Whether any output shows all of \a area
+    bool is_shown(geometry::Rectangle const& area) const;
+
+    /// The part of \a area changed since frame \a since; all of it if that's too long ago to know
+    static auto damage_since(Output const& output, geometry::Rectangle const& area, uint64_t since)
+        -> geometry::Rectangle;
+
+    std::function<void()> const schedule_frame;
+
+    std::mutex mutable mutex;
+    std::vector<Request> requests;
+    std::vector<Output> outputs;
+    /// The outputs of captures handed to renderers, which may only finish them while drawing a later frame
+    std::vector<geometry::Rectangle> unfinished;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_BASIC_SCREEN_CAPTURE_H_ */
@@ -0,0 +1,185 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "buffer_queue_statistics.h"
+#include "mir/compositor/compositor_report.h"
+
+#include <algorithm>
+#include <experimental/optional>
+#include <vector>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mt = mir::time;
+
+namespace
+{
+// More than any client keeps in flight, so anything older was dropped
+size_t const max_tracked_submissions{16};
+
+auto latency_between(mt::PosixTimestamp const& earlier, mt::PosixTimestamp const& later)
+    -> std::chrono::nanoseconds
+{
+    if (earlier.clock_id != later.clock_id || later.nanoseconds < earlier.nanoseconds)
+        return std::chrono::nanoseconds{0};
+
+    return later - earlier;
+}
+}
+
+void mc::BufferQueueStatistics::Window::add(std::chrono::nanoseconds sample)
+{
+    samples[next] = sample;
+    next = (next + 1) % samples.size();
+    count = std::min(count + 1, samples.size());
+}
+
+auto mc::BufferQueueStatistics::Window::percentile(unsigned percent) const -> std::chrono::nanoseconds
+{
+    if (!count)
+        return std::chrono::nanoseconds{0};
+
+    // Nearest rank, so small windows report a sample that actually happened
+    std::vector<std::chrono::nanoseconds> sorted(samples.begin(), samples.begin() + count);
+    auto const rank = std::max<size_t>((percent * count + 99) / 100, 1);
+    auto const nth = sorted.begin() + (rank - 1);
+    std::nth_element(sorted.begin(), nth, sorted.end());
+    return *nth;
+}
+
+mc::BufferQueueStatistics::BufferQueueStatistics(
+    void const* stream,
+    std::shared_ptr<CompositorReport> const& report) :
+    stream{stream},
+    report{report}
+{
+}
+
+void mc::BufferQueueStatistics::submitted(mg::BufferID buffer, mt::PosixTimestamp const& when)
+{
+    std::experimental::optional<mg::BufferID> forgotten;
+    unsigned queued{0};
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        ++counts.submitted;
+        submissions.push_back({buffer, when, false, false});
+
+        if (submissions.size() > max_tracked_submissions)
+        {
+            if (!submissions.front().acquired)
+            {
+                ++counts.dropped;
+                forgotten = submissions.front().buffer;
+            }
+            submissions.pop_front();
+        }
+
+        queued = std::count_if(submissions.begin(), submissions.end(),
+            [](Submission const& s) { return !s.acquired; });
+    }
+
+    if (forgotten)
+        report->buffer_dropped(stream, *forgotten);
+    report->buffer_submitted(stream, buffer, queued);
+}
+
+void mc::BufferQueueStatistics::acquired(CompositorID user, mg::BufferID buffer, mt::PosixTimestamp const& when)
+{
+    std::vector<mg::BufferID> dropped;
+    std::chrono::nanoseconds latency{0};
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        ++counts.acquired;
+
+        // Buffers may be resubmitted, so we want the most recent submission
+        auto const match = std::find_if(submissions.rbegin(), submissions.rend(),
+            [&](Submission const& s) { return s.buffer == buffer && !s.acquired; });
+
+        if (match != submissions.rend())
+        {
+            latency = latency_between(match->submitted_at, when);
+            queue_latency.add(latency);
+            match->acquired = true;
+
+            // Whatever was queued ahead of it was replaced without being acquired
+            auto const end = match.base() - 1;
+            for (auto i = submissions.begin(); i != end; ++i)
+            {
+                if (!i->acquired)
+                    dropped.push_back(i->buffer);
+            }
+            submissions.erase(
+                std::remove_if(submissions.begin(), end, [](Submission const& s) { return !s.acquired; }),
+                end);
+            counts.dropped += dropped.size();
+        }
+    }
+
+    for (auto const& id : dropped)
+        report->buffer_dropped(stream, id);
+    report->buffer_acquired(stream, user, buffer, latency);
+}
+
+void mc::BufferQueueStatistics::reacquired(CompositorID user, mg::BufferID buffer)
+{
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+        ++counts.reacquired;
+    }
+
+    report->buffer_reacquired(stream, user, buffer);
+}
+
+void mc::BufferQueueStatistics::released(mg::BufferID buffer)
+{
+    report->buffer_released(stream, buffer);
+}
+
+void mc::BufferQueueStatistics::presented(mg::BufferID buffer, mt::PosixTimestamp const& when)
+{
+    std::chrono::nanoseconds latency;
+    {
+        std::lock_guard<decltype(mutex)> lock{mutex};
+
+        auto const match = std::find_if(submissions.rbegin(), submissions.rend(),
+            [&](Submission const& s) { return s.buffer == buffer && s.acquired; });
+
+        // A buffer stays on screen for many frames, but is only presented once
+        if (match == submissions.rend() || match->presented)
+            return;
+
+        match->presented = true;
+        latency = latency_between(match->submitted_at, when);
+        present_latency.add(latency);
+        ++counts.presented;
+    }
+
+    report->buffer_presented(stream, buffer, latency);
+}
+
+auto mc::BufferQueueStatistics::stats() const -> BufferQueueStats
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    auto result = counts;
+    result.queued = std::count_if(submissions.begin(), submissions.end(),
+        [](Submission const& s) { return !s.acquired; });
+    result.queue_latency_p50 = queue_latency.percentile(50);
+    result.queue_latency_p99 = queue_latency.percentile(99);
+    result.present_latency_p50 = present_latency.percentile(50);
+    result.present_latency_p99 = present_latency.percentile(99);
+    return result;
+}
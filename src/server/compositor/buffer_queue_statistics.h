@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_BUFFER_QUEUE_STATISTICS_H_
+#define MIR_COMPOSITOR_BUFFER_QUEUE_STATISTICS_H_
+
+#include "mir/compositor/buffer_queue_stats.h"
+#include "mir/compositor/compositor_id.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/time/posix_timestamp.h"
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace compositor
+{
+class CompositorReport;
+
+/**
+ * Follows each buffer of a stream from submission to the screen, keeping
+ * counts and recent latencies for BufferStream::queue_stats() and passing
+ * each step on to the CompositorReport.
+ *
+ * Drops are inferred rather than reported by the schedule: anything
+ * submitted before an acquired buffer, but not itself acquired, was
+ * replaced. That holds for both queueing and dropping schedules.
+ */
+class BufferQueueStatistics
+{
+public:
+    BufferQueueStatistics(void const* stream, std::shared_ptr<CompositorReport> const& report);
+
+    void submitted(graphics::BufferID buffer, time::PosixTimestamp const& when);
+    void acquired(CompositorID user, graphics::BufferID buffer, time::PosixTimestamp const& when);
+    void reacquired(CompositorID user, graphics::BufferID buffer);
+    void released(graphics::BufferID buffer);
+    /// Only the first presentation of each submission counts
+    void presented(graphics::BufferID buffer, time::PosixTimestamp const& when);
+
+    auto stats() const -> BufferQueueStats;
+
+private:
+    /// Enough recent samples for a meaningful p99 without much memory per stream
+    static size_t const window_size = 128;
+
+    struct Window
+    {
+        std::array<std::chrono::nanoseconds, window_size> samples;
+        size_t count{0};
+        size_t next{0};
+
+        void add(std::chrono::nanoseconds sample);
+        auto percentile(unsigned percent) const -> std::chrono::nanoseconds;
+    };
+
+    struct Submission
+    {
+        graphics::BufferID buffer;
+        time::PosixTimestamp submitted_at;
+        bool acquired;
+        bool presented;
+    };
+
+    void const* const stream;
+    std::shared_ptr<CompositorReport> const report;
+
+    std::mutex mutable mutex;
+    BufferQueueStats counts;
+    /// The most recent submissions, oldest first
+    std::deque<Submission> submissions;
+    Window queue_latency;
+    Window present_latency;
+};
+}
+}
+
+#endif /* MIR_COMPOSITOR_BUFFER_QUEUE_STATISTICS_H_ */
@@ -0,0 +1,194 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damage_tracker.h"
+#include "mir/graphics/buffer.h"
+
+#include <cmath>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width == geom::Width{} || rect.size.height == geom::Height{};
+}
+
+void add_damage(geom::Rectangles& damage, geom::Rectangle const& rect)
+{
+    if (!is_empty(rect))
+        damage.add(rect);
+}
+}
+
+mc::DamageTracker::DamageTracker(unsigned max_buffer_age) :
+    max_buffer_age{max_buffer_age}
+{
+}
+
+auto mc::DamageTracker::area_of(mg::Renderable const& renderable) const -> geom::Rectangle
+{
+    static glm::mat4 const identity(1);
+
+    // We don't know where a transformed renderable ends up; assume everywhere
+    if (renderable.transformation() != identity)
+        return output_area;
+
+    auto area = renderable.screen_position().intersection_with(output_area);
+    if (auto const clip = renderable.clip_area())
+        area = area.intersection_with(clip.value());
+
+    return area;
+}
+
+void mc::DamageTracker::add_buffer_damage(
+    mg::Renderable const& renderable,
+    mg::BufferID earlier,
+    geom::Rectangle const& area)
+{
+    static glm::mat4 const identity(1);
+
+    auto const buffer = renderable.buffer();
+    auto const damage = renderable.damage_since(earlier);
+
+    if (!damage || !buffer || renderable.transformation() != identity)
+    {
+        add_damage(pending, area);
+        return;
+    }
+
+    auto const buffer_size = buffer->size();
+    if (buffer_size.width == geom::Width{} || buffer_size.height == geom::Height{})
+    {
+        add_damage(pending, area);
+        return;
+    }
+
+    // The buffer is stretched over screen_position(); map each damaged rect
+    // across, rounding outwards so that filtering doesn't leave stale pixels.
+    auto const position = renderable.screen_position();
+    auto const sx = double(position.size.width.as_int()) / buffer_size.width.as_int();
+    auto const sy = double(position.size.height.as_int()) / buffer_size.height.as_int();
+
+    for (auto const& rect : damage.value())
+    {
+        auto const left   = int(std::floor(rect.left().as_int() * sx));
+        auto const top    = int(std::floor(rect.top().as_int() * sy));
+        auto const right  = int(std::ceil(rect.right().as_int() * sx));
+        auto const bottom = int(std::ceil(rect.bottom().as_int() * sy));
+
+        geom::Rectangle const on_screen{
+            {position.top_left.x.as_int() + left, position.top_left.y.as_int() + top},
+            {right - left, bottom - top}};
+
+        add_damage(pending, on_screen.intersection_with(area));
+    }
+}
+
+void mc::DamageTracker::record(mg::RenderableList const& renderables, geom::Rectangle const& area)
+{
+    if (area != output_area)
+    {
+        output_area = area;
+        all_pending = true;
+    }
+
+    std::unordered_map<mg::Renderable::ID, RenderableState> this_frame;
+    this_frame.reserve(renderables.size());
+
+    mg::Renderable::ID below = nullptr;
+    for (auto const& renderable : renderables)
+    {
+        auto const buffer = renderable->buffer();
+        RenderableState const state{
+            below,
+            buffer ? buffer->id() : mg::BufferID{},
+            area_of(*renderable),
+            renderable->alpha(),
+            renderable->transformation()};
+
+        auto const previous = last_frame.find(renderable->id());
+        if (previous == last_frame.end())
+        {
+            add_damage(pending, state.area);
+        }
+        else
+        {
+            auto const& prev = previous->second;
+
+            // A change in what lies directly below means the stacking changed
+            if (prev.area != state.area ||
+                prev.alpha != state.alpha ||
+                prev.transformation != state.transformation ||
+                prev.below != state.below)
+            {
+                add_damage(pending, prev.area);
+                add_damage(pending, state.area);
+            }
+            else if (prev.buffer != state.buffer)
+            {
+                add_buffer_damage(*renderable, prev.buffer, state.area);
+            }
+
+            last_frame.erase(previous);
+        }
+
+        this_frame[renderable->id()] = state;
+        below = renderable->id();
+    }
+
+    // Whatever is left is no longer on this output
+    for (auto const& gone : last_frame)
+        add_damage(pending, gone.second.area);
+
+    last_frame = std::move(this_frame);
+}
+
+void mc::DamageTracker::damage_all()
+{
+    all_pending = true;
+}
+
+auto mc::DamageTracker::damage_for_frame(unsigned buffer_age) -> geom::Rectangle
+{
+    auto const frame_damage = all_pending ?
+        output_area :
+        pending.bounding_rectangle().intersection_with(output_area);
+
+    pending.clear();
+    all_pending = false;
+
+    history.push_front(frame_damage);
+    if (history.size() > max_buffer_age)
+        history.pop_back();
+
+    if (buffer_age == 0 || buffer_age > history.size())
+        return output_area;
+
+    geom::Rectangles repaint;
+    for (auto i = 0u; i != buffer_age; ++i)
+        add_damage(repaint, history[i]);
+
+    return repaint.bounding_rectangle();
+}
+
+auto mc::DamageTracker::last_frame_damage() const -> geom::Rectangle
+{
+    return history.empty() ? geom::Rectangle{} : history.front();
+}
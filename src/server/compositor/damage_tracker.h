@@ -0,0 +1,101 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/buffer_id.h"
+#include "mir/graphics/renderable.h"
+
+#include <deque>
+#include <unordered_map>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Tracks which parts of a single output have changed between frames.
+ *
+ * Damage is found by comparing each frame's renderables with those of the
+ * previous frame: new content, moves, resizes, stacking changes and
+ * renderables appearing or disappearing all damage the area they cover.
+ * Where a renderable knows which part of its new buffer the client changed,
+ * only that part is damaged.
+ * A short history of past frames' damage is kept so that a renderer
+ * drawing into a buffer last used N frames ago (its "buffer age") knows
+ * how much it needs to repaint.
+ */
+class DamageTracker
+{
+public:
+    /// \param max_buffer_age the oldest buffer age for which partial repaint is supported
+    explicit DamageTracker(unsigned max_buffer_age = 4);
+
+    /// Compares the renderables of this frame with the last and accumulates the damage
+    void record(graphics::RenderableList const& renderables, geometry::Rectangle const& output_area);
+
+    /// Marks the whole output damaged, e.g. when the frame was not rendered by GL
+    void damage_all();
+
+    /**
+     * Consumes the accumulated damage as a new frame and returns the area that
+     * needs to be repainted into a buffer of the given age.
+     *
+     * \param [in] buffer_age frames since the target buffer was last drawn
+     *                        into, or 0 if its contents are undefined
+     * \return the area to repaint, clipped to the output
+     */
+    auto damage_for_frame(unsigned buffer_age) -> geometry::Rectangle;
+
+    /// What changed in the frame last consumed by damage_for_frame(), whatever the buffer age
+    auto last_frame_damage() const -> geometry::Rectangle;
+
+private:
+    struct RenderableState
+    {
+        graphics::Renderable::ID below;
+        graphics::BufferID buffer;
+        geometry::Rectangle area;
+        float alpha;
+        glm::mat4 transformation;
+    };
+
+    auto area_of(graphics::Renderable const& renderable) const -> geometry::Rectangle;
+
+    /// Damages the part of area that the client says changed since earlier
+    void add_buffer_damage(
+        graphics::Renderable const& renderable,
+        graphics::BufferID earlier,
+        geometry::Rectangle const& area);
+
+    unsigned const max_buffer_age;
+    geometry::Rectangle output_area;
+    std::unordered_map<graphics::Renderable::ID, RenderableState> last_frame;
+    geometry::Rectangles pending;
+    bool all_pending{true};
+
+    /// Damage of the most recently rendered frames, newest first
+    std::deque<geometry::Rectangle> history;
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_DAMAGE_TRACKER_H_
@@ -21,9 +21,13 @@
 #include "mir/shell/shell.h"
 #include "buffer_stream_factory.h"
 #include "default_display_buffer_compositor_factory.h"
+#include "basic_screen_capture.h"
 #include "multi_threaded_compositor.h"
 #include "gl/renderer_factory.h"
 #include "mir/main_loop.h"
+#include "mir/graphics/display.h"
+#include "mir/observer_registrar.h"
+#include "mir/input/scene.h"
 
 #include "mir/options/configuration.h"
 
@@ -37,9 +41,9 @@ std::shared_ptr<ms::BufferStreamFactory>
 mir::DefaultServerConfiguration::the_buffer_stream_factory()
 {
     return buffer_stream_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mc::BufferStreamFactory>();
+            return std::make_shared<mc::BufferStreamFactory>(the_compositor_report());
         });
 }
 
@@ -50,7 +54,24 @@ mir::DefaultServerConfiguration::the_display_buffer_compositor_factory()
         [this]()
         {
             return wrap_display_buffer_compositor_factory(std::make_shared<mc::DefaultDisplayBufferCompositorFactory>(
-                the_renderer_factory(), the_compositor_report()));
+                the_renderer_factory(), the_compositor_report(), the_screen_capture()));
+        });
+}
+
+std::shared_ptr<mc::ScreenCapture>
+mir::DefaultServerConfiguration::the_screen_capture()
+{
+    return screen_capture(
+        [this]()
+        {
+            // Nudging the scene gets a frame composited even when nothing has changed
+            auto const capture = std::make_shared<mc::BasicScreenCapture>(
+                [scene = the_input_scene()]() { scene->emit_scene_changed(); });
+
+            // The initial configuration may already have been announced
+            capture->initial_configuration(the_display()->configuration());
+            the_display_configuration_observer_registrar()->register_interest(capture);
+            return capture;
         });
 }
 
@@ -84,8 +105,14 @@ mir::DefaultServerConfiguration::the_compositor()
 std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration::the_renderer_factory()
 {
     return renderer_factory(
-        []()
+        [this]()
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            using mir::renderer::gl::Renderer;
+
+            auto const draw_mode = the_options()->get<bool>(options::gl_batching_opt) ?
+                Renderer::DrawMode::batched :
+                Renderer::DrawMode::per_renderable;
+
+            return std::make_shared<mir::renderer::gl::RendererFactory>(draw_mode);
         });
 }
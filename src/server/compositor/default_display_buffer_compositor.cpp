@@ -24,7 +24,9 @@
 #include "mir/graphics/renderable.h"
 #include "mir/graphics/display_buffer.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/presentation.h"
 #include "mir/compositor/buffer_stream.h"
+#include "mir/compositor/screen_capture.h"
 #include "mir/renderer/renderer.h"
 #include "occlusion.h"
 #include <mutex>
@@ -34,13 +36,21 @@
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 
+namespace
+{
+// Matches the frames a sync group may have posted ahead of the screen
+size_t const max_unpresented_frames{3};
+}
+
 mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     mg::DisplayBuffer& display_buffer,
     std::shared_ptr<mir::renderer::Renderer> const& renderer,
-    std::shared_ptr<mc::CompositorReport> const& report) :
+    std::shared_ptr<mc::CompositorReport> const& report,
+    std::shared_ptr<mc::ScreenCapture> const& capture) :
     display_buffer(display_buffer),
     renderer(renderer),
-    report(report)
+    report(report),
+    capture(capture)
 {
 }
 
@@ -72,20 +82,48 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    // Neither overlays nor hardware planes reach the renderer's framebuffer, so
+    // composite everything while anyone is recording
+    bool const capturing = capture && capture->wants_frame(view_area);
+
+    if (!capturing && display_buffer.overlay(renderable_list))
     {
+        damage.record(renderable_list, view_area);
+
+        // Whatever GL last rendered is now stale
+        damage.damage_all();
+
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+
+        await_presentation(renderable_list, {});
     }
     else
     {
+        /*
+         * Renderables shown on hardware planes are not composited, so they
+         * only damage the framebuffer when they move on or off a plane.
+         */
+        auto composited = capturing ? renderable_list : display_buffer.assign_planes(renderable_list);
+        damage.record(composited, view_area);
+
         renderer->set_output_transform(display_buffer.transformation());
         renderer->set_viewport(view_area);
-        renderer->render(renderable_list);
+
+        auto const redraw = damage.damage_for_frame(renderer->buffer_age());
+        renderer->set_damage(redraw);
+        if (capture)
+            capture->frame_rendering(view_area, damage.last_frame_damage(), *renderer);
+        renderer->render(composited);
+
+        report->damage_in_frame(this, redraw);
+        report->draw_calls_in_frame(this, renderer->draw_calls());
 
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
 
+        await_presentation(renderable_list, composited);
+
         /*
          * This is used for the 'early release' optimization to release buffers
          * we did use back to clients before starting on the potentially slow
@@ -97,8 +135,50 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
          *        problematic IPC (LP: #1395421) will instead occur in buffer
          *        acquisition calls when we composite the next frame.
          */
+        composited.clear();
         renderable_list.clear();
     }
 
     report->finished_frame(this);
 }
+
+void mc::DefaultDisplayBufferCompositor::presented(mg::Presentation const& presentation)
+{
+    if (unpresented.empty())
+        return;
+
+    auto const frame = std::move(unpresented.front());
+    unpresented.pop_front();
+
+    for (auto const& shown : frame)
+    {
+        auto shown_presentation = presentation;
+        if (shown.zero_copy)
+            shown_presentation.flags |= mg::Presentation::zero_copy;
+        shown.notify(shown_presentation);
+    }
+}
+
+void mc::DefaultDisplayBufferCompositor::await_presentation(
+    mg::RenderableList const& shown,
+    mg::RenderableList const& composited)
+{
+    std::vector<Shown> frame;
+
+    // composited is in the same order as shown, so one pass finds what it left out
+    auto next_composited = composited.begin();
+    for (auto const& renderable : shown)
+    {
+        // Anything the renderer didn't draw went straight to the hardware
+        bool const zero_copy = next_composited == composited.end() || *next_composited != renderable;
+        if (!zero_copy)
+            ++next_composited;
+
+        if (auto notify = renderable->on_presented())
+            frame.push_back({std::move(notify), zero_copy});
+    }
+
+    unpresented.push_back(std::move(frame));
+    if (unpresented.size() > max_unpresented_frames)
+        unpresented.pop_front();
+}
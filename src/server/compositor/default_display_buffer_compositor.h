@@ -21,7 +21,12 @@
 
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/compositor_report.h"
+#include "damage_tracker.h"
+#include "mir/graphics/renderable.h"
+#include <deque>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace mir
 {
@@ -37,6 +42,7 @@ namespace compositor
 {
 
 class Scene;
+class ScreenCapture;
 
 class DefaultDisplayBufferCompositor : public DisplayBufferCompositor
 {
@@ -44,14 +50,30 @@ public:
     DefaultDisplayBufferCompositor(
         graphics::DisplayBuffer& display_buffer,
         std::shared_ptr<renderer::Renderer> const& renderer,
-        std::shared_ptr<CompositorReport> const& report);
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<ScreenCapture> const& capture = {});
 
     void composite(SceneElementSequence&& scene_sequence) override;
+    void presented(graphics::Presentation const& presentation) override;
 
 private:
+    struct Shown
+    {
+        std::function<void(graphics::Presentation const&)> notify;
+        bool zero_copy;
+    };
+
+    /// Remembers who wants to know when this frame's renderables reach the screen
+    void await_presentation(graphics::RenderableList const& shown, graphics::RenderableList const& composited);
+
     graphics::DisplayBuffer& display_buffer;
     std::shared_ptr<renderer::Renderer> const renderer;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ScreenCapture> const capture;
+    DamageTracker damage;
+
+    /// Frames not yet known to be on screen, oldest first
+    std::deque<std::vector<Shown>> unpresented;
 };
 
 }
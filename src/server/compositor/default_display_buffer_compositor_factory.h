@@ -31,19 +31,22 @@ class RendererFactory;
 ///  Compositing. Combining renderables into a display image.
 namespace compositor
 {
+class ScreenCapture;
 
 class DefaultDisplayBufferCompositorFactory : public DisplayBufferCompositorFactory
 {
 public:
     DefaultDisplayBufferCompositorFactory(
         std::shared_ptr<renderer::RendererFactory> const& renderer_factory,
-        std::shared_ptr<CompositorReport> const& report);
+        std::shared_ptr<CompositorReport> const& report,
+        std::shared_ptr<ScreenCapture> const& capture = {});
 
     std::unique_ptr<DisplayBufferCompositor> create_compositor_for(graphics::DisplayBuffer& display_buffer);
 
 private:
     std::shared_ptr<renderer::RendererFactory> const renderer_factory;
     std::shared_ptr<CompositorReport> const report;
+    std::shared_ptr<ScreenCapture> const capture;
 };
 
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_scheduler.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+using namespace std::chrono;
+
+mc::FrameScheduler::FrameScheduler(nanoseconds safety_margin) :
+    safety_margin{safety_margin}
+{
+}
+
+void mc::FrameScheduler::composited(nanoseconds cost)
+{
+    costs[next_cost] = cost;
+    next_cost = (next_cost + 1) % costs.size();
+    cost_count = std::min(cost_count + 1, costs.size());
+}
+
+void mc::FrameScheduler::posted(Timestamp const& start)
+{
+    Unflipped frame{start, {}};
+
+    // Frames started long after the planned start (e.g. after idling) weren't planned
+    if (plan.is_set() && start.clock_id == plan.value().start.clock_id &&
+        start < plan.value().start + interval / 2)
+    {
+        frame.planned_vblank = plan.value().vblank;
+    }
+    plan = optional_value<Plan>{};
+
+    unflipped.push_back(frame);
+
+    // Platforms that can't always tell us about flips mustn't grow this forever
+    while (unflipped.size() > max_unflipped)
+        unflipped.pop_front();
+}
+
+auto mc::FrameScheduler::flipped(mg::Frame const& last) -> optional_value<nanoseconds>
+{
+    if (last.msc == last_flip.msc)
+        return {};  // Nothing new (or no flip information at all)
+
+    if (last_flip.msc && last.msc > last_flip.msc && last.ust.clock_id == last_flip.ust.clock_id)
+    {
+        auto const elapsed = last.ust - last_flip.ust;
+        if (elapsed > nanoseconds::zero())
+            interval = elapsed / (last.msc - last_flip.msc);
+    }
+    last_flip = last;
+
+    if (unflipped.empty())
+        return {};
+
+    auto const frame = unflipped.front();
+    unflipped.pop_front();
+
+    if (frame.start.clock_id != last.ust.clock_id || frame.start > last.ust)
+        return {};
+
+    if (frame.planned_vblank.is_set() && frame.planned_vblank.value().clock_id == last.ust.clock_id)
+    {
+        if (last.ust > frame.planned_vblank.value() + interval / 2)
+            headroom = std::min(headroom + miss_penalty, interval);
+        else
+            headroom = std::max(headroom - on_time_recovery, nanoseconds::zero());
+    }
+
+    return last.ust - frame.start;
+}
+
+auto mc::FrameScheduler::next_start(Timestamp const& now) -> optional_value<Timestamp>
+{
+    if (interval <= nanoseconds::zero() || now.clock_id != last_flip.ust.clock_id)
+        return {};
+
+    auto const budget = composition_cost(budget_percentile) + safety_margin + headroom;
+
+    // The first vblank after the last flip that we can still make...
+    auto const earliest_finish = now + budget;
+    int64_t vblanks_ahead = 1;
+    if (earliest_finish > last_flip.ust + interval)
+        vblanks_ahead = (earliest_finish - last_flip.ust + interval - nanoseconds{1}) / interval;
+
+    auto const vblank = last_flip.ust + interval * vblanks_ahead;
+    plan = Plan{vblank - budget, vblank};
+
+    return vblank - budget;
+}
+
+auto mc::FrameScheduler::composition_cost(double percentile) const -> nanoseconds
+{
+    if (!cost_count)
+        return nanoseconds::zero();
+
+    auto recent = costs;
+    auto const last = recent.begin() + cost_count;
+    auto const rank = recent.begin() + static_cast<size_t>(percentile * (cost_count - 1) + 0.5);
+    std::nth_element(recent.begin(), rank, last);
+
+    return *rank;
+}
+
+auto mc::FrameScheduler::refresh_interval() const -> nanoseconds
+{
+    return interval;
+}
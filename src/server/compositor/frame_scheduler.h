@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+#define MIR_COMPOSITOR_FRAME_SCHEDULER_H_
+
+#include "mir/graphics/frame.h"
+#include "mir/optional_value.h"
+
+#include <array>
+#include <chrono>
+#include <deque>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Decides when to start compositing the next frame of a display sync group.
+ *
+ * The group's page flips tell us when its vblanks happen and how far apart
+ * they are. Together with the cost of recent compositions (a high percentile
+ * of them, so the odd slow frame doesn't make us miss) that lets us sample
+ * the scene as late as possible while still making the next vblank.
+ *
+ * Each frame's composition start is matched to the page flip that showed it,
+ * giving the latency from sampling the scene to the frame reaching the screen.
+ * Frames that arrive a vblank later than planned (e.g. because the GPU took
+ * longer than compositing on the CPU did) add headroom to later schedules,
+ * which drains away again while frames are on time.
+ */
+class FrameScheduler
+{
+public:
+    using Timestamp = graphics::Frame::Timestamp;
+
+    /// \param safety_margin extra time allowed for posting the frame after compositing it
+    explicit FrameScheduler(std::chrono::nanoseconds safety_margin = std::chrono::milliseconds{1});
+
+    /// Records how long compositing a frame took
+    void composited(std::chrono::nanoseconds cost);
+
+    /**
+     * Records that the frame whose composition started at \a start has been
+     * posted. If the start came from next_start() the frame is expected on
+     * the vblank that was planned for it.
+     */
+    void posted(Timestamp const& start);
+
+    /**
+     * Records the group's most recently displayed frame.
+     *
+     * Whenever the msc changes the oldest posted frame is taken as flipped,
+     * whether or not a latency comes of it, so callers matching their own
+     * frames to flips should do so on the same condition.
+     *
+     * \return the latency from the start of composition to the page flip,
+     *         if the frame is newly displayed and one of ours
+     */
+    auto flipped(graphics::Frame const& last) -> optional_value<std::chrono::nanoseconds>;
+
+    /**
+     * When to start compositing the next frame, as late as possible while
+     * still expecting to make a vblank.
+     *
+     * \return the start time in the clock of the page flips, or nothing if
+     *         there haven't yet been enough page flips to predict the next
+     */
+    auto next_start(Timestamp const& now) -> optional_value<Timestamp>;
+
+    /// The cost of composition that a given fraction of recent frames came within
+    auto composition_cost(double percentile) const -> std::chrono::nanoseconds;
+
+    /// The observed time between vblanks, or zero if not yet known
+    auto refresh_interval() const -> std::chrono::nanoseconds;
+
+private:
+    /// The percentile of composition cost budgeted for
+    static double constexpr budget_percentile = 0.95;
+    /// Composition starts we're still waiting to see flipped
+    static size_t constexpr max_unflipped = 3;
+    /// Headroom added for each missed vblank, and drained for each frame on time
+    static std::chrono::nanoseconds constexpr miss_penalty{std::chrono::milliseconds{1}};
+    static std::chrono::nanoseconds constexpr on_time_recovery{std::chrono::microseconds{100}};
+
+    struct Plan
+    {
+        Timestamp start;
+        Timestamp vblank;
+    };
+
+    struct Unflipped
+    {
+        Timestamp start;
+        optional_value<Timestamp> planned_vblank;
+    };
+
+    std::chrono::nanoseconds const safety_margin;
+
+    std::array<std::chrono::nanoseconds, 64> costs{};
+    size_t cost_count{0};
+    size_t next_cost{0};
+
+    graphics::Frame last_flip;
+    std::chrono::nanoseconds interval{0};
+    std::chrono::nanoseconds headroom{0};
+
+    optional_value<Plan> plan;
+    std::deque<Unflipped> unflipped;
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_FRAME_SCHEDULER_H_
@@ -21,6 +21,7 @@
 #include "mir/graphics/graphic_buffer_allocator.h"
 #include "mir/frontend/event_sink.h"
 #include "schedule.h"
+#include "buffer_queue_statistics.h"
 #include <boost/throw_exception.hpp>
 #include <algorithm>
 
@@ -29,8 +30,10 @@ namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 
 mc::MultiMonitorArbiter::MultiMonitorArbiter(
-    std::shared_ptr<Schedule> const& schedule) :
-    schedule(schedule)
+    std::shared_ptr<Schedule> const& schedule,
+    std::shared_ptr<BufferQueueStatistics> const& statistics) :
+    schedule(schedule),
+    statistics(statistics)
 {
     // We're highly unlikely to have more than 6 outputs
     current_buffer_users.reserve(6);
@@ -51,10 +54,13 @@ std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::compositor_acquire(composit
         if (schedule->num_scheduled() > 0)
         {
             // Advance the current buffer
-            current_buffer = schedule->next_buffer();
-            clear_current_users();
+            advance_current_buffer(id);
         }
         // Otherwise leave the current buffer alone
+        else if (current_buffer && statistics)
+        {
+            statistics->reacquired(id, current_buffer->id());
+        }
     }
 
     // If there was no current buffer and we weren't able to set one, throw and exception
@@ -75,8 +81,7 @@ std::shared_ptr<mg::Buffer> mc::MultiMonitorArbiter::snapshot_acquire()
     {
         if (schedule->num_scheduled() > 0)
         {
-            current_buffer = schedule->next_buffer();
-            clear_current_users();
+            advance_current_buffer(nullptr);
         }
         else
         {
@@ -112,11 +117,25 @@ void mc::MultiMonitorArbiter::advance_schedule()
     std::lock_guard<decltype(mutex)> lk(mutex);
     if (schedule->num_scheduled() > 0)
     {
-        current_buffer = schedule->next_buffer();
-        clear_current_users();
+        advance_current_buffer(nullptr);
     } 
 }
 
+void mc::MultiMonitorArbiter::advance_current_buffer(mc::CompositorID id)
+{
+    auto const next = schedule->next_buffer();
+
+    if (statistics)
+    {
+        if (current_buffer)
+            statistics->released(current_buffer->id());
+        statistics->acquired(id, next->id(), mir::time::PosixTimestamp::now(CLOCK_MONOTONIC));
+    }
+
+    current_buffer = next;
+    clear_current_users();
+}
+
 void mc::MultiMonitorArbiter::add_current_buffer_user(mc::CompositorID id)
 {
     // First try and find an empty slot in our vector…
@@ -33,12 +33,14 @@ namespace frontend { class ClientBuffers; }
 namespace compositor
 {
 class Schedule;
+class BufferQueueStatistics;
 
 class MultiMonitorArbiter : public BufferAcquisition 
 {
 public:
     MultiMonitorArbiter(
-        std::shared_ptr<Schedule> const& schedule);
+        std::shared_ptr<Schedule> const& schedule,
+        std::shared_ptr<BufferQueueStatistics> const& statistics = {});
     ~MultiMonitorArbiter();
 
     std::shared_ptr<graphics::Buffer> compositor_acquire(compositor::CompositorID id) override;
@@ -48,6 +50,7 @@ public:
     void advance_schedule();
 
 private:
+    void advance_current_buffer(compositor::CompositorID id);
     void add_current_buffer_user(compositor::CompositorID id);
     bool is_user_of_current_buffer(compositor::CompositorID id);
     void clear_current_users();
@@ -56,6 +59,7 @@ private:
     std::shared_ptr<graphics::Buffer> current_buffer;
     std::vector<std::experimental::optional<compositor::CompositorID>> current_buffer_users;
     std::shared_ptr<Schedule> schedule;
+    std::shared_ptr<BufferQueueStatistics> const statistics;
 };
 
 }
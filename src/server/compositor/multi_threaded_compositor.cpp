@@ -17,8 +17,10 @@
  */
 
 #include "multi_threaded_compositor.h"
+#include "frame_scheduler.h"
 #include "mir/graphics/display.h"
 #include "mir/graphics/display_buffer.h"
+#include "mir/graphics/presentation.h"
 #include "mir/compositor/display_buffer_compositor.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/compositor/display_listener.h"
@@ -110,6 +112,10 @@ public:
 
         started.set_value();
 
+        FrameScheduler scheduler;
+        auto clock_id = group.last_frame().ust.clock_id;
+        int64_t presented_msc{0};
+
         try
         {
             std::unique_lock<std::mutex> lock{run_mutex};
@@ -135,12 +141,47 @@ public:
                     not_posted_yet = false;
                     lock.unlock();
 
+                    auto const start = FrameScheduler::Timestamp::now(clock_id);
                     for (auto& tuple : compositors)
                     {
                         auto& compositor = std::get<1>(tuple);
                         compositor->composite(scene->scene_elements_for(compositor.get()));
                     }
+                    scheduler.composited(FrameScheduler::Timestamp::now(clock_id) - start);
+
                     group.post();
+                    scheduler.posted(start);
+
+                    auto const last_frame = group.last_frame();
+                    clock_id = last_frame.ust.clock_id;
+                    auto const latency = scheduler.flipped(last_frame);
+                    if (last_frame.msc != presented_msc)
+                    {
+                        /*
+                         * Each flip accounts for the oldest frame still waiting, as it
+                         * does in the scheduler, even when it can't tell the latency.
+                         * Anything else would leave the compositors a frame behind.
+                         */
+                        presented_msc = last_frame.msc;
+                        mg::Presentation const presentation{
+                            last_frame, scheduler.refresh_interval(), group.presentation_flags()};
+
+                        for (auto& compositor : compositors)
+                        {
+                            std::get<1>(compositor)->presented(presentation);
+                            if (latency)
+                                report->presented_frame(std::get<1>(compositor).get(), latency.value());
+                        }
+                    }
+                    else if (!last_frame.msc)
+                    {
+                        // Without page flip information, posting is as close as we get
+                        mg::Presentation presentation;
+                        presentation.frame.ust = FrameScheduler::Timestamp::now(clock_id);
+
+                        for (auto& compositor : compositors)
+                            std::get<1>(compositor)->presented(presentation);
+                    }
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -148,10 +189,23 @@ public:
                      * beneficial to sleep for most of the next frame. This reduces
                      * the latency between snapshotting the scene and post()
                      * completing by almost a whole frame.
+                     *   Where the group reports its page flips we know when the
+                     * next vblank is and how long compositing takes, so we can
+                     * wake just in time for it. Otherwise the platform's
+                     * recommended_sleep() is the best guess we have.
                      */
-                    auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
-                                 force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
+                    if (force_sleep >= std::chrono::milliseconds::zero())
+                    {
+                        std::this_thread::sleep_for(force_sleep);
+                    }
+                    else if (auto const next_start = scheduler.next_start(FrameScheduler::Timestamp::now(clock_id)))
+                    {
+                        mir::time::sleep_until(next_start.value());
+                    }
+                    else
+                    {
+                        std::this_thread::sleep_for(group.recommended_sleep());
+                    }
 
                     lock.lock();
 
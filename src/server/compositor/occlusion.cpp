@@ -17,10 +17,14 @@
  */
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
+#include "mir/graphics/presentation.h"
 #include "occlusion.h"
 
+#include <functional>
+#include <memory>
 #include <vector>
 
 using namespace mir::geometry;
@@ -29,37 +33,95 @@ using namespace mir::compositor;
 
 namespace
 {
-bool renderable_is_occluded(
-    Renderable const& renderable, 
+/**
+ * Presents an element with its renderable's clip area narrowed to the part left
+ * visible. Being both the element and the renderable, it costs one allocation.
+ */
+class ClippedSceneElement :
+    public SceneElement,
+    public Renderable,
+    public std::enable_shared_from_this<ClippedSceneElement>
+{
+public:
+    ClippedSceneElement(std::shared_ptr<SceneElement> element, Rectangle const& clip) :
+        element{std::move(element)},
+        original{this->element->renderable()},
+        clip{clip}
+    {
+    }
+
+    std::shared_ptr<Renderable> renderable() const override
+    {
+        return std::const_pointer_cast<ClippedSceneElement>(shared_from_this());
+    }
+    void rendered() override { element->rendered(); }
+    void occluded() override { element->occluded(); }
+
+    ID id() const override { return original->id(); }
+    std::shared_ptr<Buffer> buffer() const override { return original->buffer(); }
+    std::experimental::optional<Rectangles> damage_since(BufferID earlier) const override
+    {
+        return original->damage_since(earlier);
+    }
+    Rectangle screen_position() const override { return original->screen_position(); }
+    std::experimental::optional<Rectangle> clip_area() const override { return clip; }
+    float alpha() const override { return original->alpha(); }
+    glm::mat4 transformation() const override { return original->transformation(); }
+    bool shaped() const override { return original->shaped(); }
+    Rectangles opaque_region() const override { return original->opaque_region(); }
+    unsigned int swap_interval() const override { return original->swap_interval(); }
+    std::function<void(Presentation const&)> on_presented() const override
+    {
+        return original->on_presented();
+    }
+
+private:
+    std::shared_ptr<SceneElement> const element;
+    std::shared_ptr<Renderable> const original;
+    Rectangle const clip;
+};
+
+Rectangle drawn_area_of(Renderable const& renderable, Rectangle const& area)
+{
+    auto drawn = renderable.screen_position().intersection_with(area);
+    if (auto const clip = renderable.clip_area())
+        drawn = drawn.intersection_with(clip.value());
+    return drawn;
+}
+
+/**
+ * Works out how much of renderable remains visible below coverage, and adds
+ * whatever it hides itself to coverage.
+ *
+ * coverage is kept free of overlaps without ever being rebuilt: the visible
+ * part of each renderable doesn't overlap it, so neither do the opaque pieces
+ * of that which are appended to it.
+ *
+ * \return the bounding box of the visible part, empty if occluded, or nullopt
+ *         if there's no telling (transformed renderables)
+ */
+std::experimental::optional<Rectangle> visible_part_of(
+    Renderable const& renderable,
     Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+    Rectangles& coverage)
 {
     static glm::mat4 const identity(1);
-    static Rectangle const empty{};
 
     if (renderable.transformation() != identity)
-        return false;  // Weirdly transformed. Assume never occluded.
+        return {};  // Weirdly transformed. Assume never occluded.
 
-    auto const& window = renderable.screen_position();
-    auto const& clipped_window = window.intersection_with(area);
+    auto const visible_area = drawn_area_of(renderable, area);
+    auto const visible = difference_of(Rectangles{visible_area}, coverage);
+    if (visible.size() == 0)
+        return Rectangle{};
 
-    if (clipped_window == empty)
-        return true;  // Not in the area; definitely occluded.
-
-    bool occluded = false;
-    for (auto const& r : coverage)
+    if (renderable.alpha() == 1.0f)
     {
-        if (r.contains(clipped_window))
-        {
-            occluded = true;
-            break;
-        }
+        for (auto const& piece : intersection_of(renderable.opaque_region(), visible))
+            coverage.add(piece);
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
-
-    return occluded;
+    return visible.bounding_rectangle();
 }
 }
 
@@ -67,23 +129,44 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     SceneElementSequence& elements,
     Rectangle const& area)
 {
+    static Rectangle const empty{};
+
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    Rectangles coverage;
 
-    auto it = elements.rbegin();
-    while (it != elements.rend())
+    // Work top-down, but build the results bottom-up without shuffling
+    // elements around one at a time.
+    std::vector<bool> is_occluded(elements.size(), false);
+    for (auto i = elements.size(); i-- != 0;)
     {
-        auto const renderable = (*it)->renderable();
-        if (renderable_is_occluded(*renderable, area, coverage))
+        auto& element = elements[i];
+        auto const renderable = element->renderable();
+        auto const visible = visible_part_of(*renderable, area, coverage);
+
+        if (!visible)
+            continue;
+
+        if (visible.value() == empty)
         {
-            occluded.insert(occluded.begin(), *it);
-            it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
+            is_occluded[i] = true;
         }
-        else
+        else if (visible.value() != drawn_area_of(*renderable, area))
         {
-            it++;
+            // Partly covered: there's no point drawing what can't be seen
+            element = std::make_shared<ClippedSceneElement>(element, visible.value());
         }
     }
 
+    SceneElementSequence remaining;
+    remaining.reserve(elements.size());
+    for (auto i = 0u; i != elements.size(); ++i)
+    {
+        if (is_occluded[i])
+            occluded.push_back(std::move(elements[i]));
+        else
+            remaining.push_back(std::move(elements[i]));
+    }
+    elements.swap(remaining);
+
     return occluded;
 }
@@ -26,6 +26,14 @@ namespace mir
 namespace compositor
 {
 
+/**
+ * Removes the elements hidden by the opaque parts of those above them.
+ *
+ * Elements that remain only partly visible are replaced by ones whose
+ * renderable is clipped to the bounding box of the visible part.
+ *
+ * \return the elements removed, bottom-most first
+ */
 SceneElementSequence filter_occlusions_from(SceneElementSequence& list, geometry::Rectangle const& area);
 
 } // namespace compositor
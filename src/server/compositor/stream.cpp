@@ -21,7 +21,10 @@
 #include "queueing_schedule.h"
 #include "dropping_schedule.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/presentation.h"
 #include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <iterator>
 
 namespace mc = mir::compositor;
 namespace geom = mir::geometry;
@@ -29,16 +32,23 @@ namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
 
+namespace
+{
+// Enough to cover any client cycling through a swapchain
+unsigned const max_remembered_submissions{8};
+}
+
 enum class mc::Stream::ScheduleMode {
     Queueing,
     Dropping
 };
 
 mc::Stream::Stream(
-    geom::Size size, MirPixelFormat pf) :
+    geom::Size size, MirPixelFormat pf, std::shared_ptr<CompositorReport> const& report) :
     schedule_mode(ScheduleMode::Queueing),
     schedule(std::make_shared<mc::QueueingSchedule>()),
-    arbiter(std::make_shared<mc::MultiMonitorArbiter>(schedule)),
+    statistics(std::make_shared<mc::BufferQueueStatistics>(this, report)),
+    arbiter(std::make_shared<mc::MultiMonitorArbiter>(schedule, statistics)),
     latest_buffer_size(size),
     pf(pf),
     first_frame_posted(false),
@@ -46,20 +56,62 @@ mc::Stream::Stream(
 {
 }
 
-mc::Stream::~Stream() = default;
+mc::Stream::~Stream()
+{
+    // Anything not shown by now never will be
+    for (auto const& pending : presentation_callbacks)
+        pending.callback(nullptr);
+}
 
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    if (!buffer)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
+
+    submit_buffer(buffer, geom::Rectangles{{{}, buffer->size()}});
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
 
     {
         std::lock_guard<decltype(mutex)> lk(mutex);
+        geom::Rectangle const whole_buffer{{}, buffer->size()};
+        if (first_frame_posted && buffer->size() == latest_buffer_size && buffer->pixel_format() == pf)
+            submissions.push_back({buffer->id(), damage});
+        else
+            submissions.push_back({buffer->id(), geom::Rectangles{whole_buffer}});
+
+        if (submissions.size() > max_remembered_submissions)
+            submissions.pop_front();
+
         pf = buffer->pixel_format();
         latest_buffer_size = buffer->size();
+        statistics->submitted(buffer->id(), time::PosixTimestamp::now(CLOCK_MONOTONIC));
         schedule->schedule(buffer);
         first_frame_posted = true;
     }
+    std::vector<PresentationCallback> forgotten;
+    {
+        std::lock_guard<decltype(presentation_mutex)> lock{presentation_mutex};
+        recent_submissions.push_back({buffer->id(), ++submission_count, false});
+        if (recent_submissions.size() > max_remembered_submissions)
+        {
+            // Its presentation can no longer be matched; this also bounds what a never shown surface keeps
+            auto const oldest = recent_submissions.front().number;
+            recent_submissions.pop_front();
+
+            auto const done = std::stable_partition(
+                presentation_callbacks.begin(), presentation_callbacks.end(),
+                [&](PresentationCallback const& pending) { return pending.submission > oldest; });
+            forgotten.assign(std::make_move_iterator(done), std::make_move_iterator(presentation_callbacks.end()));
+            presentation_callbacks.erase(done, presentation_callbacks.end());
+        }
+    }
+    for (auto const& pending : forgotten)
+        pending.callback(nullptr);
     {
         std::lock_guard<decltype(callback_mutex)> lock{callback_mutex};
         frame_callback(buffer->size());
@@ -87,7 +139,39 @@ void mc::Stream::set_frame_posted_callback(
 
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    auto const buffer = arbiter->compositor_acquire(id);
+
+    std::vector<PresentationCallback> dropped;
+    {
+        std::lock_guard<decltype(presentation_mutex)> lock{presentation_mutex};
+
+        auto const acquired = std::find_if(recent_submissions.rbegin(), recent_submissions.rend(),
+            [&](RecentSubmission const& s) { return s.id == buffer->id(); });
+        if (acquired != recent_submissions.rend() && !acquired->acquired)
+        {
+            acquired->acquired = true;
+
+            // Earlier submissions no compositor took were replaced, so they won't be shown
+            auto const was_acquired = [this](uint64_t number)
+                {
+                    auto const s = std::find_if(recent_submissions.begin(), recent_submissions.end(),
+                        [&](RecentSubmission const& s) { return s.number == number; });
+                    return s != recent_submissions.end() && s->acquired;
+                };
+            auto const done = std::stable_partition(
+                presentation_callbacks.begin(), presentation_callbacks.end(),
+                [&](PresentationCallback const& pending)
+                {
+                    return pending.submission >= acquired->number || was_acquired(pending.submission);
+                });
+            dropped.assign(std::make_move_iterator(done), std::make_move_iterator(presentation_callbacks.end()));
+            presentation_callbacks.erase(done, presentation_callbacks.end());
+        }
+    }
+    for (auto const& pending : dropped)
+        pending.callback(nullptr);
+
+    return buffer;
 }
 
 geom::Size mc::Stream::stream_size()
@@ -160,8 +244,93 @@ bool mc::Stream::has_submitted_buffer() const
     return first_frame_posted;
 }
 
+auto mc::Stream::damage_between(mg::BufferID earlier, mg::BufferID later) const
+    -> std::experimental::optional<geom::Rectangles>
+{
+    if (earlier == later)
+        return geom::Rectangles{};
+
+    std::lock_guard<decltype(mutex)> lk(mutex);
+
+    // Buffers may be resubmitted, so we want the most recent submissions
+    auto const last = std::find_if(submissions.rbegin(), submissions.rend(),
+        [&](Submission const& s) { return s.id == later; });
+    auto const first = std::find_if(last, submissions.rend(),
+        [&](Submission const& s) { return s.id == earlier; });
+
+    if (first == submissions.rend())
+        return std::experimental::nullopt;
+
+    geom::Rectangles damage;
+    for (auto i = last; i != first; ++i)
+    {
+        for (auto const& rect : i->damage)
+            damage.add(rect);
+    }
+
+    return damage;
+}
+
 void mc::Stream::set_scale(float scale)
 {
     std::lock_guard<decltype(mutex)> lk(mutex);
     scale_ = scale;
 }
+
+void mc::Stream::set_opaque_region(geom::Rectangles const& region)
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    opaque_region_ = region;
+}
+
+auto mc::Stream::opaque_region() const -> geom::Rectangles
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    return opaque_region_;
+}
+
+void mc::Stream::add_presentation_callback(std::function<void(mg::Presentation const*)> const& callback)
+{
+    std::lock_guard<decltype(presentation_mutex)> lock{presentation_mutex};
+    presentation_callbacks.push_back({submission_count, callback});
+}
+
+void mc::Stream::presented(mg::BufferID id, mg::Presentation const& presentation)
+{
+    // Submissions are timed on CLOCK_MONOTONIC; if the display uses another clock "now" is close enough
+    auto const& shown_at = presentation.frame.ust;
+    statistics->presented(
+        id,
+        shown_at.clock_id == CLOCK_MONOTONIC && shown_at.nanoseconds.count() ?
+            shown_at : time::PosixTimestamp::now(CLOCK_MONOTONIC));
+
+    std::vector<PresentationCallback> shown;
+    uint64_t submission;
+    {
+        std::lock_guard<decltype(presentation_mutex)> lock{presentation_mutex};
+        if (presentation_callbacks.empty())
+            return;
+
+        // Buffers may be resubmitted, so we want the most recent submission
+        auto const submitted = std::find_if(recent_submissions.rbegin(), recent_submissions.rend(),
+            [&](RecentSubmission const& s) { return s.id == id; });
+        if (submitted == recent_submissions.rend())
+            return;
+
+        submission = submitted->number;
+        auto const done = std::stable_partition(
+            presentation_callbacks.begin(), presentation_callbacks.end(),
+            [&](PresentationCallback const& pending) { return pending.submission > submission; });
+        shown.assign(std::make_move_iterator(done), std::make_move_iterator(presentation_callbacks.end()));
+        presentation_callbacks.erase(done, presentation_callbacks.end());
+    }
+
+    // Earlier submissions were replaced without being shown
+    for (auto const& pending : shown)
+        pending.callback(pending.submission == submission ? &presentation : nullptr);
+}
+
+auto mc::Stream::queue_stats() const -> BufferQueueStats
+{
+    return statistics->stats();
+}
@@ -26,9 +26,12 @@
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
 #include "multi_monitor_arbiter.h"
+#include "buffer_queue_statistics.h"
+#include <deque>
 #include <mutex>
 #include <memory>
 #include <set>
+#include <vector>
 
 namespace mir
 {
@@ -36,13 +39,17 @@ namespace frontend { class ClientBuffers; }
 namespace compositor
 {
 class Schedule;
+class CompositorReport;
 class Stream : public BufferStream
 {
 public:
-    Stream(geometry::Size sz, MirPixelFormat format);
+    Stream(geometry::Size sz, MirPixelFormat format, std::shared_ptr<CompositorReport> const& report);
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
@@ -56,6 +63,14 @@ public:
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    void set_opaque_region(geometry::Rectangles const& region) override;
+    auto opaque_region() const -> geometry::Rectangles override;
+    auto damage_between(graphics::BufferID earlier, graphics::BufferID later) const
+        -> std::experimental::optional<geometry::Rectangles> override;
+    void add_presentation_callback(
+        std::function<void(graphics::Presentation const*)> const& callback) override;
+    void presented(graphics::BufferID id, graphics::Presentation const& presentation) override;
+    auto queue_stats() const -> BufferQueueStats override;
 
 private:
     enum class ScheduleMode;
@@ -64,14 +79,42 @@ private:
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
     std::shared_ptr<Schedule> schedule;
+    std::shared_ptr<BufferQueueStatistics> const statistics;
     std::shared_ptr<MultiMonitorArbiter> const arbiter;
     geometry::Size latest_buffer_size;
     float scale_{1.0f};
+    geometry::Rectangles opaque_region_;
     MirPixelFormat pf;
     std::atomic<bool> first_frame_posted;
 
+    struct Submission
+    {
+        graphics::BufferID id;
+        geometry::Rectangles damage;
+    };
+    /// Damage of the most recent submissions, oldest first
+    std::deque<Submission> submissions;
+
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
+
+    struct PresentationCallback
+    {
+        uint64_t submission;
+        std::function<void(graphics::Presentation const*)> callback;
+    };
+    struct RecentSubmission
+    {
+        graphics::BufferID id;
+        uint64_t number;
+        bool acquired;  ///< By any compositor
+    };
+    std::mutex presentation_mutex; // Protects the following...
+    uint64_t submission_count{0};
+    /// The most recent submissions, oldest first
+    std::deque<RecentSubmission> recent_submissions;
+    /// Waiting for their submissions to be shown, oldest first
+    std::vector<PresentationCallback> presentation_callbacks;
 };
 }
 }
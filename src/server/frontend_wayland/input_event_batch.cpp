@@ -0,0 +1,151 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_event_batch.h"
+
+#include "mir/events/event_builders.h"
+#include "mir/events/pointer_event.h"
+#include "mir/events/touch_event.h"
+
+namespace mf = mir::frontend;
+namespace mev = mir::events;
+
+namespace
+{
+auto is_motion(MirPointerEvent const& event) -> bool
+{
+    return event.action() == mir_pointer_action_motion;
+}
+
+auto is_motion(MirTouchEvent const& event) -> bool
+{
+    for (size_t i = 0; i != event.pointer_count(); ++i)
+    {
+        if (event.action(i) != mir_touch_action_change)
+            return false;
+    }
+    return event.pointer_count() != 0;
+}
+
+auto same_touch_points(MirTouchEvent const& a, MirTouchEvent const& b) -> bool
+{
+    if (a.pointer_count() != b.pointer_count())
+        return false;
+
+    for (size_t i = 0; i != a.pointer_count(); ++i)
+    {
+        if (a.id(i) != b.id(i))
+            return false;
+    }
+    return true;
+}
+
+/// Whether next is motion that can be merged into (the merged motion in) previous
+auto can_merge(MirEvent const& previous, MirEvent const& next) -> bool
+{
+    if (previous.type() != mir_event_type_input || next.type() != mir_event_type_input)
+        return false;
+
+    auto const& prev_input = *previous.to_input();
+    auto const& next_input = *next.to_input();
+
+    if (prev_input.input_type() != next_input.input_type() ||
+        prev_input.device_id() != next_input.device_id() ||
+        prev_input.modifiers() != next_input.modifiers())
+        return false;
+
+    switch (next_input.input_type())
+    {
+    case mir_input_event_type_pointer:
+    {
+        auto const& prev_pointer = *prev_input.to_pointer();
+        auto const& next_pointer = *next_input.to_pointer();
+        return is_motion(prev_pointer) && is_motion(next_pointer) &&
+               prev_pointer.buttons() == next_pointer.buttons();
+    }
+
+    case mir_input_event_type_touch:
+    {
+        auto const& prev_touch = *prev_input.to_touch();
+        auto const& next_touch = *next_input.to_touch();
+        return is_motion(prev_touch) && is_motion(next_touch) && same_touch_points(prev_touch, next_touch);
+    }
+
+    default:
+        return false;
+    }
+}
+
+/// Makes the event sent in place of previous and next: next, plus anything in previous that is relative
+auto merge(MirEvent const& previous, MirEvent const& next) -> std::shared_ptr<MirEvent const>
+{
+    std::shared_ptr<MirEvent> merged = mev::clone_event(next);
+
+    auto const input = merged->to_input();
+    if (input->input_type() == mir_input_event_type_pointer)
+    {
+        auto const& prev_pointer = *previous.to_input()->to_pointer();
+        auto const pointer = input->to_pointer();
+        pointer->set_dx(prev_pointer.dx() + pointer->dx());
+        pointer->set_dy(prev_pointer.dy() + pointer->dy());
+        pointer->set_hscroll(prev_pointer.hscroll() + pointer->hscroll());
+        pointer->set_vscroll(prev_pointer.vscroll() + pointer->vscroll());
+    }
+    // Touch positions are absolute, so the latest are all that matter
+
+    return merged;
+}
+}
+
+mf::InputEventBatch::InputEventBatch(bool coalesce_motion)
+    : coalesce_motion{coalesce_motion}
+{
+}
+
+auto mf::InputEventBatch::add(MirEvent const& event) -> bool
+{
+    return add(std::shared_ptr<MirEvent>{mev::clone_event(event)});
+}
+
+auto mf::InputEventBatch::add(std::shared_ptr<MirEvent> event) -> bool
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    bool const was_empty = entries.empty();
+
+    if (coalesce_motion && !was_empty && can_merge(*entries.back().event, *event))
+    {
+        auto& last = entries.back();
+        if (last.history.empty())
+            last.history.push_back(last.event);
+        last.event = merge(*last.event, *event);
+        last.history.push_back(std::move(event));
+    }
+    else
+    {
+        entries.push_back({std::move(event), {}});
+    }
+
+    return was_empty;
+}
+
+auto mf::InputEventBatch::take() -> std::vector<Entry>
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+    std::vector<Entry> result;
+    result.swap(entries);
+    return result;
+}
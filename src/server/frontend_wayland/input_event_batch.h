@@ -0,0 +1,72 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_INPUT_EVENT_BATCH_H_
+#define MIR_FRONTEND_INPUT_EVENT_BATCH_H_
+
+#include "mir_toolkit/event.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mir
+{
+namespace frontend
+{
+/// Input events waiting for the Wayland thread to send them to a client
+///
+/// Events are added from the input thread and taken together from the Wayland
+/// thread, so a client gets whatever arrived in between in one go. If motion
+/// coalescing is enabled, pointer or touch motion that arrives while the
+/// previous event is still waiting and is also motion (with the same buttons,
+/// modifiers and touch points) is merged into it: the client then gets one
+/// wl_pointer.frame or wl_touch.frame for the lot. Any other event ends the
+/// merging, so buttons, keys and touch down/up stay in order with the motion
+/// around them.
+class InputEventBatch
+{
+public:
+    struct Entry
+    {
+        std::shared_ptr<MirEvent const> event;
+
+        /// The events merged into event, oldest first (empty if nothing was merged)
+        std::vector<std::shared_ptr<MirEvent const>> history;
+    };
+
+    explicit InputEventBatch(bool coalesce_motion);
+
+    /// Adds (a copy of) an input event
+    /// \returns true if the batch was empty, so the caller needs to arrange for it to be taken
+    auto add(MirEvent const& event) -> bool;
+
+    /// Adds an input event the caller has already copied
+    auto add(std::shared_ptr<MirEvent> event) -> bool;
+
+    /// Takes the waiting events, oldest first, leaving the batch empty
+    auto take() -> std::vector<Entry>;
+
+private:
+    bool const coalesce_motion;
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+};
+}
+}
+
+#endif // MIR_FRONTEND_INPUT_EVENT_BATCH_H_
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "presentation_time.h"
+#include "presentation-time_wrapper.h"
+#include "wl_surface.h"
+
+#include <mir/graphics/presentation.h>
+
+#include <ctime>
+
+namespace mg = mir::graphics;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class WpPresentation : public wayland::Presentation
+{
+public:
+    WpPresentation(wl_resource* resource);
+
+    class Global : public wayland::Presentation::Global
+    {
+    public:
+        Global(wl_display* display);
+
+    private:
+        void bind(wl_resource* new_wp_presentation) override;
+    };
+
+private:
+    void destroy() override;
+
+    void feedback(wl_resource* surface, wl_resource* callback) override;
+};
+}
+}
+
+namespace
+{
+/// All feedback is given in this clock, which is what the platforms use anyway
+clockid_t const presentation_clock = CLOCK_MONOTONIC;
+
+auto in_presentation_clock(mir::time::PosixTimestamp const& t) -> std::chrono::nanoseconds
+{
+    if (t.clock_id == presentation_clock)
+        return t.nanoseconds;
+
+    auto const now = mir::time::PosixTimestamp::now(t.clock_id);
+    return mir::time::PosixTimestamp::now(presentation_clock).nanoseconds - (now - t);
+}
+
+void send_feedback(mw::PresentationFeedback const& feedback, mg::Presentation const& presentation)
+{
+    auto const timestamp = in_presentation_clock(presentation.frame.ust);
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
+    auto const nanoseconds = timestamp - seconds;
+    auto const seq = static_cast<uint64_t>(presentation.frame.msc);
+
+    feedback.send_presented_event(
+        static_cast<uint32_t>(static_cast<uint64_t>(seconds.count()) >> 32),
+        static_cast<uint32_t>(seconds.count()),
+        static_cast<uint32_t>(nanoseconds.count()),
+        static_cast<uint32_t>(presentation.refresh.count()),
+        static_cast<uint32_t>(seq >> 32),
+        static_cast<uint32_t>(seq),
+        presentation.flags);
+}
+}
+
+auto mir::frontend::create_presentation_time(wl_display* display) -> std::shared_ptr<void>
+{
+    return std::make_shared<WpPresentation::Global>(display);
+}
+
+mir::frontend::WpPresentation::Global::Global(wl_display* display) :
+    wayland::Presentation::Global::Global{display, Version<1>{}}
+{
+}
+
+void mir::frontend::WpPresentation::Global::bind(wl_resource* new_wp_presentation)
+{
+    auto const presentation = new WpPresentation{new_wp_presentation};
+    presentation->send_clock_id_event(presentation_clock);
+}
+
+mir::frontend::WpPresentation::WpPresentation(wl_resource* resource) :
+    wayland::Presentation{resource, Version<1>{}}
+{
+}
+
+void mir::frontend::WpPresentation::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mir::frontend::WpPresentation::feedback(wl_resource* surface, wl_resource* callback)
+{
+    auto const feedback = mw::make_weak(new mw::PresentationFeedback{callback, Version<1>{}});
+
+    // Called on the Wayland thread once the content committed with the feedback request is
+    // on screen, or with nullptr if it never will be
+    WlSurface::from(surface)->add_presentation_feedback(
+        [feedback](mg::Presentation const* presentation)
+        {
+            if (!feedback)
+                return;
+
+            if (presentation)
+                send_feedback(feedback.value(), *presentation);
+            else
+                feedback.value().send_discarded_event();
+
+            feedback.value().destroy_wayland_object();
+        });
+}
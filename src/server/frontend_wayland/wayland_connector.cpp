@@ -493,7 +493,9 @@ mf::WaylandConnector::WaylandConnector(
     std::shared_ptr<mf::SessionAuthorizer> const& session_authorizer,
     std::shared_ptr<SurfaceStack> const& surface_stack,
     std::shared_ptr<ms::Clipboard> const& clipboard,
+    std::shared_ptr<mc::ScreenCapture> const& screen_capture,
     bool arw_socket,
+    bool coalesce_input_motion,
     std::unique_ptr<WaylandExtensions> extensions_,
     WaylandProtocolExtensionFilter const& extension_filter)
     : display{wl_display_create(), &cleanup_display},
@@ -544,7 +546,7 @@ mf::WaylandConnector::WaylandConnector(
         executor,
         this->allocator);
     subcompositor_global = std::make_unique<mf::WlSubcompositor>(display.get());
-    seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat);
+    seat_global = std::make_unique<mf::WlSeat>(display.get(), input_hub, seat, coalesce_input_motion);
     output_manager = std::make_unique<mf::OutputManager>(
         display.get(),
         display_config,
@@ -559,7 +561,8 @@ mf::WaylandConnector::WaylandConnector(
         clipboard,
         seat_global.get(),
         output_manager.get(),
-        surface_stack});
+        surface_stack,
+        screen_capture});
 
     wl_display_init_shm(display.get());
 
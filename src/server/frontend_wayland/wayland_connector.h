@@ -42,6 +42,10 @@ namespace graphics
 {
 class GraphicBufferAllocator;
 }
+namespace compositor
+{
+class ScreenCapture;
+}
 namespace geometry
 {
 struct Size;
@@ -80,6 +84,7 @@ public:
         WlSeat* seat;
         OutputManager* output_manager;
         std::shared_ptr<SurfaceStack> surface_stack;
+        std::shared_ptr<compositor::ScreenCapture> screen_capture;
     };
 
     WaylandExtensions() = default;
@@ -116,7 +121,9 @@ public:
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<SurfaceStack> const& surface_stack,
         std::shared_ptr<scene::Clipboard> const& clipboard,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture,
         bool arw_socket,
+        bool coalesce_input_motion,
         std::unique_ptr<WaylandExtensions> extensions,
         WaylandProtocolExtensionFilter const& extension_filter);
 
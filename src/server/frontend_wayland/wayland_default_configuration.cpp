@@ -34,6 +34,10 @@
 #include "pointer_constraints_unstable_v1.h"
 #include "relative-pointer-unstable-v1_wrapper.h"
 #include "relative_pointer_unstable_v1.h"
+#include "presentation-time_wrapper.h"
+#include "presentation_time.h"
+#include "wlr-screencopy-unstable-v1_wrapper.h"
+#include "wlr_screencopy_v1.h"
 
 #include "mir/graphics/platform.h"
 #include "mir/options/default_configuration.h"
@@ -123,6 +127,20 @@ std::vector<ExtensionBuilder> const internal_extension_builders = {
         mw::PointerConstraintsV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
             { return mf::create_pointer_constraints_unstable_v1(ctx.display, *ctx.wayland_executor, ctx.shell); }
     },
+    {
+        mw::Presentation::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            { return mf::create_presentation_time(ctx.display); }
+    },
+    {
+        mw::ScreencopyManagerV1::interface_name, [](auto const& ctx) -> std::shared_ptr<void>
+            {
+                return mf::create_wlr_screencopy_manager_v1(
+                    ctx.display,
+                    ctx.wayland_executor,
+                    ctx.output_manager,
+                    ctx.screen_capture);
+            }
+    },
 };
 
 ExtensionBuilder const xwayland_builder {
@@ -217,7 +235,8 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
         mw::XdgShellV6::interface_name,
-        mw::XdgOutputManagerV1::interface_name};
+        mw::XdgOutputManagerV1::interface_name,
+        mw::Presentation::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -256,7 +275,9 @@ std::shared_ptr<mf::Connector>
                 the_session_authorizer(),
                 the_frontend_surface_stack(),
                 the_clipboard(),
+                the_screen_capture(),
                 arw_socket,
+                options->get<bool>(options::coalesce_input_motion_opt),
                 configure_wayland_extensions(
                     wayland_extensions,
                     options->is_set(mo::x11_display_opt),
@@ -26,10 +26,11 @@
 #include <boost/throw_exception.hpp>
 
 #include <cstring>
-#include <deque>
 #include <functional>
 #include <mutex>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace mf = mir::frontend;
 
@@ -59,28 +60,34 @@ public:
     explicit State(wl_event_loop* loop)
         : loop{loop}
     {
-        enqueue(
+        // Runs along with the first work spawned
+        workqueue.emplace_back(
             []()
             {
                 on_wayland_thread = true;
             });
     }
 
-    void enqueue(std::function<void()>&& work)
+    /// \returns true if the event loop needs to be woken to process the work
+    bool enqueue(std::function<void()>&& work)
     {
         if (on_wayland_thread)
         {
             work();
-            return;
+            return false;
         }
 
         std::lock_guard<std::mutex> lock{mutex};
         if (state == ExecutionState::Running)
         {
             workqueue.emplace_back(std::move(work));
+
+            // Once woken, the event loop takes everything queued, so one wakeup per batch will do
+            return !std::exchange(wakeup_pending, true);
         }
         // If we've been terminated then drop the work on the floor, letting the
         // std::function destructor clean up any necessary state.
+        return false;
     }
 
     void enqueue_termination(std::function<void()>&& terminator)
@@ -88,22 +95,20 @@ public:
         std::lock_guard<std::mutex> lock{mutex};
         if (state == ExecutionState::Running)
         {
-            workqueue.emplace_front(std::move(terminator));
+            workqueue.emplace(workqueue.begin(), std::move(terminator));
             on_wayland_thread = false;
             state = ExecutionState::TerminationRequested;
         }
     }
 
-    std::function<void()> get_work()
+    /// Takes all the queued work (oldest first), so it can be run without holding the mutex
+    std::vector<std::function<void()>> take_work()
     {
+        std::vector<std::function<void()>> work;
         std::lock_guard<std::mutex> lock{mutex};
-        if (!workqueue.empty())
-        {
-            auto const work = std::move(workqueue.front());
-            workqueue.pop_front();
-            return work;
-        }
-        return {};
+        work.swap(workqueue);
+        wakeup_pending = false;
+        return work;
     }
 
     std::unique_lock<std::mutex> drain()
@@ -136,7 +141,8 @@ private:
     std::mutex mutex;
     ExecutionState state{ExecutionState::Running};
     wl_event_loop* const loop;
-    std::deque<std::function<void()>> workqueue;
+    std::vector<std::function<void()>> workqueue;
+    bool wakeup_pending{false};
 };
 
 thread_local bool mf::WaylandExecutor::State::on_wayland_thread{false};
@@ -233,19 +239,23 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
             err);
     }
 
-    while (auto work = state->get_work())
+    // Work spawned while a batch runs lands in the next batch, so each pass locks once however much is queued
+    for (auto batch = state->take_work(); !batch.empty(); batch = state->take_work())
     {
-        try
-        {
-            work();
-        }
-        catch (...)
+        for (auto& work : batch)
         {
-            mir::log(
-                mir::logging::Severity::critical,
-                MIR_LOG_COMPONENT,
-                std::current_exception(),
-                "Exception processing Wayland event loop work item");
+            try
+            {
+                work();
+            }
+            catch (...)
+            {
+                mir::log(
+                    mir::logging::Severity::critical,
+                    MIR_LOG_COMPONENT,
+                    std::current_exception(),
+                    "Exception processing Wayland event loop work item");
+            }
         }
     }
     if (state->state != ExecutionState::Running)
@@ -260,7 +270,7 @@ int mf::WaylandExecutor::State::on_notify(int fd, uint32_t, void* data)
 
 mf::WaylandExecutor::WaylandExecutor(wl_event_loop* loop)
     : state{std::make_shared<State>(loop)},
-      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_SEMAPHORE | EFD_NONBLOCK)},
+      notify_fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
       source{wl_event_loop_add_fd(
           loop,
           notify_fd,
@@ -319,7 +329,8 @@ mf::WaylandExecutor::~WaylandExecutor()
 
 void mf::WaylandExecutor::spawn (std::function<void()>&& work)
 {
-    state->enqueue(std::move(work));
+    if (!state->enqueue(std::move(work)))
+        return;
 
     if (auto err = eventfd_write(notify_fd, 1))
     {
@@ -74,6 +74,13 @@ void mf::WaylandInputDispatcher::set_focus(bool has_focus)
 }
 
 void mf::WaylandInputDispatcher::handle_event(MirInputEvent const* event)
+{
+    handle_event(event, {});
+}
+
+void mf::WaylandInputDispatcher::handle_event(
+    MirInputEvent const* event,
+    std::vector<std::shared_ptr<MirEvent const>> const& history)
 {
     if (!wl_surface)
     {
@@ -100,9 +107,14 @@ void mf::WaylandInputDispatcher::handle_event(MirInputEvent const* event)
     case mir_input_event_type_pointer:
     {
         auto const pointer_event = mir_input_event_get_pointer_event(event);
+        std::vector<MirPointerEvent const*> pointer_history;
+        for (auto const& past : history)
+        {
+            pointer_history.push_back(mir_input_event_get_pointer_event(mir_event_get_input_event(past.get())));
+        }
         seat->for_each_listener(client, [&](WlPointer* pointer)
             {
-                pointer->event(pointer_event, wl_surface.value());
+                pointer->event(pointer_event, wl_surface.value(), pointer_history);
             });
     }   break;
 
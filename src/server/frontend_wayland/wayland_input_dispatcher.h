@@ -26,6 +26,7 @@
 
 #include <memory>
 #include <chrono>
+#include <vector>
 #include <experimental/optional>
 
 struct wl_client;
@@ -54,6 +55,8 @@ public:
     void set_keymap(input::Keymap const& keymap);
     void set_focus(bool has_focus);
     void handle_event(MirInputEvent const* event);
+    /// history holds the events coalesced into event (see InputEventBatch), oldest first
+    void handle_event(MirInputEvent const* event, std::vector<std::shared_ptr<MirEvent const>> const& history);
 
     auto latest_timestamp() const -> std::chrono::nanoseconds { return timestamp; }
 
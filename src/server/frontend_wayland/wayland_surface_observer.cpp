@@ -20,16 +20,15 @@
 #include "wayland_surface_observer.h"
 #include "wayland_utils.h"
 #include "window_wl_surface_role.h"
+#include "wl_seat.h"
 
 #include <mir/executor.h>
-#include <mir/events/event_builders.h>
 #include <mir/input/keymap.h>
 #include <mir/log.h>
 
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
-namespace mev = mir::events;
 namespace mi = mir::input;
 namespace mw = mir::wayland;
 
@@ -41,7 +40,8 @@ mf::WaylandSurfaceObserver::WaylandSurfaceObserver(
     : wayland_executor{wayland_executor},
       impl{std::make_shared<Impl>(
           mw::make_weak(window),
-          std::make_unique<WaylandInputDispatcher>(seat, surface))}
+          std::make_unique<WaylandInputDispatcher>(seat, surface),
+          seat->coalesces_input_motion())}
 {
 }
 
@@ -128,15 +128,17 @@ void mf::WaylandSurfaceObserver::placed_relative(ms::Surface const*, geometry::R
 
 void mf::WaylandSurfaceObserver::input_consumed(ms::Surface const*, MirEvent const* event)
 {
-    if (mir_event_get_type(event) == mir_event_type_input)
+    // Only one batch at a time needs to wait for the Wayland thread: later events join it
+    if (mir_event_get_type(event) == mir_event_type_input && impl->input_batch.add(*event))
     {
-        std::shared_ptr<MirEvent> owned_event = mev::clone_event(*event);
-
         run_on_wayland_thread_unless_window_destroyed(
-            [owned_event](Impl* impl, WindowWlSurfaceRole*)
+            [](Impl* impl, WindowWlSurfaceRole*)
             {
-                auto const input_event = mir_event_get_input_event(owned_event.get());
-                impl->input_dispatcher->handle_event(input_event);
+                for (auto const& entry : impl->input_batch.take())
+                {
+                    auto const input_event = mir_event_get_input_event(entry.event.get());
+                    impl->input_dispatcher->handle_event(input_event, entry.history);
+                }
             });
     }
 }
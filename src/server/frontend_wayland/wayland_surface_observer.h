@@ -21,6 +21,7 @@
 #define MIR_FRONTEND_WAYLAND_SURFACE_OBSERVER_H_
 
 #include "wayland_input_dispatcher.h"
+#include "input_event_batch.h"
 #include <mir/scene/null_surface_observer.h>
 
 #include <memory>
@@ -88,14 +89,18 @@ private:
     {
         Impl(
             wayland::Weak<WindowWlSurfaceRole> window,
-            std::unique_ptr<WaylandInputDispatcher> input_dispatcher)
+            std::unique_ptr<WaylandInputDispatcher> input_dispatcher,
+            bool coalesce_input_motion)
             : window{window},
-              input_dispatcher{std::move(input_dispatcher)}
+              input_dispatcher{std::move(input_dispatcher)},
+              input_batch{coalesce_input_motion}
         {
         }
 
         wayland::Weak<WindowWlSurfaceRole> const window;
         std::unique_ptr<WaylandInputDispatcher> const input_dispatcher;
+        /// Input waiting to be sent, added to on the input thread
+        InputEventBatch input_batch;
 
         geometry::Size window_size{};
         std::experimental::optional<geometry::Size> requested_size{};
@@ -137,7 +137,10 @@ void mir::frontend::WlPointer::set_relative_pointer(mir::wayland::RelativePointe
     relative_pointer = make_weak(relative_ptr);
 }
 
-void mir::frontend::WlPointer::event(MirPointerEvent const* event, WlSurface& root_surface)
+void mir::frontend::WlPointer::event(
+    MirPointerEvent const* event,
+    WlSurface& root_surface,
+    std::vector<MirPointerEvent const*> const& history)
 {
     switch(mir_pointer_event_action(event))
     {
@@ -154,7 +157,7 @@ void mir::frontend::WlPointer::event(MirPointerEvent const* event, WlSurface& ro
             break;
         case mir_pointer_action_motion:
             enter_or_motion(event, root_surface);
-            relative_motion(event);
+            relative_motion(event, history);
             axis(event);
             break;
         case mir_pointer_actions:
@@ -290,23 +293,38 @@ void mf::WlPointer::enter_or_motion(MirPointerEvent const* event, WlSurface& roo
     }
 }
 
-void mf::WlPointer::relative_motion(MirPointerEvent const* event)
+void mf::WlPointer::relative_motion(MirPointerEvent const* event, std::vector<MirPointerEvent const*> const& history)
 {
     if (!relative_pointer)
     {
         return;
     }
-    auto const motion = std::make_pair(
-        mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
-        mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y));
-    if (motion.first || motion.second)
+
+    auto const send_motion = [this](MirPointerEvent const* event)
+        {
+            auto const motion = std::make_pair(
+                mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x),
+                mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y));
+            if (motion.first || motion.second)
+            {
+                auto const timestamp = timestamp_of(event);
+                relative_pointer.value().send_relative_motion_event(
+                    timestamp, timestamp,
+                    motion.first, motion.second,
+                    motion.first, motion.second);
+                needs_frame = true;
+            }
+        };
+
+    // Clients of the relative pointer want every motion, not just the total
+    if (history.empty())
     {
-        auto const timestamp = timestamp_of(event);
-        relative_pointer.value().send_relative_motion_event(
-            timestamp, timestamp,
-            motion.first, motion.second,
-            motion.first, motion.second);
-        needs_frame = true;
+        send_motion(event);
+    }
+    else
+    {
+        for (auto const motion : history)
+            send_motion(motion);
     }
 }
 
@@ -29,6 +29,7 @@
 #include <functional>
 #include <optional>
 #include <set>
+#include <vector>
 
 struct MirInputEvent;
 typedef unsigned int MirPointerButtons;
@@ -56,8 +57,12 @@ public:
     void set_relative_pointer(wayland::RelativePointerV1* relative_ptr);
 
     /// Convert the Mir event into Wayland events and send them to the client. root_surface is the one that received
-    /// the Mir event, but the final Wayland event may be sent to a subsurface.
-    void event(MirPointerEvent const* event, WlSurface& root_surface);
+    /// the Mir event, but the final Wayland event may be sent to a subsurface. history holds the events (if any)
+    /// that were coalesced into event, so the relative pointer can still report each motion.
+    void event(
+        MirPointerEvent const* event,
+        WlSurface& root_surface,
+        std::vector<MirPointerEvent const*> const& history = {});
 
     struct Cursor;
 
@@ -71,7 +76,7 @@ private:
     /// Giving it an already transformed surface and position is also fine
     void enter_or_motion(MirPointerEvent const* event, WlSurface& root_surface);
     /// Sends relative motion only if the relative pointer is set
-    void relative_motion(MirPointerEvent const* event);
+    void relative_motion(MirPointerEvent const* event, std::vector<MirPointerEvent const*> const& history);
     /// Sends a frame event only if needed, leaves needs_frame false
     void maybe_frame();
 
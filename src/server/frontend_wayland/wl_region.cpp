@@ -19,7 +19,7 @@
 
 #include "wl_region.h"
 
-#include <mir/log.h>
+#include "mir/geometry/rectangles.h"
 
 namespace mf = mir::frontend;
 namespace geom = mir::geometry;
@@ -55,9 +55,10 @@ void mf::WlRegion::add(int32_t x, int32_t y, int32_t width, int32_t height)
 
 void mf::WlRegion::subtract(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    log_warning("WlRegion::subtract not implemented. ignoring.");
+    geom::Rectangles remaining;
+    for (auto const& rect : rects)
+        remaining.add(rect);
+
+    remaining = difference_of(remaining, geom::Rectangles{geom::Rectangle{{x, y}, {width, height}}});
+    rects.assign(remaining.begin(), remaining.end());
 }
@@ -151,7 +151,8 @@ private:
 mf::WlSeat::WlSeat(
     wl_display* display,
     std::shared_ptr<mi::InputDeviceHub> const& input_hub,
-    std::shared_ptr<mi::Seat> const& seat)
+    std::shared_ptr<mi::Seat> const& seat,
+    bool coalesce_input_motion)
     :   Global(display, Version<6>()),
         keymap{std::make_unique<input::Keymap>()},
         config_observer{
@@ -165,7 +166,8 @@ mf::WlSeat::WlSeat(
         keyboard_listeners{std::make_shared<ListenerList<WlKeyboard>>()},
         touch_listeners{std::make_shared<ListenerList<WlTouch>>()},
         input_hub{input_hub},
-        seat{seat}
+        seat{seat},
+        coalesce_input_motion{coalesce_input_motion}
 {
     input_hub->add_observer(config_observer);
     add_focus_listener(&focus);
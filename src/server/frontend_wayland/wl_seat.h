@@ -54,7 +54,8 @@ public:
     WlSeat(
         wl_display* display,
         std::shared_ptr<mir::input::InputDeviceHub> const& input_hub,
-        std::shared_ptr<mir::input::Seat> const& seat);
+        std::shared_ptr<mir::input::Seat> const& seat,
+        bool coalesce_input_motion);
 
     ~WlSeat();
 
@@ -82,6 +83,9 @@ public:
 
     void server_restart();
 
+    /// Whether pointer and touch motion should be coalesced while clients are sent input (see InputEventBatch)
+    auto coalesces_input_motion() const -> bool { return coalesce_input_motion; }
+
 private:
     wl_client* focused_client{nullptr}; ///< Can be null
     std::vector<ListenerTracker*> focus_listeners;
@@ -112,6 +116,7 @@ private:
 
     std::shared_ptr<input::InputDeviceHub> const input_hub;
     std::shared_ptr<input::Seat> const seat;
+    bool const coalesce_input_motion;
 
     void bind(wl_resource* new_wl_seat) override;
 };
@@ -34,6 +34,7 @@
 #include "mir/compositor/buffer_stream.h"
 #include "mir/executor.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/presentation.h"
 #include "mir/scene/surface.h"
 #include "mir/shell/surface_specification.h"
 #include "mir/log.h"
@@ -48,6 +49,24 @@ namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
+namespace
+{
+// Clients commonly damage (0, 0, INT32_MAX, INT32_MAX) to mean "everything"; keep such
+// rectangles well away from overflow when they are later intersected
+auto clamped_rect(int32_t x, int32_t y, int32_t width, int32_t height) -> geom::Rectangle
+{
+    int32_t const limit = 1 << 24;
+    auto const clamp = [limit](int64_t value) { return int32_t(std::min<int64_t>(std::max<int64_t>(value, -limit), limit)); };
+
+    auto const left = clamp(x);
+    auto const top = clamp(y);
+    auto const right = clamp(int64_t{x} + width);
+    auto const bottom = clamp(int64_t{y} + height);
+
+    return {{left, top}, {right - left, bottom - top}};
+}
+}
+
 mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
     : mw::Callback{new_resource, Version<1>()},
       destroyed{deleted_flag_for_resource(resource)}
@@ -68,10 +87,20 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedback.insert(end(presentation_feedback),
+                                 begin(source.presentation_feedback),
+                                 end(source.presentation_feedback));
+
+    surface_damage.insert(end(surface_damage), begin(source.surface_damage), end(source.surface_damage));
+    buffer_damage.insert(end(buffer_damage), begin(source.buffer_damage), end(source.buffer_damage));
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -176,6 +205,11 @@ void mf::WlSurface::remove_subsurface(WlSubsurface* child)
         children.end());
 }
 
+void mf::WlSurface::add_presentation_feedback(WlSurfaceState::PresentationFeedback const& feedback)
+{
+    pending.presentation_feedback.push_back(feedback);
+}
+
 void mf::WlSurface::refresh_surface_data_now()
 {
     role->refresh_surface_data_now();
@@ -239,6 +273,59 @@ void mf::WlSurface::send_frame_callbacks()
     frame_callbacks.clear();
 }
 
+void mf::WlSurface::await_presentation(std::vector<WlSurfaceState::PresentationFeedback> const& feedback)
+{
+    // The stream tells us from the compositor thread, but the feedback has to be sent from ours
+    stream->add_presentation_callback(
+        [executor = executor, feedback](graphics::Presentation const* presentation)
+        {
+            auto const shown = presentation ?
+                std::make_shared<graphics::Presentation>(*presentation) :
+                std::shared_ptr<graphics::Presentation>{};
+
+            executor->spawn([feedback, shown]()
+                {
+                    for (auto const& f : feedback)
+                        f(shown.get());
+                });
+        });
+}
+
+auto mf::WlSurface::damage_in_buffer(WlSurfaceState const& state, geom::Size buffer_size) const
+    -> geom::Rectangles
+{
+    geom::Rectangle const whole_buffer{{0, 0}, buffer_size};
+
+    // Without any damage the client hasn't told us what changed, so assume everything did
+    if (state.surface_damage.empty() && state.buffer_damage.empty())
+        return geom::Rectangles{whole_buffer};
+
+    // NOTE: buffer transforms are not implemented, so surface and buffer coordinates differ only by scale
+    geom::Rectangle const surface_area{
+        {0, 0},
+        {buffer_size.width.as_int() / scale, buffer_size.height.as_int() / scale}};
+
+    geom::Rectangles damage;
+    auto const add = [&damage](geom::Rectangle const& rect)
+        {
+            if (rect.size.width > geom::Width{} && rect.size.height > geom::Height{})
+                damage.add(rect);
+        };
+
+    for (auto const& rect : state.surface_damage)
+    {
+        auto const clipped = rect.intersection_with(surface_area);
+        add(geom::Rectangle{
+            {clipped.left().as_int() * scale, clipped.top().as_int() * scale},
+            {clipped.size.width.as_int() * scale, clipped.size.height.as_int() * scale}});
+    }
+
+    for (auto const& rect : state.buffer_damage)
+        add(rect.intersection_with(whole_buffer));
+
+    return damage;
+}
+
 void mf::WlSurface::destroy()
 {
     destroy_wayland_object();
@@ -256,20 +343,14 @@ void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buff
 
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.surface_damage.push_back(clamped_rect(x, y, width, height));
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    if (width > 0 && height > 0)
+        pending.buffer_damage.push_back(clamped_rect(x, y, width, height));
 }
 
 void mf::WlSurface::frame(wl_resource* new_callback)
@@ -279,8 +360,22 @@ void mf::WlSurface::frame(wl_resource* new_callback)
 
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    std::vector<geom::Rectangle> opaque;
+
+    if (region)
+    {
+        for (auto const& rect : WlRegion::from(region.value())->rectangle_vector())
+        {
+            if (rect.size.width > geom::Width{} && rect.size.height > geom::Height{})
+            {
+                opaque.push_back(clamped_rect(
+                    rect.left().as_int(), rect.top().as_int(),
+                    rect.size.width.as_int(), rect.size.height.as_int()));
+            }
+        }
+    }
+
+    pending.opaque_region = std::move(opaque);
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -300,6 +395,12 @@ void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> c
 
 namespace
 {
+void discard(std::vector<mf::WlSurfaceState::PresentationFeedback> const& feedback)
+{
+    for (auto const& f : feedback)
+        f(nullptr);
+}
+
 MirPixelFormat wl_format_to_mir_format(uint32_t format)
 {
     switch (format)
@@ -341,8 +442,19 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+    {
+        geom::Rectangles opaque;
+        for (auto const& rect : state.opaque_region.value())
+            opaque.add(rect);
+        stream->set_opaque_region(opaque);
+    }
+
     if (state.scale)
+    {
+        scale = std::max(state.scale.value(), 1);
         stream->set_scale(state.scale.value());
+    }
 
     if (state.buffer)
     {
@@ -352,7 +464,9 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
         {
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
+            previous_buffer.reset();
             send_frame_callbacks();
+            discard(state.presentation_feedback);
         }
         else
         {
@@ -368,6 +482,7 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                 };
 
             std::shared_ptr<graphics::Buffer> mir_buffer;
+            geom::Rectangles damage;
 
             if (auto const shm_buffer = wl_shm_buffer_get(buffer))
             {
@@ -385,10 +500,13 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     BOOST_THROW_EXCEPTION((
                                               std::runtime_error{"Buffer has invalid stride"}));
                 }
+                damage = damage_in_buffer(state, {width, wl_shm_buffer_get_height(shm_buffer)});
                 mir_buffer = allocator->buffer_from_shm(
                     buffer,
                     executor,
-                    std::move(executor_send_frame_callbacks));
+                    std::move(executor_send_frame_callbacks),
+                    previous_buffer.lock(),
+                    damage);
                 tracepoint(
                     mir_server_wayland,
                     sw_buffer_committed,
@@ -410,6 +528,7 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     buffer,
                     std::move(executor_send_frame_callbacks),
                     std::move(release_buffer));
+                damage = damage_in_buffer(state, mir_buffer->size());
                 tracepoint(
                     mir_server_wayland,
                     hw_buffer_committed,
@@ -417,7 +536,11 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
-            stream->submit_buffer(mir_buffer);
+            stream->submit_buffer(mir_buffer, damage);
+            previous_buffer = mir_buffer;
+
+            if (!state.presentation_feedback.empty())
+                await_presentation(state.presentation_feedback);
             auto const new_buffer_size = stream->stream_size();
 
             if (!input_shape && std::experimental::make_optional(new_buffer_size) != buffer_size_)
@@ -431,6 +554,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     else
     {
         send_frame_callbacks();
+        // Without new content there's nothing to present
+        discard(state.presentation_feedback);
     }
 
     for (WlSubsurface* child: children)
@@ -26,7 +26,9 @@
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangles.h"
 
+#include <functional>
 #include <vector>
 #include <map>
 
@@ -36,7 +38,9 @@ class Executor;
 
 namespace graphics
 {
+class Buffer;
 class GraphicBufferAllocator;
+struct Presentation;
 }
 namespace scene
 {
@@ -68,6 +72,9 @@ struct WlSurfaceState
         std::shared_ptr<bool> destroyed;
     };
 
+    /// Called on the Wayland thread when the commit is presented, or with nullptr if it is discarded
+    using PresentationFeedback = std::function<void(graphics::Presentation const*)>;
+
     // if you add variables, don't forget to update this
     void update_from(WlSurfaceState const& source);
 
@@ -83,7 +90,13 @@ struct WlSurfaceState
     std::experimental::optional<int> scale;
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    std::experimental::optional<std::vector<geometry::Rectangle>> opaque_region;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    std::vector<PresentationFeedback> presentation_feedback;
+
+    // damage is accumulated until a commit, in surface and buffer coordinates respectively
+    std::vector<geometry::Rectangle> surface_damage;
+    std::vector<geometry::Rectangle> buffer_damage;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -130,6 +143,7 @@ public:
     void remove_subsurface(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    void add_presentation_feedback(WlSurfaceState::PresentationFeedback const& feedback);
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
@@ -152,10 +166,14 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    std::weak_ptr<graphics::Buffer> previous_buffer;    ///< Weak, so as not to delay its release to the client
+    int scale{1};
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
 
     void send_frame_callbacks();
+    void await_presentation(std::vector<WlSurfaceState::PresentationFeedback> const& feedback);
+    auto damage_in_buffer(WlSurfaceState const& state, geometry::Size buffer_size) const -> geometry::Rectangles;
 
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
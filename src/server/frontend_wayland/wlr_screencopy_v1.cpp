@@ -0,0 +1,348 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wlr_screencopy_v1.h"
+#include "wlr-screencopy-unstable-v1_wrapper.h"
+#include "deleted_for_resource.h"
+#include "output_manager.h"
+#include "wl_client.h"
+
+#include "mir/compositor/screen_capture.h"
+#include "mir/executor.h"
+
+#include <boost/throw_exception.hpp>
+#include <wayland-server-protocol.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace mf = mir::frontend;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mw = mir::wayland;
+
+namespace mir
+{
+namespace frontend
+{
+class WlrScreencopyManagerV1 : public wayland::ScreencopyManagerV1::Global
+{
+public:
+    WlrScreencopyManagerV1(
+        wl_display* display,
+        std::shared_ptr<Executor> const& wayland_executor,
+        OutputManager* output_manager,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture);
+
+    std::shared_ptr<Executor> const wayland_executor;
+    OutputManager* const output_manager;
+    std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+
+private:
+    void bind(wl_resource* new_resource) override;
+};
+
+class WlrScreencopyManagerV1Instance : public wayland::ScreencopyManagerV1
+{
+public:
+    WlrScreencopyManagerV1Instance(wl_resource* new_resource, WlrScreencopyManagerV1 const& global);
+
+    /// The sequence of the last frame each output sent to this client, so copy_with_damage can report
+    /// what changed since. Only used on the Wayland thread, and shared with frames that outlive us.
+    using LastFrames = std::unordered_map<int, uint64_t>;
+
+private:
+    void capture_output(wl_resource* frame, int32_t overlay_cursor, wl_resource* output) override;
+    void capture_output_region(
+        wl_resource* frame,
+        int32_t overlay_cursor,
+        wl_resource* output,
+        int32_t x, int32_t y,
+        int32_t width, int32_t height) override;
+    void destroy() override;
+
+    /// The area of the scene shown on the output, or nullopt if it's gone
+    auto output_area(wl_resource* output) const -> std::experimental::optional<std::pair<int, geom::Rectangle>>;
+
+    std::shared_ptr<Executor> const wayland_executor;
+    OutputManager* const output_manager;
+    std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+    std::shared_ptr<LastFrames> const last_frames;
+};
+
+class WlrScreencopyFrameV1 : public wayland::ScreencopyFrameV1
+{
+public:
+    WlrScreencopyFrameV1(
+        wl_resource* new_resource,
+        std::shared_ptr<Executor> const& wayland_executor,
+        std::shared_ptr<compositor::ScreenCapture> const& screen_capture,
+        std::shared_ptr<WlrScreencopyManagerV1Instance::LastFrames> const& last_frames,
+        std::experimental::optional<std::pair<int, geom::Rectangle>> const& output_area);
+
+private:
+    void copy(wl_resource* buffer) override;
+    void copy_with_damage(wl_resource* buffer) override;
+    void destroy() override;
+
+    void start_copy(wl_resource* buffer, bool wait_for_damage);
+
+    /// Called on the Wayland thread with the captured frame, or nullptr
+    void captured(
+        wl_resource* buffer,
+        bool wait_for_damage,
+        std::shared_ptr<mc::ScreenCapture::Frame const> const& frame);
+
+    std::shared_ptr<Executor> const wayland_executor;
+    std::shared_ptr<compositor::ScreenCapture> const screen_capture;
+    std::shared_ptr<WlrScreencopyManagerV1Instance::LastFrames> const last_frames;
+    int const output_id;
+    geom::Rectangle const area;
+    bool used{false};
+};
+}
+}
+
+auto mf::create_wlr_screencopy_manager_v1(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<mc::ScreenCapture> const& screen_capture) -> std::shared_ptr<void>
+{
+    return std::make_shared<WlrScreencopyManagerV1>(display, wayland_executor, output_manager, screen_capture);
+}
+
+mf::WlrScreencopyManagerV1::WlrScreencopyManagerV1(
+    wl_display* display,
+    std::shared_ptr<Executor> const& wayland_executor,
+    OutputManager* output_manager,
+    std::shared_ptr<mc::ScreenCapture> const& screen_capture) :
+    Global{display, Version<3>()},
+    wayland_executor{wayland_executor},
+    output_manager{output_manager},
+    screen_capture{screen_capture}
+{
+}
+
+void mf::WlrScreencopyManagerV1::bind(wl_resource* new_resource)
+{
+    new WlrScreencopyManagerV1Instance{new_resource, *this};
+}
+
+mf::WlrScreencopyManagerV1Instance::WlrScreencopyManagerV1Instance(
+    wl_resource* new_resource,
+    WlrScreencopyManagerV1 const& global) :
+    ScreencopyManagerV1{new_resource, Version<3>()},
+    wayland_executor{global.wayland_executor},
+    output_manager{global.output_manager},
+    screen_capture{global.screen_capture},
+    last_frames{std::make_shared<LastFrames>()}
+{
+}
+
+void mf::WlrScreencopyManagerV1Instance::capture_output(wl_resource* frame, int32_t, wl_resource* output)
+{
+    new WlrScreencopyFrameV1{frame, wayland_executor, screen_capture, last_frames, output_area(output)};
+}
+
+void mf::WlrScreencopyManagerV1Instance::capture_output_region(
+    wl_resource* frame,
+    int32_t,
+    wl_resource* output,
+    int32_t x, int32_t y,
+    int32_t width, int32_t height)
+{
+    auto area = output_area(output);
+    if (area)
+    {
+        // The region is in the logical coordinates of xdg_output, relative to the output
+        auto const scale = WlClient::from(client)->output_geometry_scale();
+        geom::Rectangle const region{
+            area.value().second.top_left + geom::Displacement{roundf(x / scale), roundf(y / scale)},
+            geom::Size{std::max(roundf(width / scale), 0.0f), std::max(roundf(height / scale), 0.0f)}};
+        area.value().second = area.value().second.intersection_with(region);
+    }
+
+    new WlrScreencopyFrameV1{frame, wayland_executor, screen_capture, last_frames, area};
+}
+
+void mf::WlrScreencopyManagerV1Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+auto mf::WlrScreencopyManagerV1Instance::output_area(wl_resource* output) const
+    -> std::experimental::optional<std::pair<int, geom::Rectangle>>
+{
+    std::experimental::optional<std::pair<int, geom::Rectangle>> result;
+
+    if (auto const output_id = output_manager->output_id_for(client, output))
+    {
+        output_manager->display_config()->for_each_output(
+            [&](mg::DisplayConfigurationOutput const& config)
+            {
+                if (config.id == output_id.value() && config.used)
+                    result = std::make_pair(config.id.as_value(), config.extents());
+            });
+    }
+
+    return result;
+}
+
+mf::WlrScreencopyFrameV1::WlrScreencopyFrameV1(
+    wl_resource* new_resource,
+    std::shared_ptr<Executor> const& wayland_executor,
+    std::shared_ptr<mc::ScreenCapture> const& screen_capture,
+    std::shared_ptr<WlrScreencopyManagerV1Instance::LastFrames> const& last_frames,
+    std::experimental::optional<std::pair<int, geom::Rectangle>> const& output_area) :
+    ScreencopyFrameV1{new_resource, Version<3>()},
+    wayland_executor{wayland_executor},
+    screen_capture{screen_capture},
+    last_frames{last_frames},
+    output_id{output_area ? output_area.value().first : -1},
+    area{output_area ? output_area.value().second : geom::Rectangle{}}
+{
+    if (area.size.width == geom::Width{} || area.size.height == geom::Height{})
+    {
+        // Nothing to capture: the output is gone or the region misses it
+        used = true;
+        send_failed_event();
+        return;
+    }
+
+    // CPU copies only for now: the frame is read back from the renderer into a wl_shm buffer
+    auto const width = area.size.width.as_uint32_t();
+    auto const height = area.size.height.as_uint32_t();
+    send_buffer_event(WL_SHM_FORMAT_ARGB8888, width, height, width * 4);
+    if (version_supports_buffer_done())
+        send_buffer_done_event();
+}
+
+void mf::WlrScreencopyFrameV1::copy(wl_resource* buffer)
+{
+    start_copy(buffer, false);
+}
+
+void mf::WlrScreencopyFrameV1::copy_with_damage(wl_resource* buffer)
+{
+    start_copy(buffer, true);
+}
+
+void mf::WlrScreencopyFrameV1::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WlrScreencopyFrameV1::start_copy(wl_resource* buffer, bool wait_for_damage)
+{
+    if (used)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::already_used,
+            "Frame has already been copied"));
+    }
+
+    auto const shm_buffer = wl_shm_buffer_get(buffer);
+    if (!shm_buffer)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Only wl_shm buffers are supported"));
+    }
+
+    auto const format = wl_shm_buffer_get_format(shm_buffer);
+    if ((format != WL_SHM_FORMAT_ARGB8888 && format != WL_SHM_FORMAT_XRGB8888) ||
+        wl_shm_buffer_get_width(shm_buffer) != area.size.width.as_int() ||
+        wl_shm_buffer_get_height(shm_buffer) != area.size.height.as_int() ||
+        wl_shm_buffer_get_stride(shm_buffer) < area.size.width.as_int() * 4)
+    {
+        BOOST_THROW_EXCEPTION(mw::ProtocolError(
+            resource,
+            Error::invalid_buffer,
+            "Buffer does not match the format and size sent in the buffer event"));
+    }
+
+    used = true;
+
+    auto const last_frame = last_frames->find(output_id);
+    auto const since = last_frame != last_frames->end() ? last_frame->second : 0;
+
+    // The client may destroy either the frame or the buffer while the capture is in flight
+    screen_capture->capture(area, since, wait_for_damage,
+        [executor = wayland_executor,
+            frame = mw::make_weak(this),
+            buffer,
+            buffer_deleted = deleted_flag_for_resource(buffer),
+            wait_for_damage](std::shared_ptr<mc::ScreenCapture::Frame const> const& captured)
+        {
+            executor->spawn([frame, buffer, buffer_deleted, wait_for_damage, captured]()
+                {
+                    if (!frame)
+                        return;
+
+                    frame.value().captured(*buffer_deleted ? nullptr : buffer, wait_for_damage, captured);
+                });
+        });
+}
+
+void mf::WlrScreencopyFrameV1::captured(
+    wl_resource* buffer,
+    bool wait_for_damage,
+    std::shared_ptr<mc::ScreenCapture::Frame const> const& frame)
+{
+    auto const shm_buffer = buffer ? wl_shm_buffer_get(buffer) : nullptr;
+    if (!frame || !shm_buffer)
+    {
+        send_failed_event();
+        return;
+    }
+
+    auto const row_size = frame->stride().as_uint32_t();
+    auto const dest_stride = wl_shm_buffer_get_stride(shm_buffer);
+    auto const src = reinterpret_cast<char const*>(frame->pixels.data());
+
+    wl_shm_buffer_begin_access(shm_buffer);
+    auto const dest = static_cast<char*>(wl_shm_buffer_get_data(shm_buffer));
+    for (auto row = 0; row != area.size.height.as_int(); ++row)
+        memcpy(dest + row * dest_stride, src + row * row_size, row_size);
+    wl_shm_buffer_end_access(shm_buffer);
+
+    (*last_frames)[output_id] = frame->sequence;
+
+    send_flags_event(0);
+
+    if (wait_for_damage && version_supports_damage())
+    {
+        auto const damage = frame->damage;
+        send_damage_event(
+            (damage.top_left.x - area.top_left.x).as_int(),
+            (damage.top_left.y - area.top_left.y).as_int(),
+            damage.size.width.as_uint32_t(),
+            damage.size.height.as_uint32_t());
+    }
+
+    auto const seconds = std::chrono::duration_cast<std::chrono::seconds>(frame->timestamp);
+    auto const nanoseconds = frame->timestamp - seconds;
+    send_ready_event(
+        static_cast<uint32_t>(static_cast<uint64_t>(seconds.count()) >> 32),
+        static_cast<uint32_t>(seconds.count()),
+        static_cast<uint32_t>(nanoseconds.count()));
+}
@@ -19,6 +19,8 @@
 #include "scaled_buffer_stream.h"
 #include "mir/log.h"
 
+#include <cmath>
+
 namespace mf = mir::frontend;
 
 mf::ScaledBufferStream::ScaledBufferStream(std::shared_ptr<compositor::BufferStream>&& inner, float scale)
@@ -32,12 +34,25 @@ void mf::ScaledBufferStream::submit_buffer(std::shared_ptr<graphics::Buffer> con
     inner->submit_buffer(buffer);
 }
 
+void mf::ScaledBufferStream::submit_buffer(
+    std::shared_ptr<graphics::Buffer> const& buffer,
+    geometry::Rectangles const& damage)
+{
+    inner->submit_buffer(buffer, damage);
+}
+
 void mf::ScaledBufferStream::set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback)
 {
     // Does this need to be scaled? I don't ? think ? so? compositor::Stream seems to leave it unscaled.
     inner->set_frame_posted_callback(callback);
 }
 
+void mf::ScaledBufferStream::add_presentation_callback(
+    std::function<void(graphics::Presentation const*)> const& callback)
+{
+    inner->add_presentation_callback(callback);
+}
+
 void mf::ScaledBufferStream::with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec)
 {
     inner->with_most_recent_buffer_do(exec);
@@ -59,6 +74,12 @@ void mf::ScaledBufferStream::set_scale(float scale)
     inner->set_scale(scale);
 }
 
+void mf::ScaledBufferStream::set_opaque_region(geometry::Rectangles const& region)
+{
+    // The region is in the inner stream's logical coordinates, which we scale when reading it
+    inner->set_opaque_region(region);
+}
+
 auto mf::ScaledBufferStream::lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer>
 {
     return inner->lock_compositor_buffer(user_id);
@@ -90,4 +111,36 @@ auto mf::ScaledBufferStream::framedropping() const -> bool
     return inner->framedropping();
 }
 
+auto mf::ScaledBufferStream::damage_between(graphics::BufferID earlier, graphics::BufferID later) const
+    -> std::experimental::optional<geometry::Rectangles>
+{
+    // Damage is in buffer coordinates, so is unaffected by our scale
+    return inner->damage_between(earlier, later);
+}
+
+auto mf::ScaledBufferStream::opaque_region() const -> geometry::Rectangles
+{
+    geometry::Rectangles scaled;
+    for (auto const& rect : inner->opaque_region())
+    {
+        // Round inwards, so that no partly translucent pixel is claimed to be opaque
+        auto const left = int(std::ceil(rect.left().as_int() * inv_scale));
+        auto const top = int(std::ceil(rect.top().as_int() * inv_scale));
+        auto const right = int(std::floor(rect.right().as_int() * inv_scale));
+        auto const bottom = int(std::floor(rect.bottom().as_int() * inv_scale));
+
+        if (right > left && bottom > top)
+            scaled.add({{left, top}, {right - left, bottom - top}});
+    }
+    return scaled;
+}
 
+void mf::ScaledBufferStream::presented(graphics::BufferID id, graphics::Presentation const& presentation)
+{
+    inner->presented(id, presentation);
+}
+
+auto mf::ScaledBufferStream::queue_stats() const -> compositor::BufferQueueStats
+{
+    return inner->queue_stats();
+}
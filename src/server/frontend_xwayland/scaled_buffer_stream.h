@@ -38,11 +38,14 @@ public:
     /// Overrides from frontend::BufferStream
     /// @{
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer);
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer, geometry::Rectangles const& damage);
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const& callback);
+    void add_presentation_callback(std::function<void(graphics::Presentation const*)> const& callback);
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec);
     MirPixelFormat pixel_format() const;
     void allow_framedropping(bool allow);
     void set_scale(float scale);
+    void set_opaque_region(geometry::Rectangles const& region);
     /// @}
 
     /// Overrides from compositor::BufferStream
@@ -53,6 +56,11 @@ public:
     void drop_old_buffers();
     auto has_submitted_buffer() const -> bool;
     auto framedropping() const -> bool;
+    auto damage_between(graphics::BufferID earlier, graphics::BufferID later) const
+        -> std::experimental::optional<geometry::Rectangles>;
+    auto opaque_region() const -> geometry::Rectangles;
+    void presented(graphics::BufferID id, graphics::Presentation const& presentation);
+    auto queue_stats() const -> compositor::BufferQueueStats;
     /// @}
 
 private:
@@ -23,6 +23,7 @@
 #include "wayland_utils.h"
 #include "window_wl_surface_role.h"
 #include "wayland_input_dispatcher.h"
+#include "input_event_batch.h"
 
 #include <mir/executor.h>
 #include <mir/events/event_builders.h>
@@ -46,6 +47,7 @@ mf::XWaylandSurfaceObserver::XWaylandSurfaceObserver(
       wayland_executor{wayland_executor},
       input_dispatcher{std::make_shared<ThreadsafeInputDispatcher>(
           std::make_unique<WaylandInputDispatcher>(&seat, wl_surface))},
+      input_batch{std::make_shared<InputEventBatch>(seat.coalesces_input_motion())},
       scale{scale}
 {
 }
@@ -121,12 +123,19 @@ void mf::XWaylandSurfaceObserver::input_consumed(ms::Surface const*, MirEvent co
         std::shared_ptr<MirEvent> owned_event = mev::clone_event(*event);
         mev::scale_positions(*owned_event, scale);
 
-        aquire_input_dispatcher(
-            [owned_event](auto input_dispatcher)
-            {
-                auto const input_event = mir_event_get_input_event(owned_event.get());
-                input_dispatcher->handle_event(input_event);
-            });
+        // Only one batch at a time needs to wait for the Wayland thread: later events join it
+        if (input_batch->add(std::move(owned_event)))
+        {
+            aquire_input_dispatcher(
+                [input_batch = input_batch](auto input_dispatcher)
+                {
+                    for (auto const& entry : input_batch->take())
+                    {
+                        auto const input_event = mir_event_get_input_event(entry.event.get());
+                        input_dispatcher->handle_event(input_event, entry.history);
+                    }
+                });
+        }
     }
 }
 
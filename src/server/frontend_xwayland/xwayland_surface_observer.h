@@ -37,6 +37,7 @@ namespace frontend
 class WlSeat;
 class WlSurface;
 class WaylandInputDispatcher;
+class InputEventBatch;
 class XWaylandSurfaceObserverSurface;
 
 /// Must not outlive the XWaylandSurface
@@ -87,6 +88,8 @@ private:
     XWaylandSurfaceObserverSurface* const wm_surface;
     Executor& wayland_executor;
     std::shared_ptr<ThreadsafeInputDispatcher> const input_dispatcher;
+    /// Input waiting to be sent, shared with the work queued to send it
+    std::shared_ptr<InputEventBatch> const input_batch;
     float const scale;
 
     /// Runs work on the Wayland thread if the input dispatcher still exists
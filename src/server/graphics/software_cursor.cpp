@@ -82,6 +82,11 @@ public:
         return buffer_;
     }
 
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID) const override
+    {
+        return std::experimental::nullopt;
+    }
+
     geom::Rectangle screen_position() const override
     {
         std::lock_guard<std::mutex> lock{position_mutex};
@@ -108,6 +113,11 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
     void move_to(geom::Point new_position)
     {
         std::lock_guard<std::mutex> lock{position_mutex};
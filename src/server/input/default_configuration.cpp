@@ -261,7 +261,9 @@ mir::DefaultServerConfiguration::the_input_reading_multiplexer()
     return input_reading_multiplexer(
         []() -> std::shared_ptr<mir::dispatch::MultiplexingDispatchable>
         {
-            return std::make_shared<mir::dispatch::MultiplexingDispatchable>();
+            // Only the input thread dispatches this, so it can take every ready device in one go
+            int const max_events_per_dispatch{16};
+            return std::make_shared<mir::dispatch::MultiplexingDispatchable>(max_events_per_dispatch);
         }
     );
 }
@@ -68,6 +68,11 @@ public:
     {
         return buffer_;
     }
+
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID) const override
+    {
+        return std::experimental::nullopt;
+    }
     
     geom::Rectangle screen_position() const override
     {
@@ -94,6 +99,11 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
 // TouchspotRenderable    
     void move_center_to(geom::Point pos)
     {
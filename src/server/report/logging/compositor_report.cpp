@@ -19,6 +19,8 @@
 #include "compositor_report.h"
 #include "mir/logging/logger.h"
 
+#include <algorithm>
+
 using namespace mir::time;
 namespace ml = mir::logging;
 namespace mrl = mir::report::logging;
@@ -74,6 +76,52 @@ void mrl::CompositorReport::rendered_frame(SubCompositorId id)
     inst.bypassed = false;
 }
 
+void mrl::CompositorReport::damage_in_frame(SubCompositorId id, mir::geometry::Rectangle const& redrawn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& inst = instance[id];
+    inst.pixels_redrawn +=
+        static_cast<long long>(redrawn.size.width.as_int()) * redrawn.size.height.as_int();
+}
+
+void mrl::CompositorReport::draw_calls_in_frame(SubCompositorId id, unsigned draw_calls)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    instance[id].draw_calls += draw_calls;
+}
+
+void mrl::CompositorReport::presented_frame(SubCompositorId id, std::chrono::nanoseconds latency)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    instance[id].presentation_latencies.push_back(latency);
+}
+
+// Per-buffer events are too frequent to log; BufferStream::queue_stats() summarises them
+void mrl::CompositorReport::buffer_submitted(StreamId, mir::graphics::BufferID, unsigned)
+{
+}
+
+void mrl::CompositorReport::buffer_dropped(StreamId, mir::graphics::BufferID)
+{
+}
+
+void mrl::CompositorReport::buffer_acquired(
+    StreamId, SubCompositorId, mir::graphics::BufferID, std::chrono::nanoseconds)
+{
+}
+
+void mrl::CompositorReport::buffer_reacquired(StreamId, SubCompositorId, mir::graphics::BufferID)
+{
+}
+
+void mrl::CompositorReport::buffer_released(StreamId, mir::graphics::BufferID)
+{
+}
+
+void mrl::CompositorReport::buffer_presented(StreamId, mir::graphics::BufferID, std::chrono::nanoseconds)
+{
+}
+
 void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id)
 {
     // The first report is a valid sample, but don't log anything because
@@ -95,6 +143,8 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
             ).count();
 
         long bypass_percent = dn ? (nbypassed - last_reported_bypassed) * 100L / dn : 0;
+        long long avg_pixels_redrawn = dn ? (pixels_redrawn - last_reported_pixels_redrawn) / dn : 0;
+        long long avg_draw_calls = dn ? (draw_calls - last_reported_draw_calls) / dn : 0;
 
         // Keep everything premultiplied by 1000 to guarantee accuracy
         // and avoid floating point.
@@ -103,12 +153,37 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
 
-        char msg[128];
+        // The distribution of latency from sampling the scene to the screen
+        char presented[96] = "";
+        if (!presentation_latencies.empty())
+        {
+            auto percentile_usec = [this](unsigned percent)
+                {
+                    auto const n = presentation_latencies.size();
+                    auto const rank = presentation_latencies.begin() + (n - 1) * percent / 100;
+                    std::nth_element(presentation_latencies.begin(), rank, presentation_latencies.end());
+                    return static_cast<long>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(*rank).count());
+                };
+
+            long const p50 = percentile_usec(50);
+            long const p90 = percentile_usec(90);
+            long const p99 = percentile_usec(99);
+            snprintf(presented, sizeof presented, ", "
+                     "presented in %ld.%03ld/%ld.%03ld/%ld.%03ld ms (p50/p90/p99)",
+                     p50 / 1000, p50 % 1000,
+                     p90 / 1000, p90 % 1000,
+                     p99 / 1000, p99 % 1000);
+        }
+
+        char msg[320];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed, "
+                 "%lld pixels/frame redrawn, "
+                 "%lld draw calls/frame%s",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,7 +194,10 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 avg_pixels_redrawn,
+                 avg_draw_calls,
+                 presented
                  );
 
         logger.log(ml::Severity::informational, msg, component);
@@ -130,6 +208,9 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
     last_reported_latency_sum = latency_sum;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
+    last_reported_pixels_redrawn = pixels_redrawn;
+    last_reported_draw_calls = draw_calls;
+    presentation_latencies.clear();
 }
 
 void mrl::CompositorReport::finished_frame(SubCompositorId id)
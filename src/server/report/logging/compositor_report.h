@@ -24,6 +24,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 #include <chrono>
 
 namespace mir
@@ -46,7 +47,17 @@ public:
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
+    void damage_in_frame(SubCompositorId id, geometry::Rectangle const& redrawn) override;
+    void draw_calls_in_frame(SubCompositorId id, unsigned draw_calls) override;
     void finished_frame(SubCompositorId id) override;
+    void presented_frame(SubCompositorId id, std::chrono::nanoseconds latency) override;
+    void buffer_submitted(StreamId stream, graphics::BufferID buffer, unsigned queued) override;
+    void buffer_dropped(StreamId stream, graphics::BufferID buffer) override;
+    void buffer_acquired(
+        StreamId stream, SubCompositorId id, graphics::BufferID buffer, std::chrono::nanoseconds latency) override;
+    void buffer_reacquired(StreamId stream, SubCompositorId id, graphics::BufferID buffer) override;
+    void buffer_released(StreamId stream, graphics::BufferID buffer) override;
+    void buffer_presented(StreamId stream, graphics::BufferID buffer, std::chrono::nanoseconds latency) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
@@ -67,14 +78,19 @@ private:
         TimePoint latency_sum;
         long nframes = 0;
         long nbypassed = 0;
+        long long pixels_redrawn = 0;
+        long long draw_calls = 0;
         bool bypassed = true;
         bool prev_bypassed = false;
+        std::vector<std::chrono::nanoseconds> presentation_latencies; // Since the last report
 
         TimePoint last_reported_total_time_sum;
         TimePoint last_reported_render_time_sum;
         TimePoint last_reported_latency_sum;
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
+        long long last_reported_pixels_redrawn = 0;
+        long long last_reported_draw_calls = 0;
 
         void log(mir::logging::Logger& logger, SubCompositorId id);
     };
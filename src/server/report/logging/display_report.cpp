@@ -192,3 +192,21 @@ void mrl::DisplayReport::report_vsync(unsigned int output_id,
     }
     prev_frame[output_id] = frame;
 }
+
+void mrl::DisplayReport::report_dmabuf_import(uint32_t drm_fourcc, std::chrono::nanoseconds duration)
+{
+    // long long to match printf format on all architectures
+    long long const duration_us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+
+    logger->log(component(), ml::Severity::debug,
+        "Imported dmabuf (format 0x%08x) in %lld.%03lldms",
+        drm_fourcc,
+        duration_us/1000, duration_us%1000);
+}
+
+void mrl::DisplayReport::report_dmabuf_import_reused(uint32_t drm_fourcc)
+{
+    logger->log(component(), ml::Severity::debug,
+        "Reused imported dmabuf (format 0x%08x)",
+        drm_fourcc);
+}
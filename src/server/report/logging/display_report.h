@@ -60,6 +60,8 @@ class DisplayReport : public graphics::DisplayReport
     virtual void report_vt_switch_away_failure() override;
     virtual void report_vt_switch_back_failure() override;
     virtual void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) override;
+    virtual void report_dmabuf_import(uint32_t drm_fourcc, std::chrono::nanoseconds duration) override;
+    virtual void report_dmabuf_import_reused(uint32_t drm_fourcc) override;
 
   protected:
     DisplayReport(DisplayReport const&) = delete;
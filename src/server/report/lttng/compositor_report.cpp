@@ -58,7 +58,58 @@ void mir::report::lttng::CompositorReport::rendered_frame(SubCompositorId id)
     mir_tracepoint(mir_server_compositor, rendered_frame, id);
 }
 
+void mir::report::lttng::CompositorReport::damage_in_frame(SubCompositorId id, geometry::Rectangle const& redrawn)
+{
+    mir_tracepoint(mir_server_compositor, damage_in_frame, id,
+                   redrawn.top_left.x.as_int(), redrawn.top_left.y.as_int(),
+                   redrawn.size.width.as_int(), redrawn.size.height.as_int());
+}
+
+void mir::report::lttng::CompositorReport::draw_calls_in_frame(SubCompositorId id, unsigned draw_calls)
+{
+    mir_tracepoint(mir_server_compositor, draw_calls_in_frame, id, draw_calls);
+}
+
 void mir::report::lttng::CompositorReport::finished_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, finished_frame, id);
 }
+
+void mir::report::lttng::CompositorReport::presented_frame(SubCompositorId id, std::chrono::nanoseconds latency)
+{
+    mir_tracepoint(mir_server_compositor, presented_frame, id, latency.count());
+}
+
+void mir::report::lttng::CompositorReport::buffer_submitted(
+    StreamId stream, graphics::BufferID buffer, unsigned queued)
+{
+    mir_tracepoint(mir_server_compositor, buffer_submitted, stream, buffer.as_value(), queued);
+}
+
+void mir::report::lttng::CompositorReport::buffer_dropped(StreamId stream, graphics::BufferID buffer)
+{
+    mir_tracepoint(mir_server_compositor, buffer_dropped, stream, buffer.as_value());
+}
+
+void mir::report::lttng::CompositorReport::buffer_acquired(
+    StreamId stream, SubCompositorId id, graphics::BufferID buffer, std::chrono::nanoseconds latency)
+{
+    mir_tracepoint(mir_server_compositor, buffer_acquired, stream, id, buffer.as_value(), latency.count());
+}
+
+void mir::report::lttng::CompositorReport::buffer_reacquired(
+    StreamId stream, SubCompositorId id, graphics::BufferID buffer)
+{
+    mir_tracepoint(mir_server_compositor, buffer_reacquired, stream, id, buffer.as_value());
+}
+
+void mir::report::lttng::CompositorReport::buffer_released(StreamId stream, graphics::BufferID buffer)
+{
+    mir_tracepoint(mir_server_compositor, buffer_released, stream, buffer.as_value());
+}
+
+void mir::report::lttng::CompositorReport::buffer_presented(
+    StreamId stream, graphics::BufferID buffer, std::chrono::nanoseconds latency)
+{
+    mir_tracepoint(mir_server_compositor, buffer_presented, stream, buffer.as_value(), latency.count());
+}
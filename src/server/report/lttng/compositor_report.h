@@ -39,7 +39,17 @@ public:
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
     void rendered_frame(SubCompositorId id) override;
+    void damage_in_frame(SubCompositorId id, geometry::Rectangle const& redrawn) override;
+    void draw_calls_in_frame(SubCompositorId id, unsigned draw_calls) override;
     void finished_frame(SubCompositorId id) override;
+    void presented_frame(SubCompositorId id, std::chrono::nanoseconds latency) override;
+    void buffer_submitted(StreamId stream, graphics::BufferID buffer, unsigned queued) override;
+    void buffer_dropped(StreamId stream, graphics::BufferID buffer) override;
+    void buffer_acquired(
+        StreamId stream, SubCompositorId id, graphics::BufferID buffer, std::chrono::nanoseconds latency) override;
+    void buffer_reacquired(StreamId stream, SubCompositorId id, graphics::BufferID buffer) override;
+    void buffer_released(StreamId stream, graphics::BufferID buffer) override;
+    void buffer_presented(StreamId stream, graphics::BufferID buffer, std::chrono::nanoseconds latency) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
@@ -50,6 +50,109 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    damage_in_frame,
+    TP_ARGS(void const*, id, int, x, int, y, int, width, int, height),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int, x, x)
+        ctf_integer(int, y, y)
+        ctf_integer(int, width, width)
+        ctf_integer(int, height, height)
+        ctf_integer(long, pixels, (long)width * height)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    draw_calls_in_frame,
+    TP_ARGS(void const*, id, unsigned, draw_calls),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(unsigned, draw_calls, draw_calls)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    presented_frame,
+    TP_ARGS(void const*, id, int64_t, latency_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(int64_t, latency_ns, latency_ns)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    buffer_submitted,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id, unsigned, queued),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+        ctf_integer(unsigned, queued, queued)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    buffer_acquired,
+    TP_ARGS(void const*, stream, void const*, id, uint32_t, buffer_id, int64_t, latency_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+        ctf_integer(int64_t, latency_ns, latency_ns)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    buffer_reacquired,
+    TP_ARGS(void const*, stream, void const*, id, uint32_t, buffer_id),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+    )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    buffer_presented,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id, int64_t, latency_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+        ctf_integer(int64_t, latency_ns, latency_ns)
+    )
+)
+
+TRACEPOINT_EVENT_CLASS(
+    mir_server_compositor,
+    stream_buffer_event,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, stream, (uintptr_t)(stream))
+        ctf_integer(uint32_t, buffer_id, buffer_id)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    stream_buffer_event,
+    buffer_dropped,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id)
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    mir_server_compositor,
+    stream_buffer_event,
+    buffer_released,
+    TP_ARGS(void const*, stream, uint32_t, buffer_id)
+)
+
 TRACEPOINT_EVENT_CLASS(
     mir_server_compositor,
     subcompositor_event,
@@ -52,3 +52,13 @@ void mir::report::lttng::DisplayReport::report_vsync(unsigned int output_id,
 {
     mir_tracepoint(mir_server_display, report_vsync, output_id);
 }
+
+void mir::report::lttng::DisplayReport::report_dmabuf_import(uint32_t drm_fourcc, std::chrono::nanoseconds duration)
+{
+    mir_tracepoint(mir_server_display, report_dmabuf_import, drm_fourcc, duration.count());
+}
+
+void mir::report::lttng::DisplayReport::report_dmabuf_import_reused(uint32_t drm_fourcc)
+{
+    mir_tracepoint(mir_server_display, report_dmabuf_import_reused, drm_fourcc);
+}
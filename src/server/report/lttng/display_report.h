@@ -46,6 +46,8 @@ public:
     virtual void report_vt_switch_away_failure() override;
     virtual void report_vt_switch_back_failure() override;
     virtual void report_vsync(unsigned int output_id, graphics::Frame const&) override;
+    virtual void report_dmabuf_import(uint32_t drm_fourcc, std::chrono::nanoseconds duration) override;
+    virtual void report_dmabuf_import_reused(uint32_t drm_fourcc) override;
 
 private:
     ServerTracepointProvider tp_provider;
@@ -71,6 +71,25 @@ TRACEPOINT_EVENT(
      )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_display,
+    report_dmabuf_import,
+    TP_ARGS(uint32_t, drm_fourcc, uint64_t, duration_ns),
+    TP_FIELDS(
+        ctf_integer_hex(uint32_t, drm_fourcc, drm_fourcc)
+        ctf_integer(uint64_t, duration_ns, duration_ns)
+     )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_display,
+    report_dmabuf_import_reused,
+    TP_ARGS(uint32_t, drm_fourcc),
+    TP_FIELDS(
+        ctf_integer_hex(uint32_t, drm_fourcc, drm_fourcc)
+     )
+)
+
 #endif /* MIR_LTTNG_DISPLAY_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
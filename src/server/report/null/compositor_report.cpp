@@ -36,10 +36,46 @@ void mrn::CompositorReport::rendered_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::damage_in_frame(SubCompositorId, mir::geometry::Rectangle const&)
+{
+}
+
+void mrn::CompositorReport::draw_calls_in_frame(SubCompositorId, unsigned)
+{
+}
+
 void mrn::CompositorReport::finished_frame(SubCompositorId)
 {
 }
 
+void mrn::CompositorReport::presented_frame(SubCompositorId, std::chrono::nanoseconds)
+{
+}
+
+void mrn::CompositorReport::buffer_submitted(StreamId, graphics::BufferID, unsigned)
+{
+}
+
+void mrn::CompositorReport::buffer_dropped(StreamId, graphics::BufferID)
+{
+}
+
+void mrn::CompositorReport::buffer_acquired(StreamId, SubCompositorId, graphics::BufferID, std::chrono::nanoseconds)
+{
+}
+
+void mrn::CompositorReport::buffer_reacquired(StreamId, SubCompositorId, graphics::BufferID)
+{
+}
+
+void mrn::CompositorReport::buffer_released(StreamId, graphics::BufferID)
+{
+}
+
+void mrn::CompositorReport::buffer_presented(StreamId, graphics::BufferID, std::chrono::nanoseconds)
+{
+}
+
 void mrn::CompositorReport::started()
 {
 }
@@ -44,6 +44,8 @@ public:
     void report_vt_switch_back_failure() override;
     void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) override;
     void report_vsync(unsigned int output_id, graphics::Frame const&) override;
+    void report_dmabuf_import(uint32_t drm_fourcc, std::chrono::nanoseconds duration) override;
+    void report_dmabuf_import_reused(uint32_t drm_fourcc) override;
 };
 }
 }
@@ -25,6 +25,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/pixel_format_utils.h"
+#include "mir/graphics/presentation.h"
 #include "mir/geometry/displacement.h"
 #include "mir/renderer/sw/pixel_source.h"
 
@@ -35,6 +36,7 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
 
 #include <string.h> // memcpy
 
@@ -171,6 +173,12 @@ void ms::SurfaceObservers::application_id_set_to(Surface const* surf, std::strin
                  { observer->application_id_set_to(surf, application_id); });
 }
 
+void ms::SurfaceObservers::input_region_set_to(Surface const* surf, std::vector<geometry::Rectangle> const& region)
+{
+    for_each([&](std::shared_ptr<SurfaceObserver> const& observer)
+                 { observer->input_region_set_to(surf, region); });
+}
+
 ms::BasicSurface::ProofOfMutexLock::ProofOfMutexLock(std::unique_lock<std::mutex> const& lock)
 {
     if (!lock.owns_lock())
@@ -336,6 +344,8 @@ void ms::BasicSurface::set_hidden(bool hide)
     {
         std::lock_guard<std::mutex> lock(guard);
         hidden = hide;
+        if (hidden)
+            generated_renderables.clear();
     }
     observers->hidden_set_to(this, hide);
 }
@@ -366,8 +376,11 @@ std::shared_ptr<mf::BufferStream> ms::BasicSurface::primary_buffer_stream() cons
 
 void ms::BasicSurface::set_input_region(std::vector<geom::Rectangle> const& input_rectangles)
 {
-    std::lock_guard<std::mutex> lock(guard);
-    custom_input_rectangles = input_rectangles;
+    {
+        std::lock_guard<std::mutex> lock(guard);
+        custom_input_rectangles = input_rectangles;
+    }
+    observers->input_region_set_to(this, input_rectangles);
 }
 
 void ms::BasicSurface::resize(geom::Size const& desired_size)
@@ -400,6 +413,32 @@ geom::Rectangle ms::BasicSurface::input_bounds() const
     return geom::Rectangle{content_top_left(lock), content_size(lock)};
 }
 
+geom::Rectangle ms::BasicSurface::input_region_bounds() const
+{
+    std::lock_guard<std::mutex> lock(guard);
+    auto const content_top_left_ = content_top_left(lock);
+    auto bounds = geom::Rectangle{content_top_left_, content_size(lock)};
+
+    // Custom rectangles may reach outside the content (e.g. for subsurfaces)
+    for (auto const& rectangle : custom_input_rectangles)
+    {
+        if (rectangle.size.width <= geom::Width{} || rectangle.size.height <= geom::Height{})
+            continue;
+
+        auto const top_left = rectangle.top_left + as_displacement(content_top_left_);
+        auto const bottom_right = rectangle.bottom_right() + as_displacement(content_top_left_);
+        auto const new_top_left = geom::Point{
+            std::min(bounds.top_left.x, top_left.x),
+            std::min(bounds.top_left.y, top_left.y)};
+        auto const new_bottom_right = geom::Point{
+            std::max(bounds.bottom_right().x, bottom_right.x),
+            std::max(bounds.bottom_right().y, bottom_right.y)};
+        bounds = geom::Rectangle{new_top_left, as_size(new_bottom_right - new_top_left)};
+    }
+
+    return bounds;
+}
+
 // TODO: Does not account for transformation().
 bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
 {
@@ -798,6 +837,9 @@ std::shared_ptr<ms::Surface> ms::BasicSurface::parent() const
 namespace
 {
 //This class avoids locking for long periods of time by copying (or lazy-copying)
+/// How many renderable generations (across all compositors) a compositor's renderables outlive its last request
+uint64_t const max_renderable_generations{64};
+
 class SurfaceSnapshot : public mg::Renderable
 {
 public:
@@ -835,6 +877,11 @@ public:
         return compositor_buffer;
     }
 
+    std::experimental::optional<geom::Rectangles> damage_since(mg::BufferID earlier) const override
+    {
+        return underlying_buffer_stream->damage_between(earlier, buffer()->id());
+    }
+
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
@@ -850,8 +897,70 @@ public:
     bool shaped() const override
     { return mg::contains_alpha(underlying_buffer_stream->pixel_format()); }
 
+    geom::Rectangles opaque_region() const override
+    {
+        if (!shaped())
+            return geom::Rectangles{screen_position_};
+
+        // The region is in the stream's logical coordinates, which are stretched over screen_position_
+        auto const logical_size = underlying_buffer_stream->stream_size();
+        if (logical_size.width == geom::Width{} || logical_size.height == geom::Height{})
+            return {};
+
+        auto const sx = double(screen_position_.size.width.as_int()) / logical_size.width.as_int();
+        auto const sy = double(screen_position_.size.height.as_int()) / logical_size.height.as_int();
+        auto const origin = screen_position_.top_left;
+
+        geom::Rectangles region;
+        for (auto const& rect : underlying_buffer_stream->opaque_region())
+        {
+            // Round inwards, so that no partly translucent pixel is claimed to be opaque
+            auto const left = int(std::ceil(rect.left().as_int() * sx));
+            auto const top = int(std::ceil(rect.top().as_int() * sy));
+            auto const right = int(std::floor(rect.right().as_int() * sx));
+            auto const bottom = int(std::floor(rect.bottom().as_int() * sy));
+
+            auto const on_screen = geom::Rectangle{
+                {origin.x.as_int() + left, origin.y.as_int() + top},
+                {std::max(right - left, 0), std::max(bottom - top, 0)}}.intersection_with(screen_position_);
+
+            if (on_screen.size.width > geom::Width{} && on_screen.size.height > geom::Height{})
+                region.add(on_screen);
+        }
+        return region;
+    }
+
     mg::Renderable::ID id() const override
     { return id_; }
+
+    /// Whether this snapshot still matches how the surface would show \a stream
+    bool shows(
+        std::shared_ptr<mc::BufferStream> const& stream,
+        geom::Rectangle const& position,
+        std::experimental::optional<geom::Rectangle> const& clip_area,
+        glm::mat4 const& transform,
+        float alpha) const
+    {
+        return stream == underlying_buffer_stream &&
+               position == screen_position_ &&
+               clip_area == clip_area_ &&
+               transform == transformation_ &&
+               alpha == alpha_;
+    }
+
+    auto on_presented() const -> std::function<void(mg::Presentation const&)> override
+    {
+        // Only a buffer that was actually used can be shown
+        if (!compositor_buffer)
+            return {};
+
+        return [stream = std::weak_ptr<mc::BufferStream>{underlying_buffer_stream}, id = compositor_buffer->id()]
+            (mg::Presentation const& presentation)
+            {
+                if (auto const live_stream = stream.lock())
+                    live_stream->presented(id, presentation);
+            };
+    }
 private:
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
@@ -905,6 +1014,7 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
             layer.stream->set_frame_posted_callback([](auto){});
 
         layers = s;
+        generated_renderables.clear();
 
         for(auto& layer : layers)
             layer.stream->set_frame_posted_callback(
@@ -930,6 +1040,8 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
     }
 
     auto const content_top_left_ = content_top_left(lock);
+    auto& generated = generated_renderables[id];
+    auto previous = generated.renderables.begin();
 
     for (auto const& info : layers)
     {
@@ -941,13 +1053,44 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
-                info.stream, id,
-                geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
-                clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+            geom::Rectangle const position{content_top_left_ + info.displacement, std::move(size)};
+
+            // A stream with nothing new for this compositor still shows the buffer it last had,
+            // so if it is also in the same place the last renderable for it will do
+            if (previous != generated.renderables.end() &&
+                static_cast<SurfaceSnapshot const&>(**previous).shows(
+                    info.stream, position, clip_area_, transformation_matrix, surface_alpha) &&
+                !info.stream->buffers_ready_for_compositor(id))
+            {
+                list.push_back(*previous);
+            }
+            else
+            {
+                list.emplace_back(std::make_shared<SurfaceSnapshot>(
+                    info.stream, id,
+                    position,
+                    clip_area_,
+                    transformation_matrix, surface_alpha, info.stream.get()));
+            }
+
+            if (previous != generated.renderables.end())
+                ++previous;
         }
     }
+
+    generated.generation = ++renderable_generation;
+    generated.renderables = list;
+
+    // Forget compositors that have stopped asking (e.g. after a display reconfiguration),
+    // so we don't keep their buffers alive
+    for (auto i = generated_renderables.begin(); i != generated_renderables.end();)
+    {
+        if (renderable_generation - i->second.generation > max_renderable_generations)
+            i = generated_renderables.erase(i);
+        else
+            ++i;
+    }
+
     return list;
 }
 
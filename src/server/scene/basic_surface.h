@@ -30,6 +30,7 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -45,6 +46,7 @@ namespace frontend { class EventSink; }
 namespace graphics
 {
 class Buffer;
+class Renderable;
 }
 namespace input
 {
@@ -100,6 +102,7 @@ public:
     void resize(geometry::Size const& size) override;
     geometry::Point top_left() const override;
     geometry::Rectangle input_bounds() const override;
+    geometry::Rectangle input_region_bounds() const override;
     bool input_area_contains(geometry::Point const& point) const override;
     void consume(MirEvent const* event) override;
     void set_alpha(float alpha) override;
@@ -201,6 +204,16 @@ private:
     std::weak_ptr<Surface> const parent_;
 
     std::list<StreamInfo> layers;
+
+    /// The renderables last generated for a compositor, reused while nothing they show changes
+    struct GeneratedRenderables
+    {
+        uint64_t generation;
+        std::vector<std::shared_ptr<graphics::Renderable>> renderables;
+    };
+    std::map<compositor::CompositorID, GeneratedRenderables> mutable generated_renderables;
+    uint64_t mutable renderable_generation{0};
+
     // Surface attributes:
     MirWindowType type_ = mir_window_type_normal;
     MirWindowState state_ = mir_window_state_restored;
@@ -18,12 +18,15 @@
 
 #include "gl_pixel_buffer.h"
 #include "mir/graphics/buffer.h"
+#include "mir/graphics/pixel_ops.h"
 #include "mir/renderer/gl/context.h"
 #include "mir/renderer/gl/texture_source.h"
 
+#include <cstdio>
+#include <cstring>
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
 #include <GLES2/gl2ext.h>
 
 namespace mg = mir::graphics;
@@ -39,19 +42,15 @@ bool is_big_endian()
     return (*reinterpret_cast<char*>(&n) != 1);
 }
 
-inline uint32_t abgr_to_argb(uint32_t p)
-{
-    return ((p << 16) & 0x00ff0000) | /* Move R to new position */
-           ((p) & 0x0000ff00) |       /* G remains at same position */
-           ((p >> 16) & 0x000000ff) | /* Move B to new position */
-           ((p) & 0xff000000);        /* A remains at same position */
-}
+/// How long to wait for the GPU to copy a buffer, in nanoseconds; a healthy GPU takes far less
+GLuint64 const copy_timeout{1000000000};
 
 }
 
 ms::GLPixelBuffer::GLPixelBuffer(std::unique_ptr<renderer::gl::Context> gl_context)
     : gl_context{std::move(gl_context)},
-      tex{0}, fbo{0}, gl_pixel_format{0}, pixels_need_y_flip{false}
+      tex{0}, fbo{0}, gl_pixel_format{0}, pixels_need_y_flip{false},
+      readback{Readback::unknown}, copy_tex{0}, copy_fbo{0}, pbo{0}, pbo_size{0}, pbo_holds_pixels{false}
 {
     /*
      * TODO: Handle systems that are big-endian, and therefore GL_BGRA doesn't
@@ -70,9 +69,15 @@ ms::GLPixelBuffer::~GLPixelBuffer() noexcept
      * This may be called from a different thread
      * than the one that called prepare
      */
-    if (tex != 0 || fbo != 0)
+    if (tex != 0 || fbo != 0 || copy_tex != 0 || pbo != 0)
         gl_context->make_current();
 
+    if (pbo != 0)
+        glDeleteBuffers(1, &pbo);
+    if (copy_tex != 0)
+        glDeleteTextures(1, &copy_tex);
+    if (copy_fbo != 0)
+        glDeleteFramebuffers(1, &copy_fbo);
     if (tex != 0)
         glDeleteTextures(1, &tex);
     if (fbo != 0)
@@ -83,6 +88,17 @@ void ms::GLPixelBuffer::prepare()
 {
     gl_context->make_current();
 
+    if (readback == Readback::unknown)
+    {
+        /* Pixel buffer objects and fences are core in GLES 3 */
+        auto const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+        int major{0};
+        if (version && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+            readback = Readback::pixel_buffer_object;
+        else
+            readback = Readback::direct;
+    }
+
     if (tex == 0)
         glGenTextures(1, &tex);
 
@@ -95,6 +111,61 @@ void ms::GLPixelBuffer::prepare()
     glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 }
 
+void ms::GLPixelBuffer::read_pixels(GLsizei width, GLsizei height, GLvoid* dest)
+{
+    /* First try to get pixels as BGRA, unless we've already found that fails */
+    if (gl_pixel_format != GL_RGBA)
+    {
+        glGetError();
+        glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, dest);
+
+        if (glGetError() == GL_NO_ERROR)
+        {
+            gl_pixel_format = GL_BGRA_EXT;
+            return;
+        }
+    }
+
+    /* If getting pixels as BGRA failed, fall back to RGBA */
+    gl_pixel_format = GL_RGBA;
+    glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, dest);
+}
+
+void ms::GLPixelBuffer::copy_to_private_texture(geom::Size const& size)
+{
+    auto const width = size.width.as_int();
+    auto const height = size.height.as_int();
+
+    if (copy_tex == 0)
+    {
+        glGenTextures(1, &copy_tex);
+        glGenFramebuffers(1, &copy_fbo);
+    }
+
+    if (size != copy_size)
+    {
+        glBindTexture(GL_TEXTURE_2D, copy_tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindFramebuffer(GL_FRAMEBUFFER, copy_fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, copy_tex, 0);
+        copy_size = size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, copy_fbo);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    /* We only have the buffer until fill_from() returns, after which the client may draw into it again */
+    auto const copied = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    auto const status = glClientWaitSync(copied, GL_SYNC_FLUSH_COMMANDS_BIT, copy_timeout);
+    glDeleteSync(copied);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, copy_fbo);
+
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        BOOST_THROW_EXCEPTION(std::runtime_error("Timed out copying buffer for readback"));
+}
+
 void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
 {
     auto width = buffer.size().width.as_uint32_t();
@@ -113,50 +184,96 @@ void ms::GLPixelBuffer::fill_from(graphics::Buffer& buffer)
 
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
 
-    /* First try to get pixels as BGRA */
-    glGetError();
-    gl_pixel_format = GL_BGRA_EXT;
-    glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+    if (readback == Readback::pixel_buffer_object)
+    {
+        /* Whatever fails, don't hand out a previous buffer's pixels */
+        size_ = geom::Size{};
+        pixels_need_y_flip = false;
+        pbo_holds_pixels = false;
 
-    /* If getting pixels as BGRA failed, fall back to RGBA */
-    if (glGetError() != GL_NO_ERROR)
+        /*
+         * Copying the buffer to a texture of our own is quick, and once that's done
+         * the client can have its buffer back while the GPU reads back our copy.
+         */
+        copy_to_private_texture(buffer.size());
+
+        if (pbo == 0)
+            glGenBuffers(1, &pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+
+        GLsizeiptr const size = pixels.size();
+        if (size > pbo_size)
+        {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+            pbo_size = size;
+        }
+
+        /* Mapping the PBO and converting the pixels waits until they're asked for */
+        read_pixels(width, height, nullptr);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pbo_holds_pixels = true;
+    }
+    else
     {
-        gl_pixel_format = GL_RGBA;
-        glReadPixels(0, 0, width, height, gl_pixel_format, GL_UNSIGNED_BYTE, pixels.data());
+        read_pixels(width, height, pixels.data());
     }
 
     size_ = buffer.size();
     pixels_need_y_flip = true;
 }
 
-void const* ms::GLPixelBuffer::as_argb_8888()
+void ms::GLPixelBuffer::collect_readback()
 {
-    if (pixels_need_y_flip)
+    gl_context->make_current();
+    pbo_holds_pixels = false;
+
+    auto const width = size_.width.as_uint32_t();
+    auto const height = size_.height.as_uint32_t();
+    auto const row_size = stride().as_uint32_t();
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    auto const mapped = static_cast<char const*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, pixels.size(), GL_MAP_READ_BIT));
+    if (!mapped)
     {
-        auto const stride_val = stride().as_uint32_t();
-        auto const height = size_.height.as_uint32_t();
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Failed to map pixel buffer object"));
+    }
 
-        std::vector<char> tmp(stride_val);
+    /* Flip (and, for RGBA, convert) as we copy out of the mapping, rather than in a second pass */
+    for (unsigned y = 0; y != height; ++y)
+    {
+        auto const src = mapped + (height - 1 - y) * row_size;
+        auto const dest = pixels.data() + y * row_size;
 
-        for (unsigned int i = 0; i < height / 2; i++)
-        {
-            /* Store line i */
-            tmp.assign(&pixels[i * stride_val], &pixels[(i + 1) * stride_val]);
+        if (gl_pixel_format == GL_RGBA)
+            mg::pixel_ops::swap_red_and_blue(src, dest, width);
+        else
+            memcpy(dest, src, row_size);
+    }
 
-            /* Copy line height - i - 1 to line i */
-            copy_and_convert_pixel_line(&pixels[(height - i - 1) * stride_val],
-                                        &pixels[i * stride_val]);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
 
-            /* Copy stored line (i) to height - i - 1 */
-            copy_and_convert_pixel_line(tmp.data(),
-                                        &pixels[(height - i - 1) * stride_val]);
+void const* ms::GLPixelBuffer::as_argb_8888()
+{
+    if (pixels_need_y_flip)
+    {
+        if (pbo_holds_pixels)
+        {
+            collect_readback();
         }
-
-        /* Process middle line if there is one */
-        if (height % 2 == 1)
+        else
         {
-            copy_and_convert_pixel_line(&pixels[(height / 2) * stride_val],
-                                        &pixels[(height / 2) * stride_val]);
+            if (gl_pixel_format == GL_RGBA)
+            {
+                /* Convert from abgr_8888 to argb_8888 */
+                mg::pixel_ops::swap_red_and_blue(pixels.data(), pixels.data(), pixels.size() / sizeof(uint32_t));
+            }
+
+            mg::pixel_ops::flip_vertically(pixels.data(), stride().as_uint32_t(), size_.height.as_uint32_t());
         }
 
         pixels_need_y_flip = false;
@@ -174,21 +291,3 @@ geom::Stride ms::GLPixelBuffer::stride() const
 {
     return geom::Stride{size_.width.as_uint32_t() * sizeof(uint32_t)};
 }
-
-void ms::GLPixelBuffer::copy_and_convert_pixel_line(char* src, char* dst)
-{
-    if (gl_pixel_format == GL_RGBA)
-    {
-        /* Convert from abgr_8888 to argb_8888 while copying */
-        auto pixels_src = reinterpret_cast<uint32_t*>(src);
-        auto pixels_dst = reinterpret_cast<uint32_t*>(dst);
-        auto const width = size_.width.as_uint32_t();
-
-        for (uint32_t n = 0; n < width; n++)
-            pixels_dst[n] = abgr_to_argb(pixels_src[n]);
-    }
-    else if (src != dst)
-    {
-        std::copy(src, src + stride().as_uint32_t(), dst);
-    }
-}
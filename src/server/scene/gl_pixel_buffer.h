@@ -24,7 +24,7 @@
 #include <memory>
 #include <vector>
 
-#include <GLES2/gl2.h>
+#include <GLES3/gl3.h>
 
 namespace mir
 {
@@ -42,7 +42,14 @@ class Context;
 
 namespace scene
 {
-/** Extracts the pixels from a graphics::Buffer using GL facilities. */
+/**
+ * Extracts the pixels from a graphics::Buffer using GL facilities.
+ *
+ * On GLES 3 the GPU copies the buffer into a texture of our own, and reads that back
+ * into a pixel buffer object. fill_from() only waits (for a bounded time) for the first
+ * copy, as the buffer may be reused once it returns; mapping the pixel buffer object,
+ * and converting its contents, is left to as_argb_8888().
+ */
 class GLPixelBuffer : public PixelBuffer
 {
 public:
@@ -56,7 +63,9 @@ public:
 
 private:
     void prepare();
-    void copy_and_convert_pixel_line(char* src, char* dst);
+    void read_pixels(GLsizei width, GLsizei height, GLvoid* dest);
+    void copy_to_private_texture(geometry::Size const& size);
+    void collect_readback();
 
     std::unique_ptr<renderer::gl::Context> const gl_context;
     GLuint tex;
@@ -64,6 +73,14 @@ private:
     std::vector<char> pixels;
     GLuint gl_pixel_format;
     bool pixels_need_y_flip;
+
+    enum class Readback { unknown, direct, pixel_buffer_object } readback;
+    GLuint copy_tex;
+    GLuint copy_fbo;
+    geometry::Size copy_size;
+    GLuint pbo;
+    GLsizeiptr pbo_size;
+    bool pbo_holds_pixels;  ///< Whether the last fill_from() is still to be collected
     geometry::Size size_;
     geometry::Stride stride_;
 };
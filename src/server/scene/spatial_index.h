@@ -0,0 +1,263 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SPATIAL_INDEX_H_
+#define MIR_SCENE_SPATIAL_INDEX_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * Finds the topmost of a stack of items whose bounds contain a point.
+ *
+ * The plane is divided into a uniform grid and each cell lists the items
+ * whose bounds overlap it, topmost first. Looking up a point only considers
+ * the items in its cell, so the cost depends on how many items overlap there
+ * rather than how many there are. Items too big to be worth adding to every
+ * cell they cover are kept in a separate list and always considered.
+ *
+ * Not thread safe: the owner serializes access.
+ */
+template<typename Item>
+class SpatialIndex
+{
+public:
+    /// Width and height of a grid cell
+    static int constexpr cell_size = 256;
+
+    /// Items covering more cells than this are always considered instead
+    static size_t constexpr max_cells_per_item = 1024;
+
+    /// Adds an item on top of the others
+    void add(std::shared_ptr<Item> const& item, geometry::Rectangle const& bounds)
+    {
+        auto& entry = entries[item.get()];
+        if (entry.item)
+            unlink(item.get(), entry);
+
+        entry.item = item;
+        entry.bounds = bounds;
+        entry.order = next_order++;
+        link(item.get(), entry);
+    }
+
+    /// Updates the bounds of an item (if it has been added)
+    void update(Item const* item, geometry::Rectangle const& bounds)
+    {
+        auto const existing = entries.find(item);
+        if (existing == entries.end() || existing->second.bounds == bounds)
+            return;
+
+        unlink(item, existing->second);
+        existing->second.bounds = bounds;
+        link(item, existing->second);
+    }
+
+    void remove(Item const* item)
+    {
+        auto const existing = entries.find(item);
+        if (existing != entries.end())
+        {
+            unlink(item, existing->second);
+            entries.erase(existing);
+        }
+    }
+
+    /// Restacks the items in the given order (bottom to top), which must include every item added
+    template<typename Sequence>
+    void restack(Sequence const& bottom_to_top)
+    {
+        next_order = 0;
+        for (auto const& item : bottom_to_top)
+        {
+            auto const entry = entries.find(&*item);
+            if (entry != entries.end())
+                entry->second.order = next_order++;
+        }
+
+        for (auto& cell : cells)
+            sort(cell.second);
+        sort(oversized);
+    }
+
+    /**
+     * The topmost item with bounds containing point that is accepted by \a accept
+     *
+     * \a accept is called for the candidates from the top down until it returns true.
+     */
+    template<typename Accept>
+    auto top_item_at(geometry::Point const& point, Accept const& accept) const -> std::shared_ptr<Item>
+    {
+        static std::vector<Slot> const none;
+
+        auto const cell = cells.find(cell_key(cell_of(point.x.as_int()), cell_of(point.y.as_int())));
+        auto const& local = cell != cells.end() ? cell->second : none;
+
+        // Both lists are topmost first, so merge them
+        auto l = local.begin();
+        auto o = oversized.begin();
+        while (l != local.end() || o != oversized.end())
+        {
+            auto const& slot = (o == oversized.end() || (l != local.end() && l->order > o->order)) ? *l++ : *o++;
+
+            auto const& entry = entries.at(slot.item);
+            if (entry.bounds.contains(point) && accept(*entry.item))
+                return entry.item;
+        }
+
+        return {};
+    }
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<Item> item;
+        geometry::Rectangle bounds;
+        uint64_t order;
+    };
+
+    /// An entry in a list of candidates, with a copy of the item's order so lists sort without lookups
+    struct Slot
+    {
+        Item const* item;
+        uint64_t order;
+    };
+
+    static auto cell_of(int coordinate) -> int32_t
+    {
+        // Round towards negative infinity, so cells don't straddle the axes
+        return coordinate >= 0 ? coordinate / cell_size : (coordinate + 1) / cell_size - 1;
+    }
+
+    static auto cell_key(int32_t cx, int32_t cy) -> uint64_t
+    {
+        return (uint64_t{static_cast<uint32_t>(cx)} << 32) | static_cast<uint32_t>(cy);
+    }
+
+    struct CellRange
+    {
+        int32_t left, top, right, bottom;  ///< Inclusive
+
+        auto count() const -> uint64_t
+        {
+            return uint64_t(right - left + 1) * uint64_t(bottom - top + 1);
+        }
+    };
+
+    static auto cells_of(geometry::Rectangle const& bounds) -> CellRange
+    {
+        auto const bottom_right = bounds.bottom_right();
+        return {
+            cell_of(bounds.top_left.x.as_int()),
+            cell_of(bounds.top_left.y.as_int()),
+            cell_of(bottom_right.x.as_int() - 1),
+            cell_of(bottom_right.y.as_int() - 1)};
+    }
+
+    static auto is_empty(geometry::Rectangle const& bounds) -> bool
+    {
+        return bounds.size.width.as_int() <= 0 || bounds.size.height.as_int() <= 0;
+    }
+
+    void link(Item const* item, Entry const& entry)
+    {
+        Slot const slot{item, entry.order};
+        auto const add_to = [&slot](std::vector<Slot>& list)
+            {
+                auto const p = std::find_if(list.begin(), list.end(),
+                    [&slot](Slot const& s) { return s.order < slot.order; });
+                list.insert(p, slot);
+            };
+
+        if (is_empty(entry.bounds))
+            return;
+
+        auto const range = cells_of(entry.bounds);
+        if (range.count() > max_cells_per_item)
+        {
+            add_to(oversized);
+            return;
+        }
+
+        for (auto cy = range.top; cy <= range.bottom; ++cy)
+        {
+            for (auto cx = range.left; cx <= range.right; ++cx)
+                add_to(cells[cell_key(cx, cy)]);
+        }
+    }
+
+    void unlink(Item const* item, Entry const& entry)
+    {
+        auto const remove_from = [item](std::vector<Slot>& list)
+            {
+                list.erase(
+                    std::remove_if(list.begin(), list.end(), [item](Slot const& s) { return s.item == item; }),
+                    list.end());
+            };
+
+        if (is_empty(entry.bounds))
+            return;
+
+        auto const range = cells_of(entry.bounds);
+        if (range.count() > max_cells_per_item)
+        {
+            remove_from(oversized);
+            return;
+        }
+
+        for (auto cy = range.top; cy <= range.bottom; ++cy)
+        {
+            for (auto cx = range.left; cx <= range.right; ++cx)
+            {
+                auto const cell = cells.find(cell_key(cx, cy));
+                if (cell == cells.end())
+                    continue;
+
+                remove_from(cell->second);
+
+                // Drop unused cells, so a moving item doesn't leave a trail behind it
+                if (cell->second.empty())
+                    cells.erase(cell);
+            }
+        }
+    }
+
+    void sort(std::vector<Slot>& list)
+    {
+        for (auto& slot : list)
+            slot.order = entries.at(slot.item).order;
+
+        std::sort(list.begin(), list.end(), [](Slot const& a, Slot const& b) { return a.order > b.order; });
+    }
+
+    std::unordered_map<Item const*, Entry> entries;
+    std::unordered_map<uint64_t, std::vector<Slot>> cells;
+    std::vector<Slot> oversized;
+    uint64_t next_order{0};
+};
+}
+}
+
+#endif // MIR_SCENE_SPATIAL_INDEX_H_
@@ -33,6 +33,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <shared_mutex>
 #include <stdexcept>
 
 namespace ms = mir::scene;
@@ -48,14 +49,12 @@ class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -78,7 +77,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -109,11 +107,12 @@ private:
 };
 
 /**
- * A SurfaceDepthLayerObserver must not outlive the SurfaceStack it was created for
+ * Keeps the SurfaceStack up to date with changes to the surfaces in it.
+ * A StackedSurfaceObserver must not outlive the SurfaceStack it was created for
  */
-struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
+struct StackedSurfaceObserver : ms::NullSurfaceObserver
 {
-    SurfaceDepthLayerObserver(ms::SurfaceStack* stack)
+    StackedSurfaceObserver(ms::SurfaceStack* stack)
         : stack{stack}
     {
     }
@@ -124,6 +123,21 @@ struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
         stack->raise(surface);
     }
 
+    void moved_to(ms::Surface const* surface, geom::Point const& /*top_left*/) override
+    {
+        stack->update_input_bounds(surface);
+    }
+
+    void content_resized_to(ms::Surface const* surface, geom::Size const& /*content_size*/) override
+    {
+        stack->update_input_bounds(surface);
+    }
+
+    void input_region_set_to(ms::Surface const* surface, std::vector<geom::Rectangle> const& /*region*/) override
+    {
+        stack->update_input_bounds(surface);
+    }
+
 private:
     ms::SurfaceStack* stack;
 };
@@ -133,14 +147,15 @@ private:
 ms::SurfaceStack::SurfaceStack(
     std::shared_ptr<SceneReport> const& report) :
     report{report},
+    rendering_snapshot{std::make_shared<RenderingSnapshot>()},
     scene_changed{false},
-    surface_observer{std::make_shared<SurfaceDepthLayerObserver>(this)}
+    surface_observer{std::make_shared<StackedSurfaceObserver>(this)}
 {
 }
 
 ms::SurfaceStack::~SurfaceStack() noexcept(true)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard<decltype(guard)> lg(guard);
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
@@ -152,29 +167,25 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
 
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
-    RecursiveReadLock lg(guard);
+    auto const snapshot = std::atomic_load(&rendering_snapshot);
 
     scene_changed = false;
     mc::SceneElementSequence elements;
-    for (auto const& layer : surface_layers)
+    for (auto const& entry : snapshot->surfaces)
     {
-        for (auto const& surface : layer)
+        if (entry.surface->visible())
         {
-            if (surface->visible())
+            for (auto& renderable : entry.surface->generate_renderables(id))
             {
-                for (auto& renderable : surface->generate_renderables(id))
-                {
-                    elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
-                            renderable,
-                            rendering_trackers[surface.get()],
-                            id));
-                }
+                elements.emplace_back(
+                    std::make_shared<SurfaceSceneElement>(
+                        renderable,
+                        entry.tracker,
+                        id));
             }
         }
     }
-    for (auto const& renderable : overlays)
+    for (auto const& renderable : snapshot->overlays)
     {
         elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
     }
@@ -183,26 +194,19 @@ mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID i
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 {
-    RecursiveReadLock lg(guard);
+    auto const snapshot = std::atomic_load(&rendering_snapshot);
 
     int result = scene_changed ? 1 : 0;
-    for (auto const& layer : surface_layers)
+    for (auto const& entry : snapshot->surfaces)
     {
-        for (auto const& surface : layer)
+        if (entry.surface->visible() && entry.tracker->is_exposed_in(id))
         {
-            if (surface->visible())
-            {
-                auto const tracker = rendering_trackers.find(surface.get());
-                if (tracker != rendering_trackers.end() && tracker->second->is_exposed_in(id))
-                {
-                    // Note that we ask the surface and not a Renderable.
-                    // This is because we don't want to waste time and resources
-                    // on a snapshot till we're sure we need it...
-                    int ready = surface->buffers_ready_for_compositor(id);
-                    if (ready > result)
-                        result = ready;
-                }
-            }
+            // Note that we ask the surface and not a Renderable.
+            // This is because we don't want to waste time and resources
+            // on a snapshot till we're sure we need it...
+            int ready = entry.surface->buffers_ready_for_compositor(id);
+            if (ready > result)
+                result = ready;
         }
     }
     return result;
@@ -210,7 +214,7 @@ int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
 
 void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard<decltype(guard)> lg(guard);
 
     registered_compositors.insert(cid);
 
@@ -219,7 +223,7 @@ void ms::SurfaceStack::register_compositor(mc::CompositorID cid)
 
 void ms::SurfaceStack::unregister_compositor(mc::CompositorID cid)
 {
-    RecursiveWriteLock lg(guard);
+    std::lock_guard<decltype(guard)> lg(guard);
 
     registered_compositors.erase(cid);
 
@@ -230,8 +234,9 @@ void ms::SurfaceStack::add_input_visualization(
     std::shared_ptr<mg::Renderable> const& overlay)
 {
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<decltype(guard)> lg(guard);
         overlays.push_back(overlay);
+        publish_rendering_snapshot();
     }
     emit_scene_changed();
 }
@@ -241,13 +246,14 @@ void ms::SurfaceStack::remove_input_visualization(
 {
     auto overlay = weak_overlay.lock();
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<decltype(guard)> lg(guard);
         auto const p = std::find(overlays.begin(), overlays.end(), overlay);
         if (p == overlays.end())
         {
             BOOST_THROW_EXCEPTION(std::runtime_error("Attempt to remove an overlay which was never added or which has been previously removed"));
         }
         overlays.erase(p);
+        publish_rendering_snapshot();
     }
     
     emit_scene_changed();
@@ -256,7 +262,7 @@ void ms::SurfaceStack::remove_input_visualization(
 void ms::SurfaceStack::emit_scene_changed()
 {
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<decltype(guard)> lg(guard);
         scene_changed = true;
     }
     observers.scene_changed();
@@ -267,10 +273,13 @@ void ms::SurfaceStack::add_surface(
     mi::InputReceptionMode input_mode)
 {
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<decltype(guard)> lg(guard);
         insert_surface_at_top_of_depth_layer(surface);
         create_rendering_tracker_for(surface);
         surface->add_observer(surface_observer);
+        input_index.add(surface, surface->input_region_bounds());
+        restack_input_index();
+        publish_rendering_snapshot();
     }
     surface->set_reception_mode(input_mode);
     observers.surface_added(surface);
@@ -284,7 +293,7 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
 
     bool found_surface = false;
     {
-        RecursiveWriteLock lg(guard);
+        std::lock_guard<decltype(guard)> lg(guard);
 
         for (auto& layer : surface_layers)
         {
@@ -295,6 +304,8 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
                 layer.erase(surface);
                 rendering_trackers.erase(keep_alive.get());
                 keep_alive->remove_observer(surface_observer);
+                input_index.remove(keep_alive.get());
+                publish_rendering_snapshot();
                 found_surface = true;
                 break;
             }
@@ -309,42 +320,35 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
+auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
+-> std::shared_ptr<Surface>
 {
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
+    std::shared_lock<decltype(guard)> lg(guard);
 
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    return input_index.top_item_at(cursor, [&](Surface const& surface)
+        {
+            return surface.input_area_contains(cursor);
+        });
 }
 
-auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
--> std::shared_ptr<Surface>
+auto ms::SurfaceStack::input_surface_at(geometry::Point const& point) -> std::shared_ptr<mi::Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : in_reverse(surface_layers))
-    {
-        for (auto const& surface : in_reverse(layer))
-        {
-            // TODO There's a lack of clarity about how the input area will
-            // TODO be maintained and whether this test will detect clicks on
-            // TODO decorations (it should) as these may be outside the area
-            // TODO known to the client.  But it works for now.
-            if (surface->input_area_contains(cursor))
-                    return surface;
-        }
-    }
+    return surface_at(point);
+}
 
-    return {};
+void ms::SurfaceStack::update_input_bounds(Surface const* surface)
+{
+    std::lock_guard<decltype(guard)> lg(guard);
+    input_index.update(surface, surface->input_region_bounds());
 }
 
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
 {
-    RecursiveReadLock lg(guard);
+    std::shared_lock<decltype(guard)> lg(guard);
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
@@ -359,7 +363,7 @@ void ms::SurfaceStack::raise(Surface const* surface)
     SurfaceSet affected_surfaces;
 
     {
-        RecursiveWriteLock ul(guard);
+        std::lock_guard<decltype(guard)> ul(guard);
         for (auto& layer : surface_layers)
         {
             auto const p = std::find_if(
@@ -376,6 +380,8 @@ void ms::SurfaceStack::raise(Surface const* surface)
                 layer.erase(p);
                 insert_surface_at_top_of_depth_layer(surface_shared);
                 affected_surfaces.insert(surface_shared);
+                restack_input_index();
+                publish_rendering_snapshot();
                 break;
             }
         }
@@ -401,7 +407,7 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
 {
     bool surfaces_reordered{false};
     {
-        RecursiveWriteLock ul(guard);
+        std::lock_guard<decltype(guard)> ul(guard);
         for (auto& layer : surface_layers)
         {
             auto const old_layer = layer;
@@ -426,6 +432,12 @@ void ms::SurfaceStack::raise(SurfaceSet const& ss)
             if (old_layer != layer)
                 surfaces_reordered = true;
         }
+
+        if (surfaces_reordered)
+        {
+            restack_input_index();
+            publish_rendering_snapshot();
+        }
     }
 
     if (surfaces_reordered)
@@ -438,14 +450,14 @@ void ms::SurfaceStack::create_rendering_tracker_for(std::shared_ptr<Surface> con
 {
     auto const tracker = std::make_shared<RenderingTracker>(surface);
 
-    RecursiveWriteLock ul(guard);
+    std::lock_guard<decltype(guard)> ul(guard);
     tracker->active_compositors(registered_compositors);
     rendering_trackers[surface.get()] = tracker;
 }
 
 void ms::SurfaceStack::update_rendering_tracker_compositors()
 {
-    RecursiveReadLock ul(guard);
+    std::shared_lock<decltype(guard)> ul(guard);
 
     for (auto const& pair : rendering_trackers)
         pair.second->active_compositors(registered_compositors);
@@ -459,12 +471,41 @@ void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surf
     surface_layers[depth_index].push_back(surface);
 }
 
+void ms::SurfaceStack::restack_input_index()
+{
+    std::vector<Surface const*> bottom_to_top;
+    for (auto const& layer : surface_layers)
+    {
+        for (auto const& surface : layer)
+            bottom_to_top.push_back(surface.get());
+    }
+    input_index.restack(bottom_to_top);
+}
+
+void ms::SurfaceStack::publish_rendering_snapshot()
+{
+    auto snapshot = std::make_shared<RenderingSnapshot>();
+
+    for (auto const& layer : surface_layers)
+    {
+        for (auto const& surface : layer)
+        {
+            auto const tracker = rendering_trackers.find(surface.get());
+            if (tracker != rendering_trackers.end())
+                snapshot->surfaces.push_back({surface, tracker->second});
+        }
+    }
+    snapshot->overlays = overlays;
+
+    std::atomic_store(&rendering_snapshot, std::shared_ptr<RenderingSnapshot const>{std::move(snapshot)});
+}
+
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
 {
     observers.add(observer);
 
     // Notify observer of existing surfaces
-    RecursiveReadLock lk(guard);
+    std::shared_lock<decltype(guard)> lk(guard);
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
@@ -489,7 +530,7 @@ auto ms::SurfaceStack::stacking_order_of(SurfaceSet const& surfaces) const -> Su
 {
     SurfaceList result;
 
-    RecursiveReadLock lk(guard);
+    std::shared_lock<decltype(guard)> lk(guard);
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
@@ -25,10 +25,11 @@
 #include "mir/compositor/scene.h"
 #include "mir/scene/observer.h"
 #include "mir/input/scene.h"
-#include "mir/recursive_read_write_mutex.h"
+#include "mir/recursive_shared_mutex.h"
 
 #include "mir/basic_observers.h"
 #include "mir/scene/surface_observer.h"
+#include "spatial_index.h"
 
 #include <atomic>
 #include <map>
@@ -85,10 +86,13 @@ public:
 
     // From Scene
     void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) override;
+    auto input_surface_at(geometry::Point const& point) -> std::shared_ptr<input::Surface> override;
 
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
     void raise(Surface const* surface);
+    /// Updates the hit-testing index after the surface's input region may have moved or changed
+    void update_input_bounds(Surface const* surface);
     virtual void raise(std::weak_ptr<Surface> const& surface) override;
     void raise(SurfaceSet const& surfaces) override;
 
@@ -115,8 +119,26 @@ private:
     void create_rendering_tracker_for(std::shared_ptr<Surface> const&);
     void update_rendering_tracker_compositors();
     void insert_surface_at_top_of_depth_layer(std::shared_ptr<Surface> const& surface);
+    /// Brings the order of input_index up to date with the stack. Requires guard to be write-locked.
+    void restack_input_index();
 
-    RecursiveReadWriteMutex mutable guard;
+    /// What the compositors need of the stack, replaced (never modified) when the stack changes
+    struct RenderingSnapshot
+    {
+        struct Entry
+        {
+            std::shared_ptr<Surface> surface;
+            std::shared_ptr<RenderingTracker> tracker;
+        };
+
+        std::vector<Entry> surfaces;    ///< bottom to top
+        std::vector<std::shared_ptr<graphics::Renderable>> overlays;
+    };
+
+    /// Replaces the rendering snapshot with one of the current stack. Requires guard to be write-locked.
+    void publish_rendering_snapshot();
+
+    RecursiveSharedMutex mutable guard;
 
     std::shared_ptr<SceneReport> const report;
 
@@ -128,11 +150,18 @@ private:
      * The inner vectors contain the list of surfaces on each layer (bottom to top)
      */
     std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
+
+    /// The surfaces in surface_layers, by the bounds of their input regions, for hit-testing
+    SpatialIndex<Surface> input_index;
+
     std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
     std::set<compositor::CompositorID> registered_compositors;
     
     std::vector<std::shared_ptr<graphics::Renderable>> overlays;
 
+    /// Only accessed through std::atomic_load()/std::atomic_store(), so compositors don't need guard
+    std::shared_ptr<RenderingSnapshot const> rendering_snapshot;
+
     Observers observers;
     std::atomic<bool> scene_changed;
     std::shared_ptr<SurfaceObserver> surface_observer;
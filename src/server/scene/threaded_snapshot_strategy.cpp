@@ -21,6 +21,9 @@
 #include "mir/compositor/buffer_stream.h"
 #include "mir/thread_name.h"
 
+#define MIR_LOG_COMPONENT "snapshot"
+#include "mir/log.h"
+
 #include <deque>
 #include <mutex>
 #include <condition_variable>
@@ -73,9 +76,24 @@ public:
 
     void take_snapshot(WorkItem const& wi)
     {
-        wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
-            pixels->fill_from(buffer);
-        });
+        try
+        {
+            wi.stream->with_most_recent_buffer_do([this](mir::graphics::Buffer& buffer) {
+                pixels->fill_from(buffer);
+            });
+        }
+        catch (...)
+        {
+            mir::log(
+                mir::logging::Severity::error,
+                MIR_LOG_COMPONENT,
+                std::current_exception(),
+                "Failed to take snapshot");
+
+            // An empty snapshot tells whoever asked that there's nothing to show
+            wi.snapshot_taken(ms::Snapshot{geom::Size{}, geom::Stride{}, nullptr});
+            return;
+        }
 
         wi.snapshot_taken(
             ms::Snapshot{pixels->size(),
@@ -22,6 +22,7 @@
 #include "input.h"
 
 #include "mir/graphics/graphic_buffer_allocator.h"
+#include "mir/graphics/pixel_ops.h"
 #include "mir/renderer/sw/pixel_source.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
@@ -112,6 +113,16 @@ inline void render_row(
         *i = color;
 }
 
+inline void render_rect(
+    uint32_t* const data,
+    geom::Size buf_size,
+    geom::Rectangle rect,
+    uint32_t color)
+{
+    for (geom::Y y = rect.top(); y < rect.bottom(); y += geom::DeltaY{1})
+        render_row(data, buf_size, {rect.left(), y}, rect.size.width, color);
+}
+
 inline void render_close_icon(
     uint32_t* const data,
     geom::Size buf_size,
@@ -173,47 +184,51 @@ class msd::Renderer::Text::Impl
     : public Text
 {
 public:
-    Impl();
-    ~Impl();
+    explicit Impl(std::unique_ptr<Font> font);
 
-    void render(
-        Pixel* buf,
-        geom::Size buf_size,
-        std::string const& text,
-        geom::Point top_left,
-        geom::Height height_pixels,
-        Pixel color) override;
+    auto rasterize(std::string const& text, geom::Height height_pixels) -> Coverage override;
 
 private:
+    /// Beyond this we start the cache again, as titles can contain any of Unicode
+    static size_t const max_cached_glyphs{1024};
+
     std::mutex mutex;
+    std::unique_ptr<Font> const font;
+    /// Keyed by pixel height and codepoint (there is only the one font face)
+    std::map<std::pair<int, char32_t>, std::shared_ptr<Glyph const>> glyphs;
+
+    auto glyph(char32_t codepoint, geom::Height height) -> std::shared_ptr<Glyph const>;
+
+    static auto utf8_to_utf32(std::string const& text) -> std::u32string;
+};
+
+class msd::Renderer::Text::FreeTypeFont
+    : public Font
+{
+public:
+    FreeTypeFont();
+    ~FreeTypeFont();
+
+    auto render(char32_t codepoint, geom::Height height_pixels) -> Glyph override;
+
+private:
     FT_Library library;
     FT_Face face;
+    geom::Height char_size{};
 
     void set_char_size(geom::Height height);
     void rasterize_glyph(char32_t glyph);
-    void render_glyph(
-        Pixel* buf,
-        geom::Size buf_size,
-        FT_Bitmap const* glyph,
-        geom::Point top_left,
-        Pixel color);
 
     static auto font_path() -> std::string;
-    static auto utf8_to_utf32(std::string const& text) -> std::u32string;
 };
 
 class msd::Renderer::Text::Null
     : public Text
 {
 public:
-    void render(
-        Pixel*,
-        geom::Size,
-        std::string const&,
-        geom::Point,
-        geom::Height,
-        Pixel) override
+    auto rasterize(std::string const&, geom::Height) -> Coverage override
     {
+        return {};
     }
 
 private:
@@ -230,7 +245,7 @@ auto msd::Renderer::Text::instance() -> std::shared_ptr<Text>
     {
         try
         {
-            shared = std::make_shared<Impl>();
+            shared = with_font(std::make_unique<FreeTypeFont>());
         }
         catch (std::runtime_error const& error)
         {
@@ -242,7 +257,133 @@ auto msd::Renderer::Text::instance() -> std::shared_ptr<Text>
     return shared;
 }
 
-msd::Renderer::Text::Impl::Impl()
+auto msd::Renderer::Text::with_font(std::unique_ptr<Font> font) -> std::shared_ptr<Text>
+{
+    return std::make_shared<Impl>(std::move(font));
+}
+
+msd::Renderer::Text::Impl::Impl(std::unique_ptr<Font> font)
+    : font{std::move(font)}
+{
+}
+
+auto msd::Renderer::Text::Impl::rasterize(
+    std::string const& text,
+    geom::Height height_pixels) -> Coverage
+{
+    if (height_pixels <= geom::Height{})
+        return {};
+
+    auto const utf32 = utf8_to_utf32(text);
+
+    // Lay the line out from cached glyphs, only holding the lock while the font might be used
+    std::vector<std::pair<std::shared_ptr<Glyph const>, geom::Displacement>> line;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        geom::Displacement pen;
+        for (char32_t const codepoint : utf32)
+        {
+            try
+            {
+                auto const cached = glyph(codepoint, height_pixels);
+                line.emplace_back(cached, pen);
+                pen = pen + cached->advance;
+            }
+            catch (std::runtime_error const& error)
+            {
+                log_warning("%s", error.what());
+            }
+        }
+    }
+
+    Coverage coverage;
+    for (auto const& placed : line)
+    {
+        auto const& rect = placed.first->rect;
+        if (area(rect.size))
+        {
+            geom::Rectangle const glyph_rect{rect.top_left + placed.second, rect.size};
+            if (area(coverage.extents.size))
+            {
+                geom::Point const top_left{
+                    std::min(coverage.extents.left(), glyph_rect.left()),
+                    std::min(coverage.extents.top(), glyph_rect.top())};
+                geom::Point const bottom_right{
+                    std::max(coverage.extents.right(), glyph_rect.right()),
+                    std::max(coverage.extents.bottom(), glyph_rect.bottom())};
+                coverage.extents = {top_left, as_size(bottom_right - top_left)};
+            }
+            else
+            {
+                coverage.extents = glyph_rect;
+            }
+        }
+    }
+
+    auto const width = coverage.extents.size.width.as_int();
+    coverage.alpha.resize(area(coverage.extents.size));
+
+    for (auto const& placed : line)
+    {
+        Glyph const& glyph = *placed.first;
+        auto const glyph_width = glyph.rect.size.width.as_int();
+        auto const offset = glyph.rect.top_left + placed.second - coverage.extents.top_left;
+
+        for (int y = 0; y < glyph.rect.size.height.as_int(); y++)
+        {
+            unsigned char const* const glyph_row = glyph.alpha.data() + y * glyph_width;
+            unsigned char* const coverage_row =
+                coverage.alpha.data() + (offset.dy.as_int() + y) * width + offset.dx.as_int();
+
+            // Where glyphs overlap keep the stronger coverage
+            for (int x = 0; x < glyph_width; x++)
+                coverage_row[x] = std::max(coverage_row[x], glyph_row[x]);
+        }
+    }
+
+    return coverage;
+}
+
+auto msd::Renderer::Text::Impl::glyph(
+    char32_t codepoint,
+    geom::Height height) -> std::shared_ptr<Glyph const>
+{
+    auto const key = std::make_pair(height.as_int(), codepoint);
+    auto const cached = glyphs.find(key);
+    if (cached != glyphs.end())
+        return cached->second;
+
+    auto rendered = std::make_shared<Glyph const>(font->render(codepoint, height));
+
+    if (glyphs.size() >= max_cached_glyphs)
+        glyphs.clear();
+
+    glyphs[key] = rendered;
+    return rendered;
+}
+
+auto msd::Renderer::Text::Impl::utf8_to_utf32(std::string const& text) -> std::u32string
+{
+    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
+    std::u32string utf32_text;
+    try {
+        utf32_text = converter.from_bytes(text);
+    } catch(const std::range_error& e) {
+        log_warning("Window title %s is not valid UTF-8", text.c_str());
+        // fall back to ASCII
+        for (char const c : text)
+        {
+            if (isprint(c))
+                utf32_text += c;
+            else
+                utf32_text += 0xFFFD; // REPLACEMENT CHARACTER (�)
+        }
+    }
+    return utf32_text;
+}
+
+msd::Renderer::Text::FreeTypeFont::FreeTypeFont()
 {
     if (auto const error = FT_Init_FreeType(&library))
         BOOST_THROW_EXCEPTION(std::runtime_error(
@@ -260,7 +401,7 @@ msd::Renderer::Text::Impl::Impl()
     }
 }
 
-msd::Renderer::Text::Impl::~Impl()
+msd::Renderer::Text::FreeTypeFont::~FreeTypeFont()
 {
     if (auto const error = FT_Done_Face(face))
         log_warning("Failed to uninitialize font face with error %d", error);
@@ -271,69 +412,46 @@ msd::Renderer::Text::Impl::~Impl()
     library = nullptr;
 }
 
-void msd::Renderer::Text::Impl::render(
-    Pixel* buf,
-    geom::Size buf_size,
-    std::string const& text,
-    geom::Point top_left,
-    geom::Height height_pixels,
-    Pixel color)
+auto msd::Renderer::Text::FreeTypeFont::render(
+    char32_t codepoint,
+    geom::Height height) -> Glyph
 {
-    if (!area(buf_size) || height_pixels <= geom::Height{})
-        return;
-
-    std::lock_guard<std::mutex> lock{mutex};
-
-    if (!library || !face)
+    set_char_size(height);
+    rasterize_glyph(codepoint);
+
+    auto const slot = face->glyph;
+    auto const& bitmap = slot->bitmap;
+
+    Glyph rendered;
+    rendered.rect = {
+        {slot->bitmap_left, height.as_int() - slot->bitmap_top},
+        {bitmap.width, bitmap.rows}};
+    rendered.advance = {slot->advance.x / 64, slot->advance.y / 64};
+    rendered.alpha.resize(bitmap.width * bitmap.rows);
+    for (unsigned row = 0; row < bitmap.rows; row++)
     {
-        log_warning("FreeType not initialized");
-        return;
+        std::copy_n(
+            bitmap.buffer + row * bitmap.pitch,
+            bitmap.width,
+            rendered.alpha.data() + row * bitmap.width);
     }
 
-    try
-    {
-        set_char_size(height_pixels);
-    }
-    catch (std::runtime_error const& error)
-    {
-        log_warning("%s", error.what());
-        return;
-    }
-
-    auto const utf32 = utf8_to_utf32(text);
-
-    for (char32_t const glyph : utf32)
-    {
-        try
-        {
-            rasterize_glyph(glyph);
-
-            geom::Point glyph_top_left =
-                top_left +
-                geom::Displacement{
-                    face->glyph->bitmap_left,
-                    height_pixels.as_int() - face->glyph->bitmap_top};
-            render_glyph(buf, buf_size, &face->glyph->bitmap, glyph_top_left, color);
-
-            top_left += geom::Displacement{
-                face->glyph->advance.x / 64,
-                face->glyph->advance.y / 64};
-        }
-        catch (std::runtime_error const& error)
-        {
-            log_warning("%s", error.what());
-        }
-    }
+    return rendered;
 }
 
-void msd::Renderer::Text::Impl::set_char_size(geom::Height height)
+void msd::Renderer::Text::FreeTypeFont::set_char_size(geom::Height height)
 {
+    if (height == char_size)
+        return;
+
     if (auto const error = FT_Set_Pixel_Sizes(face, 0, height.as_int()))
         BOOST_THROW_EXCEPTION(std::runtime_error(
             "Setting char size failed with error " + std::to_string(error)));
+
+    char_size = height;
 }
 
-void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
+void msd::Renderer::Text::FreeTypeFont::rasterize_glyph(char32_t glyph)
 {
     auto const glyph_index = FT_Get_Char_Index(face, glyph);
 
@@ -346,47 +464,7 @@ void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
             "Failed to render glyph " + std::to_string(glyph_index)));
 }
 
-void msd::Renderer::Text::Impl::render_glyph(
-    Pixel* buf,
-    geom::Size buf_size,
-    FT_Bitmap const* glyph,
-    geom::Point top_left,
-    Pixel color)
-{
-    geom::X const buffer_left = std::max(top_left.x, geom::X{});
-    geom::X const buffer_right = std::min(top_left.x + geom::DeltaX{glyph->width}, as_x(buf_size.width));
-
-    geom::Y const buffer_top = std::max(top_left.y, geom::Y{});
-    geom::Y const buffer_bottom = std::min(top_left.y + geom::DeltaY{glyph->rows}, as_y(buf_size.height));
-
-    geom::Displacement const glyph_offset = as_displacement(top_left);
-
-    unsigned char* const color_pixels = (unsigned char *)&color;
-    unsigned char const color_alpha = color_pixels[3];
-
-    for (geom::Y buffer_y = buffer_top; buffer_y < buffer_bottom; buffer_y += geom::DeltaY{1})
-    {
-        geom::Y const glyph_y = buffer_y - glyph_offset.dy;
-        unsigned char* const glyph_row = glyph->buffer + glyph_y.as_int() * glyph->pitch;
-        Pixel* const buffer_row = buf + buffer_y.as_int() * buf_size.width.as_int();
-
-        for (geom::X buffer_x = buffer_left; buffer_x < buffer_right; buffer_x += geom::DeltaX{1})
-        {
-            geom::X const glyph_x = buffer_x - glyph_offset.dx;
-            unsigned char const glyph_alpha = ((int)glyph_row[glyph_x.as_int()] * color_alpha) / 255;
-            unsigned char* const buffer_pixels = (unsigned char *)(buffer_row + buffer_x.as_int());
-            for (int i = 0; i < 3; i++)
-            {
-                // Blend color with the previous buffer color based on the glyph's alpha
-                buffer_pixels[i] =
-                    ((int)buffer_pixels[i] * (255 - glyph_alpha)) / 255 +
-                    ((int)color_pixels[i] * glyph_alpha) / 255;
-            }
-        }
-    }
-}
-
-auto msd::Renderer::Text::Impl::font_path() -> std::string
+auto msd::Renderer::Text::FreeTypeFont::font_path() -> std::string
 {
     // Similar to default_font() in examples/example-server-lib/wallpaper_config.cpp
 
@@ -413,29 +491,17 @@ auto msd::Renderer::Text::Impl::font_path() -> std::string
     BOOST_THROW_EXCEPTION(std::runtime_error("Failed to find a font"));
 }
 
-auto msd::Renderer::Text::Impl::utf8_to_utf32(std::string const& text) -> std::u32string
+msd::Renderer::Renderer(
+    std::shared_ptr<graphics::GraphicBufferAllocator> const& buffer_allocator,
+    std::shared_ptr<StaticGeometry const> const& static_geometry)
+    : Renderer{buffer_allocator, static_geometry, Text::instance()}
 {
-    std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> converter;
-    std::u32string utf32_text;
-    try {
-        utf32_text = converter.from_bytes(text);
-    } catch(const std::range_error& e) {
-        log_warning("Window title %s is not valid UTF-8", text.c_str());
-        // fall back to ASCII
-        for (char const c : text)
-        {
-            if (isprint(c))
-                utf32_text += c;
-            else
-                utf32_text += 0xFFFD; // REPLACEMENT CHARACTER (�)
-        }
-    }
-    return utf32_text;
 }
 
 msd::Renderer::Renderer(
     std::shared_ptr<graphics::GraphicBufferAllocator> const& buffer_allocator,
-    std::shared_ptr<StaticGeometry const> const& static_geometry)
+    std::shared_ptr<StaticGeometry const> const& static_geometry,
+    std::shared_ptr<Text> const& text)
     : buffer_allocator{buffer_allocator},
       focused_theme{
           default_focused_background,
@@ -462,7 +528,7 @@ msd::Renderer::Renderer(
               render_minimize_icon}},
       },
       static_geometry{static_geometry},
-      text{Text::instance()}
+      text{text}
 {
 }
 
@@ -503,7 +569,7 @@ void msd::Renderer::update_state(WindowState const& window_state, InputState con
     if (window_state.window_name() != name)
     {
         name = window_state.window_name();
-        needs_titlebar_redraw = true;
+        needs_title_redraw = true;
     }
 
     if (input_state.buttons() != buttons)
@@ -538,29 +604,56 @@ auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared
         needs_titlebar_redraw = true;
     }
 
+    if (needs_title_redraw)
+    {
+        title = text->rasterize(name, static_geometry->title_font_height);
+    }
+
+    // Buttons under the old title have to be redrawn along with the new one
+    geom::Rectangle const cleared_title_area = title_area;
+
     if (needs_titlebar_redraw)
     {
-        for (geom::Y y{0}; y < as_y(titlebar_size.height); y += geom::DeltaY{1})
+        render_rect(titlebar_pixels.get(), titlebar_size, {{}, titlebar_size}, current_theme->background_color);
+    }
+    else if (needs_title_redraw)
+    {
+        render_rect(titlebar_pixels.get(), titlebar_size, title_area, current_theme->background_color);
+    }
+
+    if (needs_titlebar_redraw || needs_title_redraw)
+    {
+        geom::Rectangle const placed_title{
+            static_geometry->title_font_top_left + as_displacement(title.extents.top_left),
+            title.extents.size};
+        title_area = placed_title.intersection_with({{}, titlebar_size});
+
+        auto const clipped = title_area.top_left - placed_title.top_left;
+        auto const title_width = title.extents.size.width.as_int();
+        for (int row = 0; row < title_area.size.height.as_int(); row++)
         {
-            render_row(
-                titlebar_pixels.get(), titlebar_size,
-                {0, y}, titlebar_size.width,
-                current_theme->background_color);
+            mg::pixel_ops::blend_coverage(
+                titlebar_pixels.get() +
+                    (title_area.top().as_int() + row) * titlebar_size.width.as_int() + title_area.left().as_int(),
+                title.alpha.data() + (clipped.dy.as_int() + row) * title_width + clipped.dx.as_int(),
+                title_area.size.width.as_int(),
+                current_theme->text_color);
         }
-
-        text->render(
-            titlebar_pixels.get(),
-            titlebar_size,
-            name,
-            static_geometry->title_font_top_left,
-            static_geometry->title_font_height,
-            current_theme->text_color);
     }
 
-    if (needs_titlebar_redraw || needs_titlebar_buttons_redraw)
+    if (needs_titlebar_redraw || needs_title_redraw || needs_titlebar_buttons_redraw)
     {
+        bool const redraw_all_buttons = needs_titlebar_redraw || needs_titlebar_buttons_redraw;
+
         for (auto const& button : buttons)
         {
+            if (!redraw_all_buttons &&
+                !button.rect.overlaps(cleared_title_area) &&
+                !button.rect.overlaps(title_area))
+            {
+                continue;
+            }
+
             auto const icon = button_icons.find(button.function);
             if (icon != button_icons.end())
             {
@@ -595,6 +688,7 @@ auto msd::Renderer::render_titlebar() -> std::experimental::optional<std::shared
     }
 
     needs_titlebar_redraw = false;
+    needs_title_redraw = false;
     needs_titlebar_buttons_redraw = false;
 
     return make_buffer(titlebar_pixels.get(), titlebar_size);
@@ -20,11 +20,14 @@
 #define MIR_SHELL_DECORATION_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/displacement.h"
 
 #include "input.h"
 
 #include <memory>
 #include <map>
+#include <string>
+#include <vector>
 
 namespace mir
 {
@@ -47,42 +50,68 @@ auto const bytes_per_pixel = 4;
 class Renderer
 {
 public:
-    Renderer(
-        std::shared_ptr<graphics::GraphicBufferAllocator> const& buffer_allocator,
-        std::shared_ptr<StaticGeometry const> const& static_geometry);
-
-    void update_state(WindowState const& window_state, InputState const& input_state);
-    auto render_titlebar() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
-    auto render_left_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
-    auto render_right_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
-    auto render_bottom_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
-
-private:
     using Pixel = uint32_t;
 
     class Text
     {
     public:
+        /// 8-bit coverage of a line of text, which can be blended onto a buffer in any color
+        struct Coverage
+        {
+            geometry::Rectangle extents;        ///< Relative to the top left of the text
+            std::vector<unsigned char> alpha;   ///< One byte per pixel of extents, row by row
+        };
+
+        /// A rendered glyph, positioned relative to the top left of the line at the pen position
+        struct Glyph
+        {
+            geometry::Rectangle rect;
+            geometry::Displacement advance;
+            std::vector<unsigned char> alpha;   ///< One byte per pixel of rect, row by row
+        };
+
+        /// Renders glyphs one at a time, from a single font face
+        class Font
+        {
+        public:
+            virtual ~Font() = default;
+
+            /// May throw std::runtime_error, in which case the glyph is left out
+            virtual auto render(char32_t codepoint, geometry::Height height_pixels) -> Glyph = 0;
+        };
+
         static auto instance() -> std::shared_ptr<Text>;
+        /// Text laid out from glyphs rendered by font, which are kept for reuse
+        static auto with_font(std::unique_ptr<Font> font) -> std::shared_ptr<Text>;
 
         virtual ~Text() = default;
 
-        virtual void render(
-            Pixel* buf,
-            geometry::Size buf_size,
-            std::string const& text,
-            geometry::Point top_left,
-            geometry::Height height_pixels,
-            Pixel color) = 0;
+        virtual auto rasterize(std::string const& text, geometry::Height height_pixels) -> Coverage = 0;
 
     private:
         class Impl;
         class Null;
+        class FreeTypeFont;
 
         static std::mutex static_mutex;
         static std::weak_ptr<Text> singleton;
     };
 
+    Renderer(
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& buffer_allocator,
+        std::shared_ptr<StaticGeometry const> const& static_geometry);
+    Renderer(
+        std::shared_ptr<graphics::GraphicBufferAllocator> const& buffer_allocator,
+        std::shared_ptr<StaticGeometry const> const& static_geometry,
+        std::shared_ptr<Text> const& text);
+
+    void update_state(WindowState const& window_state, InputState const& input_state);
+    auto render_titlebar() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
+    auto render_left_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
+    auto render_right_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
+    auto render_bottom_border() -> std::experimental::optional<std::shared_ptr<graphics::Buffer>>;
+
+private:
     /// A visual theme for a decoration
     /// Focused and unfocused windows use a different theme
     struct Theme
@@ -123,10 +152,16 @@ private:
     std::unique_ptr<Pixel[]> titlebar_pixels; // can be nullptr
 
     bool needs_titlebar_redraw{true};
+    bool needs_title_redraw{true};
     bool needs_titlebar_buttons_redraw{true};
     std::string name;
     std::vector<ButtonInfo> buttons;
 
+    /// The window's title, only rasterized again when the name changes
+    Text::Coverage title;
+    /// Where title was last drawn into titlebar_pixels
+    geometry::Rectangle title_area;
+
     std::shared_ptr<Text> const text;
 
     void update_solid_color_pixels();
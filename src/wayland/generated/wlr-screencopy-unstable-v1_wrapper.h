@@ -0,0 +1,124 @@
+/*
+ * AUTOGENERATED - DO NOT EDIT
+ *
+ * This file is generated from wlr-screencopy-unstable-v1.xml
+ * To regenerate, run the “refresh-wayland-wrapper” target.
+ */
+
+#ifndef MIR_FRONTEND_WAYLAND_WLR_SCREENCOPY_UNSTABLE_V1_XML_WRAPPER
+#define MIR_FRONTEND_WAYLAND_WLR_SCREENCOPY_UNSTABLE_V1_XML_WRAPPER
+
+#include <experimental/optional>
+
+#include "mir/fd.h"
+#include <wayland-server-core.h>
+
+#include "mir/wayland/wayland_base.h"
+
+namespace mir
+{
+namespace wayland
+{
+
+class ScreencopyManagerV1;
+class ScreencopyFrameV1;
+
+class ScreencopyManagerV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwlr_screencopy_manager_v1";
+
+    static ScreencopyManagerV1* from(struct wl_resource*);
+
+    ScreencopyManagerV1(struct wl_resource* resource, Version<3>);
+    virtual ~ScreencopyManagerV1();
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+    class Global : public wayland::Global
+    {
+    public:
+        Global(wl_display* display, Version<3>);
+
+        auto interface_name() const -> char const* override;
+
+    private:
+        virtual void bind(wl_resource* new_zwlr_screencopy_manager_v1) = 0;
+        friend ScreencopyManagerV1::Thunks;
+    };
+
+private:
+    virtual void capture_output(struct wl_resource* frame, int32_t overlay_cursor, struct wl_resource* output) = 0;
+    virtual void capture_output_region(struct wl_resource* frame, int32_t overlay_cursor, struct wl_resource* output, int32_t x, int32_t y, int32_t width, int32_t height) = 0;
+    virtual void destroy() = 0;
+};
+
+class ScreencopyFrameV1 : public Resource
+{
+public:
+    static char const constexpr* interface_name = "zwlr_screencopy_frame_v1";
+
+    static ScreencopyFrameV1* from(struct wl_resource*);
+
+    ScreencopyFrameV1(struct wl_resource* resource, Version<3>);
+    virtual ~ScreencopyFrameV1();
+
+    void send_buffer_event(uint32_t format, uint32_t width, uint32_t height, uint32_t stride) const;
+    void send_flags_event(uint32_t flags) const;
+    void send_ready_event(uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec) const;
+    void send_failed_event() const;
+    bool version_supports_damage();
+    void send_damage_event(uint32_t x, uint32_t y, uint32_t width, uint32_t height) const;
+    bool version_supports_linux_dmabuf();
+    void send_linux_dmabuf_event(uint32_t format, uint32_t width, uint32_t height) const;
+    bool version_supports_buffer_done();
+    void send_buffer_done_event() const;
+
+    void destroy_wayland_object() const;
+
+    struct wl_client* const client;
+    struct wl_resource* const resource;
+
+    struct Error
+    {
+        static uint32_t const already_used = 0;
+        static uint32_t const invalid_buffer = 1;
+    };
+
+    struct Flags
+    {
+        static uint32_t const y_invert = 1;
+    };
+
+    struct Opcode
+    {
+        static uint32_t const buffer = 0;
+        static uint32_t const flags = 1;
+        static uint32_t const ready = 2;
+        static uint32_t const failed = 3;
+        static uint32_t const damage = 4;
+        static uint32_t const linux_dmabuf = 5;
+        static uint32_t const buffer_done = 6;
+    };
+
+    struct Thunks;
+
+    static bool is_instance(wl_resource* resource);
+
+private:
+    virtual void copy(struct wl_resource* buffer) = 0;
+    virtual void destroy() = 0;
+    virtual void copy_with_damage(struct wl_resource* buffer) = 0;
+};
+
+}
+}
+
+#endif // MIR_FRONTEND_WAYLAND_WLR_SCREENCOPY_UNSTABLE_V1_XML_WRAPPER
@@ -80,9 +80,29 @@ public:
         return !rectangular;
     }
 
+    /// Declares parts of a non-rectangular renderable opaque
+    void set_opaque_region(geometry::Rectangles const& region)
+    {
+        opaque = region;
+    }
+
+    geometry::Rectangles opaque_region() const override
+    {
+        if (rectangular)
+            return {rect};
+        return opaque;
+    }
+
     void set_buffer(std::shared_ptr<graphics::Buffer> b)
     {
         buf = b;
+        damage = std::experimental::nullopt;
+    }
+
+    void set_buffer(std::shared_ptr<graphics::Buffer> b, geometry::Rectangles const& buffer_damage)
+    {
+        buf = b;
+        damage = buffer_damage;
     }
 
     std::shared_ptr<graphics::Buffer> buffer() const override
@@ -90,6 +110,11 @@ public:
         return buf;
     }
 
+    std::experimental::optional<geometry::Rectangles> damage_since(graphics::BufferID) const override
+    {
+        return damage;
+    }
+
     geometry::Rectangle screen_position() const override
     {
         return rect;
@@ -107,9 +132,11 @@ public:
 
 private:
     std::shared_ptr<graphics::Buffer> buf;
+    std::experimental::optional<geometry::Rectangles> damage;
     mir::geometry::Rectangle rect;
     float opacity;
     bool rectangular;
+    geometry::Rectangles opaque;
 };
 
 } // namespace doubles
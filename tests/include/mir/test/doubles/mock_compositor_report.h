@@ -41,8 +41,28 @@ public:
                  void(compositor::CompositorReport::SubCompositorId, graphics::RenderableList const&));
     MOCK_METHOD1(rendered_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD2(damage_in_frame,
+                 void(compositor::CompositorReport::SubCompositorId, geometry::Rectangle const&));
+    MOCK_METHOD2(draw_calls_in_frame,
+                 void(compositor::CompositorReport::SubCompositorId, unsigned));
     MOCK_METHOD1(finished_frame,
                  void(compositor::CompositorReport::SubCompositorId));
+    MOCK_METHOD2(presented_frame,
+                 void(compositor::CompositorReport::SubCompositorId, std::chrono::nanoseconds));
+    MOCK_METHOD3(buffer_submitted,
+                 void(compositor::CompositorReport::StreamId, graphics::BufferID, unsigned));
+    MOCK_METHOD2(buffer_dropped,
+                 void(compositor::CompositorReport::StreamId, graphics::BufferID));
+    MOCK_METHOD4(buffer_acquired,
+                 void(compositor::CompositorReport::StreamId, compositor::CompositorReport::SubCompositorId,
+                      graphics::BufferID, std::chrono::nanoseconds));
+    MOCK_METHOD3(buffer_reacquired,
+                 void(compositor::CompositorReport::StreamId, compositor::CompositorReport::SubCompositorId,
+                      graphics::BufferID));
+    MOCK_METHOD2(buffer_released,
+                 void(compositor::CompositorReport::StreamId, graphics::BufferID));
+    MOCK_METHOD3(buffer_presented,
+                 void(compositor::CompositorReport::StreamId, graphics::BufferID, std::chrono::nanoseconds));
     MOCK_METHOD0(started, void());
     MOCK_METHOD0(stopped, void());
     MOCK_METHOD0(scheduled, void());
@@ -43,6 +43,8 @@ public:
     MOCK_METHOD0(report_vt_switch_back_failure, void());
     MOCK_METHOD2(report_egl_configuration, void(EGLDisplay,EGLConfig));
     MOCK_METHOD2(report_vsync, void(unsigned int, graphics::Frame const&));
+    MOCK_METHOD2(report_dmabuf_import, void(uint32_t, std::chrono::nanoseconds));
+    MOCK_METHOD1(report_dmabuf_import_reused, void(uint32_t));
 };
 
 }
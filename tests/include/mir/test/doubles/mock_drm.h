@@ -26,6 +26,11 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <unordered_map>
+#include <initializer_list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace mir
 {
@@ -49,6 +54,7 @@ public:
     int write_fd() const;
     drmModeRes* resources_ptr();
 
+    /// Adds a CRTC with the properties atomic mode setting needs (as does add_connector())
     void add_crtc(uint32_t id, drmModeModeInfo mode);
     void add_encoder(uint32_t encoder_id, uint32_t crtc_id, uint32_t possible_crtcs_mask);
     void add_connector(uint32_t connector_id, uint32_t type, drmModeConnection connection,
@@ -56,6 +62,9 @@ public:
                        std::vector<uint32_t>& possible_encoder_ids,
                        geometry::Size const& physical_size,
                        drmModeSubPixel subpixel_arrangement = DRM_MODE_SUBPIXEL_UNKNOWN);
+    /// Adds a plane with the standard atomic plane properties
+    void add_plane(uint32_t plane_id, uint32_t type, uint32_t possible_crtcs_mask,
+                   std::vector<uint32_t> const& formats);
 
     void prepare();
     void reset();
@@ -63,6 +72,11 @@ public:
     drmModeCrtc* find_crtc(uint32_t id);
     drmModeEncoder* find_encoder(uint32_t id);
     drmModeConnector* find_connector(uint32_t id);
+    drmModePlaneRes* plane_resources_ptr();
+    drmModePlane* find_plane(uint32_t id);
+    drmModeObjectProperties* find_object_properties(uint32_t object_id);
+    drmModePropertyRes* find_property(uint32_t id);
+    uint32_t property_id(uint32_t object_id, char const* name) const;
 
     enum ModePreference {NormalMode, PreferredMode};
     static drmModeModeInfo create_mode(uint16_t hdisplay, uint16_t vdisplay,
@@ -85,6 +99,26 @@ private:
     std::vector<drmModeModeInfo> modes;
     std::vector<drmModeModeInfo> modes_empty;
     std::vector<uint32_t> connector_encoder_ids;
+
+    void add_properties(
+        uint32_t object_id,
+        std::initializer_list<std::pair<char const*, uint64_t>> names_and_values);
+
+    struct FakeObjectProperties
+    {
+        std::vector<uint32_t> ids;
+        std::vector<uint64_t> values;
+        drmModeObjectProperties properties;
+    };
+
+    drmModePlaneRes plane_resources;
+    std::vector<drmModePlane> planes;
+    std::vector<uint32_t> plane_ids;
+    std::map<uint32_t, std::vector<uint32_t>> plane_formats;
+    std::map<uint32_t, FakeObjectProperties> object_properties;
+    std::map<uint32_t, drmModePropertyRes> properties;
+    std::map<std::pair<uint32_t, std::string>, uint32_t> property_ids;
+    uint32_t next_property_id{1000};
 };
 
 class MockDRM
@@ -116,6 +150,12 @@ public:
     MOCK_METHOD1(drmModeFreePlane, void(drmModePlanePtr ptr));
     MOCK_METHOD1(drmModeFreeObjectProperties, void(drmModeObjectPropertiesPtr));
 
+    MOCK_METHOD4(drmModeAtomicAddProperty, int(drmModeAtomicReqPtr req, uint32_t object_id,
+                                               uint32_t property_id, uint64_t value));
+    MOCK_METHOD4(drmModeAtomicCommit, int(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data));
+    MOCK_METHOD4(drmModeCreatePropertyBlob, int(int fd, void const* data, size_t size, uint32_t* id));
+    MOCK_METHOD2(drmModeDestroyPropertyBlob, int(int fd, uint32_t id));
+
     MOCK_METHOD8(drmModeAddFB, int(int fd, uint32_t width, uint32_t height,
                                    uint8_t depth, uint8_t bpp, uint32_t pitch,
                                    uint32_t bo_handle, uint32_t *buf_id));
@@ -187,6 +227,14 @@ public:
         std::vector<uint32_t>& possible_encoder_ids,
         geometry::Size const& physical_size,
         drmModeSubPixel subpixel_arrangement = DRM_MODE_SUBPIXEL_UNKNOWN);
+    void add_plane(
+        char const* device,
+        uint32_t plane_id,
+        uint32_t type,
+        uint32_t possible_crtcs_mask,
+        std::vector<uint32_t> const& formats);
+    /// The id of the named property of a fake object, for matching atomic requests
+    uint32_t property_id(char const* device, uint32_t object_id, char const* name);
 
     void prepare(char const* device);
     void reset(char const* device);
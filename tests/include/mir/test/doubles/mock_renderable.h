@@ -49,12 +49,14 @@ struct MockRenderable : public graphics::Renderable
 
     MOCK_CONST_METHOD0(id, ID());
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
+    MOCK_CONST_METHOD1(damage_since, std::experimental::optional<geometry::Rectangles>(graphics::BufferID));
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
     MOCK_CONST_METHOD0(shaped, bool());
+    MOCK_CONST_METHOD0(opaque_region, geometry::Rectangles());
     MOCK_CONST_METHOD0(swap_interval, unsigned int());
 };
 }
@@ -34,6 +34,10 @@ struct MockRenderer : public renderer::Renderer
     MOCK_METHOD1(set_viewport, void(geometry::Rectangle const&));
     MOCK_METHOD1(set_output_transform, void(glm::mat2 const&));
     MOCK_CONST_METHOD1(render, void(graphics::RenderableList const&));
+    MOCK_METHOD1(set_damage, void(geometry::Rectangle const&));
+    MOCK_CONST_METHOD0(buffer_age, unsigned());
+    MOCK_CONST_METHOD0(draw_calls, unsigned());
+    MOCK_METHOD4(capture_next_frame, void(geometry::Rectangle const&, void*, geometry::Stride, std::function<void(bool)> const&));
     MOCK_METHOD0(suspend, void());
 
     ~MockRenderer() noexcept {}
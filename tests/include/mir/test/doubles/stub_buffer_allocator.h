@@ -83,7 +83,9 @@ struct StubBufferAllocator : public graphics::GraphicBufferAllocator
     auto buffer_from_shm(
         wl_resource* resource,
         std::shared_ptr<mir::Executor> executor,
-        std::function<void()>&& on_consumed) -> std::shared_ptr<graphics::Buffer> override
+        std::function<void()>&& on_consumed,
+        std::shared_ptr<graphics::Buffer> const& previous,
+        geometry::Rectangles const& damage) -> std::shared_ptr<graphics::Buffer> override
     {
         // Temporary(?!) hack to actually use the buffer, for WLCS test
         // Transitioning the StubGraphicsPlatform to use the MESA surfaceless GL platform would
@@ -94,7 +96,9 @@ struct StubBufferAllocator : public graphics::GraphicBufferAllocator
             resource,
             std::move(executor),
             std::make_shared<graphics::common::EGLContextExecutor>(std::make_unique<test::doubles::NullGLContext>()),
-            std::move(on_consumed));
+            std::move(on_consumed),
+            previous,
+            damage);
     }
 };
 
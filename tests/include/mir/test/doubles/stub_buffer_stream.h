@@ -65,6 +65,15 @@ public:
     {
         if (b) ++nready;
     }
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& b, geometry::Rectangles const&) override
+    {
+        submit_buffer(b);
+    }
+    auto damage_between(graphics::BufferID, graphics::BufferID) const
+        -> std::experimental::optional<geometry::Rectangles> override
+    {
+        return {};
+    }
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& fn) override
     {
         fn(*stub_compositor_buffer);
@@ -73,6 +82,11 @@ public:
     void set_frame_posted_callback(std::function<void(geometry::Size const&)> const&) override {}
     bool has_submitted_buffer() const override { return true; }
     void set_scale(float) override {}
+    void set_opaque_region(geometry::Rectangles const&) override {}
+    auto opaque_region() const -> geometry::Rectangles override { return {}; }
+    void add_presentation_callback(std::function<void(graphics::Presentation const*)> const&) override {}
+    void presented(graphics::BufferID, graphics::Presentation const&) override {}
+    auto queue_stats() const -> compositor::BufferQueueStats override { return {}; }
 
     std::shared_ptr<graphics::Buffer> stub_compositor_buffer;
     int nready = 0;
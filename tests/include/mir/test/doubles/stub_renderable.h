@@ -70,6 +70,10 @@ public:
     {
         return stub_buffer;
     }
+    std::experimental::optional<geometry::Rectangles> damage_since(graphics::BufferID) const override
+    {
+        return std::experimental::nullopt;
+    }
     geometry::Rectangle screen_position() const override
     {
         return rect;
@@ -90,6 +94,12 @@ public:
     {
         return false;
     }
+    geometry::Rectangles opaque_region() const override
+    {
+        if (shaped())
+            return {};
+        return {screen_position()};
+    }
     unsigned int swap_interval() const override
     {
         return 1;
@@ -36,6 +36,18 @@ public:
     void set_viewport(geometry::Rectangle const&) override {}
     void set_output_transform(glm::mat2 const&) override {}
     void suspend() override {}
+    void set_damage(geometry::Rectangle const&) override {}
+    unsigned buffer_age() const override { return 0; }
+    unsigned draw_calls() const override { return 0; }
+
+    void capture_next_frame(
+        geometry::Rectangle const&,
+        void*,
+        geometry::Stride,
+        std::function<void(bool)> const& done) override
+    {
+        done(false);
+    }
 
     void render(graphics::RenderableList const& renderables) const override
     {
@@ -19,6 +19,7 @@
 #include "multithread_harness.h"
 
 #include "src/server/compositor/stream.h"
+#include "src/server/report/null_report_factory.h"
 #include "mir/graphics/graphic_buffer_allocator.h"
 
 #include <gmock/gmock.h>
@@ -32,6 +33,7 @@ namespace mc = mir::compositor;
 namespace mf = mir::frontend;
 namespace mg = mir::graphics;
 namespace mt = mir::testing;
+namespace mr = mir::report;
 namespace geom = mir::geometry;
 
 namespace
@@ -42,7 +44,7 @@ struct SwapperSwappingStress : public ::testing::Test
     void SetUp()
     {
         stream = std::make_shared<mc::Stream>(
-            geom::Size{380, 210}, mir_pixel_format_abgr_8888);
+            geom::Size{380, 210}, mir_pixel_format_abgr_8888, mr::null_compositor_report());
     }
 
     std::shared_ptr<mc::Stream> stream;
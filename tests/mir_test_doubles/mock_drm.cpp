@@ -37,7 +37,8 @@ mtd::MockDRM* global_mock = nullptr;
 }
 
 mtd::FakeDRMResources::FakeDRMResources()
-    : pipe_fds{-1, -1}
+    : pipe_fds{-1, -1},
+      plane_resources()
 {
     /* Use the read end of a pipe as the fake DRM fd */
     if (pipe(pipe_fds) < 0 || pipe_fds[0] < 0)
@@ -115,6 +116,25 @@ void mtd::FakeDRMResources::prepare()
     for (auto const& connector: connectors)
         connector_ids.push_back(connector.connector_id);
     resources.connectors = connector_ids.data();
+
+    plane_ids.clear();
+    for (auto& plane: planes)
+    {
+        auto& formats = plane_formats[plane.plane_id];
+        plane.formats = formats.data();
+        plane.count_formats = formats.size();
+        plane_ids.push_back(plane.plane_id);
+    }
+    plane_resources.count_planes = plane_ids.size();
+    plane_resources.planes = plane_ids.data();
+
+    for (auto& object: object_properties)
+    {
+        auto& fake = object.second;
+        fake.properties.count_props = fake.ids.size();
+        fake.properties.props = fake.ids.data();
+        fake.properties.prop_values = fake.values.data();
+    }
 }
 
 void mtd::FakeDRMResources::reset()
@@ -128,6 +148,14 @@ void mtd::FakeDRMResources::reset()
     crtc_ids.clear();
     encoder_ids.clear();
     connector_ids.clear();
+
+    plane_resources = drmModePlaneRes();
+    planes.clear();
+    plane_ids.clear();
+    plane_formats.clear();
+    object_properties.clear();
+    properties.clear();
+    property_ids.clear();
 }
 
 void mtd::FakeDRMResources::add_crtc(uint32_t id, drmModeModeInfo mode)
@@ -138,6 +166,8 @@ void mtd::FakeDRMResources::add_crtc(uint32_t id, drmModeModeInfo mode)
     crtc.mode = mode;
 
     crtcs.push_back(crtc);
+
+    add_properties(id, {{"MODE_ID", 0}, {"ACTIVE", 0}});
 }
 
 void mtd::FakeDRMResources::add_encoder(uint32_t encoder_id, uint32_t crtc_id,
@@ -176,6 +206,48 @@ void mtd::FakeDRMResources::add_connector(uint32_t connector_id,
     connector.subpixel = subpixel_arrangement;
 
     connectors.push_back(connector);
+
+    add_properties(connector_id, {{"CRTC_ID", 0}});
+}
+
+void mtd::FakeDRMResources::add_plane(uint32_t plane_id,
+                                      uint32_t type,
+                                      uint32_t possible_crtcs_mask,
+                                      std::vector<uint32_t> const& formats)
+{
+    drmModePlane plane = drmModePlane();
+
+    plane.plane_id = plane_id;
+    plane.possible_crtcs = possible_crtcs_mask;
+
+    planes.push_back(plane);
+    plane_formats[plane_id] = formats;
+
+    add_properties(
+        plane_id,
+        {{"type", type}, {"FB_ID", 0}, {"CRTC_ID", 0},
+         {"SRC_X", 0}, {"SRC_Y", 0}, {"SRC_W", 0}, {"SRC_H", 0},
+         {"CRTC_X", 0}, {"CRTC_Y", 0}, {"CRTC_W", 0}, {"CRTC_H", 0}});
+}
+
+void mtd::FakeDRMResources::add_properties(
+    uint32_t object_id,
+    std::initializer_list<std::pair<char const*, uint64_t>> names_and_values)
+{
+    auto& fake = object_properties[object_id];
+    for (auto const& name_and_value : names_and_values)
+    {
+        drmModePropertyRes property = drmModePropertyRes();
+
+        property.prop_id = next_property_id++;
+        strncpy(property.name, name_and_value.first, DRM_PROP_NAME_LEN - 1);
+
+        properties[property.prop_id] = property;
+        property_ids[{object_id, name_and_value.first}] = property.prop_id;
+
+        fake.ids.push_back(property.prop_id);
+        fake.values.push_back(name_and_value.second);
+    }
 }
 
 drmModeCrtc* mtd::FakeDRMResources::find_crtc(uint32_t id)
@@ -208,6 +280,37 @@ drmModeConnector* mtd::FakeDRMResources::find_connector(uint32_t id)
     return nullptr;
 }
 
+drmModePlaneRes* mtd::FakeDRMResources::plane_resources_ptr()
+{
+    return &plane_resources;
+}
+
+drmModePlane* mtd::FakeDRMResources::find_plane(uint32_t id)
+{
+    for (auto& plane : planes)
+    {
+        if (plane.plane_id == id)
+            return &plane;
+    }
+    return nullptr;
+}
+
+drmModeObjectProperties* mtd::FakeDRMResources::find_object_properties(uint32_t object_id)
+{
+    auto const found = object_properties.find(object_id);
+    return found != object_properties.end() ? &found->second.properties : nullptr;
+}
+
+drmModePropertyRes* mtd::FakeDRMResources::find_property(uint32_t id)
+{
+    auto const found = properties.find(id);
+    return found != properties.end() ? &found->second : nullptr;
+}
+
+uint32_t mtd::FakeDRMResources::property_id(uint32_t object_id, char const* name) const
+{
+    return property_ids.at({object_id, name});
+}
 
 drmModeModeInfo mtd::FakeDRMResources::create_mode(uint16_t hdisplay, uint16_t vdisplay,
                                                    uint32_t clock, uint16_t htotal,
@@ -304,8 +407,45 @@ mtd::MockDRM::MockDRM()
                     return fd_to_drm.at(fd).find_connector(connector_id);
                 }));
 
+    ON_CALL(*this, drmModeGetPlaneResources(_))
+        .WillByDefault(
+            Invoke(
+                [this](int fd) -> drmModePlaneResPtr
+                {
+                    auto const drm = fd_to_drm.find(fd);
+                    return drm != fd_to_drm.end() ? drm->second.plane_resources_ptr() : nullptr;
+                }));
+
+    ON_CALL(*this, drmModeGetPlane(_, _))
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t plane_id)
+                {
+                    return fd_to_drm.at(fd).find_plane(plane_id);
+                }));
+
     ON_CALL(*this, drmModeObjectGetProperties(_, _, _))
-        .WillByDefault(Return(&empty_object_props));
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t object_id, uint32_t)
+                {
+                    auto const drm = fd_to_drm.find(fd);
+                    if (drm != fd_to_drm.end())
+                    {
+                        if (auto const props = drm->second.find_object_properties(object_id))
+                            return props;
+                    }
+                    return &empty_object_props;
+                }));
+
+    ON_CALL(*this, drmModeGetProperty(_, _))
+        .WillByDefault(
+            Invoke(
+                [this](int fd, uint32_t property_id) -> drmModePropertyPtr
+                {
+                    auto const drm = fd_to_drm.find(fd);
+                    return drm != fd_to_drm.end() ? drm->second.find_property(property_id) : nullptr;
+                }));
 
     ON_CALL(*this, drmSetInterfaceVersion(_, _))
         .WillByDefault(
@@ -380,6 +520,21 @@ void mtd::MockDRM::add_encoder(
     fake_drms[device].add_encoder(encoder_id, crtc_id, possible_crtcs_mask);
 }
 
+void mtd::MockDRM::add_plane(
+    char const* device,
+    uint32_t plane_id,
+    uint32_t type,
+    uint32_t possible_crtcs_mask,
+    std::vector<uint32_t> const& formats)
+{
+    fake_drms[device].add_plane(plane_id, type, possible_crtcs_mask, formats);
+}
+
+uint32_t mtd::MockDRM::property_id(char const* device, uint32_t object_id, char const* name)
+{
+    return fake_drms[device].property_id(object_id, name);
+}
+
 void mtd::MockDRM::prepare(char const *device)
 {
     fake_drms[device].prepare();
@@ -625,6 +780,27 @@ void drmModeFreeObjectProperties(drmModeObjectPropertiesPtr ptr)
     global_mock->drmModeFreeObjectProperties(ptr);
 }
 
+int drmModeAtomicAddProperty(drmModeAtomicReqPtr req, uint32_t object_id,
+                             uint32_t property_id, uint64_t value)
+{
+    return global_mock->drmModeAtomicAddProperty(req, object_id, property_id, value);
+}
+
+int drmModeAtomicCommit(int fd, drmModeAtomicReqPtr req, uint32_t flags, void* user_data)
+{
+    return global_mock->drmModeAtomicCommit(fd, req, flags, user_data);
+}
+
+int drmModeCreatePropertyBlob(int fd, void const* data, size_t size, uint32_t* id)
+{
+    return global_mock->drmModeCreatePropertyBlob(fd, data, size, id);
+}
+
+int drmModeDestroyPropertyBlob(int fd, uint32_t id)
+{
+    return global_mock->drmModeDestroyPropertyBlob(fd, id);
+}
+
 int drmModeAddFB(int fd, uint32_t width, uint32_t height,
                  uint8_t depth, uint8_t bpp, uint32_t pitch,
                  uint32_t bo_handle, uint32_t *buf_id)
@@ -361,6 +361,14 @@ void glTexImage2D(GLenum target, GLint level, GLint internalformat,
     global_mock_gl->glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
 }
 
+void glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset,
+                     GLsizei width, GLsizei height,
+                     GLenum format, GLenum type, const GLvoid* pixels)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+}
+
 void glGenFramebuffers(GLsizei n, GLuint *framebuffers)
 {
     CHECK_GLOBAL_VOID_MOCK();
@@ -476,3 +484,42 @@ void glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
     CHECK_GLOBAL_VOID_MOCK();
     global_mock_gl->glScissor(x, y, width, height);
 }
+
+GLsync glFenceSync(GLenum condition, GLbitfield flags)
+{
+    CHECK_GLOBAL_MOCK(GLsync);
+    return global_mock_gl->glFenceSync(condition, flags);
+}
+
+GLenum glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    CHECK_GLOBAL_MOCK(GLenum);
+    return global_mock_gl->glClientWaitSync(sync, flags, timeout);
+}
+
+void glDeleteSync(GLsync sync)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glDeleteSync(sync);
+}
+
+void glBlitFramebuffer(
+    GLint src_x0, GLint src_y0, GLint src_x1, GLint src_y1,
+    GLint dst_x0, GLint dst_y0, GLint dst_x1, GLint dst_y1,
+    GLbitfield mask, GLenum filter)
+{
+    CHECK_GLOBAL_VOID_MOCK();
+    global_mock_gl->glBlitFramebuffer(src_x0, src_y0, src_x1, src_y1, dst_x0, dst_y0, dst_x1, dst_y1, mask, filter);
+}
+
+void* glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    CHECK_GLOBAL_MOCK(void*);
+    return global_mock_gl->glMapBufferRange(target, offset, length, access);
+}
+
+GLboolean glUnmapBuffer(GLenum target)
+{
+    CHECK_GLOBAL_MOCK(GLboolean);
+    return global_mock_gl->glUnmapBuffer(target);
+}
@@ -462,6 +462,11 @@ void basic_software_buffer_drawing(
             return buffer_;
         }
 
+        auto damage_since(mg::BufferID) const -> std::experimental::optional<mir::geometry::Rectangles> override
+        {
+            return std::experimental::nullopt;
+        }
+
         auto screen_position() const -> mir::geometry::Rectangle override
         {
             return mir::geometry::Rectangle{top_left, buffer()->size()};
@@ -482,6 +487,13 @@ void basic_software_buffer_drawing(
             return mg::contains_alpha(buffer_->pixel_format());
         }
 
+        auto opaque_region() const -> mir::geometry::Rectangles override
+        {
+            if (shaped())
+                return {};
+            return {screen_position()};
+        }
+
         auto clip_area() const -> std::experimental::optional<mir::geometry::Rectangle> override
         {
             return std::experimental::optional<mir::geometry::Rectangle>{};
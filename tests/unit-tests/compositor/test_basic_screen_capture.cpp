@@ -0,0 +1,288 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/basic_screen_capture.h"
+
+#include "mir/test/doubles/mock_renderer.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+namespace mc = mir::compositor;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+namespace
+{
+struct BasicScreenCapture : Test
+{
+    BasicScreenCapture()
+    {
+        ON_CALL(renderer, capture_next_frame(_, _, _, _))
+            .WillByDefault(InvokeArgument<3>(true));
+
+        screen_capture.initial_configuration(configuration({output, other_output}));
+    }
+
+    static auto configuration(std::vector<geom::Rectangle> const& outputs)
+        -> std::shared_ptr<mir::graphics::DisplayConfiguration const>
+    {
+        return std::make_shared<mtd::StubDisplayConfig>(outputs);
+    }
+
+    void capture(geom::Rectangle const& area, uint64_t since = 0, bool wait_for_damage = false)
+    {
+        screen_capture.capture(area, since, wait_for_damage,
+            [this](std::shared_ptr<mc::ScreenCapture::Frame const> const& frame)
+            {
+                frames.push_back(frame);
+            });
+    }
+
+    geom::Rectangle const output{{0, 0}, {640, 480}};
+    geom::Rectangle const other_output{{640, 0}, {640, 480}};
+    geom::Rectangle const no_damage{};
+
+    int frames_scheduled{0};
+    mc::BasicScreenCapture screen_capture{[this] { ++frames_scheduled; }};
+    NiceMock<mtd::MockRenderer> renderer;
+    std::vector<std::shared_ptr<mc::ScreenCapture::Frame const>> frames;
+};
+}
+
+TEST_F(BasicScreenCapture, capture_schedules_a_frame_of_the_output)
+{
+    EXPECT_FALSE(screen_capture.wants_frame(output));
+
+    capture(output);
+
+    EXPECT_THAT(frames_scheduled, Eq(1));
+    EXPECT_TRUE(screen_capture.wants_frame(output));
+    EXPECT_FALSE(screen_capture.wants_frame(other_output));
+}
+
+TEST_F(BasicScreenCapture, hands_capture_to_renderer_of_output_containing_area)
+{
+    geom::Rectangle const area{{10, 20}, {30, 40}};
+    capture(area);
+
+    EXPECT_CALL(renderer, capture_next_frame(_, _, _, _)).Times(0);
+    screen_capture.frame_rendering(other_output, other_output, renderer);
+    Mock::VerifyAndClearExpectations(&renderer);
+
+    EXPECT_CALL(renderer, capture_next_frame(Eq(area), NotNull(), Eq(geom::Stride{30 * 4}), _))
+        .WillOnce(InvokeArgument<3>(true));
+    screen_capture.frame_rendering(output, output, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    ASSERT_THAT(frames[0], NotNull());
+    EXPECT_THAT(frames[0]->area, Eq(area));
+    EXPECT_THAT(frames[0]->pixels.size(), Eq(30u * 40u));
+    EXPECT_FALSE(screen_capture.wants_frame(output));
+}
+
+TEST_F(BasicScreenCapture, keeps_output_composited_until_renderer_finishes_capture)
+{
+    std::function<void(bool)> finish;
+    EXPECT_CALL(renderer, capture_next_frame(_, _, _, _))
+        .WillOnce(SaveArg<3>(&finish));
+
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+
+    // The renderer finishes the capture while drawing a later frame, so there has to be one
+    EXPECT_THAT(frames_scheduled, Eq(2));
+    EXPECT_TRUE(screen_capture.wants_frame(output));
+    EXPECT_FALSE(screen_capture.wants_frame(other_output));
+    EXPECT_THAT(frames, IsEmpty());
+
+    finish(true);
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0], NotNull());
+    EXPECT_FALSE(screen_capture.wants_frame(output));
+
+    screen_capture.frame_rendering(output, no_damage, renderer);
+    EXPECT_THAT(frames_scheduled, Eq(2));
+}
+
+TEST_F(BasicScreenCapture, reports_failure_as_null_frame)
+{
+    capture(output);
+
+    EXPECT_CALL(renderer, capture_next_frame(_, _, _, _))
+        .WillOnce(InvokeArgument<3>(false));
+    screen_capture.frame_rendering(output, output, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0], IsNull());
+}
+
+TEST_F(BasicScreenCapture, first_frame_is_all_damaged)
+{
+    geom::Rectangle const area{{10, 20}, {30, 40}};
+    capture(area);
+
+    screen_capture.frame_rendering(output, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0]->damage, Eq(area));
+}
+
+TEST_F(BasicScreenCapture, reports_damage_since_previous_capture)
+{
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    geom::Rectangle const first_change{{10, 10}, {10, 10}};
+    geom::Rectangle const second_change{{100, 100}, {10, 10}};
+    screen_capture.frame_rendering(output, first_change, renderer);
+    screen_capture.frame_rendering(output, second_change, renderer);
+
+    capture(output, since);
+    screen_capture.frame_rendering(output, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->sequence, Gt(since));
+    EXPECT_THAT(frames[1]->damage, Eq(geom::Rectangle{{10, 10}, {100, 100}}));
+}
+
+TEST_F(BasicScreenCapture, damage_is_clipped_to_captured_area)
+{
+    geom::Rectangle const area{{0, 0}, {100, 100}};
+    capture(area);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    screen_capture.frame_rendering(output, geom::Rectangle{{50, 50}, {100, 100}}, renderer);
+
+    capture(area, since);
+    screen_capture.frame_rendering(output, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->damage, Eq(geom::Rectangle{{50, 50}, {50, 50}}));
+}
+
+TEST_F(BasicScreenCapture, waiting_for_damage_does_not_schedule_a_frame)
+{
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+    frames_scheduled = 0;
+
+    capture(output, since, true);
+
+    EXPECT_THAT(frames_scheduled, Eq(0));
+}
+
+TEST_F(BasicScreenCapture, waiting_for_damage_skips_frames_without_damage_in_area)
+{
+    geom::Rectangle const area{{0, 0}, {100, 100}};
+    capture(area);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    capture(area, since, true);
+
+    screen_capture.frame_rendering(output, no_damage, renderer);
+    screen_capture.frame_rendering(output, geom::Rectangle{{200, 200}, {10, 10}}, renderer);
+    EXPECT_THAT(frames.size(), Eq(1u));
+
+    screen_capture.frame_rendering(output, geom::Rectangle{{90, 90}, {20, 20}}, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->damage, Eq(geom::Rectangle{{90, 90}, {10, 10}}));
+}
+
+TEST_F(BasicScreenCapture, too_old_a_frame_is_all_damaged)
+{
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    for (int i = 0; i != 100; ++i)
+        screen_capture.frame_rendering(output, geom::Rectangle{{i, i}, {1, 1}}, renderer);
+
+    capture(output, since);
+    screen_capture.frame_rendering(output, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->damage, Eq(output));
+}
+
+TEST_F(BasicScreenCapture, capture_of_area_on_no_output_fails_at_once)
+{
+    capture(geom::Rectangle{{600, 0}, {80, 80}});
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0], IsNull());
+    EXPECT_THAT(frames_scheduled, Eq(0));
+}
+
+TEST_F(BasicScreenCapture, capture_pending_across_output_removal_fails)
+{
+    capture(other_output);
+    capture(output);
+
+    screen_capture.configuration_applied(configuration({output}));
+
+    ASSERT_THAT(frames.size(), Eq(1u));
+    EXPECT_THAT(frames[0], IsNull());
+    EXPECT_FALSE(screen_capture.wants_frame(other_output));
+
+    // The capture of the remaining output is still served
+    screen_capture.frame_rendering(output, output, renderer);
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1], NotNull());
+}
+
+TEST_F(BasicScreenCapture, frames_stay_numbered_across_configuration_changes)
+{
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    screen_capture.configuration_applied(configuration({output}));
+
+    geom::Rectangle const change{{10, 10}, {10, 10}};
+    screen_capture.frame_rendering(output, change, renderer);
+    capture(output, since);
+    screen_capture.frame_rendering(output, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->sequence, Gt(since));
+    EXPECT_THAT(frames[1]->damage, Eq(change));
+}
+
+TEST_F(BasicScreenCapture, moved_output_is_all_damaged)
+{
+    capture(output);
+    screen_capture.frame_rendering(output, output, renderer);
+    auto const since = frames.back()->sequence;
+
+    geom::Rectangle const moved{{0, 480}, {640, 480}};
+    screen_capture.configuration_applied(configuration({moved, other_output}));
+
+    capture(moved, since);
+    screen_capture.frame_rendering(moved, no_damage, renderer);
+
+    ASSERT_THAT(frames.size(), Eq(2u));
+    EXPECT_THAT(frames[1]->sequence, Gt(since));
+    EXPECT_THAT(frames[1]->damage, Eq(moved));
+}
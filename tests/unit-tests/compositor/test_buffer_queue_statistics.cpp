@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/buffer_queue_statistics.h"
+
+#include "mir/test/doubles/mock_compositor_report.h"
+#include "mir/test/fake_shared.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono_literals;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+struct BufferQueueStatistics : Test
+{
+    static auto at(std::chrono::nanoseconds ns) -> mir::time::PosixTimestamp
+    {
+        return {CLOCK_MONOTONIC, ns};
+    }
+
+    mg::BufferID const a{1}, b{2}, c{3};
+    void const* const compositor{this};
+
+    NiceMock<mtd::MockCompositorReport> report;
+    int const stream_tag{0};
+    void const* const stream{&stream_tag};
+    mc::BufferQueueStatistics statistics{stream, mt::fake_shared(report)};
+};
+}
+
+TEST_F(BufferQueueStatistics, starts_empty)
+{
+    auto const stats = statistics.stats();
+
+    EXPECT_THAT(stats.submitted, Eq(0u));
+    EXPECT_THAT(stats.acquired, Eq(0u));
+    EXPECT_THAT(stats.dropped, Eq(0u));
+    EXPECT_THAT(stats.presented, Eq(0u));
+    EXPECT_THAT(stats.queued, Eq(0u));
+    EXPECT_THAT(stats.present_latency_p99, Eq(0ns));
+}
+
+TEST_F(BufferQueueStatistics, counts_buffers_through_the_queue)
+{
+    statistics.submitted(a, at(0ms));
+    statistics.submitted(b, at(1ms));
+    EXPECT_THAT(statistics.stats().queued, Eq(2u));
+
+    statistics.acquired(compositor, a, at(2ms));
+    statistics.reacquired(compositor, a);
+    statistics.presented(a, at(5ms));
+
+    auto const stats = statistics.stats();
+    EXPECT_THAT(stats.submitted, Eq(2u));
+    EXPECT_THAT(stats.acquired, Eq(1u));
+    EXPECT_THAT(stats.reacquired, Eq(1u));
+    EXPECT_THAT(stats.presented, Eq(1u));
+    EXPECT_THAT(stats.dropped, Eq(0u));
+    EXPECT_THAT(stats.queued, Eq(1u));
+}
+
+TEST_F(BufferQueueStatistics, buffers_skipped_by_an_acquisition_are_dropped)
+{
+    EXPECT_CALL(report, buffer_dropped(stream, a));
+    EXPECT_CALL(report, buffer_dropped(stream, b));
+
+    statistics.submitted(a, at(0ms));
+    statistics.submitted(b, at(1ms));
+    statistics.submitted(c, at(2ms));
+    statistics.acquired(compositor, c, at(3ms));
+
+    auto const stats = statistics.stats();
+    EXPECT_THAT(stats.dropped, Eq(2u));
+    EXPECT_THAT(stats.queued, Eq(0u));
+}
+
+TEST_F(BufferQueueStatistics, resubmitted_buffer_replaces_its_earlier_submission)
+{
+    // A queueing schedule moves a resubmitted buffer to the back of the queue
+    statistics.submitted(a, at(0ms));
+    statistics.submitted(b, at(1ms));
+    statistics.submitted(a, at(2ms));
+
+    statistics.acquired(compositor, b, at(3ms));
+    EXPECT_THAT(statistics.stats().dropped, Eq(1u));
+
+    statistics.acquired(compositor, a, at(4ms));
+    auto const stats = statistics.stats();
+    EXPECT_THAT(stats.dropped, Eq(1u));
+    EXPECT_THAT(stats.queue_latency_p99, Eq(2ms));
+}
+
+TEST_F(BufferQueueStatistics, reports_latency_from_submission)
+{
+    EXPECT_CALL(report, buffer_acquired(stream, compositor, a, Eq(4ms)));
+    EXPECT_CALL(report, buffer_presented(stream, a, Eq(10ms)));
+
+    statistics.submitted(a, at(6ms));
+    statistics.acquired(compositor, a, at(10ms));
+    statistics.presented(a, at(16ms));
+}
+
+TEST_F(BufferQueueStatistics, each_submission_is_presented_once)
+{
+    EXPECT_CALL(report, buffer_presented(_, _, _)).Times(1);
+
+    statistics.submitted(a, at(0ms));
+    statistics.acquired(compositor, a, at(1ms));
+    statistics.presented(a, at(2ms));
+    statistics.presented(a, at(3ms));
+
+    EXPECT_THAT(statistics.stats().presented, Eq(1u));
+}
+
+TEST_F(BufferQueueStatistics, unacquired_buffer_is_not_presented)
+{
+    statistics.submitted(a, at(0ms));
+    statistics.presented(a, at(2ms));
+
+    EXPECT_THAT(statistics.stats().presented, Eq(0u));
+}
+
+TEST_F(BufferQueueStatistics, latency_percentiles_cover_recent_buffers)
+{
+    for (int i = 1; i <= 100; ++i)
+    {
+        auto const submit = at(i * 100ms);
+        statistics.submitted(a, submit);
+        statistics.acquired(compositor, a, submit + i * 1ms);
+        statistics.presented(a, submit + i * 2ms);
+    }
+
+    auto const stats = statistics.stats();
+    EXPECT_THAT(stats.queue_latency_p50, Eq(50ms));
+    EXPECT_THAT(stats.queue_latency_p99, Eq(99ms));
+    EXPECT_THAT(stats.present_latency_p50, Eq(100ms));
+    EXPECT_THAT(stats.present_latency_p99, Eq(198ms));
+}
+
+TEST_F(BufferQueueStatistics, old_samples_leave_the_window)
+{
+    for (int i = 0; i != 1000; ++i)
+    {
+        statistics.submitted(a, at(i * 100ms));
+        statistics.acquired(compositor, a, at(i * 100ms + (i < 500 ? 50ms : 1ms)));
+    }
+
+    EXPECT_THAT(statistics.stats().queue_latency_p99, Eq(1ms));
+}
+
+TEST_F(BufferQueueStatistics, forgotten_submissions_count_as_dropped)
+{
+    // Nothing composites a hidden surface, so its buffers are only ever replaced
+    for (int i = 0; i != 100; ++i)
+        statistics.submitted(mg::BufferID(i % 3 + 1), at(i * 1ms));
+
+    auto const stats = statistics.stats();
+    EXPECT_THAT(stats.dropped + stats.queued, Eq(100u));
+    EXPECT_THAT(stats.queued, Lt(100u));
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_buffer.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+struct DamageTracker : Test
+{
+    geom::Rectangle const output{{0, 0}, {1920, 1080}};
+    std::shared_ptr<mtd::FakeRenderable> const cursor{
+        std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{100, 100}, {16, 16}})};
+    std::shared_ptr<mtd::FakeRenderable> const window{
+        std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{200, 200}, {640, 480}})};
+    mc::DamageTracker tracker;
+
+    void settle(mg::RenderableList const& renderables)
+    {
+        tracker.record(renderables, output);
+        tracker.damage_for_frame(1);
+    }
+};
+}
+
+TEST_F(DamageTracker, first_frame_damages_everything)
+{
+    tracker.record({window}, output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(output));
+}
+
+TEST_F(DamageTracker, unchanged_frame_has_no_damage)
+{
+    settle({window, cursor});
+
+    tracker.record({window, cursor}, output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(geom::Rectangle{}));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_its_renderable)
+{
+    settle({window, cursor});
+
+    cursor->set_buffer(std::make_shared<mtd::StubBuffer>());
+    tracker.record({window, cursor}, output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(cursor->screen_position()));
+}
+
+TEST_F(DamageTracker, new_buffer_damages_only_what_the_client_changed)
+{
+    settle({window, cursor});
+
+    window->set_buffer(
+        std::make_shared<mtd::StubBuffer>(geom::Size{320, 240}),
+        geom::Rectangles{{{10, 10}, {5, 5}}});
+    tracker.record({window, cursor}, output);
+
+    // The 320x240 buffer is drawn at 640x480, so damage doubles in size
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(geom::Rectangle{{220, 220}, {10, 10}}));
+}
+
+TEST_F(DamageTracker, client_damage_is_clipped_to_the_renderable)
+{
+    settle({window, cursor});
+
+    window->set_buffer(
+        std::make_shared<mtd::StubBuffer>(geom::Size{640, 480}),
+        geom::Rectangles{{{600, 400}, {100, 100}}});
+    tracker.record({window, cursor}, output);
+
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(geom::Rectangle{{800, 600}, {40, 80}}));
+}
+
+TEST_F(DamageTracker, removed_renderable_damages_where_it_was)
+{
+    settle({window, cursor});
+
+    tracker.record({window}, output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(cursor->screen_position()));
+}
+
+TEST_F(DamageTracker, restacking_damages_restacked_renderables)
+{
+    settle({window, cursor});
+
+    tracker.record({cursor, window}, output);
+    auto const damage = tracker.damage_for_frame(1);
+
+    EXPECT_TRUE(damage.contains(cursor->screen_position()));
+    EXPECT_TRUE(damage.contains(window->screen_position()));
+}
+
+TEST_F(DamageTracker, damage_is_clipped_to_output)
+{
+    auto const offscreen = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{1900, 1000}, {100, 100}});
+    settle({offscreen});
+
+    offscreen->set_buffer(std::make_shared<mtd::StubBuffer>());
+    tracker.record({offscreen}, output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(geom::Rectangle{{1900, 1000}, {20, 80}}));
+}
+
+TEST_F(DamageTracker, older_buffers_include_damage_from_earlier_frames)
+{
+    settle({window, cursor});
+
+    cursor->set_buffer(std::make_shared<mtd::StubBuffer>());
+    tracker.record({window, cursor}, output);
+    tracker.damage_for_frame(1);
+
+    window->set_buffer(std::make_shared<mtd::StubBuffer>());
+    tracker.record({window, cursor}, output);
+    auto const damage = tracker.damage_for_frame(2);
+
+    EXPECT_TRUE(damage.contains(cursor->screen_position()));
+    EXPECT_TRUE(damage.contains(window->screen_position()));
+}
+
+TEST_F(DamageTracker, unknown_buffer_age_damages_everything)
+{
+    settle({window, cursor});
+
+    tracker.record({window, cursor}, output);
+    EXPECT_THAT(tracker.damage_for_frame(0), Eq(output));
+}
+
+TEST_F(DamageTracker, buffer_older_than_history_damages_everything)
+{
+    mc::DamageTracker tracker{2};
+    tracker.record({window, cursor}, output);
+    tracker.damage_for_frame(1);
+    tracker.record({window, cursor}, output);
+    tracker.damage_for_frame(1);
+
+    tracker.record({window, cursor}, output);
+    EXPECT_THAT(tracker.damage_for_frame(3), Eq(output));
+}
+
+TEST_F(DamageTracker, damage_all_damages_everything)
+{
+    settle({window, cursor});
+
+    tracker.record({window, cursor}, output);
+    tracker.damage_all();
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(output));
+}
+
+TEST_F(DamageTracker, output_change_damages_everything)
+{
+    settle({window, cursor});
+
+    geom::Rectangle const moved_output{{1920, 0}, {1920, 1080}};
+    tracker.record({window, cursor}, moved_output);
+    EXPECT_THAT(tracker.damage_for_frame(1), Eq(moved_output));
+}
+
+TEST_F(DamageTracker, last_frame_damage_ignores_buffer_age)
+{
+    settle({window, cursor});
+
+    cursor->set_buffer(std::make_shared<mtd::StubBuffer>());
+    tracker.record({window, cursor}, output);
+    EXPECT_THAT(tracker.damage_for_frame(0), Eq(output));
+
+    EXPECT_THAT(tracker.last_frame_damage(), Eq(cursor->screen_position()));
+}
@@ -35,6 +35,8 @@
 #include "mir/test/doubles/mock_scene.h"
 #include "mir/test/doubles/stub_scene.h"
 #include "mir/test/doubles/stub_scene_element.h"
+#include "mir/graphics/presentation.h"
+#include "mir/compositor/screen_capture.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -86,6 +88,18 @@ auto make_scene_elements(std::initializer_list<std::shared_ptr<mg::Renderable>>
     return elements;
 }
 
+struct PresentedRenderable : mtd::FakeRenderable
+{
+    using mtd::FakeRenderable::FakeRenderable;
+
+    auto on_presented() const -> std::function<void(mg::Presentation const&)> override
+    {
+        return [this](mg::Presentation const& presentation) { presentations.push_back(presentation); };
+    }
+
+    std::vector<mg::Presentation> mutable presentations;
+};
+
 struct DefaultDisplayBufferCompositor : public testing::Test
 {
     DefaultDisplayBufferCompositor()
@@ -167,6 +181,10 @@ TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
     EXPECT_CALL(display_buffer, overlay(_))
         .InSequence(seq)
         .WillOnce(Return(false));
+    EXPECT_CALL(*report, damage_in_frame(_, screen))
+        .InSequence(seq);
+    EXPECT_CALL(*report, draw_calls_in_frame(_, 7u))
+        .InSequence(seq);
     EXPECT_CALL(*report, renderables_in_frame(_,_))
         .InSequence(seq);
     EXPECT_CALL(*report, rendered_frame(_))
@@ -176,6 +194,8 @@ TEST_F(DefaultDisplayBufferCompositor, rendering_reports_everything)
 
     EXPECT_CALL(mock_renderer, render(_))
         .Times(1);
+    ON_CALL(mock_renderer, draw_calls())
+        .WillByDefault(Return(7u));
 
     mc::DefaultDisplayBufferCompositor compositor(
         display_buffer,
@@ -298,6 +318,106 @@ TEST_F(DefaultDisplayBufferCompositor, optimization_toggles_seamlessly)
     fullscreen->set_buffer({});  // Avoid GMock complaining about false leaks
 }
 
+TEST_F(DefaultDisplayBufferCompositor, redraws_only_damage_when_buffer_is_reused)
+{
+    using namespace testing;
+    ON_CALL(mock_renderer, buffer_age())
+        .WillByDefault(Return(1));
+
+    Sequence seq;
+    EXPECT_CALL(mock_renderer, set_damage(screen))
+        .InSequence(seq);
+    EXPECT_CALL(mock_renderer, render(_))
+        .InSequence(seq);
+    EXPECT_CALL(mock_renderer, set_damage(small->screen_position()))
+        .InSequence(seq);
+    EXPECT_CALL(mock_renderer, render(_))
+        .InSequence(seq);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    small->set_buffer(std::make_shared<mtd::StubBuffer>());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, redraws_everything_after_overlay)
+{
+    using namespace testing;
+    ON_CALL(mock_renderer, buffer_age())
+        .WillByDefault(Return(1));
+
+    Sequence seq;
+    EXPECT_CALL(display_buffer, overlay(_))
+        .InSequence(seq)
+        .WillOnce(Return(false));
+    EXPECT_CALL(mock_renderer, set_damage(screen))
+        .InSequence(seq);
+    EXPECT_CALL(display_buffer, overlay(_))
+        .InSequence(seq)
+        .WillOnce(Return(true));
+    EXPECT_CALL(display_buffer, overlay(_))
+        .InSequence(seq)
+        .WillOnce(Return(false));
+    EXPECT_CALL(mock_renderer, set_damage(screen))
+        .InSequence(seq);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({fullscreen}));
+    compositor.composite(make_scene_elements({fullscreen}));
+    compositor.composite(make_scene_elements({fullscreen}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, renders_only_what_is_not_on_hardware_planes)
+{
+    using namespace testing;
+    mg::RenderableList const composited{big};
+
+    EXPECT_CALL(display_buffer, assign_planes(ElementsAre(big, small)))
+        .WillOnce(Return(composited));
+    EXPECT_CALL(mock_renderer, render(ContainerEq(composited)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, redraws_renderable_moved_off_hardware_plane)
+{
+    using namespace testing;
+    ON_CALL(mock_renderer, buffer_age())
+        .WillByDefault(Return(1));
+
+    Sequence seq;
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .InSequence(seq)
+        .WillOnce(Return(mg::RenderableList{big}));
+    EXPECT_CALL(mock_renderer, set_damage(screen))
+        .InSequence(seq);
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .InSequence(seq)
+        .WillOnce(ReturnArg<0>());
+    EXPECT_CALL(mock_renderer, set_damage(small->screen_position()))
+        .InSequence(seq);
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, small}));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
 TEST_F(DefaultDisplayBufferCompositor, occluded_surfaces_are_not_rendered)
 {
     using namespace testing;
@@ -388,3 +508,131 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+
+TEST_F(DefaultDisplayBufferCompositor, tells_renderables_when_their_frame_is_presented)
+{
+    using namespace testing;
+    auto const shown = std::make_shared<PresentedRenderable>(geom::Rectangle{{10, 20},{30, 40}});
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({big, shown}));
+    EXPECT_THAT(shown->presentations, IsEmpty());
+
+    mg::Presentation presentation;
+    presentation.frame.msc = 7;
+    presentation.flags = mg::Presentation::vsync;
+    compositor.presented(presentation);
+
+    ASSERT_THAT(shown->presentations, SizeIs(1));
+    EXPECT_THAT(shown->presentations[0].frame.msc, Eq(7));
+    EXPECT_THAT(shown->presentations[0].flags, Eq(mg::Presentation::vsync));
+
+    // Nothing more was posted, so there's nothing more to present
+    compositor.presented(presentation);
+    EXPECT_THAT(shown->presentations, SizeIs(1));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, flags_renderables_on_hardware_planes_as_zero_copy)
+{
+    using namespace testing;
+    auto const on_plane = std::make_shared<PresentedRenderable>(geom::Rectangle{{10, 20},{30, 40}});
+    auto const rendered = std::make_shared<PresentedRenderable>(geom::Rectangle{{5, 10},{100, 200}});
+
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .WillOnce(Return(mg::RenderableList{rendered}));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+
+    compositor.composite(make_scene_elements({rendered, on_plane}));
+    compositor.presented(mg::Presentation{});
+
+    ASSERT_THAT(on_plane->presentations, SizeIs(1));
+    ASSERT_THAT(rendered->presentations, SizeIs(1));
+    EXPECT_THAT(on_plane->presentations[0].flags, Eq(mg::Presentation::zero_copy));
+    EXPECT_THAT(rendered->presentations[0].flags, Eq(0u));
+}
+
+namespace
+{
+struct MockScreenCapture : mc::ScreenCapture
+{
+    MOCK_METHOD4(capture, void(geom::Rectangle const&, uint64_t, bool, Callback const&));
+    MOCK_CONST_METHOD1(wants_frame, bool(geom::Rectangle const&));
+    MOCK_METHOD3(frame_rendering, void(geom::Rectangle const&, geom::Rectangle const&, mir::renderer::Renderer&));
+};
+}
+
+TEST_F(DefaultDisplayBufferCompositor, composites_instead_of_overlaying_while_capturing)
+{
+    using namespace testing;
+    NiceMock<MockScreenCapture> capture;
+    EXPECT_CALL(capture, wants_frame(Eq(screen)))
+        .WillOnce(Return(true));
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .Times(0);
+    EXPECT_CALL(mock_renderer, render(_));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report(),
+        mt::fake_shared(capture));
+    compositor.composite(make_scene_elements({fullscreen}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, composites_what_would_be_on_hardware_planes_while_capturing)
+{
+    using namespace testing;
+    NiceMock<MockScreenCapture> capture;
+    ON_CALL(capture, wants_frame(_))
+        .WillByDefault(Return(true));
+    ON_CALL(display_buffer, assign_planes(_))
+        .WillByDefault(Return(mg::RenderableList{big}));
+
+    EXPECT_CALL(display_buffer, assign_planes(_))
+        .Times(0);
+    EXPECT_CALL(mock_renderer, render(ElementsAre(big, small)));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report(),
+        mt::fake_shared(capture));
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, hands_capture_the_frame_damage_before_rendering)
+{
+    using namespace testing;
+    NiceMock<MockScreenCapture> capture;
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report(),
+        mt::fake_shared(capture));
+
+    // The first frame damages the whole output
+    {
+        InSequence seq;
+        EXPECT_CALL(capture, frame_rendering(Eq(screen), Eq(screen), Ref(mock_renderer)));
+        EXPECT_CALL(mock_renderer, render(_));
+    }
+    compositor.composite(make_scene_elements({small}));
+    Mock::VerifyAndClearExpectations(&capture);
+    Mock::VerifyAndClearExpectations(&mock_renderer);
+
+    // After that, only what changed, whatever the buffer age
+    ON_CALL(mock_renderer, buffer_age())
+        .WillByDefault(Return(0));
+    EXPECT_CALL(capture, frame_rendering(Eq(screen), Eq(small->screen_position()), _));
+    compositor.composite(make_scene_elements({}));
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/frame_scheduler.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+using namespace testing;
+using namespace std::chrono;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+
+namespace
+{
+struct FrameScheduler : Test
+{
+    using Timestamp = mc::FrameScheduler::Timestamp;
+
+    static auto at(nanoseconds t) -> Timestamp
+    {
+        return {CLOCK_MONOTONIC, t};
+    }
+
+    static auto frame(int64_t msc, nanoseconds ust) -> mg::Frame
+    {
+        mg::Frame f;
+        f.msc = msc;
+        f.ust = at(ust);
+        return f;
+    }
+
+    nanoseconds const interval{16'000'000};
+    nanoseconds const margin{1'000'000};
+    mc::FrameScheduler scheduler{margin};
+};
+}
+
+TEST_F(FrameScheduler, has_no_opinion_without_page_flips)
+{
+    EXPECT_FALSE(scheduler.next_start(at(1s)));
+
+    scheduler.flipped(mg::Frame{});
+    EXPECT_FALSE(scheduler.next_start(at(1s)));
+    EXPECT_THAT(scheduler.refresh_interval(), Eq(nanoseconds::zero()));
+}
+
+TEST_F(FrameScheduler, learns_refresh_interval_from_page_flips)
+{
+    scheduler.flipped(frame(10, 1s));
+    EXPECT_FALSE(scheduler.next_start(at(1s)));
+
+    // A skipped vblank doesn't look like a slower refresh rate
+    scheduler.flipped(frame(12, 1s + 2*interval));
+
+    EXPECT_THAT(scheduler.refresh_interval(), Eq(interval));
+}
+
+TEST_F(FrameScheduler, starts_composition_just_in_time_for_next_vblank)
+{
+    scheduler.flipped(frame(1, 1s));
+    scheduler.flipped(frame(2, 1s + interval));
+
+    for (int i = 0; i != 10; ++i)
+        scheduler.composited(3ms);
+
+    auto const start = scheduler.next_start(at(1s + interval + 1ms));
+
+    ASSERT_TRUE(start);
+    EXPECT_THAT(start.value().nanoseconds, Eq(1s + 2*interval - 3ms - margin));
+}
+
+TEST_F(FrameScheduler, budgets_for_all_but_the_slowest_compositions)
+{
+    for (int i = 0; i != 95; ++i)
+        scheduler.composited(2ms);
+    for (int i = 0; i != 5; ++i)
+        scheduler.composited(10ms);
+
+    auto const cost = scheduler.composition_cost(0.9);
+
+    EXPECT_THAT(cost, Eq(2ms));
+    EXPECT_THAT(scheduler.composition_cost(1.0), Eq(10ms));
+}
+
+TEST_F(FrameScheduler, aims_for_a_later_vblank_if_the_next_cannot_be_made)
+{
+    scheduler.flipped(frame(1, 1s));
+    scheduler.flipped(frame(2, 1s + interval));
+    scheduler.composited(10ms);
+
+    // Too late to composite for the vblank at 1s + 2*interval
+    auto const start = scheduler.next_start(at(1s + interval + 10ms));
+
+    ASSERT_TRUE(start);
+    EXPECT_THAT(start.value().nanoseconds, Eq(1s + 3*interval - 10ms - margin));
+}
+
+TEST_F(FrameScheduler, reports_latency_from_composition_start_to_page_flip)
+{
+    scheduler.flipped(frame(1, 1s));
+
+    scheduler.posted(at(1s + 10ms));
+    auto const latency = scheduler.flipped(frame(2, 1s + interval));
+
+    ASSERT_TRUE(latency);
+    EXPECT_THAT(latency.value(), Eq(interval - 10ms));
+}
+
+TEST_F(FrameScheduler, matches_deferred_page_flips_to_the_frames_they_show)
+{
+    scheduler.flipped(frame(1, 1s));
+
+    // Clone groups don't wait for their page flip before posting again
+    scheduler.posted(at(1s + 5ms));
+    EXPECT_FALSE(scheduler.flipped(frame(1, 1s)));
+    scheduler.posted(at(1s + 15ms));
+
+    auto const latency = scheduler.flipped(frame(2, 1s + interval));
+
+    ASSERT_TRUE(latency);
+    EXPECT_THAT(latency.value(), Eq(interval - 5ms));
+}
+
+TEST_F(FrameScheduler, allows_more_time_after_missing_a_vblank)
+{
+    scheduler.flipped(frame(1, 1s));
+    scheduler.flipped(frame(2, 1s + interval));
+    scheduler.composited(3ms);
+
+    auto const now = at(1s + interval + 1ms);
+    auto const first = scheduler.next_start(now).value();
+
+    // ...but the frame only made it to the vblank after
+    scheduler.posted(first);
+    scheduler.flipped(frame(4, 1s + 3*interval));
+
+    auto const second = scheduler.next_start(at(1s + 3*interval + 1ms)).value();
+
+    EXPECT_THAT(1s + 4*interval - second.nanoseconds, Gt(3ms + margin));
+}
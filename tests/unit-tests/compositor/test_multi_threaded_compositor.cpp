@@ -24,6 +24,7 @@
 #include "mir/compositor/scene.h"
 #include "mir/compositor/display_buffer_compositor_factory.h"
 #include "mir/scene/observer.h"
+#include "mir/graphics/presentation.h"
 #include "mir/raii.h"
 
 #include "mir/test/current_thread_name.h"
@@ -43,6 +44,7 @@
 #include <thread>
 #include <mutex>
 #include <chrono>
+#include <atomic>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -345,6 +347,93 @@ public:
     std::vector<std::string> thread_names;
 };
 
+class FlippingDisplay : public mtd::NullDisplay
+{
+public:
+    /// Posting flips, except for every skip'th post; flips are timed long before any frame starts
+    FlippingDisplay(int skip) : group{skip} {}
+
+    void for_each_display_sync_group(std::function<void(mg::DisplaySyncGroup&)> const& f) override
+    {
+        f(group);
+    }
+
+    int64_t flips() const
+    {
+        return group.last_frame().msc;
+    }
+
+private:
+    struct FlippingDisplaySyncGroup : mg::DisplaySyncGroup
+    {
+        FlippingDisplaySyncGroup(int skip) : skip{skip} {}
+
+        void for_each_display_buffer(std::function<void(mg::DisplayBuffer&)> const& f) override
+        {
+            f(buffer);
+        }
+        void post() override
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (++posts % skip)
+            {
+                ++frame.msc;
+                frame.ust = mg::Frame::Timestamp{CLOCK_MONOTONIC, std::chrono::nanoseconds{frame.msc}};
+            }
+        }
+        std::chrono::milliseconds recommended_sleep() const override
+        {
+            return std::chrono::milliseconds::zero();
+        }
+        mg::Frame last_frame() const override
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            return frame;
+        }
+
+        int const skip;
+        mtd::NullDisplayBuffer buffer;
+        std::mutex mutable mutex;
+        int posts{0};
+        mg::Frame frame;
+    };
+
+    FlippingDisplaySyncGroup group;
+};
+
+class PresentationCountingDisplayBufferCompositor : public mc::DisplayBufferCompositor
+{
+public:
+    PresentationCountingDisplayBufferCompositor(std::atomic<int64_t>& presentations)
+        : presentations(presentations)
+    {
+    }
+
+    void composite(mc::SceneElementSequence&&) override
+    {
+        std::this_thread::yield();
+    }
+
+    void presented(mg::Presentation const&) override
+    {
+        ++presentations;
+    }
+
+private:
+    std::atomic<int64_t>& presentations;
+};
+
+class PresentationCountingDisplayBufferCompositorFactory : public mc::DisplayBufferCompositorFactory
+{
+public:
+    std::unique_ptr<mc::DisplayBufferCompositor> create_compositor_for(mg::DisplayBuffer&) override
+    {
+        return std::make_unique<PresentationCountingDisplayBufferCompositor>(presentations);
+    }
+
+    std::atomic<int64_t> presentations{0};
+};
+
 namespace
 {
 struct StubDisplayListener : mc::DisplayListener
@@ -468,6 +557,25 @@ TEST(MultiThreadedCompositor, reports_in_the_right_places)
     compositor.stop();
 }
 
+TEST(MultiThreadedCompositor, tells_compositors_of_every_flip_even_if_it_cant_time_it)
+{
+    using namespace testing;
+
+    auto display = std::make_shared<FlippingDisplay>(3);
+    auto scene = std::make_shared<StubScene>();
+    auto db_compositor_factory = std::make_shared<PresentationCountingDisplayBufferCompositorFactory>();
+    mc::MultiThreadedCompositor compositor{display, scene, db_compositor_factory, null_display_listener, null_report, default_delay, false};
+
+    compositor.start();
+    scene->set_pending(100);
+    while (display->flips() < 20)
+        std::this_thread::yield();
+    scene->set_pending(0);
+    compositor.stop();
+
+    EXPECT_THAT(db_compositor_factory->presentations.load(), Eq(display->flips()));
+}
+
 /*
  * It's difficult to test that a render won't happen, without some further
  * introspective capabilities that would complicate the code. This test will
@@ -17,6 +17,7 @@
  */
 
 #include "mir/geometry/rectangle.h"
+#include "mir/graphics/presentation.h"
 #include "src/server/compositor/occlusion.h"
 #include "mir/test/doubles/fake_renderable.h"
 #include "mir/test/doubles/stub_scene_element.h"
@@ -62,6 +63,17 @@ struct OcclusionFilterTest : public Test
     Rectangle monitor_rect;
 };
 
+struct PresentationAwareRenderable : mtd::FakeRenderable
+{
+    using mtd::FakeRenderable::FakeRenderable;
+
+    auto on_presented() const -> std::function<void(mg::Presentation const&)> override
+    {
+        return [this](mg::Presentation const&) { ++presentations; };
+    }
+
+    mutable int presentations{0};
+};
 }
 
 TEST_F(OcclusionFilterTest, single_window_not_occluded)
@@ -125,6 +137,33 @@ TEST_F(OcclusionFilterTest, shaped_window_occludes_nothing)
     EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
 }
 
+TEST_F(OcclusionFilterTest, opaque_part_of_shaped_window_occludes_what_is_beneath_it)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 1.0f, false);
+    top->set_opaque_region({Rectangle{{20, 20}, {80, 80}}});
+    auto beneath_opaque = std::make_shared<mtd::FakeRenderable>(30, 30, 10, 10);
+    auto beneath_edge = std::make_shared<mtd::FakeRenderable>(12, 12, 10, 10);
+    auto elements = scene_elements_from({beneath_opaque, beneath_edge, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(beneath_opaque));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(beneath_edge, top));
+}
+
+TEST_F(OcclusionFilterTest, translucent_window_with_opaque_region_occludes_nothing)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {100, 100}}, 0.5f, false);
+    top->set_opaque_region({Rectangle{{10, 10}, {100, 100}}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(30, 30, 10, 10);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
+
 TEST_F(OcclusionFilterTest, identical_window_occluded)
 {
     auto top = std::make_shared<mtd::FakeRenderable>(10, 10, 10, 10);
@@ -202,3 +241,106 @@ TEST_F(OcclusionFilterTest,
     EXPECT_THAT(renderables_from(occlusions), ElementsAre(partially_onscreen));
     EXPECT_THAT(renderables_from(elements), ElementsAre(covering));
 }
+
+TEST_F(OcclusionFilterTest, window_covered_by_several_windows_occluded)
+{
+    auto const left = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 200);
+    auto const right = std::make_shared<mtd::FakeRenderable>(100, 0, 100, 200);
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(10, 10, 180, 180);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
+
+TEST_F(OcclusionFilterTest, partially_covered_window_clipped_to_what_remains_visible)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 200);
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 300, 200);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(2u));
+    EXPECT_THAT(elements[1]->renderable(), Eq(top));
+
+    auto const clipped = elements[0]->renderable();
+    EXPECT_THAT(clipped->id(), Eq(bottom->id()));
+    EXPECT_THAT(clipped->screen_position(), Eq(bottom->screen_position()));
+    EXPECT_THAT(clipped->clip_area(), Eq(Rectangle{{100, 0}, {200, 200}}));
+}
+
+TEST_F(OcclusionFilterTest, clipped_window_still_hears_when_it_is_presented)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 200);
+    auto const bottom = std::make_shared<PresentationAwareRenderable>(0, 0, 300, 200);
+    auto elements = scene_elements_from({bottom, top});
+
+    filter_occlusions_from(elements, monitor_rect);
+
+    ASSERT_THAT(elements.size(), Eq(2u));
+    auto const clipped = elements[0]->renderable();
+    ASSERT_THAT(clipped, Ne(bottom));
+
+    auto const on_presented = clipped->on_presented();
+    ASSERT_TRUE(on_presented);
+    on_presented(mg::Presentation{});
+    EXPECT_THAT(bottom->presentations, Eq(1));
+}
+
+TEST_F(OcclusionFilterTest, window_with_holes_not_clipped)
+{
+    auto const top = std::make_shared<mtd::FakeRenderable>(100, 100, 100, 100);
+    auto const bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 300, 300);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
+
+TEST_F(OcclusionFilterTest, hundred_windows_covered_by_hundred_tiles_occluded)
+{
+    std::vector<std::shared_ptr<mg::Renderable>> windows;
+    std::vector<std::shared_ptr<mg::Renderable>> tiles;
+    for (int i = 0; i != 100; ++i)
+    {
+        // Every window straddles several tiles, so none is hidden by any one of them
+        windows.push_back(std::make_shared<mtd::FakeRenderable>(10 + 7 * (i % 10), 10 + 5 * (i / 10), 850, 850));
+        tiles.push_back(std::make_shared<mtd::FakeRenderable>(100 * (i % 10), 100 * (i / 10), 100, 100));
+    }
+
+    auto stack = windows;
+    stack.insert(stack.end(), tiles.begin(), tiles.end());
+    auto elements = scene_elements_from(stack);
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAreArray(windows));
+    EXPECT_THAT(renderables_from(elements), ElementsAreArray(tiles));
+}
+
+TEST_F(OcclusionFilterTest, hundred_cascaded_windows_clipped_to_their_visible_strips)
+{
+    std::vector<std::shared_ptr<mg::Renderable>> windows;
+    for (int i = 0; i != 100; ++i)
+        windows.push_back(std::make_shared<mtd::FakeRenderable>(10 * i, 0, 400, 300));
+    auto elements = scene_elements_from(windows);
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(100u));
+    EXPECT_THAT(elements[99]->renderable(), Eq(windows[99]));
+    for (int i = 0; i != 99; ++i)
+    {
+        auto const renderable = elements[i]->renderable();
+        EXPECT_THAT(renderable->id(), Eq(windows[i]->id()));
+        // Only the left edge peeks out from under the next window
+        EXPECT_THAT(renderable->clip_area(), Eq(Rectangle{{10 * i, 0}, {10, 300}}));
+    }
+}
@@ -21,7 +21,9 @@
 #include "mir/test/doubles/mock_event_sink.h"
 #include "mir/test/fake_shared.h"
 #include "src/server/compositor/stream.h"
+#include "src/server/report/null_report_factory.h"
 #include "mir/scene/null_surface_observer.h"
+#include "mir/graphics/presentation.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -33,6 +35,7 @@ namespace mtd = mir::test::doubles;
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace geom = mir::geometry;
+namespace mr = mir::report;
 namespace
 {
 struct Stream : Test
@@ -51,7 +54,7 @@ struct Stream : Test
     std::vector<std::shared_ptr<mg::Buffer>> buffers;
     MirPixelFormat construction_format{mir_pixel_format_rgb_565};
     mc::Stream stream{
-        initial_size, construction_format};
+        initial_size, construction_format, mr::null_compositor_report()};
 };
 }
 
@@ -241,3 +244,192 @@ TEST_F(Stream, stream_remembers_scale_when_buffer_added)
     stream.submit_buffer(buffers[0]);
     ASSERT_THAT(stream.stream_size(), Eq(initial_size / 2));
 }
+
+TEST_F(Stream, reports_damage_accumulated_between_buffers)
+{
+    geom::Rectangle const first_damage{{1, 0}, {2, 1}};
+    geom::Rectangle const second_damage{{20, 1}, {3, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{first_damage});
+    stream.submit_buffer(buffers[2], geom::Rectangles{second_damage});
+
+    auto const damage = stream.damage_between(buffers[0]->id(), buffers[2]->id());
+    ASSERT_TRUE(damage);
+    EXPECT_THAT(damage.value(), Eq(geom::Rectangles{first_damage, second_damage}));
+    EXPECT_THAT(stream.damage_between(buffers[2]->id(), buffers[2]->id()).value(), Eq(geom::Rectangles{}));
+}
+
+TEST_F(Stream, damage_from_unknown_buffer_is_unknown)
+{
+    auto const unknown = std::make_shared<mtd::StubBuffer>(initial_size);
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(buffers[1], geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_FALSE(stream.damage_between(unknown->id(), buffers[1]->id()));
+    EXPECT_FALSE(stream.damage_between(buffers[1]->id(), buffers[0]->id()));
+}
+
+TEST_F(Stream, resized_buffer_is_wholly_damaged)
+{
+    geom::Size const new_size{333, 139};
+    auto const resized = std::make_shared<mtd::StubBuffer>(new_size);
+
+    stream.submit_buffer(buffers[0]);
+    stream.submit_buffer(resized, geom::Rectangles{{{1, 0}, {2, 1}}});
+
+    EXPECT_THAT(
+        stream.damage_between(buffers[0]->id(), resized->id()).value(),
+        Eq(geom::Rectangles{{{0, 0}, new_size}}));
+}
+
+TEST_F(Stream, reports_presentation_of_the_buffer_submitted)
+{
+    mg::Presentation const* reported{nullptr};
+    mg::Presentation presentation;
+    presentation.frame.msc = 42;
+    presentation.flags = mg::Presentation::vsync;
+    int calls = 0;
+
+    stream.submit_buffer(buffers[0]);
+    stream.add_presentation_callback(
+        [&](mg::Presentation const* p) { reported = p; ++calls; });
+
+    stream.presented(buffers[1]->id(), presentation);
+    EXPECT_THAT(calls, Eq(0));
+
+    stream.presented(buffers[0]->id(), presentation);
+    EXPECT_THAT(calls, Eq(1));
+    ASSERT_THAT(reported, NotNull());
+    EXPECT_THAT(reported->frame.msc, Eq(42));
+
+    // Only once
+    stream.presented(buffers[0]->id(), presentation);
+    EXPECT_THAT(calls, Eq(1));
+}
+
+TEST_F(Stream, discards_presentation_of_buffers_replaced_before_being_shown)
+{
+    std::vector<bool> shown;
+    auto const record = [&](mg::Presentation const* p) { shown.push_back(p != nullptr); };
+
+    stream.submit_buffer(buffers[0]);
+    stream.add_presentation_callback(record);
+    stream.submit_buffer(buffers[1]);
+    stream.add_presentation_callback(record);
+    stream.submit_buffer(buffers[2]);
+    stream.add_presentation_callback(record);
+
+    stream.presented(buffers[1]->id(), mg::Presentation{});
+    EXPECT_THAT(shown, ElementsAre(false, true));
+
+    stream.presented(buffers[2]->id(), mg::Presentation{});
+    EXPECT_THAT(shown, ElementsAre(false, true, true));
+}
+
+TEST_F(Stream, discards_presentation_of_buffers_dropped_before_being_acquired)
+{
+    std::vector<bool> shown;
+    auto const record = [&](mg::Presentation const* p) { shown.push_back(p != nullptr); };
+
+    stream.allow_framedropping(true);
+    for (auto const& buffer : buffers)
+    {
+        stream.submit_buffer(buffer);
+        stream.add_presentation_callback(record);
+    }
+
+    // A covered or off-screen surface is acquired, but never presented
+    stream.lock_compositor_buffer(this);
+    EXPECT_THAT(shown, ElementsAre(false, false));
+
+    stream.presented(buffers.back()->id(), mg::Presentation{});
+    EXPECT_THAT(shown, ElementsAre(false, false, true));
+}
+
+TEST_F(Stream, keeps_presentation_of_acquired_buffers_until_they_are_presented)
+{
+    std::vector<bool> shown;
+    auto const record = [&](mg::Presentation const* p) { shown.push_back(p != nullptr); };
+
+    stream.submit_buffer(buffers[0]);
+    stream.add_presentation_callback(record);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1]);
+    stream.add_presentation_callback(record);
+
+    // Another compositor may still be showing the first buffer
+    stream.lock_compositor_buffer(this);
+    EXPECT_THAT(shown, IsEmpty());
+
+    stream.presented(buffers[0]->id(), mg::Presentation{});
+    EXPECT_THAT(shown, ElementsAre(true));
+
+    stream.presented(buffers[1]->id(), mg::Presentation{});
+    EXPECT_THAT(shown, ElementsAre(true, true));
+}
+
+TEST_F(Stream, bounds_presentations_waiting_on_a_surface_that_is_never_shown)
+{
+    int pending{0};
+    mc::Stream unseen{initial_size, construction_format, mr::null_compositor_report()};
+
+    for (auto i = 0u; i != 100; ++i)
+    {
+        unseen.submit_buffer(buffers[i % buffers.size()]);
+        ++pending;
+        unseen.add_presentation_callback([&](mg::Presentation const*) { --pending; });
+    }
+
+    EXPECT_THAT(pending, Lt(10));
+}
+
+TEST_F(Stream, discards_outstanding_presentations_when_destroyed)
+{
+    std::vector<bool> shown;
+    {
+        mc::Stream transient{initial_size, construction_format, mr::null_compositor_report()};
+        transient.submit_buffer(buffers[0]);
+        transient.add_presentation_callback(
+            [&](mg::Presentation const* p) { shown.push_back(p != nullptr); });
+    }
+
+    EXPECT_THAT(shown, ElementsAre(false));
+}
+
+TEST_F(Stream, counts_buffers_dropped_by_framedropping)
+{
+    stream.allow_framedropping(true);
+    for(auto& buffer : buffers)
+        stream.submit_buffer(buffer);
+
+    stream.lock_compositor_buffer(this);
+
+    auto const stats = stream.queue_stats();
+    EXPECT_THAT(stats.submitted, Eq(buffers.size()));
+    EXPECT_THAT(stats.acquired, Eq(1u));
+    EXPECT_THAT(stats.dropped, Eq(buffers.size() - 1));
+}
+
+TEST_F(Stream, counts_compositor_reusing_its_buffer)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.lock_compositor_buffer(this);
+
+    auto const stats = stream.queue_stats();
+    EXPECT_THAT(stats.acquired, Eq(1u));
+    EXPECT_THAT(stats.reacquired, Eq(1u));
+}
+
+TEST_F(Stream, counts_presentations_without_callbacks)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+
+    stream.presented(buffers[0]->id(), mg::Presentation{});
+    stream.presented(buffers[0]->id(), mg::Presentation{});
+
+    EXPECT_THAT(stream.queue_stats().presented, Eq(1u));
+}
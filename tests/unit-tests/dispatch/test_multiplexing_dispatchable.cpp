@@ -29,6 +29,7 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -490,3 +491,45 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_handles_every_ready_dispatchee)
+{
+    int const dispatchee_count{5};
+    int dispatched{0};
+
+    md::MultiplexingDispatchable dispatcher(dispatchee_count);
+    std::vector<std::shared_ptr<mt::TestDispatchable>> dispatchees;
+    for (int i = 0; i < dispatchee_count; ++i)
+    {
+        dispatchees.push_back(std::make_shared<mt::TestDispatchable>([&dispatched]() { ++dispatched; }));
+        dispatcher.add_watch(dispatchees.back());
+        dispatchees.back()->trigger();
+    }
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, testing::Eq(dispatchee_count));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_skips_dispatchee_removed_earlier_in_batch)
+{
+    md::MultiplexingDispatchable dispatcher(2);
+
+    int dispatched{0};
+    std::shared_ptr<mt::TestDispatchable> a, b;
+    a = std::make_shared<mt::TestDispatchable>([&]() { ++dispatched; dispatcher.remove_watch(b); });
+    b = std::make_shared<mt::TestDispatchable>([&]() { ++dispatched; dispatcher.remove_watch(a); });
+    dispatcher.add_watch(a);
+    dispatcher.add_watch(b);
+
+    a->trigger();
+    b->trigger();
+
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatched, testing::Eq(1));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
@@ -285,3 +285,71 @@ TEST_F(TestRectangles, remove_only_removes_one_instance)
         EXPECT_THAT(rectangles.size(), Eq(i));
     }
 }
+
+TEST_F(TestRectangles, union_of_overlapping_rectangles_does_not_overlap)
+{
+    Rectangle const left{{0, 0}, {100, 100}};
+    Rectangle const right{{50, 0}, {100, 100}};
+
+    auto const result = union_of(Rectangles{left}, Rectangles{right});
+
+    EXPECT_THAT(result, Eq(Rectangles{left, {{100, 0}, {50, 100}}}));
+}
+
+TEST_F(TestRectangles, union_of_drops_contained_and_empty_rectangles)
+{
+    Rectangle const outer{{0, 0}, {100, 100}};
+
+    auto const result = union_of(Rectangles{outer, {{10, 10}, {0, 5}}}, Rectangles{{{10, 10}, {10, 10}}});
+
+    EXPECT_THAT(result, Eq(Rectangles{outer}));
+}
+
+TEST_F(TestRectangles, intersection_of_regions)
+{
+    Rectangles const a{{{0, 0}, {100, 100}}, {{200, 0}, {100, 100}}};
+    Rectangles const b{{{50, 50}, {200, 10}}};
+
+    auto const result = intersection_of(a, b);
+
+    EXPECT_THAT(result, Eq(Rectangles{{{50, 50}, {50, 10}}, {{200, 50}, {50, 10}}}));
+}
+
+TEST_F(TestRectangles, intersection_of_disjoint_regions_is_empty)
+{
+    auto const result = intersection_of(Rectangles{{{0, 0}, {10, 10}}}, Rectangles{{{10, 0}, {10, 10}}});
+
+    EXPECT_THAT(result.size(), Eq(0u));
+}
+
+TEST_F(TestRectangles, difference_of_punches_a_hole)
+{
+    Rectangle const outer{{0, 0}, {30, 30}};
+    Rectangle const hole{{10, 10}, {10, 10}};
+
+    auto const result = difference_of(Rectangles{outer}, Rectangles{hole});
+
+    EXPECT_THAT(result, Eq(Rectangles{
+        {{0, 0}, {30, 10}},
+        {{0, 20}, {30, 10}},
+        {{0, 10}, {10, 10}},
+        {{20, 10}, {10, 10}}}));
+}
+
+TEST_F(TestRectangles, difference_of_tiled_cover_is_empty)
+{
+    Rectangle const window{{0, 0}, {200, 100}};
+    Rectangles const tiles{{{0, 0}, {100, 100}}, {{100, 0}, {100, 100}}};
+
+    EXPECT_THAT(difference_of(Rectangles{window}, tiles).size(), Eq(0u));
+}
+
+TEST_F(TestRectangles, difference_of_overlapping_rectangles_does_not_overlap)
+{
+    Rectangles const a{{{0, 0}, {20, 20}}, {{10, 0}, {20, 20}}};
+    Rectangles const b{{{0, 0}, {5, 20}}};
+
+    auto const result = difference_of(a, b);
+
+    EXPECT_THAT(result, Eq(Rectangles{{{5, 0}, {15, 20}}, {{20, 0}, {10, 20}}}));
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/dmabuf_import.h"
+#include "mir/graphics/egl_extensions.h"
+
+#include "mir/test/doubles/mock_gl.h"
+#include "mir/test/doubles/mock_egl.h"
+#include "mir/test/doubles/mock_display_report.h"
+#include "mir/test/doubles/null_gl_context.h"
+#include "mir/test/doubles/explicit_executor.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <GLES2/gl2ext.h>
+#include <drm_fourcc.h>
+
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+using namespace testing;
+
+namespace
+{
+struct DmabufImport : Test
+{
+    DmabufImport()
+    {
+        mock_egl.provide_egl_extensions();
+        ON_CALL(mock_gl, glGenTextures(1, _))
+            .WillByDefault(SetArgPointee<1>(texture));
+    }
+
+    ~DmabufImport()
+    {
+        // Textures are deleted on the Wayland thread
+        wayland_executor->execute();
+    }
+
+    auto import() -> std::shared_ptr<mg::DmabufImport>
+    {
+        return mg::DmabufImport::import(dpy, extensions, report, fourcc, attributes);
+    }
+
+    NiceMock<mtd::MockEGL> mock_egl;
+    NiceMock<mtd::MockGL> mock_gl;
+    std::shared_ptr<NiceMock<mtd::MockDisplayReport>> const report{
+        std::make_shared<NiceMock<mtd::MockDisplayReport>>()};
+    std::shared_ptr<mg::EGLExtensions> const extensions{std::make_shared<mg::EGLExtensions>()};
+    std::shared_ptr<mir::renderer::gl::Context> const ctx{std::make_shared<mtd::NullGLContext>()};
+    std::shared_ptr<mtd::ExplicitExectutor> const wayland_executor{std::make_shared<mtd::ExplicitExectutor>()};
+
+    EGLDisplay const dpy{mock_egl.fake_egl_display};
+    uint32_t const fourcc{DRM_FORMAT_ARGB8888};
+    EGLint const attributes[1]{EGL_NONE};
+    GLuint const texture{42};
+};
+}
+
+TEST_F(DmabufImport, imports_once_for_every_submission)
+{
+    EXPECT_CALL(mock_egl, eglCreateImageKHR(dpy, EGL_NO_CONTEXT, EGL_LINUX_DMA_BUF_EXT, _, _)).Times(1);
+    EXPECT_CALL(*report, report_dmabuf_import(fourcc, _)).Times(1);
+    EXPECT_CALL(*report, report_dmabuf_import_reused(fourcc)).Times(2);
+
+    auto const imported = import();
+    ASSERT_THAT(imported, NotNull());
+
+    mg::DmabufSubmission first{imported};
+    mg::DmabufSubmission second{imported};
+    mg::DmabufSubmission third{imported};
+}
+
+TEST_F(DmabufImport, failed_import_is_not_reported)
+{
+    ON_CALL(mock_egl, eglCreateImageKHR(_, _, _, _, _))
+        .WillByDefault(Return(EGL_NO_IMAGE_KHR));
+
+    EXPECT_CALL(*report, report_dmabuf_import(_, _)).Times(0);
+
+    EXPECT_THAT(import(), IsNull());
+}
+
+TEST_F(DmabufImport, submissions_share_one_texture)
+{
+    EXPECT_CALL(mock_gl, glGenTextures(1, _)).Times(1);
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, texture)).Times(2);
+
+    auto const imported = import();
+
+    mg::DmabufSubmission{imported}.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+    mg::DmabufSubmission{imported}.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+}
+
+TEST_F(DmabufImport, releases_image_and_texture_with_the_last_user)
+{
+    auto imported = import();
+
+    EXPECT_CALL(mock_egl, eglDestroyImageKHR(dpy, mock_egl.fake_egl_image)).Times(0);
+    {
+        mg::DmabufSubmission submission{imported};
+        submission.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+
+        // The submission still holds the import
+        imported.reset();
+        Mock::VerifyAndClearExpectations(&mock_egl);
+
+        EXPECT_CALL(mock_egl, eglDestroyImageKHR(dpy, mock_egl.fake_egl_image)).Times(1);
+        EXPECT_CALL(mock_gl, glDeleteTextures(1, Pointee(texture))).Times(1);
+    }
+    wayland_executor->execute();
+}
+
+TEST_F(DmabufImport, relatches_only_on_first_bind_of_each_submission)
+{
+    auto const imported = import();
+    mg::DmabufSubmission first{imported};
+    mg::DmabufSubmission second{imported};
+
+    EXPECT_CALL(mock_egl, glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, mock_egl.fake_egl_image)).Times(1);
+    first.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+    first.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+    Mock::VerifyAndClearExpectations(&mock_egl);
+
+    EXPECT_CALL(mock_egl, glEGLImageTargetTexture2DOES(GL_TEXTURE_2D, mock_egl.fake_egl_image)).Times(1);
+    second.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+    second.bind(GL_TEXTURE_2D, ctx, wayland_executor);
+}
+
+TEST_F(DmabufImport, external_textures_are_latched_only_when_created)
+{
+    EXPECT_CALL(mock_egl, glEGLImageTargetTexture2DOES(GL_TEXTURE_EXTERNAL_OES, _)).Times(1);
+
+    auto const imported = import();
+    mg::DmabufSubmission first{imported};
+    mg::DmabufSubmission second{imported};
+
+    first.bind(GL_TEXTURE_EXTERNAL_OES, ctx, wayland_executor);
+    first.bind(GL_TEXTURE_EXTERNAL_OES, ctx, wayland_executor);
+    second.bind(GL_TEXTURE_EXTERNAL_OES, ctx, wayland_executor);
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/graphics/pixel_ops.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace mgp = mir::graphics::pixel_ops;
+
+using namespace testing;
+
+namespace
+{
+// Odd sizes, so both the vector loops and their scalar tails (and partial rotation tiles) are used
+unsigned const width = 37;
+unsigned const height = 45;
+
+auto numbered_pixels(size_t count) -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> pixels(count);
+    for (size_t i = 0; i != count; ++i)
+        pixels[i] = static_cast<uint32_t>(i * 0x9E3779B1u);
+    return pixels;
+}
+
+auto div255(uint32_t x) -> uint32_t
+{
+    return (x + 127) / 255;
+}
+}
+
+TEST(PixelOps, rotating_normal_copies_rows_within_strides)
+{
+    unsigned const src_pitch = width + 3, dest_pitch = width + 5;
+    auto const src = numbered_pixels(src_pitch * height);
+    std::vector<uint32_t> dest(dest_pitch * height, 0xDEADBEEF);
+
+    mgp::rotate(mir_orientation_normal, src.data(), src_pitch * 4, width, height, dest.data(), dest_pitch * 4);
+
+    for (unsigned y = 0; y != height; ++y)
+    {
+        for (unsigned x = 0; x != width; ++x)
+            ASSERT_THAT(dest[y * dest_pitch + x], Eq(src[y * src_pitch + x]));
+        EXPECT_THAT(dest[y * dest_pitch + width], Eq(0xDEADBEEF));
+    }
+}
+
+TEST(PixelOps, rotating_inverted_turns_image_upside_down)
+{
+    auto const src = numbered_pixels(width * height);
+    std::vector<uint32_t> dest(width * height);
+
+    mgp::rotate(mir_orientation_inverted, src.data(), width * 4, width, height, dest.data(), width * 4);
+
+    for (unsigned y = 0; y != height; ++y)
+        for (unsigned x = 0; x != width; ++x)
+            ASSERT_THAT(dest[y * width + x], Eq(src[((height - 1) - y) * width + (width - 1) - x]));
+}
+
+TEST(PixelOps, rotating_left_turns_image_anticlockwise)
+{
+    unsigned const src_pitch = width + 3, dest_pitch = height + 5;
+    auto const src = numbered_pixels(src_pitch * height);
+    std::vector<uint32_t> dest(dest_pitch * width);
+
+    mgp::rotate(mir_orientation_left, src.data(), src_pitch * 4, width, height, dest.data(), dest_pitch * 4);
+
+    // The top right of the source ends up at the top left
+    for (unsigned row = 0; row != width; ++row)
+        for (unsigned col = 0; col != height; ++col)
+            ASSERT_THAT(dest[row * dest_pitch + col], Eq(src[col * src_pitch + (width - 1) - row]));
+}
+
+TEST(PixelOps, rotating_right_turns_image_clockwise)
+{
+    unsigned const src_pitch = width + 3, dest_pitch = height + 5;
+    auto const src = numbered_pixels(src_pitch * height);
+    std::vector<uint32_t> dest(dest_pitch * width);
+
+    mgp::rotate(mir_orientation_right, src.data(), src_pitch * 4, width, height, dest.data(), dest_pitch * 4);
+
+    // The bottom left of the source ends up at the top left
+    for (unsigned row = 0; row != width; ++row)
+        for (unsigned col = 0; col != height; ++col)
+            ASSERT_THAT(dest[row * dest_pitch + col], Eq(src[((height - 1) - col) * src_pitch + row]));
+}
+
+TEST(PixelOps, flips_rows_in_place)
+{
+    auto const original = numbered_pixels(width * height);
+    auto pixels = original;
+
+    mgp::flip_vertically(pixels.data(), width * 4, height);
+
+    for (unsigned y = 0; y != height; ++y)
+        for (unsigned x = 0; x != width; ++x)
+            ASSERT_THAT(pixels[y * width + x], Eq(original[((height - 1) - y) * width + x]));
+}
+
+TEST(PixelOps, swaps_red_and_blue_in_place)
+{
+    auto pixels = numbered_pixels(width);
+    auto const original = pixels;
+
+    mgp::swap_red_and_blue(pixels.data(), pixels.data(), pixels.size());
+
+    for (size_t i = 0; i != pixels.size(); ++i)
+    {
+        auto const p = original[i];
+        ASSERT_THAT(pixels[i], Eq((p & 0xFF00FF00) | ((p & 0xFF) << 16) | ((p >> 16) & 0xFF))) << "at " << i;
+    }
+}
+
+TEST(PixelOps, expands_rgb_565_to_opaque_argb_8888)
+{
+    std::vector<uint16_t> const pixels{0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x8410, 0x1234,
+                                       0x0000, 0xFFFF, 0xF800, 0x07E0, 0x001F, 0x8410, 0x1234};
+    std::vector<uint32_t> expanded(pixels.size());
+
+    mgp::expand_rgb_565(pixels.data(), expanded.data(), pixels.size());
+
+    EXPECT_THAT(expanded, ElementsAre(
+        0xFF000000, 0xFFFFFFFF, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFF848284, 0xFF1045A5,
+        0xFF000000, 0xFFFFFFFF, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFF848284, 0xFF1045A5));
+}
+
+TEST(PixelOps, expands_rgba_4444_to_argb_8888)
+{
+    std::vector<uint16_t> const pixels{0x0000, 0xFFFF, 0xF00F, 0x0F0F, 0x00FF, 0x1234, 0x8880,
+                                       0x0000, 0xFFFF, 0xF00F, 0x0F0F, 0x00FF, 0x1234, 0x8880};
+    std::vector<uint32_t> expanded(pixels.size());
+
+    mgp::expand_rgba_4444(pixels.data(), expanded.data(), pixels.size());
+
+    EXPECT_THAT(expanded, ElementsAre(
+        0x00000000, 0xFFFFFFFF, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0x44112233, 0x00888888,
+        0x00000000, 0xFFFFFFFF, 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0x44112233, 0x00888888));
+}
+
+TEST(PixelOps, premultiplies_colour_by_alpha)
+{
+    auto const original = numbered_pixels(width);
+    std::vector<uint32_t> premultiplied(original.size());
+
+    mgp::premultiply_alpha(original.data(), premultiplied.data(), original.size());
+
+    for (size_t i = 0; i != original.size(); ++i)
+    {
+        auto const p = original[i];
+        auto const a = p >> 24;
+        ASSERT_THAT(premultiplied[i], Eq(
+            (p & 0xFF000000) |
+            div255(((p >> 16) & 0xFF) * a) << 16 |
+            div255(((p >> 8) & 0xFF) * a) << 8 |
+            div255((p & 0xFF) * a))) << "at " << i;
+    }
+}
+
+TEST(PixelOps, blends_colour_by_coverage_keeping_alpha)
+{
+    auto pixels = numbered_pixels(width);
+    auto const original = pixels;
+    std::vector<unsigned char> coverage(width);
+    for (unsigned i = 0; i != width; ++i)
+        coverage[i] = static_cast<unsigned char>(i * 7);
+    uint32_t const color = 0xC0204080;
+
+    mgp::blend_coverage(pixels.data(), coverage.data(), pixels.size(), color);
+
+    for (size_t i = 0; i != pixels.size(); ++i)
+    {
+        auto const p = original[i];
+        auto const alpha = div255(coverage[i] * (color >> 24));
+        auto const channel = [&](int shift)
+            {
+                return div255(((p >> shift) & 0xFF) * (255 - alpha) + ((color >> shift) & 0xFF) * alpha) << shift;
+            };
+        ASSERT_THAT(pixels[i], Eq((p & 0xFF000000) | channel(16) | channel(8) | channel(0))) << "at " << i;
+    }
+}
+
+TEST(PixelOps, full_coverage_of_opaque_colour_replaces_colour)
+{
+    std::vector<uint32_t> pixels(width, 0x80123456);
+    std::vector<unsigned char> const coverage(width, 0xFF);
+
+    mgp::blend_coverage(pixels.data(), coverage.data(), pixels.size(), 0xFFABCDEF);
+
+    EXPECT_THAT(pixels, Each(Eq(0x80ABCDEFu)));
+}
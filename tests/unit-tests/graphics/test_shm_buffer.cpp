@@ -18,6 +18,7 @@
 
 #include "src/platforms/common/server/shm_buffer.h"
 #include "src/platforms/common/server/egl_context_executor.h"
+#include "src/platforms/common/server/shm_texture.h"
 #include "mir/renderer/gl/context.h"
 
 #include "mir/test/doubles/mock_gl.h"
@@ -362,3 +363,185 @@ TEST_F(ShmBufferTest, texture_is_destroyed_on_thread_with_current_context)
         eglMakeCurrent(dummy_dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
     }
 }
+
+namespace
+{
+struct ShmTextureTest : public testing::Test
+{
+    ShmTextureTest()
+    {
+        ON_CALL(mock_gl, glGenTextures(1, _))
+            .WillByDefault(SetArgPointee<1>(tex_id));
+        ON_CALL(mock_egl, eglQueryContext(_, _, _, _))
+            .WillByDefault(Return(EGL_TRUE));
+        make_current(ctx);
+    }
+
+    ~ShmTextureTest()
+    {
+        make_current(EGL_NO_CONTEXT);
+    }
+
+    void make_current(EGLContext context)
+    {
+        eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+    }
+
+    auto bind(uint64_t seq, geom::Size const& size, MirPixelFormat format) -> bool
+    {
+        return texture.bind(
+            seq,
+            size,
+            format,
+            geom::Stride{size.width.as_int() * MIR_BYTES_PER_PIXEL(format)},
+            [this](auto const& do_with_pixels) { do_with_pixels(pixels.data()); });
+    }
+
+    testing::NiceMock<mtd::MockEGL> mock_egl;
+    testing::NiceMock<mtd::MockGL> mock_gl;
+
+    EGLDisplay const dpy{reinterpret_cast<EGLDisplay>(0xaabbccdd)};
+    EGLContext const ctx{reinterpret_cast<EGLContext>(0x66221144)};
+    GLuint const tex_id{0x8086};
+
+    geom::Size const size{64, 32};
+    MirPixelFormat const format{mir_pixel_format_abgr_8888};
+    std::vector<unsigned char> const pixels = std::vector<unsigned char>(128 * 64 * 4);
+
+    std::shared_ptr<mgc::EGLContextExecutor> const egl_delegate{
+        std::make_shared<mgc::EGLContextExecutor>(
+            std::make_unique<DumbGLContext>(reinterpret_cast<EGLContext>(42)))};
+    mgc::ShmTexture texture{egl_delegate};
+};
+}
+
+TEST_F(ShmTextureTest, uploads_only_the_damage_since_the_last_bind)
+{
+    auto const first = texture.submit({});
+    bind(first, size, format);
+
+    geom::Rectangle const damage{{8, 4}, {10, 6}};
+    auto const second = texture.submit(geom::Rectangles{damage});
+
+    auto const row_bytes = size.width.as_int() * 4;
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(
+        GL_TEXTURE_2D, 0,
+        8, 4, 10, 6,
+        GL_RGBA, GL_UNSIGNED_BYTE,
+        pixels.data() + 4 * row_bytes + 8 * 4));
+
+    EXPECT_TRUE(bind(second, size, format));
+}
+
+TEST_F(ShmTextureTest, rebinding_the_same_buffer_uploads_nothing)
+{
+    auto const seq = texture.submit({});
+    bind(seq, size, format);
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, tex_id));
+
+    EXPECT_TRUE(bind(seq, size, format));
+}
+
+TEST_F(ShmTextureTest, reallocates_on_size_change)
+{
+    bind(texture.submit({}), size, format);
+
+    geom::Size const new_size{128, 64};
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexImage2D(
+        GL_TEXTURE_2D, 0, _,
+        new_size.width.as_int(), new_size.height.as_int(),
+        0, _, _, pixels.data()));
+
+    bind(texture.submit(geom::Rectangles{{{0, 0}, {1, 1}}}), new_size, format);
+}
+
+TEST_F(ShmTextureTest, reallocates_on_format_change)
+{
+    bind(texture.submit({}), size, format);
+
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexImage2D(
+        GL_TEXTURE_2D, 0, GL_RGB,
+        size.width.as_int(), size.height.as_int(),
+        0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, pixels.data()));
+
+    bind(texture.submit(geom::Rectangles{{{0, 0}, {1, 1}}}), size, mir_pixel_format_rgb_565);
+}
+
+TEST_F(ShmTextureTest, refuses_to_bind_a_buffer_older_than_the_texture)
+{
+    auto const older = texture.submit({});
+    auto const newer = texture.submit({});
+    bind(newer, size, format);
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexSubImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+
+    // The caller falls back to a private texture
+    EXPECT_FALSE(bind(older, size, format));
+}
+
+TEST_F(ShmTextureTest, each_context_gets_its_own_texture)
+{
+    EGLContext const other_ctx{reinterpret_cast<EGLContext>(0x11335577)};
+    GLuint const other_tex_id{0x8087};
+
+    auto const first = texture.submit({});
+    bind(first, size, format);
+    auto const second = texture.submit(geom::Rectangles{{{0, 0}, {1, 1}}});
+    bind(second, size, format);
+
+    // A context that has never seen the stream needs a texture and a full upload...
+    make_current(other_ctx);
+    EXPECT_CALL(mock_gl, glGenTextures(1, _))
+        .WillOnce(SetArgPointee<1>(other_tex_id));
+    EXPECT_CALL(mock_gl, glTexImage2D(
+        GL_TEXTURE_2D, 0, _,
+        size.width.as_int(), size.height.as_int(),
+        0, _, _, pixels.data()));
+    EXPECT_TRUE(bind(second, size, format));
+    Mock::VerifyAndClearExpectations(&mock_gl);
+
+    // ...and doesn't disturb the first context's texture
+    make_current(ctx);
+    EXPECT_CALL(mock_gl, glGenTextures(_, _)).Times(0);
+    EXPECT_CALL(mock_gl, glTexImage2D(_, _, _, _, _, _, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glBindTexture(GL_TEXTURE_2D, tex_id));
+    EXPECT_TRUE(bind(second, size, format));
+}
+
+TEST_F(ShmTextureTest, texture_of_a_destroyed_context_is_deleted_when_another_context_binds)
+{
+    EGLContext const other_ctx{reinterpret_cast<EGLContext>(0x11335577)};
+    GLuint const other_tex_id{0x8087};
+
+    bind(texture.submit({}), size, format);
+
+    ON_CALL(mock_egl, eglQueryContext(_, ctx, _, _))
+        .WillByDefault(Return(EGL_FALSE));
+    make_current(other_ctx);
+    EXPECT_CALL(mock_gl, glGenTextures(1, _))
+        .WillOnce(SetArgPointee<1>(other_tex_id));
+    EXPECT_CALL(mock_gl, glDeleteTextures(1, Pointee(tex_id)));
+
+    EXPECT_TRUE(bind(texture.submit({}), size, format));
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
+
+TEST_F(ShmTextureTest, textures_of_live_contexts_are_kept)
+{
+    EGLContext const other_ctx{reinterpret_cast<EGLContext>(0x11335577)};
+
+    bind(texture.submit({}), size, format);
+
+    make_current(other_ctx);
+    EXPECT_CALL(mock_gl, glDeleteTextures(_, _)).Times(0);
+
+    EXPECT_TRUE(bind(texture.submit({}), size, format));
+    Mock::VerifyAndClearExpectations(&mock_gl);
+}
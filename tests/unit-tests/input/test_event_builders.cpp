@@ -283,3 +283,46 @@ TEST_F(InputEventBuilder, when_deserialized_input_device_state_event_has_supplie
         EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 2, i), Eq(pressed_keys[i]));
     }
 }
+
+TEST_F(InputEventBuilder, when_deserialized_pointer_event_has_supplied_properties)
+{
+    auto const action = mir_pointer_action_motion;
+    auto const buttons = mir_pointer_button_primary;
+    float const x = 12.5f, y = 7.0f, hscroll = 1.0f, vscroll = -2.0f, dx = 3.5f, dy = -4.5f;
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers, action, buttons,
+                              x, y, hscroll, vscroll, dx, dy);
+
+    auto deserialized_event = MirEvent::deserialize(MirEvent::serialize(ev.get()));
+
+    ASSERT_THAT(mir_event_get_type(deserialized_event.get()), Eq(mir_event_type_input));
+    auto ie = mir_event_get_input_event(deserialized_event.get());
+    ASSERT_THAT(mir_input_event_get_type(ie), Eq(mir_input_event_type_pointer));
+    auto pev = mir_input_event_get_pointer_event(ie);
+
+    EXPECT_THAT(mir_input_event_get_device_id(ie), Eq(device_id));
+    EXPECT_THAT(mir_input_event_get_event_time(ie), Eq(timestamp.count()));
+    EXPECT_THAT(mir_pointer_event_modifiers(pev), Eq(modifiers));
+    EXPECT_THAT(mir_pointer_event_action(pev), Eq(action));
+    EXPECT_THAT(mir_pointer_event_buttons(pev), Eq(buttons));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_x), Eq(x));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_y), Eq(y));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_hscroll), Eq(hscroll));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_vscroll), Eq(vscroll));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_relative_x), Eq(dx));
+    EXPECT_THAT(mir_pointer_event_axis_value(pev, mir_pointer_axis_relative_y), Eq(dy));
+}
+
+TEST_F(InputEventBuilder, cloned_touch_event_is_independent_of_original)
+{
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers);
+    mev::add_touch(*ev, 0, mir_touch_action_down, mir_touch_tooltype_finger, 1.0f, 2.0f, 0.5f, 4.0f, 3.0f, 0.0f);
+
+    auto clone = mev::clone_event(*ev);
+    mev::transform_positions(*ev, {10, 20});
+
+    auto tev = mir_input_event_get_touch_event(mir_event_get_input_event(clone.get()));
+    ASSERT_THAT(mir_touch_event_point_count(tev), Eq(1u));
+    EXPECT_THAT(mir_touch_event_axis_value(tev, 0, mir_touch_axis_x), Eq(1.0f));
+    EXPECT_THAT(mir_touch_event_axis_value(tev, 0, mir_touch_axis_y), Eq(2.0f));
+    EXPECT_THAT(mir_touch_event_action(tev, 0), Eq(mir_touch_action_down));
+}
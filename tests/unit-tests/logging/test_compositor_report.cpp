@@ -189,3 +189,25 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, reports_distribution_of_presentation_latency)
+{
+    const void* const id = "My Screen";
+
+    report.started();
+
+    for (int f = 0; f < 3; ++f)
+    {
+        for (int latency_ms = 1; latency_ms <= 100; ++latency_ms)
+            report.presented_frame(id, chrono::milliseconds(latency_ms));
+
+        report.began_frame(id);
+        report.rendered_frame(id);
+        report.finished_frame(id);
+        clock->advance_by(chrono::microseconds(12345678));
+    }
+    EXPECT_TRUE(recorder->last_message_contains("presented in 50.000/90.000/99.000 ms"))
+        << recorder->last_message();
+
+    report.stopped();
+}
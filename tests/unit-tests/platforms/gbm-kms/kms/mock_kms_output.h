@@ -59,8 +59,14 @@ struct MockKMSOutput : public graphics::gbm::KMSOutput
     MOCK_METHOD1(schedule_page_flip_thunk, bool(graphics::gbm::FBHandle const*));
     MOCK_METHOD0(wait_for_page_flip, void());
 
+    MOCK_METHOD2(add_page_flip, bool(graphics::gbm::AtomicRequest&, graphics::gbm::FBHandle const&));
+    MOCK_METHOD1(schedule_atomic_flip, bool(graphics::gbm::AtomicRequest&));
+
     MOCK_CONST_METHOD0(last_frame, graphics::Frame());
 
+    MOCK_METHOD1(can_show_overlays, bool(std::vector<graphics::gbm::OverlayLayer> const&));
+    MOCK_METHOD1(set_overlays, void(std::vector<graphics::gbm::OverlayLayer> const&));
+
     MOCK_METHOD1(set_cursor, bool(gbm_bo*));
     MOCK_METHOD1(move_cursor, void(geometry::Point));
     MOCK_METHOD0(clear_cursor, bool());
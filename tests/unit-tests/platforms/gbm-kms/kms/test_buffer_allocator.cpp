@@ -91,7 +91,8 @@ protected:
             *display,
             platform->gbm->device,
             mgg::BypassOption::allowed,
-            mgg::BufferImportMethod::gbm_native_pixmap));
+            mgg::BufferImportMethod::gbm_native_pixmap,
+            mir::report::null_display_report()));
     }
 
     // Defaults
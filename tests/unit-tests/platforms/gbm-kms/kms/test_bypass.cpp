@@ -84,6 +84,19 @@ TEST_F(BypassMatchTest, shaped_fullscreen_window_not_bypassed)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
 }
 
+TEST_F(BypassMatchTest, shaped_fullscreen_window_declared_opaque_bypassed)
+{
+    mgg::BypassMatch matcher(primary_monitor);
+
+    auto const window = std::make_shared<mtd::FakeRenderable>(primary_monitor, 1.0f, false);
+    window->set_opaque_region({primary_monitor});
+    mg::RenderableList list{window};
+
+    auto it = std::find_if(list.rbegin(), list.rend(), matcher);
+    EXPECT_NE(list.rend(), it);
+    EXPECT_EQ(window, *it);
+}
+
 TEST_F(BypassMatchTest, offset_fullscreen_window_not_bypassed)
 {
     mgg::BypassMatch matcher(primary_monitor);
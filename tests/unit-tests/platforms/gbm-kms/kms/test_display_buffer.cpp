@@ -20,6 +20,7 @@
 #include "mir/test/doubles/null_console_services.h"
 #include "src/platforms/gbm-kms/server/kms/platform.h"
 #include "src/platforms/gbm-kms/server/kms/display_buffer.h"
+#include "src/platforms/gbm-kms/server/kms/atomic_request.h"
 #include "src/platforms/gbm-kms/include/native_buffer.h"
 #include "mir/graphics/dmabuf_buffer.h"
 #include "src/server/report/null_report_factory.h"
@@ -421,6 +422,64 @@ TEST_F(MesaDisplayBufferTest, clone_mode_first_flip_flips_but_no_wait)
     db.post();
 }
 
+TEST_F(MesaDisplayBufferTest, clone_mode_flips_all_outputs_in_one_atomic_commit)
+{
+    auto const other_kms_output = std::make_shared<NiceMock<MockKMSOutput>>();
+    ON_CALL(*other_kms_output, set_crtc_thunk(_))
+        .WillByDefault(Return(true));
+
+    EXPECT_CALL(*mock_kms_output, add_page_flip(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*other_kms_output, add_page_flip(_, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_atomic_flip(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+    EXPECT_CALL(*other_kms_output, schedule_page_flip_thunk(_))
+        .Times(0);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, other_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, clone_mode_flips_outputs_separately_if_any_is_not_atomic)
+{
+    auto const other_kms_output = std::make_shared<NiceMock<MockKMSOutput>>();
+    ON_CALL(*other_kms_output, set_crtc_thunk(_))
+        .WillByDefault(Return(true));
+
+    ON_CALL(*mock_kms_output, add_page_flip(_, _))
+        .WillByDefault(Return(true));
+    ON_CALL(*other_kms_output, add_page_flip(_, _))
+        .WillByDefault(Return(false));
+    EXPECT_CALL(*mock_kms_output, schedule_atomic_flip(_))
+        .Times(0);
+    EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*other_kms_output, schedule_page_flip_thunk(_))
+        .WillOnce(Return(true));
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output, other_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    db.swap_buffers();
+    db.post();
+}
+
 TEST_F(MesaDisplayBufferTest, single_mode_first_post_flips_with_wait)
 {
     EXPECT_CALL(*mock_kms_output, schedule_page_flip_thunk(_))
@@ -512,3 +571,69 @@ TEST_F(MesaDisplayBufferTest, skips_bypass_because_of_incompatible_bypass_buffer
 
     EXPECT_FALSE(db.overlay(list));
 }
+
+TEST_F(MesaDisplayBufferTest, puts_dmabuf_renderable_above_composited_ones_on_overlay_plane)
+{
+    geometry::Rectangle const overlay_area{{20, 40}, {10, 10}};
+    auto const overlay_renderable = std::make_shared<FakeRenderable>(overlay_area);
+    overlay_renderable->set_buffer(mock_bypassable_buffer);
+
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_CALL(*mock_kms_output, can_show_overlays(
+        ElementsAre(Field(&OverlayLayer::destination, Eq(geometry::Rectangle{{8, 6}, {10, 10}})))))
+        .WillOnce(Return(true));
+
+    RenderableList const list{fake_software_renderable, overlay_renderable};
+    EXPECT_THAT(db.assign_planes(list), ElementsAre(fake_software_renderable));
+
+    EXPECT_CALL(*mock_kms_output, set_overlays(SizeIs(1)));
+
+    db.make_current();
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, composites_renderables_the_overlay_planes_cannot_show)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    ON_CALL(*mock_kms_output, can_show_overlays(_))
+        .WillByDefault(Return(false));
+    EXPECT_CALL(*mock_kms_output, set_overlays(_)).Times(0);
+
+    RenderableList const list{fake_software_renderable, fake_bypassable_renderable};
+    EXPECT_THAT(db.assign_planes(list), ElementsAreArray(list));
+
+    db.make_current();
+    db.swap_buffers();
+    db.post();
+}
+
+TEST_F(MesaDisplayBufferTest, renderables_beneath_composited_ones_are_not_put_on_overlay_planes)
+{
+    graphics::gbm::DisplayBuffer db(
+        graphics::gbm::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_CALL(*mock_kms_output, can_show_overlays(_)).Times(0);
+
+    RenderableList const list{fake_bypassable_renderable, fake_software_renderable};
+    EXPECT_THAT(db.assign_planes(list), ElementsAreArray(list));
+}
@@ -17,6 +17,7 @@
  */
 
 #include "src/platforms/gbm-kms/server/kms/kms_page_flipper.h"
+#include "src/platforms/gbm-kms/server/kms/atomic_request.h"
 
 #include "mir/test/doubles/mock_drm.h"
 #include "mir/test/doubles/mock_display_report.h"
@@ -69,6 +70,15 @@ ACTION_P(InvokePageFlipHandler, param)
     ASSERT_EQ(1, read(arg0, &dummy, 1));
 }
 
+ACTION_P2(InvokePageFlipHandler2, param, crtc_id)
+{
+    int const dont_care{0};
+    char dummy;
+
+    arg1->page_flip_handler2(dont_care, dont_care, dont_care, dont_care, crtc_id, *param);
+    ASSERT_EQ(1, read(arg0, &dummy, 1));
+}
+
 }
 
 TEST_F(KMSPageFlipperTest, schedule_flip_calls_drm_page_flip)
@@ -149,6 +159,60 @@ TEST_F(KMSPageFlipperTest, wait_for_flip_reports_vsync)
     page_flipper.wait_for_flip(crtc_id);
 }
 
+TEST_F(KMSPageFlipperTest, atomic_flip_of_several_crtcs_needs_crtc_in_flip_events)
+{
+    using namespace testing;
+
+    mgg::AtomicRequest request;
+    request.add_flip(10, 30);
+    request.add_flip(11, 31);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _))
+        .Times(0);
+
+    EXPECT_FALSE(page_flipper.schedule_atomic_flip(request));
+    page_flipper.wait_for_flip(10);
+    page_flipper.wait_for_flip(11);
+}
+
+TEST_F(KMSPageFlipperTest, atomic_flip_of_several_crtcs_completes_each_from_its_own_event)
+{
+    using namespace testing;
+
+    uint32_t const crtc_ids[] = {10, 11};
+    uint32_t const connector_ids[] = {30, 31};
+    void* user_data{nullptr};
+    bool committed{false};
+
+    ON_CALL(mock_drm, drmGetCap(drm_fd, DRM_CAP_CRTC_IN_VBLANK_EVENT, _))
+        .WillByDefault(DoAll(SetArgPointee<2>(1), Return(0)));
+    mgg::KMSPageFlipper page_flipper{drm_fd, mt::fake_shared(report)};
+
+    mgg::AtomicRequest request;
+    request.add_flip(crtc_ids[0], connector_ids[0]);
+    request.add_flip(crtc_ids[1], connector_ids[1]);
+    request.on_commit([&committed] { committed = true; });
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(
+        drm_fd, request.get(), DRM_MODE_PAGE_FLIP_EVENT | DRM_MODE_ATOMIC_NONBLOCK, _))
+        .WillOnce(DoAll(SaveArg<3>(&user_data), Return(0)));
+
+    EXPECT_CALL(mock_drm, drmHandleEvent(drm_fd, _))
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, crtc_ids[1]), Return(0)))
+        .WillOnce(DoAll(InvokePageFlipHandler2(&user_data, crtc_ids[0]), Return(0)));
+    EXPECT_CALL(report, report_vsync(connector_ids[0], _));
+    EXPECT_CALL(report, report_vsync(connector_ids[1], _));
+
+    EXPECT_TRUE(page_flipper.schedule_atomic_flip(request));
+    EXPECT_TRUE(committed);
+
+    mock_drm.generate_event_on(drm_device);
+    mock_drm.generate_event_on(drm_device);
+
+    page_flipper.wait_for_flip(crtc_ids[0]);
+    page_flipper.wait_for_flip(crtc_ids[1]);
+}
+
 TEST_F(KMSPageFlipperTest, wait_for_non_scheduled_page_flip_doesnt_block)
 {
     using namespace testing;
@@ -18,6 +18,7 @@
 
 #include "src/platforms/gbm-kms/server/kms/real_kms_output.h"
 #include "src/platforms/gbm-kms/server/kms/page_flipper.h"
+#include "src/platforms/gbm-kms/server/kms/atomic_request.h"
 #include "mir/fatal.h"
 
 #include "mir/test/fake_shared.h"
@@ -30,6 +31,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <fcntl.h>
+#include <drm_fourcc.h>
 
 namespace mg = mir::graphics;
 namespace mgg = mir::graphics::gbm;
@@ -46,6 +48,11 @@ class NullPageFlipper : public mgg::PageFlipper
 {
 public:
     bool schedule_flip(uint32_t,uint32_t,uint32_t) override { return true; }
+    bool schedule_atomic_flip(mgg::AtomicRequest& request) override
+    {
+        request.committed();
+        return true;
+    }
     mg::Frame wait_for_flip(uint32_t) override { return {}; }
 };
 
@@ -53,9 +60,23 @@ class MockPageFlipper : public mgg::PageFlipper
 {
 public:
     MOCK_METHOD3(schedule_flip, bool(uint32_t,uint32_t,uint32_t));
+    MOCK_METHOD1(schedule_atomic_flip, bool(mgg::AtomicRequest&));
     MOCK_METHOD1(wait_for_flip, mg::Frame(uint32_t));
 };
 
+MATCHER_P2(FlipsCrtc, crtc_id, connector_id, "")
+{
+    return arg.flips().size() == 1 &&
+           arg.flips().front().crtc_id == crtc_id &&
+           arg.flips().front().connector_id == connector_id;
+}
+
+ACTION(CommitRequest)
+{
+    arg0.committed();
+    return true;
+}
+
 class RealKMSOutputTest : public ::testing::Test
 {
 public:
@@ -148,6 +169,38 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    void setup_planes(std::vector<uint32_t> const& overlay_formats)
+    {
+        uint32_t const possible_crtcs_mask{0x1};
+
+        mock_drm.reset(drm_device);
+
+        mock_drm.add_crtc(
+            drm_device,
+            crtc_ids[0],
+            drmModeModeInfo());
+        mock_drm.add_encoder(
+            drm_device,
+            encoder_ids[0],
+            crtc_ids[0],
+            possible_crtcs_mask);
+        mock_drm.add_connector(
+            drm_device,
+            connector_ids[0],
+            DRM_MODE_CONNECTOR_VGA,
+            DRM_MODE_CONNECTED,
+            encoder_ids[0],
+            modes,
+            possible_encoder_ids1,
+            geom::Size());
+        mock_drm.add_plane(
+            drm_device, primary_plane_id, DRM_PLANE_TYPE_PRIMARY, possible_crtcs_mask, {DRM_FORMAT_XRGB8888});
+        mock_drm.add_plane(
+            drm_device, overlay_plane_id, DRM_PLANE_TYPE_OVERLAY, possible_crtcs_mask, overlay_formats);
+
+        mock_drm.prepare(drm_device);
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -162,11 +215,15 @@ public:
     MockPageFlipper mock_page_flipper;
     NullPageFlipper null_page_flipper;
     std::vector<drmModeModeInfo> modes_empty;
+    std::vector<drmModeModeInfo> modes{
+        mtd::FakeDRMResources::create_mode(1920, 1080, 138500, 2080, 1111, mtd::FakeDRMResources::PreferredMode)};
 
     char const* const drm_device = "/dev/dri/card0";
     int const drm_fd;
 
     gbm_bo* const fake_bo{reinterpret_cast<gbm_bo*>(0x123ba)};
+    uint32_t const primary_plane_id{40};
+    uint32_t const overlay_plane_id{41};
     uint32_t const invalid_id;
     std::vector<uint32_t> const crtc_ids;
     std::vector<uint32_t> const encoder_ids;
@@ -548,3 +605,245 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, can_show_overlays_tests_layer_on_overlay_plane)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_planes({DRM_FORMAT_XRGB8888, DRM_FORMAT_ARGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, overlay_plane_id, mock_drm.property_id(drm_device, overlay_plane_id, "FB_ID"), fb_id));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, overlay_plane_id, mock_drm.property_id(drm_device, overlay_plane_id, "CRTC_X"), 20));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, primary_plane_id, _, _)).Times(0);
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_TEST_ONLY, _))
+        .WillOnce(Return(0));
+
+    EXPECT_TRUE(output.can_show_overlays(
+        {{fb, DRM_FORMAT_XRGB8888, std::nullopt, {100, 100}, {{20, 30}, {100, 100}}}}));
+}
+
+TEST_F(RealKMSOutputTest, cannot_show_overlay_in_format_the_plane_does_not_support)
+{
+    using namespace testing;
+
+    setup_planes({DRM_FORMAT_NV12});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    append_fb_id(67);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _)).Times(0);
+
+    EXPECT_FALSE(output.can_show_overlays(
+        {{fb, DRM_FORMAT_XRGB8888, std::nullopt, {100, 100}, {{0, 0}, {100, 100}}}}));
+}
+
+TEST_F(RealKMSOutputTest, cannot_show_overlays_without_atomic_modesetting)
+{
+    using namespace testing;
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    ON_CALL(mock_drm, drmSetClientCap(_, DRM_CLIENT_CAP_ATOMIC, _))
+        .WillByDefault(Return(-EINVAL));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(_, _, _, _)).Times(0);
+
+    append_fb_id(67);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_FALSE(output.can_show_overlays(
+        {{fb, DRM_FORMAT_XRGB8888, std::nullopt, {100, 100}, {{0, 0}, {100, 100}}}}));
+}
+
+TEST_F(RealKMSOutputTest, page_flips_are_atomic_if_the_driver_supports_it)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, primary_plane_id, mock_drm.property_id(drm_device, primary_plane_id, "FB_ID"), fb_id));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(_, _, _)).Times(0);
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(FlipsCrtc(crtc_ids[0], connector_ids[0])))
+        .WillOnce(CommitRequest());
+
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+}
+
+TEST_F(RealKMSOutputTest, page_flips_are_legacy_without_atomic_modesetting)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+    ON_CALL(mock_drm, drmSetClientCap(_, DRM_CLIENT_CAP_ATOMIC, _))
+        .WillByDefault(Return(-EINVAL));
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, _, _, _, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], fb_id, _, _, Pointee(connector_ids[0]), _, _));
+    EXPECT_CALL(mock_page_flipper, schedule_flip(crtc_ids[0], fb_id, connector_ids[0]))
+        .WillOnce(Return(true));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_)).Times(0);
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+
+    mgg::AtomicRequest request;
+    EXPECT_FALSE(output.add_page_flip(request, *fb));
+    EXPECT_THAT(request.flips(), IsEmpty());
+}
+
+TEST_F(RealKMSOutputTest, set_crtc_is_an_atomic_modeset_if_the_driver_supports_it)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+    uint32_t const mode_blob{555};
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeCreatePropertyBlob(drm_fd, _, sizeof(drmModeModeInfo), _))
+        .WillOnce(DoAll(SetArgPointee<3>(mode_blob), Return(0)));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, crtc_ids[0], mock_drm.property_id(drm_device, crtc_ids[0], "MODE_ID"), mode_blob));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, connector_ids[0], mock_drm.property_id(drm_device, connector_ids[0], "CRTC_ID"), crtc_ids[0]));
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, primary_plane_id, mock_drm.property_id(drm_device, primary_plane_id, "FB_ID"), fb_id));
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(0));
+    EXPECT_CALL(mock_drm, drmModeDestroyPropertyBlob(drm_fd, mode_blob));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, _, _, _, _, _, _)).Times(0);
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+}
+
+TEST_F(RealKMSOutputTest, failed_atomic_modeset_falls_back_to_legacy)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(null_page_flipper)};
+
+    EXPECT_CALL(mock_drm, drmModeAtomicCommit(drm_fd, _, DRM_MODE_ATOMIC_ALLOW_MODESET, _))
+        .WillOnce(Return(-EINVAL));
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, _, _, _, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], fb_id, _, _, Pointee(connector_ids[0]), _, _));
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+}
+
+TEST_F(RealKMSOutputTest, overlay_planes_change_with_the_page_flip)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_planes({DRM_FORMAT_XRGB8888});
+
+    mgg::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper)};
+
+    append_fb_id(fb_id);
+    auto fb = output.fb_for(fake_bo);
+    EXPECT_TRUE(output.set_crtc(*fb));
+
+    output.set_overlays({{fb, DRM_FORMAT_XRGB8888, std::nullopt, {100, 100}, {{0, 0}, {100, 100}}}});
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, overlay_plane_id, mock_drm.property_id(drm_device, overlay_plane_id, "FB_ID"), fb_id));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(FlipsCrtc(crtc_ids[0], connector_ids[0])))
+        .WillOnce(CommitRequest());
+
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+
+    // Switching the overlays off disables the plane in the next flip
+    Mock::VerifyAndClearExpectations(&mock_drm);
+    Mock::VerifyAndClearExpectations(&mock_page_flipper);
+    output.set_overlays({});
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(
+        _, overlay_plane_id, mock_drm.property_id(drm_device, overlay_plane_id, "FB_ID"), 0));
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_))
+        .WillOnce(CommitRequest());
+
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+
+    Mock::VerifyAndClearExpectations(&mock_drm);
+    Mock::VerifyAndClearExpectations(&mock_page_flipper);
+
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, _, _, _)).Times(AnyNumber());
+    EXPECT_CALL(mock_drm, drmModeAtomicAddProperty(_, overlay_plane_id, _, _)).Times(0);
+    EXPECT_CALL(mock_page_flipper, schedule_atomic_flip(_))
+        .WillOnce(CommitRequest());
+
+    EXPECT_TRUE(output.schedule_page_flip(*fb));
+}
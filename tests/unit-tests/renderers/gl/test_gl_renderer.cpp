@@ -158,6 +158,19 @@ public:
     std::shared_ptr<testing::NiceMock<mtd::MockRenderable>> renderable;
     mg::RenderableList renderable_list;
     glm::mat4 trans;
+
+    auto renderable_at(mir::geometry::Rectangle const& position, bool shaped)
+        -> std::shared_ptr<testing::NiceMock<mtd::MockRenderable>>
+    {
+        auto const result = std::make_shared<testing::NiceMock<mtd::MockRenderable>>();
+        ON_CALL(*result, id()).WillByDefault(Return(result.get()));
+        ON_CALL(*result, buffer()).WillByDefault(Return(mock_buffer));
+        ON_CALL(*result, shaped()).WillByDefault(Return(shaped));
+        ON_CALL(*result, alpha()).WillByDefault(Return(1.0f));
+        ON_CALL(*result, transformation()).WillByDefault(Return(trans));
+        ON_CALL(*result, screen_position()).WillByDefault(Return(position));
+        return result;
+    }
 };
 
 }
@@ -183,6 +196,44 @@ TEST_F(GLRenderer, enables_blending_for_rgba_surfaces)
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, disables_blending_for_rgba_surfaces_opaque_where_drawn)
+{
+    EXPECT_CALL(*renderable, shaped()).WillOnce(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1, 2}, {3, 4}}}));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, enables_blending_for_rgba_surfaces_partly_opaque_where_drawn)
+{
+    EXPECT_CALL(*renderable, shaped()).WillOnce(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1, 2}, {3, 2}}}));
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, disables_blending_where_only_opaque_parts_are_damaged)
+{
+    EXPECT_CALL(*renderable, shaped()).WillOnce(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1, 2}, {3, 2}}}));
+    EXPECT_CALL(mock_gl, glEnable(_)).Times(AnyNumber());
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.set_damage({{1, 2}, {3, 1}});
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, enables_blending_for_rgbx_translucent_surfaces)
 {
     EXPECT_CALL(*renderable, alpha()).WillRepeatedly(Return(0.5f));
@@ -316,6 +367,39 @@ TEST_F(GLRenderer, dont_set_scissor_test_when_unnecessary)
 }
 
 
+TEST_F(GLRenderer, scissors_to_damage)
+{
+    EXPECT_CALL(mock_gl, glEnable(GL_SCISSOR_TEST));
+    EXPECT_CALL(mock_gl, glScissor(0, 3, 1, 1));
+    EXPECT_CALL(mock_gl, glDisable(GL_SCISSOR_TEST));
+
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.set_damage({{1, 2}, {1, 1}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, skips_renderables_outside_damage)
+{
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(0);
+
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.set_damage({{10, 10}, {1, 1}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, damage_only_applies_to_next_frame)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.set_damage({{1, 2}, {1, 1}});
+    renderer.render(renderable_list);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, unchanged_viewport_avoids_gl_calls)
 {
     int const screen_width = 1920;
@@ -466,3 +550,251 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+TEST_F(GLRenderer, reports_draw_calls)
+{
+    mrg::Renderer renderer(display_buffer);
+
+    renderer.render({renderable, renderable});
+
+    EXPECT_THAT(renderer.draw_calls(), testing::Eq(2u));
+}
+
+TEST_F(GLRenderer, batched_uploads_all_vertices_once_and_draws_from_the_buffer)
+{
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawMode::batched);
+
+    // Each quad is unrolled into two triangles
+    EXPECT_CALL(mock_gl, glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(mgl::Vertex), _, GL_STREAM_DRAW));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 0, 6));
+    EXPECT_CALL(mock_gl, glDrawArrays(GL_TRIANGLES, 6, 6));
+
+    renderer.render({renderable, renderable});
+
+    EXPECT_THAT(renderer.draw_calls(), testing::Eq(2u));
+}
+
+TEST_F(GLRenderer, batched_sets_shared_state_once)
+{
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawMode::batched);
+
+    EXPECT_CALL(mock_gl, glUseProgram(_)).Times(1);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(1);
+
+    renderer.render({
+        renderable_at({{0, 0}, {10, 10}}, false),
+        renderable_at({{20, 0}, {10, 10}}, false)});
+}
+
+TEST_F(GLRenderer, batched_groups_draws_that_do_not_overlap)
+{
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawMode::batched);
+
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(1);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(1);
+
+    renderer.render({
+        renderable_at({{0, 0}, {10, 10}}, false),
+        renderable_at({{0, 0}, {10, 10}}, true),
+        renderable_at({{20, 0}, {10, 10}}, false)});
+}
+
+TEST_F(GLRenderer, batched_keeps_stacking_order_of_overlapping_draws)
+{
+    mrg::Renderer renderer(display_buffer, mrg::Renderer::DrawMode::batched);
+
+    InSequence seq;
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+
+    renderer.render({
+        renderable_at({{0, 0}, {10, 10}}, false),
+        renderable_at({{0, 0}, {10, 10}}, true),
+        renderable_at({{5, 5}, {10, 10}}, false)});
+}
+
+namespace
+{
+// Fills a glReadPixels() destination with each row's index, counting up from the bottom as GL does
+void read_row_numbers(GLint, GLint, GLsizei width, GLsizei height, GLenum, GLenum, GLvoid* pixels)
+{
+    auto const dest = static_cast<uint32_t*>(pixels);
+    for (GLsizei row = 0; row != height; ++row)
+        std::fill(dest + row * width, dest + (row + 1) * width, static_cast<uint32_t>(row));
+}
+
+auto set_gl_viewport(GLint x, GLint y, GLint width, GLint height) -> std::function<void(GLenum, GLint*)>
+{
+    return [=](GLenum, GLint* params)
+        {
+            params[0] = x;
+            params[1] = y;
+            params[2] = width;
+            params[3] = height;
+        };
+}
+}
+
+TEST_F(GLRenderer, captures_area_before_swapping_with_top_row_first)
+{
+    using namespace testing;
+    mir::geometry::Rectangle const view_area{{1, 2}, {3, 4}};
+    ON_CALL(mock_display_buffer, view_area()).WillByDefault(Return(view_area));
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _)).WillByDefault(Invoke(set_gl_viewport(0, 0, 3, 4)));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.set_viewport(view_area);
+
+    std::vector<uint32_t> pixels(3 * 4, 0xdeadbeef);
+    bool captured{false};
+    renderer.capture_next_frame(view_area, pixels.data(), mir::geometry::Stride{3 * 4},
+        [&](bool success) { captured = success; });
+
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_gl, glReadPixels(0, 0, 3, 4, GL_BGRA_EXT, GL_UNSIGNED_BYTE, _))
+            .WillOnce(Invoke(read_row_numbers));
+        EXPECT_CALL(mock_display_buffer, swap_buffers());
+    }
+
+    renderer.render(renderable_list);
+
+    EXPECT_TRUE(captured);
+    EXPECT_THAT(pixels, ElementsAre(3, 3, 3, 2, 2, 2, 1, 1, 1, 0, 0, 0));
+}
+
+TEST_F(GLRenderer, captures_only_the_next_frame)
+{
+    using namespace testing;
+    mir::geometry::Rectangle const view_area{{1, 2}, {3, 4}};
+    ON_CALL(mock_display_buffer, view_area()).WillByDefault(Return(view_area));
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _)).WillByDefault(Invoke(set_gl_viewport(0, 0, 3, 4)));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.set_viewport(view_area);
+
+    std::vector<uint32_t> pixels(3 * 4);
+    int captures{0};
+    renderer.capture_next_frame(view_area, pixels.data(), mir::geometry::Stride{3 * 4},
+        [&](bool) { ++captures; });
+
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, _, _, _)).Times(1);
+
+    renderer.render(renderable_list);
+    renderer.render(renderable_list);
+
+    EXPECT_THAT(captures, Eq(1));
+}
+
+TEST_F(GLRenderer, fails_capture_of_a_scaled_viewport)
+{
+    using namespace testing;
+    mir::geometry::Rectangle const view_area{{1, 2}, {3, 4}};
+    ON_CALL(mock_display_buffer, view_area()).WillByDefault(Return(view_area));
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _)).WillByDefault(Invoke(set_gl_viewport(0, 0, 6, 8)));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.set_viewport(view_area);
+
+    std::vector<uint32_t> pixels(3 * 4);
+    std::experimental::optional<bool> captured;
+    renderer.capture_next_frame(view_area, pixels.data(), mir::geometry::Stride{3 * 4},
+        [&](bool success) { captured = success; });
+
+    EXPECT_CALL(mock_gl, glReadPixels(_, _, _, _, _, _, _)).Times(0);
+
+    renderer.render(renderable_list);
+
+    ASSERT_TRUE(captured);
+    EXPECT_FALSE(captured.value());
+}
+
+TEST_F(GLRenderer, captures_through_pixel_buffer_object_with_gles3)
+{
+    using namespace testing;
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.3")));
+    mir::geometry::Rectangle const view_area{{0, 0}, {4, 4}};
+    ON_CALL(mock_display_buffer, view_area()).WillByDefault(Return(view_area));
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _)).WillByDefault(Invoke(set_gl_viewport(0, 0, 4, 4)));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.set_viewport(view_area);
+
+    // The bottom right quarter of the output
+    std::vector<uint32_t> pixels(2 * 2);
+    bool captured{false};
+    renderer.capture_next_frame({{2, 2}, {2, 2}}, pixels.data(), mir::geometry::Stride{2 * 4},
+        [&](bool success) { captured = success; });
+
+    std::vector<uint32_t> pixel_buffer(2 * 2);
+    auto const fence = reinterpret_cast<GLsync>(0x5e7c);
+    ON_CALL(mock_gl, glGenBuffers(1, _)).WillByDefault(SetArgPointee<1>(7));
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_gl, glBindBuffer(GL_PIXEL_PACK_BUFFER, Ne(0u)));
+        EXPECT_CALL(mock_gl, glReadPixels(2, 0, 2, 2, GL_BGRA_EXT, GL_UNSIGNED_BYTE, nullptr))
+            .WillOnce(InvokeWithoutArgs([&] { read_row_numbers(0, 0, 2, 2, 0, 0, pixel_buffer.data()); }));
+        EXPECT_CALL(mock_gl, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+            .WillOnce(Return(fence));
+        EXPECT_CALL(mock_display_buffer, swap_buffers());
+    }
+    EXPECT_CALL(mock_gl, glMapBufferRange(_, _, _, _)).Times(0);
+
+    renderer.render(renderable_list);
+
+    // Waiting for the copy would stall the compositor, so it's collected with the next frame
+    EXPECT_FALSE(captured);
+    Mock::VerifyAndClearExpectations(&mock_gl);
+    Mock::VerifyAndClearExpectations(&mock_display_buffer);
+
+    {
+        InSequence seq;
+        EXPECT_CALL(mock_gl, glClientWaitSync(fence, 0, 0))
+            .WillOnce(Return(GL_ALREADY_SIGNALED));
+        EXPECT_CALL(mock_gl, glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 2 * 2 * 4, GL_MAP_READ_BIT))
+            .WillOnce(Return(pixel_buffer.data()));
+        EXPECT_CALL(mock_gl, glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+        EXPECT_CALL(mock_gl, glDeleteSync(fence));
+    }
+
+    renderer.render(renderable_list);
+
+    EXPECT_TRUE(captured);
+    EXPECT_THAT(pixels, ElementsAre(1, 1, 0, 0));
+}
+
+TEST_F(GLRenderer, pixel_buffer_object_capture_waits_for_the_copy_to_finish)
+{
+    using namespace testing;
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.3")));
+    mir::geometry::Rectangle const view_area{{0, 0}, {4, 4}};
+    ON_CALL(mock_display_buffer, view_area()).WillByDefault(Return(view_area));
+    ON_CALL(mock_gl, glGetIntegerv(GL_VIEWPORT, _)).WillByDefault(Invoke(set_gl_viewport(0, 0, 4, 4)));
+
+    auto const fence = reinterpret_cast<GLsync>(0x5e7c);
+    std::vector<uint32_t> pixel_buffer(4 * 4);
+    ON_CALL(mock_gl, glFenceSync(_, _)).WillByDefault(Return(fence));
+    ON_CALL(mock_gl, glMapBufferRange(_, _, _, _)).WillByDefault(Return(pixel_buffer.data()));
+
+    mrg::Renderer renderer(mock_display_buffer);
+    renderer.set_viewport(view_area);
+
+    std::vector<uint32_t> pixels(4 * 4);
+    bool captured{false};
+    renderer.capture_next_frame(view_area, pixels.data(), mir::geometry::Stride{4 * 4},
+        [&](bool success) { captured = success; });
+    renderer.render(renderable_list);
+
+    EXPECT_CALL(mock_gl, glClientWaitSync(fence, _, _))
+        .WillOnce(Return(GL_TIMEOUT_EXPIRED))
+        .WillOnce(Return(GL_CONDITION_SATISFIED));
+
+    renderer.render(renderable_list);
+    EXPECT_FALSE(captured);
+
+    renderer.render(renderable_list);
+    EXPECT_TRUE(captured);
+}
@@ -72,6 +72,7 @@ public:
     MOCK_METHOD2(cursor_image_set_to, void(ms::Surface const*, mir::graphics::CursorImage const& image));
     MOCK_METHOD1(cursor_image_removed, void(ms::Surface const*));
     MOCK_METHOD2(application_id_set_to, void(ms::Surface const*, std::string const&));
+    MOCK_METHOD2(input_region_set_to, void(ms::Surface const*, std::vector<geom::Rectangle> const&));
 };
 
 struct BasicSurfaceTest : public testing::Test
@@ -583,6 +584,35 @@ TEST_F(BasicSurfaceTest, set_input_region)
     }
 }
 
+TEST_F(BasicSurfaceTest, notifies_about_input_region_changes)
+{
+    using namespace testing;
+
+    std::vector<geom::Rectangle> const region{{{0, 0}, {1, 1}}};
+    NiceMock<MockSurfaceObserver> mock_surface_observer;
+
+    EXPECT_CALL(mock_surface_observer, input_region_set_to(_, region))
+        .Times(1);
+
+    surface.add_observer(mt::fake_shared(mock_surface_observer));
+
+    surface.set_input_region(region);
+}
+
+TEST_F(BasicSurfaceTest, input_region_bounds_include_input_region_outside_surface)
+{
+    using namespace testing;
+
+    EXPECT_THAT(surface.input_region_bounds(), Eq(surface.input_bounds()));
+
+    surface.set_input_region({{{-5, 0}, {1, 1}}, {{0, 0}, {1, 20}}});
+
+    auto const top_left = surface.input_bounds().top_left;
+    EXPECT_THAT(
+        surface.input_region_bounds(),
+        Eq(geom::Rectangle{top_left + geom::Displacement{-5, 0}, {5 + rect.size.width.as_int(), 20}}));
+}
+
 TEST_F(BasicSurfaceTest, updates_default_input_region_when_surface_is_resized_to_larger_size)
 {
     geom::Rectangle const new_rect{rect.top_left,{20,20}};
@@ -1638,3 +1668,78 @@ TEST_F(BasicSurfaceTest, buffer_can_be_submitted_to_set_stream_after_surface_des
     surface.reset();
     callback({10, 10});
 }
+
+TEST_F(BasicSurfaceTest, renderable_of_opaque_stream_is_opaque_everywhere)
+{
+    using namespace testing;
+
+    auto const renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+    EXPECT_THAT(renderables[0]->opaque_region(), Eq(geom::Rectangles{renderables[0]->screen_position()}));
+}
+
+TEST_F(BasicSurfaceTest, opaque_region_of_shaped_stream_is_mapped_to_the_screen)
+{
+    using namespace testing;
+
+    auto const stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    ON_CALL(*stream, stream_size()).WillByDefault(Return(geom::Size{6, 7}));
+    ON_CALL(*stream, opaque_region()).WillByDefault(Return(geom::Rectangles{{{1, 1}, {2, 3}}}));
+
+    // The stream is drawn at twice its logical size
+    surface.set_streams({{stream, {1, 1}, geom::Size{12, 14}}});
+
+    auto const renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+    ASSERT_TRUE(renderables[0]->shaped());
+    EXPECT_THAT(renderables[0]->opaque_region(), Eq(geom::Rectangles{{{7, 10}, {4, 6}}}));
+}
+
+TEST_F(BasicSurfaceTest, reuses_renderables_while_nothing_they_show_changes)
+{
+    using namespace testing;
+
+    auto const first = surface.generate_renderables(compositor_id);
+    auto const second = surface.generate_renderables(compositor_id);
+
+    ASSERT_THAT(first, SizeIs(1));
+    ASSERT_THAT(second, SizeIs(1));
+    EXPECT_THAT(second[0], Eq(first[0]));
+}
+
+TEST_F(BasicSurfaceTest, regenerates_renderables_when_surface_moves)
+{
+    using namespace testing;
+
+    auto const first = surface.generate_renderables(compositor_id);
+    surface.move_to({100, 100});
+    auto const second = surface.generate_renderables(compositor_id);
+
+    ASSERT_THAT(second, SizeIs(1));
+    EXPECT_THAT(second[0], Ne(first[0]));
+    EXPECT_THAT(second[0]->screen_position().top_left, Eq(geom::Point{100, 100}));
+}
+
+TEST_F(BasicSurfaceTest, regenerates_renderables_when_stream_has_a_new_buffer)
+{
+    using namespace testing;
+
+    auto const first = surface.generate_renderables(compositor_id);
+    mock_buffer_stream->buffers_ready_ = 1;
+    auto const second = surface.generate_renderables(compositor_id);
+
+    ASSERT_THAT(second, SizeIs(1));
+    EXPECT_THAT(second[0], Ne(first[0]));
+}
+
+TEST_F(BasicSurfaceTest, generates_separate_renderables_for_each_compositor)
+{
+    using namespace testing;
+    int const other_compositor{0};
+
+    auto const first = surface.generate_renderables(compositor_id);
+    auto const other = surface.generate_renderables(&other_compositor);
+
+    ASSERT_THAT(other, SizeIs(1));
+    EXPECT_THAT(other[0], Ne(first[0]));
+}
@@ -225,3 +225,151 @@ TEST_F(GLPixelBufferTest, returns_data_from_rgba_buffer_texture)
     EXPECT_EQ(width - 1,
               static_cast<uint32_t const*>(data)[width * height - 1]);
 }
+
+TEST_F(GLPixelBufferTest, only_tries_bgra_once_if_unsupported)
+{
+    using namespace testing;
+    uint32_t const width{mock_buffer.size().width.as_uint32_t()};
+    uint32_t const height{mock_buffer.size().height.as_uint32_t()};
+
+    ON_CALL(mock_gl, glGetError())
+        .WillByDefault(Return(GL_INVALID_ENUM));
+
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, _))
+        .Times(1);
+    EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, _))
+        .Times(3);
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    for (int i = 0; i != 3; ++i)
+    {
+        pixels.fill_from(mock_buffer);
+        pixels.as_argb_8888();
+    }
+}
+
+TEST_F(GLPixelBufferTest, reads_back_through_pixel_buffer_object_on_gles3)
+{
+    using namespace testing;
+    GLuint const pbo{30};
+    GLuint const copy_fbo{31};
+    auto const fence = reinterpret_cast<GLsync>(0xfe7ce);
+    uint32_t const width{mock_buffer.size().width.as_uint32_t()};
+    uint32_t const height{mock_buffer.size().height.as_uint32_t()};
+
+    std::vector<uint32_t> gpu_pixels(width * height);
+    for (uint32_t i = 0; i < width * height; ++i)
+        gpu_pixels[i] = i;
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.3")));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    EXPECT_CALL(mock_gl, glGenFramebuffers(1,_))
+        .WillOnce(Return())
+        .WillOnce(SetArgPointee<1>(copy_fbo));
+    EXPECT_CALL(mock_gl, glBindFramebuffer(_,_))
+        .Times(AnyNumber());
+
+    {
+        InSequence s;
+
+        /* The GPU copies the buffer to a texture of our own, and we wait only for that */
+        EXPECT_CALL(mock_gl, glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, _));
+        EXPECT_CALL(mock_gl, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0))
+            .WillOnce(Return(fence));
+        EXPECT_CALL(mock_gl, glClientWaitSync(fence,_,_))
+            .WillOnce(Return(GL_CONDITION_SATISFIED));
+        EXPECT_CALL(mock_gl, glDeleteSync(fence));
+        EXPECT_CALL(mock_gl, glBindFramebuffer(GL_FRAMEBUFFER, copy_fbo));
+        EXPECT_CALL(mock_gl, glGenBuffers(1,_))
+            .WillOnce(SetArgPointee<1>(pbo));
+        EXPECT_CALL(mock_gl, glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo));
+        EXPECT_CALL(mock_gl, glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_READ));
+        /* The GPU reads our copy back into the PBO: nothing is read into client memory */
+        EXPECT_CALL(mock_gl, glReadPixels(0, 0, width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, nullptr));
+        EXPECT_CALL(mock_gl, glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    }
+    EXPECT_CALL(mock_gl, glClientWaitSync(Ne(fence),_,_)).Times(0);
+
+    EXPECT_CALL(mock_gl, glMapBufferRange(_,_,_,_)).Times(0);
+
+    pixels.fill_from(mock_buffer);
+
+    Mock::VerifyAndClearExpectations(&mock_gl);
+
+    {
+        InSequence s;
+
+        /* The pixels are collected when they're needed */
+        EXPECT_CALL(mock_gl, glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo));
+        EXPECT_CALL(mock_gl, glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, width * height * 4, GL_MAP_READ_BIT))
+            .WillOnce(Return(gpu_pixels.data()));
+        EXPECT_CALL(mock_gl, glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+        EXPECT_CALL(mock_gl, glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    }
+
+    auto data = pixels.as_argb_8888();
+
+    /* Check that data has been properly y-flipped */
+    EXPECT_EQ(1,
+              static_cast<uint32_t const*>(data)[width * (height - 1) + 1]);
+    EXPECT_EQ(width * (height / 2),
+              static_cast<uint32_t const*>(data)[width * (height / 2)]);
+    EXPECT_EQ(width * (height - 1),
+              static_cast<uint32_t const*>(data)[0]);
+    EXPECT_EQ(width - 1,
+              static_cast<uint32_t const*>(data)[width * height - 1]);
+
+    EXPECT_CALL(mock_gl, glDeleteBuffers(1, Pointee(pbo)));
+}
+
+TEST_F(GLPixelBufferTest, copy_of_the_buffer_completes_before_the_buffer_is_released)
+{
+    using namespace testing;
+    auto const fence = reinterpret_cast<GLsync>(0xfe7ce);
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.3")));
+    ON_CALL(mock_gl, glFenceSync(_,_))
+        .WillByDefault(Return(fence));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    /* The stream only lends us its buffer for the duration of fill_from() */
+    bool buffer_held{false};
+    EXPECT_CALL(mock_gl, glClientWaitSync(fence,_,_))
+        .WillOnce(InvokeWithoutArgs(
+            [&buffer_held]()
+            {
+                EXPECT_TRUE(buffer_held);
+                return GL_CONDITION_SATISFIED;
+            }));
+
+    buffer_held = true;
+    pixels.fill_from(mock_buffer);
+    buffer_held = false;
+}
+
+TEST_F(GLPixelBufferTest, fails_rather_than_waiting_forever_for_the_copy)
+{
+    using namespace testing;
+    auto const fence = reinterpret_cast<GLsync>(0xfe7ce);
+
+    ON_CALL(mock_gl, glGetString(GL_VERSION))
+        .WillByDefault(Return(reinterpret_cast<GLubyte const*>("OpenGL ES 3.2 Mesa 21.0.3")));
+    ON_CALL(mock_gl, glFenceSync(_,_))
+        .WillByDefault(Return(fence));
+
+    ms::GLPixelBuffer pixels{std::move(context)};
+
+    EXPECT_CALL(mock_gl, glClientWaitSync(fence, _, Gt(0u)))
+        .WillOnce(Return(GL_TIMEOUT_EXPIRED));
+    EXPECT_CALL(mock_gl, glDeleteSync(fence));
+    EXPECT_CALL(mock_gl, glReadPixels(_,_,_,_,_,_,_)).Times(0);
+
+    EXPECT_THROW(pixels.fill_from(mock_buffer), std::runtime_error);
+    EXPECT_EQ(geom::Size(), pixels.size());
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/spatial_index.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+namespace
+{
+struct Item
+{
+    bool accepts{true};
+};
+
+struct SpatialIndex : Test
+{
+    auto at(int x, int y) -> std::shared_ptr<Item>
+    {
+        return index.top_item_at({x, y}, [](Item const& item) { return item.accepts; });
+    }
+
+    ms::SpatialIndex<Item> index;
+    std::shared_ptr<Item> const bottom{std::make_shared<Item>()};
+    std::shared_ptr<Item> const middle{std::make_shared<Item>()};
+    std::shared_ptr<Item> const top{std::make_shared<Item>()};
+};
+}
+
+TEST_F(SpatialIndex, finds_topmost_item_containing_point)
+{
+    index.add(bottom, {{0, 0}, {1000, 1000}});
+    index.add(middle, {{100, 100}, {500, 500}});
+    index.add(top, {{300, 300}, {100, 100}});
+
+    EXPECT_THAT(at(350, 350), Eq(top));
+    EXPECT_THAT(at(150, 150), Eq(middle));
+    EXPECT_THAT(at(900, 900), Eq(bottom));
+    EXPECT_THAT(at(1000, 1000), IsNull());
+    EXPECT_THAT(at(-1, -1), IsNull());
+}
+
+TEST_F(SpatialIndex, skips_items_that_are_not_accepted)
+{
+    index.add(bottom, {{0, 0}, {100, 100}});
+    index.add(top, {{0, 0}, {100, 100}});
+    top->accepts = false;
+
+    EXPECT_THAT(at(50, 50), Eq(bottom));
+}
+
+TEST_F(SpatialIndex, follows_updated_bounds)
+{
+    index.add(bottom, {{0, 0}, {100, 100}});
+    index.update(bottom.get(), {{2000, 2000}, {100, 100}});
+
+    EXPECT_THAT(at(50, 50), IsNull());
+    EXPECT_THAT(at(2050, 2050), Eq(bottom));
+}
+
+TEST_F(SpatialIndex, follows_restacking)
+{
+    index.add(bottom, {{0, 0}, {100, 100}});
+    index.add(top, {{0, 0}, {100, 100}});
+
+    index.restack(std::vector<Item const*>{top.get(), bottom.get()});
+
+    EXPECT_THAT(at(50, 50), Eq(bottom));
+}
+
+TEST_F(SpatialIndex, removed_items_are_not_found)
+{
+    index.add(bottom, {{0, 0}, {100, 100}});
+    index.add(top, {{0, 0}, {100, 100}});
+    index.remove(top.get());
+
+    EXPECT_THAT(at(50, 50), Eq(bottom));
+    index.update(top.get(), {{0, 0}, {100, 100}});
+    EXPECT_THAT(at(50, 50), Eq(bottom));
+}
+
+TEST_F(SpatialIndex, handles_negative_coordinates)
+{
+    index.add(bottom, {{-300, -300}, {200, 200}});
+
+    EXPECT_THAT(at(-101, -101), Eq(bottom));
+    EXPECT_THAT(at(-100, -100), IsNull());
+    EXPECT_THAT(at(-301, -200), IsNull());
+}
+
+TEST_F(SpatialIndex, oversized_items_stack_with_the_others)
+{
+    index.add(bottom, {{0, 0}, {100, 100}});
+    index.add(middle, {{-100000, -100000}, {200000, 200000}});
+    index.add(top, {{0, 0}, {10, 10}});
+
+    EXPECT_THAT(at(5, 5), Eq(top));
+    EXPECT_THAT(at(50, 50), Eq(middle));
+    EXPECT_THAT(at(50000, 50000), Eq(middle));
+
+    index.restack(std::vector<Item const*>{middle.get(), bottom.get(), top.get()});
+    EXPECT_THAT(at(50, 50), Eq(bottom));
+}
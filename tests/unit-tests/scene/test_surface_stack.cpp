@@ -240,7 +240,7 @@ TEST_F(SurfaceStack, scene_counts_pending_accurately)
     ms::SurfaceStack stack{report};
     stack.register_compositor(this);
 
-    auto stream = std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888);
+    auto stream = std::make_shared<mc::Stream>(geom::Size{ 1, 1 }, mir_pixel_format_abgr_8888, mr::null_compositor_report());
 
     auto surface = std::make_shared<ms::BasicSurface>(
         nullptr /* session */,
@@ -996,6 +996,38 @@ TEST_F(SurfaceStack, returns_top_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, surface_under_cursor_follows_moves_and_raises)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+    stub_surface2->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+
+    stub_surface2->move_to({0, 0});
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({1050, 1050}).get(), IsNull());
+
+    stack.raise(stub_surface1);
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+}
+
+TEST_F(SurfaceStack, surface_under_cursor_includes_input_region_outside_surface)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stub_surface1->resize({100, 100});
+
+    EXPECT_THAT(stack.surface_at({650, 650}).get(), IsNull());
+
+    stub_surface1->set_input_region({{{0, 0}, {100, 100}}, {{600, 600}, {100, 100}}});
+    EXPECT_THAT(stack.surface_at({650, 650}), Eq(stub_surface1));
+    EXPECT_THAT(stack.input_surface_at({650, 650}), Eq(stub_surface1));
+}
+
 TEST_F(SurfaceStack, returns_top_visible_surface_under_cursor)
 {
     geom::Point const cursor_over_all {100, 100};
@@ -112,6 +112,37 @@ TEST_F(ThreadedSnapshotStrategyTest, takes_snapshot)
     EXPECT_EQ(pixels, snapshot.pixels);
 }
 
+TEST_F(ThreadedSnapshotStrategyTest, reports_failure_to_fill_pixels_as_empty_snapshot)
+{
+    using namespace testing;
+
+    MockPixelBuffer pixel_buffer;
+
+    EXPECT_CALL(pixel_buffer, fill_from(_))
+        .WillOnce(Throw(std::runtime_error{"Timed out copying buffer for readback"}));
+    EXPECT_CALL(pixel_buffer, as_argb_8888())
+        .Times(0);
+
+    ms::ThreadedSnapshotStrategy strategy{mt::fake_shared(pixel_buffer)};
+
+    mt::Signal snapshot_taken;
+
+    ms::Snapshot snapshot{geom::Size{1, 1}, geom::Stride{4}, &snapshot};
+
+    strategy.take_snapshot_of(
+        mt::fake_shared(buffer_access),
+        [&](ms::Snapshot const& s)
+        {
+            snapshot = s;
+            snapshot_taken.raise();
+        });
+
+    ASSERT_TRUE(snapshot_taken.wait_for(std::chrono::seconds{5}));
+
+    EXPECT_EQ(geom::Size{}, snapshot.size);
+    EXPECT_EQ(nullptr, snapshot.pixels);
+}
+
 #ifndef MIR_DONT_USE_PTHREAD_GETNAME_NP
 TEST_F(ThreadedSnapshotStrategyTest, names_snapshot_thread)
 {
@@ -155,7 +155,8 @@ struct DecorationBasicDecoration
                 {
                     creation_params = params;
                     decoration_surface.resize(params.size);
-                    decoration_surface.add_observer(observer);
+                    if (observer)
+                        decoration_surface.add_observer(observer);
                     return mt::fake_shared(decoration_surface);
                 }));
         ON_CALL(*session, create_buffer_stream(_))
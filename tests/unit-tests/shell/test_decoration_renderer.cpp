@@ -0,0 +1,237 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/shell/decoration/renderer.h"
+#include "src/server/shell/decoration/window.h"
+#include "src/server/shell/decoration/input.h"
+
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/stub_surface.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace geom = mir::geometry;
+namespace msd = mir::shell::decoration;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+
+namespace
+{
+using Pixel = msd::Renderer::Pixel;
+using Text = msd::Renderer::Text;
+
+Pixel const focused_background   = 0xFF323232;
+Pixel const unfocused_background = 0xFF808080;
+Pixel const unfocused_text       = 0xFFA0A0A0;
+
+struct FakeFont : Text::Font
+{
+    explicit FakeFont(std::map<char32_t, int>& renders)
+        : renders{renders}
+    {
+    }
+
+    auto render(char32_t codepoint, geom::Height height_pixels) -> Text::Glyph override
+    {
+        ++renders[codepoint];
+
+        Text::Glyph glyph;
+        glyph.rect = {{0, 0}, {2, height_pixels.as_int()}};
+        glyph.advance = {3, 0};
+        glyph.alpha.assign(2 * height_pixels.as_int(), 0xFF);
+        return glyph;
+    }
+
+    std::map<char32_t, int>& renders;
+};
+
+struct MockText : Text
+{
+    MOCK_METHOD2(rasterize, Coverage(std::string const&, geom::Height));
+};
+
+/// Fully covers a solid block, so the blended pixels are exactly the text color
+auto solid_title(geom::Rectangle const& extents) -> Text::Coverage
+{
+    return {extents, std::vector<unsigned char>(extents.size.width.as_int() * extents.size.height.as_int(), 0xFF)};
+}
+
+struct StubWindow : mtd::StubSurface
+{
+    std::string name() const override { return name_; }
+    geom::Size window_size() const override { return {100, 60}; }
+    MirWindowState state() const override { return mir_window_state_restored; }
+    MirWindowFocusState focus_state() const override { return focus; }
+
+    std::string name_{"old"};
+    MirWindowFocusState focus{mir_window_focus_state_focused};
+};
+
+struct DecorationRenderer : Test
+{
+    DecorationRenderer()
+    {
+        ON_CALL(*text, rasterize(std::string{"old"}, _))
+            .WillByDefault(Return(old_title));
+        ON_CALL(*text, rasterize(std::string{"new"}, _))
+            .WillByDefault(Return(new_title));
+    }
+
+    void update(msd::Renderer& renderer)
+    {
+        renderer.update_state(msd::WindowState{static_geometry, window}, msd::InputState{buttons, {}});
+    }
+
+    auto titlebar(msd::Renderer& renderer) -> std::vector<Pixel>
+    {
+        auto const buffer = renderer.render_titlebar();
+        EXPECT_TRUE(buffer);
+        auto const& bytes = std::dynamic_pointer_cast<mtd::StubBuffer>(buffer.value())->written_pixels;
+        std::vector<Pixel> pixels(bytes.size() / sizeof(Pixel));
+        std::memcpy(pixels.data(), bytes.data(), bytes.size());
+        return pixels;
+    }
+
+    static auto at(std::vector<Pixel> const& pixels, geom::Point point) -> Pixel
+    {
+        return pixels[point.y.as_int() * 100 + point.x.as_int()];
+    }
+
+    std::shared_ptr<msd::StaticGeometry const> const static_geometry{
+        std::make_shared<msd::StaticGeometry const>(msd::StaticGeometry{
+            geom::Height{24},       // titlebar_height
+            geom::Width{6},         // side_border_width
+            geom::Height{6},        // bottom_border_height
+            geom::Size{16, 16},     // resize_corner_input_size
+            geom::Width{24},        // button_width
+            geom::Width{6},         // padding_between_buttons
+            geom::Height{14},       // title_font_height
+            geom::Point{8, 2},      // title_font_top_left
+            geom::Displacement{5, 5},// icon_padding
+            geom::Width{2},         // icon_line_width
+        })};
+    std::shared_ptr<StubWindow> const window{std::make_shared<StubWindow>()};
+    // The close button lies under the end of the old title, but not the new one
+    std::vector<msd::ButtonInfo> const buttons{
+        {msd::ButtonFunction::Close, msd::ButtonState::Up, {{70, 0}, {24, 24}}}};
+
+    // Placed in the titlebar at title_font_top_left
+    Text::Coverage const old_title{solid_title({{0, 2}, {70, 10}})};
+    Text::Coverage const new_title{solid_title({{0, 2}, {20, 10}})};
+
+    std::shared_ptr<NiceMock<MockText>> const text{std::make_shared<NiceMock<MockText>>()};
+    std::shared_ptr<mtd::StubBufferAllocator> const allocator{std::make_shared<mtd::StubBufferAllocator>()};
+};
+}
+
+TEST(DecorationText, second_rasterize_uses_cached_glyphs)
+{
+    std::map<char32_t, int> renders;
+    auto const text = Text::with_font(std::make_unique<FakeFont>(renders));
+
+    auto const first = text->rasterize("abba", geom::Height{14});
+    auto const second = text->rasterize("abba", geom::Height{14});
+
+    EXPECT_THAT(renders, ElementsAre(Pair(U'a', 1), Pair(U'b', 1)));
+    EXPECT_THAT(second.extents, Eq(first.extents));
+    EXPECT_THAT(second.alpha, Eq(first.alpha));
+}
+
+TEST(DecorationText, glyphs_are_cached_per_height)
+{
+    std::map<char32_t, int> renders;
+    auto const text = Text::with_font(std::make_unique<FakeFont>(renders));
+
+    text->rasterize("a", geom::Height{14});
+    text->rasterize("a", geom::Height{20});
+    text->rasterize("a", geom::Height{14});
+
+    EXPECT_THAT(renders[U'a'], Eq(2));
+}
+
+TEST(DecorationText, lays_out_glyphs_at_their_advance)
+{
+    std::map<char32_t, int> renders;
+    auto const text = Text::with_font(std::make_unique<FakeFont>(renders));
+
+    auto const coverage = text->rasterize("abc", geom::Height{10});
+
+    // Glyphs 2 wide, 3 apart
+    EXPECT_THAT(coverage.extents, Eq(geom::Rectangle{{0, 0}, {8, 10}}));
+    EXPECT_THAT(coverage.alpha[2], Eq(0));
+    EXPECT_THAT(coverage.alpha[3], Eq(0xFF));
+}
+
+TEST_F(DecorationRenderer, focus_change_reblends_title_without_rasterizing)
+{
+    EXPECT_CALL(*text, rasterize(_, _)).Times(1);
+
+    msd::Renderer renderer{allocator, static_geometry, text};
+    update(renderer);
+    auto const focused = titlebar(renderer);
+    EXPECT_THAT(at(focused, {2, 20}), Eq(focused_background));
+
+    window->focus = mir_window_focus_state_unfocused;
+    update(renderer);
+    auto const unfocused = titlebar(renderer);
+
+    EXPECT_THAT(at(unfocused, {2, 20}), Eq(unfocused_background));
+    EXPECT_THAT(at(unfocused, {10, 6}), Eq(unfocused_text));
+}
+
+TEST_F(DecorationRenderer, name_change_rasterizes_the_new_name_only)
+{
+    InSequence seq;
+    EXPECT_CALL(*text, rasterize(std::string{"old"}, _));
+    EXPECT_CALL(*text, rasterize(std::string{"new"}, _));
+
+    msd::Renderer renderer{allocator, static_geometry, text};
+    update(renderer);
+    titlebar(renderer);
+
+    window->name_ = "new";
+    update(renderer);
+    titlebar(renderer);
+}
+
+TEST_F(DecorationRenderer, name_change_redraws_old_and_new_titles_with_buttons_intact)
+{
+    msd::Renderer renderer{allocator, static_geometry, text};
+    update(renderer);
+    auto const before = titlebar(renderer);
+
+    window->name_ = "new";
+    update(renderer);
+    auto const after = titlebar(renderer);
+
+    // Where only the old title was is back to the background...
+    EXPECT_THAT(at(before, {40, 6}), Ne(focused_background));
+    EXPECT_THAT(at(after, {40, 6}), Eq(focused_background));
+
+    // ...the close button the old title overlapped is redrawn...
+    EXPECT_THAT(at(after, {72, 6}), Eq(at(before, {72, 6})));
+    EXPECT_THAT(at(after, {72, 6}), Ne(focused_background));
+
+    // ...and the result is what a full redraw gives
+    msd::Renderer fresh{allocator, static_geometry, text};
+    update(fresh);
+    EXPECT_THAT(after, Eq(titlebar(fresh)));
+}
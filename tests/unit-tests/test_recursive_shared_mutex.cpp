@@ -0,0 +1,231 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/recursive_shared_mutex.h"
+
+#include "mir/test/barrier.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace mt = mir::test;
+
+using namespace testing;
+
+namespace
+{
+/* Like those for RecursiveReadWriteMutex, these tests fail by hanging. */
+struct RecursiveSharedMutex : public Test
+{
+    int const recursion_depth{1729};
+    unsigned const reader_threads{42};
+    mt::Barrier readonly_barrier{reader_threads};
+    mt::Barrier read_and_write_barrier{reader_threads+1};
+    std::vector<std::thread> threads;
+
+    mir::RecursiveSharedMutex mutex;
+
+    void SetUp()
+    {
+        threads.reserve(reader_threads+1);
+    }
+
+    void TearDown()
+    {
+        for (auto& thread : threads)
+            if (thread.joinable()) thread.join();
+    }
+
+    MOCK_METHOD0(notify_read_locked, void());
+    MOCK_METHOD0(notify_read_unlocking, void());
+    MOCK_METHOD0(notify_write_locked, void());
+    MOCK_METHOD0(notify_write_unlocking, void());
+};
+}
+
+TEST_F(RecursiveSharedMutex, can_be_recursively_read_locked)
+{
+    for (int i = 0; i != recursion_depth; ++i)
+        mutex.lock_shared();
+
+    for (int i = 0; i != recursion_depth; ++i)
+        mutex.unlock_shared();
+}
+
+TEST_F(RecursiveSharedMutex, can_be_recursively_write_locked)
+{
+    for (int i = 0; i != recursion_depth; ++i)
+        mutex.lock();
+
+    for (int i = 0; i != recursion_depth; ++i)
+        mutex.unlock();
+}
+
+TEST_F(RecursiveSharedMutex, can_be_write_locked_on_thread_with_read_lock)
+{
+    std::shared_lock<decltype(mutex)> read{mutex};
+    std::lock_guard<decltype(mutex)> write{mutex};
+}
+
+TEST_F(RecursiveSharedMutex, can_be_read_locked_on_thread_with_write_lock)
+{
+    std::lock_guard<decltype(mutex)> write{mutex};
+    std::shared_lock<decltype(mutex)> read{mutex};
+}
+
+TEST_F(RecursiveSharedMutex, can_be_read_locked_on_multiple_threads)
+{
+    auto const reader_function =
+        [&]{
+            mutex.lock_shared();
+            notify_read_locked();
+
+            readonly_barrier.ready();
+
+            notify_read_unlocking();
+            mutex.unlock_shared();
+        };
+
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_read_locked()).Times(reader_threads);
+    EXPECT_CALL(*this, notify_read_unlocking()).Times(reader_threads);
+
+    for (auto i = 0U; i != reader_threads; ++i)
+        threads.push_back(std::thread{reader_function});
+}
+
+TEST_F(RecursiveSharedMutex, write_lock_waits_for_read_locks_on_other_threads)
+{
+    auto const reader_function =
+        [&]{
+            mutex.lock_shared();
+            notify_read_locked();
+
+            read_and_write_barrier.ready();
+
+            notify_read_unlocking();
+            mutex.unlock_shared();
+        };
+
+    auto const writer_function =
+        [&]{
+            read_and_write_barrier.ready();
+
+            mutex.lock();
+            notify_write_locked();
+            mutex.unlock();
+        };
+
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_read_locked()).Times(reader_threads);
+    EXPECT_CALL(*this, notify_read_unlocking()).Times(reader_threads);
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+
+    for (auto i = 0U; i != reader_threads; ++i)
+        threads.push_back(std::thread{reader_function});
+
+    threads.push_back(std::thread{writer_function});
+}
+
+TEST_F(RecursiveSharedMutex, read_lock_waits_for_write_locks_on_other_threads)
+{
+    auto const reader_function =
+        [&]{
+            read_and_write_barrier.ready();
+
+            mutex.lock_shared();
+            notify_read_locked();
+            mutex.unlock_shared();
+        };
+
+    auto const writer_function =
+        [&]{
+            mutex.lock();
+            notify_write_locked();
+
+            read_and_write_barrier.ready();
+
+            notify_write_unlocking();
+            mutex.unlock();
+        };
+
+    InSequence seq;
+
+    EXPECT_CALL(*this, notify_write_locked()).Times(1);
+    EXPECT_CALL(*this, notify_write_unlocking()).Times(1);
+    EXPECT_CALL(*this, notify_read_locked()).Times(reader_threads);
+
+    for (auto i = 0U; i != reader_threads; ++i)
+        threads.push_back(std::thread{reader_function});
+
+    threads.push_back(std::thread{writer_function});
+}
+
+TEST_F(RecursiveSharedMutex, waiting_writer_does_not_block_recursive_read_lock)
+{
+    std::atomic<bool> written{false};
+
+    mutex.lock_shared();
+
+    std::thread writer{[&]
+        {
+            std::lock_guard<decltype(mutex)> lock{mutex};
+            written = true;
+        }};
+
+    // Give the writer a chance to start waiting for us
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+    mutex.lock_shared();
+    EXPECT_FALSE(written);
+    mutex.unlock_shared();
+    mutex.unlock_shared();
+
+    writer.join();
+    EXPECT_TRUE(written);
+}
+
+TEST_F(RecursiveSharedMutex, write_locks_exclude_each_other)
+{
+    int const iterations{1000};
+    unsigned const writer_threads{8};
+    int counter{0};
+
+    for (auto i = 0U; i != writer_threads; ++i)
+    {
+        threads.push_back(std::thread{[&]
+            {
+                for (int j = 0; j != iterations; ++j)
+                {
+                    std::lock_guard<decltype(mutex)> lock{mutex};
+                    std::shared_lock<decltype(mutex)> nested{mutex};
+                    ++counter;
+                }
+            }});
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(counter, Eq(static_cast<int>(iterations*writer_threads)));
+}
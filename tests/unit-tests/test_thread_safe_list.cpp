@@ -22,6 +22,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <thread>
+
 namespace
 {
 
@@ -157,3 +160,78 @@ TEST_F(ThreadSafeListTest, clears_all_elements)
 
     EXPECT_THAT(elements_seen, Eq(0));
 }
+
+TEST_F(ThreadSafeListTest, remove_waits_for_element_in_use_in_different_thread)
+{
+    using namespace testing;
+
+    list.add(element1);
+
+    mir::test::Signal element_in_use;
+    std::atomic<bool> callback_finished{false};
+
+    std::thread t{
+        [&]
+        {
+            list.for_each(
+                [&] (Element const&)
+                {
+                    element_in_use.raise();
+                    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+                    callback_finished = true;
+                });
+        }};
+
+    element_in_use.wait_for(std::chrono::seconds{3});
+    list.remove(element1);
+
+    EXPECT_TRUE(callback_finished);
+
+    t.join();
+}
+
+TEST_F(ThreadSafeListTest, can_remove_element_while_iterating_it_in_nested_iteration)
+{
+    using namespace testing;
+
+    list.add(element1);
+    list.add(element2);
+
+    int elements_seen = 0;
+
+    list.for_each(
+        [&] (Element const&)
+        {
+            list.for_each(
+                [&] (Element const& element)
+                {
+                    list.remove(element);
+                });
+            ++elements_seen;
+        });
+
+    EXPECT_THAT(elements_seen, Eq(1));
+}
+
+TEST_F(ThreadSafeListTest, elements_added_while_iterating_are_seen_by_later_iterations)
+{
+    using namespace testing;
+
+    list.add(element1);
+
+    int elements_seen = 0;
+
+    list.for_each(
+        [&] (Element const&)
+        {
+            list.add(element2);
+            ++elements_seen;
+        });
+
+    EXPECT_THAT(elements_seen, Eq(1));
+
+    elements_seen = 0;
+    list.for_each([&] (Element const&) { ++elements_seen; });
+
+    EXPECT_THAT(elements_seen, Eq(2));
+}
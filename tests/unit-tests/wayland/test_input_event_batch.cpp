@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2021 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/input_event_batch.h"
+
+#include "mir/events/event_builders.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <linux/input-event-codes.h>
+
+namespace mf = mir::frontend;
+namespace mev = mir::events;
+
+using namespace testing;
+
+namespace
+{
+struct InputEventBatch : Test
+{
+    MirInputDeviceId const device_id{7};
+    MirInputEventModifiers const modifiers{mir_input_event_modifier_none};
+
+    auto motion(float x, float y, float dx, float dy, MirPointerButtons buttons = 0) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            device_id, std::chrono::nanoseconds{++time}, {}, modifiers,
+            mir_pointer_action_motion, buttons, x, y, 0.0f, 1.0f, dx, dy);
+    }
+
+    auto button(MirPointerAction action, MirPointerButtons buttons) -> mir::EventUPtr
+    {
+        return mev::make_event(
+            device_id, std::chrono::nanoseconds{++time}, {}, modifiers,
+            action, buttons, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    }
+
+    auto key() -> mir::EventUPtr
+    {
+        return mev::make_event(
+            device_id, std::chrono::nanoseconds{++time}, {}, mir_keyboard_action_down, 0, KEY_A, modifiers);
+    }
+
+    auto touch(MirTouchAction action, float x, float y) -> mir::EventUPtr
+    {
+        auto event = mev::make_event(device_id, std::chrono::nanoseconds{++time}, {}, modifiers);
+        mev::add_touch(*event, 0, action, mir_touch_tooltype_finger, x, y, 1.0f, 1.0f, 1.0f, 1.0f);
+        return event;
+    }
+
+    static auto pointer(MirEvent const& event) -> MirPointerEvent const*
+    {
+        return mir_input_event_get_pointer_event(mir_event_get_input_event(&event));
+    }
+
+    static auto touch_of(MirEvent const& event) -> MirTouchEvent const*
+    {
+        return mir_input_event_get_touch_event(mir_event_get_input_event(&event));
+    }
+
+    int64_t time{0};
+    mf::InputEventBatch batch{true};
+};
+}
+
+TEST_F(InputEventBatch, only_the_first_event_needs_scheduling)
+{
+    EXPECT_TRUE(batch.add(*key()));
+    EXPECT_FALSE(batch.add(*key()));
+
+    EXPECT_THAT(batch.take().size(), Eq(2u));
+    EXPECT_TRUE(batch.add(*key()));
+}
+
+TEST_F(InputEventBatch, consecutive_pointer_motion_is_coalesced)
+{
+    batch.add(*motion(1, 2, 1, 2));
+    batch.add(*motion(4, 6, 3, 4));
+    batch.add(*motion(9, 8, 5, 2));
+
+    auto const entries = batch.take();
+
+    ASSERT_THAT(entries.size(), Eq(1u));
+    auto const event = pointer(*entries[0].event);
+    EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_x), Eq(9.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_y), Eq(8.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_x), Eq(9.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_relative_y), Eq(8.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(event, mir_pointer_axis_vscroll), Eq(3.0f));
+    EXPECT_THAT(mir_input_event_get_event_time(mir_event_get_input_event(entries[0].event.get())), Eq(time));
+}
+
+TEST_F(InputEventBatch, coalesced_motion_keeps_full_history)
+{
+    batch.add(*motion(1, 2, 1, 2));
+    batch.add(*motion(4, 6, 3, 4));
+    batch.add(*motion(9, 8, 5, 2));
+
+    auto const entries = batch.take();
+
+    ASSERT_THAT(entries.size(), Eq(1u));
+    auto const& history = entries[0].history;
+    ASSERT_THAT(history.size(), Eq(3u));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(*history[0]), mir_pointer_axis_relative_x), Eq(1.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(*history[1]), mir_pointer_axis_relative_x), Eq(3.0f));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(*history[2]), mir_pointer_axis_relative_x), Eq(5.0f));
+}
+
+TEST_F(InputEventBatch, buttons_and_keys_keep_their_order_with_motion)
+{
+    batch.add(*motion(1, 1, 1, 1));
+    batch.add(*motion(2, 2, 1, 1));
+    batch.add(*button(mir_pointer_action_button_down, mir_pointer_button_primary));
+    batch.add(*motion(3, 3, 1, 1, mir_pointer_button_primary));
+    batch.add(*key());
+    batch.add(*motion(4, 4, 1, 1, mir_pointer_button_primary));
+    batch.add(*motion(5, 5, 1, 1, mir_pointer_button_primary));
+
+    auto const entries = batch.take();
+
+    ASSERT_THAT(entries.size(), Eq(5u));
+    EXPECT_THAT(mir_pointer_event_action(pointer(*entries[0].event)), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(mir_pointer_event_action(pointer(*entries[1].event)), Eq(mir_pointer_action_button_down));
+    EXPECT_THAT(mir_pointer_event_action(pointer(*entries[2].event)), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(mir_input_event_get_type(mir_event_get_input_event(entries[3].event.get())),
+                Eq(mir_input_event_type_key));
+    EXPECT_THAT(mir_pointer_event_axis_value(pointer(*entries[4].event), mir_pointer_axis_x), Eq(5.0f));
+}
+
+TEST_F(InputEventBatch, motion_with_different_buttons_is_not_coalesced)
+{
+    batch.add(*motion(1, 1, 1, 1));
+    batch.add(*motion(2, 2, 1, 1, mir_pointer_button_secondary));
+
+    EXPECT_THAT(batch.take().size(), Eq(2u));
+}
+
+TEST_F(InputEventBatch, touch_motion_is_coalesced_but_not_down_or_up)
+{
+    batch.add(*touch(mir_touch_action_down, 1, 1));
+    batch.add(*touch(mir_touch_action_change, 2, 2));
+    batch.add(*touch(mir_touch_action_change, 3, 3));
+    batch.add(*touch(mir_touch_action_up, 3, 3));
+
+    auto const entries = batch.take();
+
+    ASSERT_THAT(entries.size(), Eq(3u));
+    EXPECT_THAT(mir_touch_event_action(touch_of(*entries[0].event), 0), Eq(mir_touch_action_down));
+    EXPECT_THAT(mir_touch_event_axis_value(touch_of(*entries[1].event), 0, mir_touch_axis_x), Eq(3.0f));
+    EXPECT_THAT(entries[1].history.size(), Eq(2u));
+    EXPECT_THAT(mir_touch_event_action(touch_of(*entries[2].event), 0), Eq(mir_touch_action_up));
+}
+
+TEST_F(InputEventBatch, nothing_is_coalesced_when_disabled)
+{
+    mf::InputEventBatch batch{false};
+
+    batch.add(*motion(1, 1, 1, 1));
+    batch.add(*motion(2, 2, 1, 1));
+
+    EXPECT_THAT(batch.take().size(), Eq(2u));
+}
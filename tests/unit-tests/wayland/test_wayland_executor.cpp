@@ -82,6 +82,22 @@ TEST_F(WaylandExecutorTest, dispatching_the_event_loop_dispatches_spawned_task)
     EXPECT_TRUE(executed);
 }
 
+TEST_F(WaylandExecutorTest, one_dispatch_runs_all_queued_tasks_in_order)
+{
+    mf::WaylandExecutor executor{the_event_loop};
+
+    std::vector<int> executed;
+    for (auto i = 0; i != 10; ++i)
+    {
+        executor.spawn([&executed, i]() { executed.push_back(i); });
+    }
+
+    wl_event_loop_dispatch(the_event_loop, 0);
+
+    EXPECT_THAT(executed, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+    EXPECT_THAT(event_loop_fd, Not(FdIsReadable()));
+}
+
 TEST_F(WaylandExecutorTest, can_spawn_more_tasks_from_a_task)
 {
     using namespace std::literals::chrono_literals;